@@ -0,0 +1,247 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned MESSAGE_SIZE = 64u;
+static constexpr unsigned THROUGHPUT_MESSAGES = 1000000u;
+static constexpr unsigned PING_PONGS = 20000u;
+
+static atomic_uint s_pongs = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void print_result(char const *const name, uint64_t const throughputNs, uint64_t const pingPongNs)
+{
+   printf("%-12s: %10.0f msg/s | round trip %6.2f us\n", name,
+      THROUGHPUT_MESSAGES / (throughputNs / 1000000000.0),
+      (pingPongNs / 1000.0) / PING_PONGS
+   );
+}
+
+static void wait_child(pid_t const pid)
+{
+   int status;
+   assert(waitpid(pid, &status, 0) == pid);
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Channels
+//------------------------------------------------------------------------------------------------
+
+static void count_message(void const *, unsigned, void *)
+{
+}
+
+static void reply_message(void const *message, unsigned const length, void *arg)
+{
+   while (!psignal_channel_send(arg, message, length))
+   {
+      sched_yield();
+   }
+}
+
+static void count_pong(void const *, unsigned, void *)
+{
+   atomic_fetch_add(&s_pongs, 1u);
+}
+
+static void bench_channels(void)
+{
+   unsigned char message[MESSAGE_SIZE] = {};
+   PSigChannelConfig const config = { .capacity = 4096u, .messageSize = MESSAGE_SIZE };
+
+   // Throughput: the child consumes, the parent produces as fast as it can.
+   PSigChannel *channel;
+   assert(psignal_channel_create(&config, &channel));
+
+   pid_t const consumer = fork();
+   assert(consumer >= 0);
+   if (consumer == 0)
+   {
+      assert(psignal_channel_consume(channel, &count_message, nullptr));
+      while (psignal_channel_stats(channel).received < THROUGHPUT_MESSAGES)
+      {
+         nanosleep(&(struct timespec) { .tv_nsec = 1000000 }, nullptr);
+      }
+      _exit(0);
+   }
+
+   uint64_t start = now_ns();
+   for (unsigned i = 0; i < THROUGHPUT_MESSAGES; ++i)
+   {
+      while (!psignal_channel_send(channel, message, MESSAGE_SIZE))
+      {
+         sched_yield();
+      }
+   }
+   wait_child(consumer);
+   uint64_t const throughputNs = now_ns() - start;
+
+   PSigChannelStats const stats = psignal_channel_stats(channel);
+   printf("channels    : %llu doorbells for %llu messages (%llu full rings)\n",
+      stats.doorbells, stats.sent, stats.full
+   );
+   psignal_channel_close(channel);
+
+   // Latency: one message at a time, the child echoes it back.
+   PSigChannel *requests;
+   PSigChannel *replies;
+   assert(psignal_channel_create(&config, &requests));
+   assert(psignal_channel_create(&config, &replies));
+
+   pid_t const echo = fork();
+   assert(echo >= 0);
+   if (echo == 0)
+   {
+      assert(psignal_channel_consume(requests, &reply_message, replies));
+      while (psignal_channel_stats(requests).received < PING_PONGS)
+      {
+         nanosleep(&(struct timespec) { .tv_nsec = 1000000 }, nullptr);
+      }
+      _exit(0);
+   }
+
+   atomic_store(&s_pongs, 0u);
+   assert(psignal_channel_consume(replies, &count_pong, nullptr));
+
+   start = now_ns();
+   for (unsigned i = 0; i < PING_PONGS; ++i)
+   {
+      assert(psignal_channel_send(requests, message, MESSAGE_SIZE));
+      while (atomic_load(&s_pongs) <= i)
+      {
+         sched_yield();
+      }
+   }
+   uint64_t const pingPongNs = now_ns() - start;
+   wait_child(echo);
+
+   psignal_channel_close(requests);
+   psignal_channel_close(replies);
+
+   print_result("channels", throughputNs, pingPongNs);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// File descriptors (pipes, unix sockets)
+//------------------------------------------------------------------------------------------------
+
+typedef bool (*OpenFn)(int fds[2]);
+
+static bool open_pipe(int fds[2])
+{
+   return pipe(fds) == 0;
+}
+
+static bool open_socket(int fds[2])
+{
+   return socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == 0;
+}
+
+static void read_message(int const fd, unsigned char *const message)
+{
+   for (size_t got = 0u; got < MESSAGE_SIZE;)
+   {
+      ssize_t const n = read(fd, message + got, MESSAGE_SIZE - got);
+      assert(n > 0);
+      got += (size_t)n;
+   }
+}
+
+static void bench_fds(char const *const name, OpenFn const open_fn)
+{
+   unsigned char message[MESSAGE_SIZE] = {};
+
+   int data[2];
+   assert(open_fn(data));
+
+   pid_t const consumer = fork();
+   assert(consumer >= 0);
+   if (consumer == 0)
+   {
+      close(data[1]);
+      for (unsigned i = 0; i < THROUGHPUT_MESSAGES; ++i)
+      {
+         read_message(data[0], message);
+      }
+      _exit(0);
+   }
+   close(data[0]);
+
+   uint64_t start = now_ns();
+   for (unsigned i = 0; i < THROUGHPUT_MESSAGES; ++i)
+   {
+      assert(write(data[1], message, MESSAGE_SIZE) == MESSAGE_SIZE);
+   }
+   wait_child(consumer);
+   uint64_t const throughputNs = now_ns() - start;
+   close(data[1]);
+
+   int requests[2];
+   int replies[2];
+   assert(open_fn(requests) && open_fn(replies));
+
+   pid_t const echo = fork();
+   assert(echo >= 0);
+   if (echo == 0)
+   {
+      for (unsigned i = 0; i < PING_PONGS; ++i)
+      {
+         read_message(requests[0], message);
+         assert(write(replies[1], message, MESSAGE_SIZE) == MESSAGE_SIZE);
+      }
+      _exit(0);
+   }
+
+   start = now_ns();
+   for (unsigned i = 0; i < PING_PONGS; ++i)
+   {
+      assert(write(requests[1], message, MESSAGE_SIZE) == MESSAGE_SIZE);
+      read_message(replies[0], message);
+   }
+   uint64_t const pingPongNs = now_ns() - start;
+   wait_child(echo);
+
+   close(requests[0]);
+   close(requests[1]);
+   close(replies[0]);
+   close(replies[1]);
+
+   print_result(name, throughputNs, pingPongNs);
+}
+
+
+int main(void)
+{
+   printf("Channels benchmark (%u bytes messages, across processes)...\n", MESSAGE_SIZE);
+
+   assert(psignal_library_init());
+   assert(psignal_channels_init());
+
+   bench_channels();
+   bench_fds("pipe", &open_pipe);
+   bench_fds("unix socket", &open_socket);
+
+   psignal_channels_shutdown();
+   psignal_library_shutdown();
+
+   return 0;
+}
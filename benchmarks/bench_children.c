@@ -0,0 +1,89 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned MAX_CHILDREN = 4096u;
+static unsigned const CHILDREN_COUNTS[] = { 64u, 512u, 2048u, 4096u };
+
+static atomic_uint s_exits = 0u;
+static atomic_ullong s_lastExitNs = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void on_child_exit(PSigChildExit const *)
+{
+   atomic_fetch_add(&s_exits, 1u);
+   atomic_store(&s_lastExitNs, now_ns());
+}
+
+// Forks children blocked on a pipe, then releases them all at once by closing it.
+static void bench_storm(unsigned const childrenCount)
+{
+   atomic_store(&s_exits, 0u);
+
+   int pipeFds[2];
+   assert(pipe(pipeFds) == 0);
+
+   for (unsigned i = 0; i < childrenCount; ++i)
+   {
+      pid_t const pid = fork();
+      assert(pid >= 0);
+      if (pid == 0)
+      {
+         char byte;
+         close(pipeFds[1]);
+         (void)read(pipeFds[0], &byte, 1);
+         _exit(0);
+      }
+      assert(psignal_children_watch(pid, &on_child_exit, nullptr));
+   }
+   close(pipeFds[0]);
+
+   PSigChildrenStats const before = psignal_children_stats();
+   uint64_t const start = now_ns();
+   close(pipeFds[1]);
+
+   while (atomic_load(&s_exits) < childrenCount)
+   {
+      nanosleep(&(struct timespec) { .tv_nsec = 100000 }, nullptr);
+   }
+
+   uint64_t const elapsedNs = atomic_load(&s_lastExitNs) - start;
+   PSigChildrenStats const after = psignal_children_stats();
+   assert(after.dispatched - before.dispatched == childrenCount);
+
+   printf("%5u children: all reaped in %8.2f ms | %9.0f exits/s\n", childrenCount,
+      elapsedNs / 1000000.0,
+      childrenCount / (elapsedNs / 1000000000.0)
+   );
+}
+
+
+int main(void)
+{
+   printf("Children reaping benchmark...\n");
+
+   assert(psignal_library_init());
+   assert(psignal_children_init(&(PSigChildrenConfig) { .capacity = MAX_CHILDREN }));
+
+   for (unsigned i = 0; i < sizeof(CHILDREN_COUNTS) / sizeof(CHILDREN_COUNTS[0]); ++i)
+   {
+      bench_storm(CHILDREN_COUNTS[i]);
+   }
+
+   psignal_children_shutdown();
+   psignal_library_shutdown();
+
+   return 0;
+}
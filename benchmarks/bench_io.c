@@ -0,0 +1,197 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Many connections, few of them active at a time.
+static constexpr unsigned MAX_CONNECTIONS = 8192u;
+static constexpr unsigned ACTIVE_PER_ROUND = 16u;
+static constexpr unsigned ROUNDS = 500u;
+static unsigned const CONNECTION_COUNTS[] = { 256u, 2048u, 8192u };
+
+static int s_readFds[MAX_CONNECTIONS];
+static int s_writeFds[MAX_CONNECTIONS];
+static atomic_uint s_bytesSeen = 0u;
+static atomic_bool s_stop = false;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(void const *lhs, void const *rhs)
+{
+   uint64_t const a = *(uint64_t const *)lhs;
+   uint64_t const b = *(uint64_t const *)rhs;
+   return (a > b) - (a < b);
+}
+
+static void drain(int const fd)
+{
+   char buffer[64];
+   ssize_t got;
+   while ((got = read(fd, buffer, sizeof(buffer))) > 0)
+   {
+      atomic_fetch_add(&s_bytesSeen, (unsigned)got);
+   }
+}
+
+static void open_connections(unsigned const count)
+{
+   for (unsigned i = 0; i < count; ++i)
+   {
+      int fds[2];
+      assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+      s_readFds[i] = fds[0];
+      s_writeFds[i] = fds[1];
+   }
+}
+
+static void close_connections(unsigned const count)
+{
+   for (unsigned i = 0; i < count; ++i)
+   {
+      close(s_readFds[i]);
+      close(s_writeFds[i]);
+   }
+}
+
+// Activates a few random connections per round, measures how long until all of them were read.
+static void run_rounds(char const *const name, unsigned const count, uint64_t const armNs)
+{
+   uint64_t samples[ROUNDS];
+   char const byte = 'x';
+
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      atomic_store(&s_bytesSeen, 0u);
+
+      uint64_t const start = now_ns();
+      for (unsigned i = 0; i < ACTIVE_PER_ROUND; ++i)
+      {
+         assert(write(s_writeFds[(unsigned)rand() % count], &byte, 1) == 1);
+      }
+      while (atomic_load(&s_bytesSeen) < ACTIVE_PER_ROUND) {}
+      samples[round] = now_ns() - start;
+   }
+
+   qsort(samples, ROUNDS, sizeof(*samples), &compare_u64);
+   printf("%-8s %5u fds: arm %8.1f us | round p50 %7.1f us | p99 %7.1f us\n", name, count,
+      armNs / 1000.0,
+      samples[ROUNDS / 2] / 1000.0,
+      samples[(ROUNDS * 99) / 100] / 1000.0
+   );
+}
+
+
+//------------------------------------------------------------------------------------------------
+// F_SETSIG
+//------------------------------------------------------------------------------------------------
+
+static void on_ready(PSigIoEvent const *events, unsigned const count, void *)
+{
+   for (unsigned i = 0; i < count; ++i)
+   {
+      drain(events[i].fd);
+   }
+}
+
+static void bench_rt_signals(unsigned const count)
+{
+   open_connections(count);
+
+   uint64_t const start = now_ns();
+   for (unsigned i = 0; i < count; ++i)
+   {
+      assert(psignal_io_arm(s_readFds[i], POLLIN, nullptr));
+   }
+   uint64_t const armNs = now_ns() - start;
+
+   run_rounds("F_SETSIG", count, armNs);
+
+   for (unsigned i = 0; i < count; ++i)
+   {
+      psignal_io_disarm(s_readFds[i]);
+   }
+   close_connections(count);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// epoll
+//------------------------------------------------------------------------------------------------
+
+static void *epoll_main(void *arg)
+{
+   int const epollFd = *(int const *)arg;
+   struct epoll_event events[64];
+
+   while (!atomic_load(&s_stop))
+   {
+      int const ready = epoll_wait(epollFd, events, 64, 100);
+      for (int i = 0; i < ready; ++i)
+      {
+         drain(events[i].data.fd);
+      }
+   }
+   return nullptr;
+}
+
+static void bench_epoll(unsigned const count)
+{
+   open_connections(count);
+
+   int epollFd = epoll_create1(0);
+   assert(epollFd >= 0);
+
+   uint64_t const start = now_ns();
+   for (unsigned i = 0; i < count; ++i)
+   {
+      struct epoll_event event = { .events = EPOLLIN | EPOLLET, .data.fd = s_readFds[i] };
+      assert(epoll_ctl(epollFd, EPOLL_CTL_ADD, s_readFds[i], &event) == 0);
+   }
+   uint64_t const armNs = now_ns() - start;
+
+   pthread_t thread;
+   atomic_store(&s_stop, false);
+   assert(pthread_create(&thread, nullptr, &epoll_main, &epollFd) == 0);
+
+   run_rounds("epoll", count, armNs);
+
+   atomic_store(&s_stop, true);
+   pthread_join(thread, nullptr);
+   close(epollFd);
+   close_connections(count);
+}
+
+
+int main(void)
+{
+   printf("I/O readiness benchmark (%u rounds of %u active connections)...\n", ROUNDS, ACTIVE_PER_ROUND);
+
+   assert(psignal_library_init());
+   assert(psignal_io_init(&(PSigIoConfig) { .callback = &on_ready }));
+
+   for (unsigned i = 0; i < sizeof(CONNECTION_COUNTS) / sizeof(CONNECTION_COUNTS[0]); ++i)
+   {
+      bench_rt_signals(CONNECTION_COUNTS[i]);
+      bench_epoll(CONNECTION_COUNTS[i]);
+   }
+
+   psignal_io_shutdown();
+   psignal_library_shutdown();
+
+   return 0;
+}
@@ -0,0 +1,90 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static constexpr unsigned ROUNDS = 200000u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// What the library did before the masks API: every PSignal is checked.
+static void to_sigset_loop(PSignalMask const mask, sigset_t *const set)
+{
+   sigemptyset(set);
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if ((mask >> idx) & 1u)
+      {
+         sigaddset(set, psignal_to_raw_signal(idx));
+      }
+   }
+}
+
+static PSignalMask from_sigset_loop(sigset_t const *const set)
+{
+   PSignalMask mask = 0u;
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (sigismember(set, psignal_to_raw_signal(idx)) == 1)
+      {
+         mask |= (PSignalMask)1u << idx;
+      }
+   }
+   return mask;
+}
+
+static uint64_t bench_round_trip(PSignalMask const mask, bool const bitScan)
+{
+   PSignalMask check = 0u;
+   uint64_t const start = now_ns();
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      sigset_t set;
+      if (bitScan)
+      {
+         psignal_mask_to_sigset(mask, &set);
+         check ^= psignal_mask_from_sigset(&set);
+      }
+      else
+      {
+         to_sigset_loop(mask, &set);
+         check ^= from_sigset_loop(&set);
+      }
+   }
+   uint64_t const elapsedNs = now_ns() - start;
+
+   assert(check == ((ROUNDS & 1u) ? mask : 0u));
+   return elapsedNs;
+}
+
+static void bench_mask(char const *const name, PSignalMask const mask)
+{
+   uint64_t const scanNs = bench_round_trip(mask, true);
+   uint64_t const loopNs = bench_round_trip(mask, false);
+   printf("%-18s (%2u signals): bit-scan %7.2f ns | full loop %7.2f ns (x%.1f)\n", name,
+      psignal_mask_count(mask), scanNs / (double)ROUNDS, loopNs / (double)ROUNDS,
+      (double)loopNs / (double)scanNs
+   );
+}
+
+
+int main(void)
+{
+   printf("PSignalMask <-> sigset_t round trip benchmark...\n");
+
+   bench_mask("one signal", psignal_mask_of(PSignal_SIGTERM));
+   bench_mask("dispatcher", psignal_mask_of(PSignal_SIGIO) | psignal_mask_of(PSignal_SIGRTMAX));
+   bench_mask("terminate", psignal_disposition_mask(PSigDisposition_TERMINATE));
+   bench_mask("all", psignal_disposition_mask_all());
+
+   return 0;
+}
@@ -0,0 +1,77 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+static constexpr unsigned ROUNDS = 200000u;
+
+static char const *const NAMES[] =
+{
+   "SIGTERM", "SIGINT", "SIGHUP", "SIGUSR1", "SIGCHLD", "SIGWINCH", "SIGSYS", "SIGRTMIN + 3",
+   "SIGRTMAX - 2", "SIGPIPE", "SIGKILL", "SIGSEGV"
+};
+static constexpr unsigned NAMES_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// What a config layer does without psignal_from_name.
+static bool from_name_linear(char const *const name, PSignal *const out)
+{
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (strcasecmp(psignal_name(idx), name) == 0)
+      {
+         *out = idx;
+         return true;
+      }
+   }
+   return false;
+}
+
+static uint64_t bench_parse(bool (*const parse)(char const *, PSignal *), unsigned *const checksum)
+{
+   unsigned sum = 0u;
+   uint64_t const start = now_ns();
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      for (unsigned i = 0; i < NAMES_COUNT; ++i)
+      {
+         PSignal psig;
+         bool const found = parse(NAMES[i], &psig);
+         assert(found);
+         sum += psig;
+      }
+   }
+   uint64_t const elapsedNs = now_ns() - start;
+
+   *checksum = sum;
+   return elapsedNs;
+}
+
+
+int main(void)
+{
+   printf("Signal names parsing benchmark...\n");
+
+   unsigned hashSum, linearSum;
+   uint64_t const hashNs = bench_parse(&psignal_from_name, &hashSum);
+   uint64_t const linearNs = bench_parse(&from_name_linear, &linearSum);
+   assert(hashSum == linearSum);
+
+   double const parses = (double)ROUNDS * NAMES_COUNT;
+   printf("psignal_from_name: %7.2f ns/name | linear strcasecmp: %7.2f ns/name (x%.1f)\n",
+      hashNs / parses, linearNs / parses, (double)linearNs / (double)hashNs
+   );
+
+   return 0;
+}
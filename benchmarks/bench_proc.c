@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned PROCESSES = 4000u;
+static constexpr unsigned THREADS_PER_PROCESS = 4u;
+
+static atomic_uint s_visited = 0u;
+static atomic_ullong s_checksum = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void write_file(char const *const path, char const *const content)
+{
+   FILE *const file = fopen(path, "w");
+   assert(file != nullptr);
+   fputs(content, file);
+   fclose(file);
+}
+
+static int remove_entry(char const *path, struct stat const *, int, struct FTW *)
+{
+   return remove(path);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Synthetic /proc: <root>/<pid>/status and <root>/<pid>/task/<tid>/status, made from the status
+// of this process with a different blocked mask for each task.
+//------------------------------------------------------------------------------------------------
+
+static void make_status(char *const out, size_t const capacity, char const *const model, unsigned const task)
+{
+   char const *const line = strstr(model, "SigBlk:");
+   assert(line != nullptr);
+
+   int const prefix = (int)(line - model);
+   char const *const rest = strchr(line, '\n');
+   snprintf(out, capacity, "%.*sSigBlk:\t%016llx%s", prefix, model,
+      (unsigned long long)task * 0x10001u, rest
+   );
+}
+
+static void make_tree(char const *const root)
+{
+   char model[8192];
+   int const fd = open("/proc/self/status", O_RDONLY);
+   ssize_t const size = read(fd, model, sizeof(model) - 1u);
+   close(fd);
+   assert(size > 0);
+   model[size] = '\0';
+
+   char path[256];
+   char status[8192];
+   for (unsigned process = 0; process < PROCESSES; ++process)
+   {
+      unsigned const pid = 1000u + process * THREADS_PER_PROCESS;
+      snprintf(path, sizeof(path), "%s/%u", root, pid);
+      mkdir(path, 0755);
+      make_status(status, sizeof(status), model, pid);
+      snprintf(path, sizeof(path), "%s/%u/status", root, pid);
+      write_file(path, status);
+
+      snprintf(path, sizeof(path), "%s/%u/task", root, pid);
+      mkdir(path, 0755);
+      for (unsigned thread = 0; thread < THREADS_PER_PROCESS; ++thread)
+      {
+         snprintf(path, sizeof(path), "%s/%u/task/%u", root, pid, pid + thread);
+         mkdir(path, 0755);
+         make_status(status, sizeof(status), model, pid + thread);
+         snprintf(path, sizeof(path), "%s/%u/task/%u/status", root, pid, pid + thread);
+         write_file(path, status);
+      }
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// What the node agent does without the library: generic line and string parsing.
+//------------------------------------------------------------------------------------------------
+
+static void read_status_generic(char const *const path)
+{
+   FILE *const file = fopen(path, "r");
+   if (file == nullptr)
+      return;
+
+   char *line = nullptr;
+   size_t capacity = 0u;
+   unsigned long long blocked = 0u;
+   while (getline(&line, &capacity, file) > 0)
+   {
+      char *const colon = strchr(line, ':');
+      if (colon == nullptr)
+         continue;
+
+      *colon = '\0';
+      if (strcmp(line, "SigBlk") == 0)
+      {
+         blocked = strtoull(colon + 1, nullptr, 16);
+      }
+      else if (strcmp(line, "SigPnd") == 0 || strcmp(line, "ShdPnd") == 0
+         || strcmp(line, "SigIgn") == 0 || strcmp(line, "SigCgt") == 0)
+      {
+         (void)strtoull(colon + 1, nullptr, 16);
+      }
+   }
+   free(line);
+   fclose(file);
+
+   sigset_t set;
+   sigemptyset(&set);
+   for (int sig = 1; sig <= 64; ++sig)
+   {
+      if ((blocked >> (sig - 1)) & 1u)
+      {
+         sigaddset(&set, sig);
+      }
+   }
+   atomic_fetch_add(&s_visited, 1u);
+   atomic_fetch_add(&s_checksum, psignal_mask_from_sigset(&set));
+}
+
+static void scan_generic(char const *const root)
+{
+   DIR *const processes = opendir(root);
+   assert(processes != nullptr);
+
+   struct dirent *process;
+   char path[1024];
+   while ((process = readdir(processes)) != nullptr)
+   {
+      if (process->d_name[0] < '0' || process->d_name[0] > '9')
+         continue;
+
+      snprintf(path, sizeof(path), "%s/%s/task", root, process->d_name);
+      DIR *const threads = opendir(path);
+      if (threads == nullptr)
+         continue;
+
+      struct dirent *thread;
+      while ((thread = readdir(threads)) != nullptr)
+      {
+         if (thread->d_name[0] < '0' || thread->d_name[0] > '9')
+            continue;
+
+         snprintf(path, sizeof(path), "%s/%s/task/%s/status", root, process->d_name, thread->d_name);
+         read_status_generic(path);
+      }
+      closedir(threads);
+   }
+   closedir(processes);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Benchmark
+//------------------------------------------------------------------------------------------------
+
+static void count_state(PSigProcState const *const state, void *)
+{
+   atomic_fetch_add(&s_visited, 1u);
+   atomic_fetch_add(&s_checksum, state->blocked);
+}
+
+static uint64_t bench_scan(char const *const root, unsigned const workers, unsigned long long *const checksum)
+{
+   atomic_store(&s_visited, 0u);
+   atomic_store(&s_checksum, 0u);
+
+   uint64_t const start = now_ns();
+   if (workers == 0u)
+   {
+      scan_generic(root);
+   }
+   else
+   {
+      PSigProcScanConfig const config = { .root = root, .threads = true, .workers = workers };
+      assert(psignal_proc_scan(&config, &count_state, nullptr));
+   }
+   uint64_t const elapsedNs = now_ns() - start;
+
+   assert(atomic_load(&s_visited) == PROCESSES * THREADS_PER_PROCESS);
+   *checksum = atomic_load(&s_checksum);
+   return elapsedNs;
+}
+
+
+int main(void)
+{
+   unsigned const tasks = PROCESSES * THREADS_PER_PROCESS;
+   printf("/proc signal state scan benchmark (%u synthetic threads)...\n", tasks);
+
+   char root[] = "/tmp/bench_proc_XXXXXX";
+   assert(mkdtemp(root) != nullptr);
+   make_tree(root);
+
+   unsigned long long genericSum, scanSum;
+   (void)bench_scan(root, 0u, &genericSum); // Warms the dentry cache up.
+   uint64_t const genericNs = bench_scan(root, 0u, &genericSum);
+   printf("%-20s: %8.2f ms | %6.2f us/thread\n", "generic parsing", genericNs / 1000000.0,
+      genericNs / 1000.0 / tasks
+   );
+
+   static unsigned const WORKERS[] = { 1u, 2u, 4u, 8u };
+   for (unsigned i = 0; i < sizeof(WORKERS) / sizeof(WORKERS[0]); ++i)
+   {
+      uint64_t const scanNs = bench_scan(root, WORKERS[i], &scanSum);
+      assert(scanSum == genericSum);
+      printf("psignal_proc_scan x%u: %8.2f ms | %6.2f us/thread (x%.1f)\n", WORKERS[i],
+         scanNs / 1000000.0, scanNs / 1000.0 / tasks, (double)genericNs / (double)scanNs
+      );
+   }
+
+   nftw(root, &remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+   return 0;
+}
@@ -0,0 +1,90 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static constexpr unsigned ROUNDS = 2000000u;
+
+// Reached through pointers, the queries can't be inlined: each use is an out-of-line call.
+static bool (*volatile s_isStandard)(PSignal) = &psignal_is_standard;
+static bool (*volatile s_isRealTime)(PSignal) = &psignal_is_real_time;
+static bool (*volatile s_validate)(unsigned) = &psignal_validate;
+static PSigDisposition (*volatile s_dispositionDefault)(PSignal) = &psignal_disposition_default;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void print_result(char const *const name, uint64_t const inlineNs, uint64_t const callNs)
+{
+   double const queries = (double)ROUNDS * PSignal_ENUM_COUNT;
+   printf("%-28s: inline %6.3f ns/query | call %6.3f ns/query (x%.1f)\n", name,
+      inlineNs / queries, callNs / queries, (double)callNs / (double)inlineNs
+   );
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Classification loop, as found in the dispatch and setup paths.
+//------------------------------------------------------------------------------------------------
+
+static unsigned count_inline(void)
+{
+   unsigned count = 0u;
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      for (unsigned value = round & 1u; value < PSignal_ENUM_COUNT + (round & 1u); ++value)
+      {
+         if (!psignal_validate(value))
+            continue;
+
+         PSignal const psig = (PSignal)value;
+         count += psignal_is_standard(psig) + psignal_is_real_time(psig);
+         count += psignal_disposition_default(psig) == PSigDisposition_TERMINATE;
+      }
+   }
+   return count;
+}
+
+static unsigned count_calls(void)
+{
+   unsigned count = 0u;
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      for (unsigned value = round & 1u; value < PSignal_ENUM_COUNT + (round & 1u); ++value)
+      {
+         if (!s_validate(value))
+            continue;
+
+         PSignal const psig = (PSignal)value;
+         count += s_isStandard(psig) + s_isRealTime(psig);
+         count += s_dispositionDefault(psig) == PSigDisposition_TERMINATE;
+      }
+   }
+   return count;
+}
+
+
+int main(void)
+{
+   printf("Pure queries benchmark...\n");
+
+   uint64_t start = now_ns();
+   unsigned const inlineCount = count_inline();
+   uint64_t const inlineNs = now_ns() - start;
+
+   start = now_ns();
+   unsigned const callCount = count_calls();
+   uint64_t const callNs = now_ns() - start;
+
+   assert(inlineCount == callCount);
+   print_result("validate+classify+disp", inlineNs, callNs);
+
+   return 0;
+}
@@ -0,0 +1,67 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned ITERATIONS = 200000u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static double cost_ns(long const nr)
+{
+   uint64_t const start = now_ns();
+   for (unsigned i = 0; i < ITERATIONS; ++i)
+   {
+      (void)syscall(nr, 0);
+   }
+   return (double)(now_ns() - start) / ITERATIONS;
+}
+
+static bool emulate(PSigSyscall *call)
+{
+   call->result = 1;
+   return true;
+}
+
+static bool passthrough(PSigSyscall *)
+{
+   return false;
+}
+
+
+int main(void)
+{
+   printf("Seccomp trap benchmark (%u calls per measure)...\n", ITERATIONS);
+
+   assert(psignal_library_init());
+   assert(psignal_seccomp_init());
+
+   double const native = cost_ns(SYS_getppid);
+   double const nativeOther = cost_ns(SYS_getpid);
+
+   assert(psignal_seccomp_set_handler(SYS_getppid, &emulate, nullptr));
+   assert(psignal_seccomp_set_handler(SYS_getsid, &passthrough, nullptr));
+   assert(psignal_seccomp_install());
+
+   double const emulated = cost_ns(SYS_getppid);
+   double const passedThrough = cost_ns(SYS_getsid);
+   double const filtered = cost_ns(SYS_getpid);
+
+   printf("native syscall            : %8.1f ns\n", native);
+   printf("untrapped, behind filter  : %8.1f ns (%+.1f ns)\n", filtered, filtered - nativeOther);
+   printf("trapped and emulated      : %8.1f ns\n", emulated);
+   printf("trapped and run for real  : %8.1f ns\n", passedThrough);
+
+   // The filter stays installed: the library isn't shut down, trapped syscalls still need it.
+   return 0;
+}
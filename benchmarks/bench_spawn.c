@@ -0,0 +1,90 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned SPAWNS = 500u;
+static size_t const RSS_SIZES[] = { 0u, 64u << 20u, 256u << 20u };
+
+static char *const s_argv[] = { "true", nullptr };
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void wait_child(pid_t const pid)
+{
+   int status;
+   assert(waitpid(pid, &status, 0) == pid);
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static pid_t spawn_fork_exec(void)
+{
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      execv("/bin/true", s_argv);
+      _exit(127);
+   }
+   return pid;
+}
+
+static pid_t spawn_psignal(void)
+{
+   pid_t pid;
+   assert(psignal_spawn(&pid, "/bin/true", s_argv, nullptr, nullptr));
+   return pid;
+}
+
+static double bench_spawns(pid_t (*const spawn)(void))
+{
+   uint64_t const start = now_ns();
+   for (unsigned i = 0; i < SPAWNS; ++i)
+   {
+      wait_child(spawn());
+   }
+   return SPAWNS / ((now_ns() - start) / 1000000000.0);
+}
+
+
+int main(void)
+{
+   printf("Spawn benchmark...\n");
+
+   assert(psignal_library_init());
+
+   for (unsigned i = 0; i < sizeof(RSS_SIZES) / sizeof(RSS_SIZES[0]); ++i)
+   {
+      // Touched so that fork() has every page table entry to copy.
+      char *const rss = (RSS_SIZES[i] != 0u) ? malloc(RSS_SIZES[i]) : nullptr;
+      assert(RSS_SIZES[i] == 0u || rss != nullptr);
+      if (rss != nullptr)
+      {
+         memset(rss, 1, RSS_SIZES[i]);
+      }
+
+      double const forkRate = bench_spawns(&spawn_fork_exec);
+      double const spawnRate = bench_spawns(&spawn_psignal);
+      printf("%4zu MiB RSS: fork+exec %8.0f spawns/s | psignal_spawn %8.0f spawns/s (x%.2f)\n",
+         RSS_SIZES[i] >> 20u, forkRate, spawnRate, spawnRate / forkRate
+      );
+
+      free(rss);
+   }
+
+   psignal_library_shutdown();
+
+   return 0;
+}
@@ -0,0 +1,112 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static constexpr unsigned MAX_THREADS = 512u;
+static constexpr unsigned ROUNDS = 50u;
+static unsigned const THREAD_COUNTS[] = { 1u, 16u, 64u, 256u, 512u };
+
+static pthread_t s_threads[MAX_THREADS];
+static atomic_bool s_stop = false;
+static atomic_uint s_ready = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(void const *lhs, void const *rhs)
+{
+   uint64_t const a = *(uint64_t const *)lhs;
+   uint64_t const b = *(uint64_t const *)rhs;
+   return (a > b) - (a < b);
+}
+
+// Alternates short bursts of work with sleeps, like a typical request thread.
+static void *worker_main(void *)
+{
+   assert(psignal_thread_register(nullptr));
+   atomic_fetch_add(&s_ready, 1u);
+
+   volatile unsigned sink = 0u;
+   while (!atomic_load_explicit(&s_stop, memory_order_relaxed))
+   {
+      for (unsigned i = 0; i < 10000u; ++i)
+      {
+         sink += i;
+      }
+      nanosleep(&(struct timespec) { .tv_nsec = 100000 }, nullptr);
+   }
+
+   psignal_thread_unregister();
+   return nullptr;
+}
+
+static void empty_world_fn(void *)
+{
+}
+
+static void bench_pause(unsigned const threadCount)
+{
+   atomic_store(&s_stop, false);
+   atomic_store(&s_ready, 0u);
+
+   for (unsigned i = 0; i < threadCount; ++i)
+   {
+      assert(pthread_create(&s_threads[i], nullptr, &worker_main, nullptr) == 0);
+   }
+   while (atomic_load(&s_ready) < threadCount)
+   {
+      sched_yield();
+   }
+
+   uint64_t samples[ROUNDS];
+   for (unsigned round = 0; round < ROUNDS; ++round)
+   {
+      uint64_t const start = now_ns();
+      assert(psignal_threads_stop_the_world(&empty_world_fn, nullptr));
+      samples[round] = now_ns() - start;
+   }
+
+   atomic_store(&s_stop, true);
+   for (unsigned i = 0; i < threadCount; ++i)
+   {
+      pthread_join(s_threads[i], nullptr);
+   }
+
+   qsort(samples, ROUNDS, sizeof(*samples), &compare_u64);
+   printf("%4u threads: pause p50 %8.1f us | p99 %8.1f us | max %8.1f us\n", threadCount,
+      samples[ROUNDS / 2] / 1000.0,
+      samples[(ROUNDS * 99) / 100] / 1000.0,
+      samples[ROUNDS - 1] / 1000.0
+   );
+}
+
+
+int main(void)
+{
+   printf("Stop the world benchmark (%u rounds per configuration)...\n", ROUNDS);
+
+   assert(psignal_library_init());
+   assert(psignal_threads_init());
+
+   for (unsigned i = 0; i < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); ++i)
+   {
+      bench_pause(THREAD_COUNTS[i]);
+   }
+
+   psignal_threads_shutdown();
+   psignal_library_shutdown();
+
+   return 0;
+}
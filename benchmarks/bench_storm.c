@@ -0,0 +1,84 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr unsigned STORM_SIGNALS = 100000u;
+static constexpr uint64_t CALLBACK_WORK_NS = 2000u;
+
+static atomic_uint s_calls = 0u;
+static atomic_uint s_deliveries = 0u;
+static atomic_ullong s_callbackNs = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Stands for a callback doing real work (redrawing on SIGWINCH, reaping on SIGCHLD, ...).
+static void busy_callback(PSigCallbackInfo const *info)
+{
+   uint64_t const start = now_ns();
+   while (now_ns() - start < CALLBACK_WORK_NS) {}
+
+   atomic_fetch_add(&s_calls, 1u);
+   atomic_fetch_add(&s_deliveries, info->count);
+   atomic_fetch_add(&s_callbackNs, now_ns() - start);
+}
+
+// RT signals are queued: every one of them is delivered, unlike standard ones.
+static void bench_storm(char const *const name, PSigDispatchPolicy const *const policy)
+{
+   atomic_store(&s_calls, 0u);
+   atomic_store(&s_deliveries, 0u);
+   atomic_store(&s_callbackNs, 0u);
+   assert(psignal_callback_set_policy(PSignal_SIGRTMIN_1, policy));
+
+   int const sig = psignal_to_raw_signal(PSignal_SIGRTMIN_1);
+   uint64_t const start = now_ns();
+   for (unsigned i = 0; i < STORM_SIGNALS; ++i)
+   {
+      while (sigqueue(getpid(), sig, (union sigval) {}) != 0) {}
+   }
+   while (atomic_load(&s_deliveries) < STORM_SIGNALS)
+   {
+      nanosleep(&(struct timespec) { .tv_nsec = 100000 }, nullptr);
+   }
+   uint64_t const elapsedNs = now_ns() - start;
+
+   printf("%-22s: %6u calls | %8.2f ms in callbacks | storm absorbed in %8.2f ms\n", name,
+      atomic_load(&s_calls), atomic_load(&s_callbackNs) / 1000000.0, elapsedNs / 1000000.0
+   );
+}
+
+
+int main(void)
+{
+   printf("Signal storm dispatch benchmark (%u signals)...\n", STORM_SIGNALS);
+
+   assert(psignal_library_init());
+   assert(psignal_callback_hook_on_sig(PSignal_SIGRTMIN_1, busy_callback));
+
+   bench_storm("immediate", nullptr);
+   bench_storm("latest-only", &(PSigDispatchPolicy) { .mode = PSigDispatchMode_LATEST_ONLY });
+   bench_storm("coalesce 1ms", &(PSigDispatchPolicy) {
+      .mode = PSigDispatchMode_COALESCE, .windowNs = 1000000u
+   });
+   bench_storm("rate limit 100/s", &(PSigDispatchPolicy) {
+      .mode = PSigDispatchMode_RATE_LIMIT, .maxPerSecond = 100u
+   });
+
+   assert(psignal_callback_set_policy(PSignal_SIGRTMIN_1, nullptr));
+   psignal_callback_remove_from_sig(PSignal_SIGRTMIN_1, busy_callback);
+   psignal_library_shutdown();
+
+   return 0;
+}
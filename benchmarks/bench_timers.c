@@ -0,0 +1,127 @@
+#include "libposix_signals/libposix_signals.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static constexpr unsigned TIMERS_COUNT = 60000u;
+static constexpr unsigned JITTER_SAMPLES = 10000u;
+
+static PSigTimerId s_ids[TIMERS_COUNT];
+static uint64_t s_jitters[JITTER_SAMPLES];
+static atomic_uint s_jitterCount = 0u;
+
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void noop_callback(PSigTimerInfo const *)
+{
+}
+
+static void jitter_callback(PSigTimerInfo const *info)
+{
+   uint64_t const observed = now_ns();
+   unsigned const idx = atomic_fetch_add(&s_jitterCount, 1u);
+   if (idx < JITTER_SAMPLES)
+   {
+      s_jitters[idx] = observed - info->deadlineNs;
+   }
+}
+
+static int compare_u64(void const *lhs, void const *rhs)
+{
+   uint64_t const a = *(uint64_t const *)lhs;
+   uint64_t const b = *(uint64_t const *)rhs;
+   return (a > b) - (a < b);
+}
+
+static void bench_arm_cancel(void)
+{
+   PSigTimerSpec spec = {
+      .delivery = PSigTimerDelivery_HANDLER,
+      .callback = noop_callback
+   };
+
+   uint64_t const addStart = now_ns();
+   for (unsigned i = 0; i < TIMERS_COUNT; ++i)
+   {
+      // Spread from 1s to ~60s so that every wheel level gets used.
+      spec.delayNs = 1000000000u + (uint64_t)i * 1000000u;
+      assert(psignal_timer_add(&spec, &s_ids[i]));
+   }
+   uint64_t const addEnd = now_ns();
+
+   for (unsigned i = 0; i < TIMERS_COUNT; ++i)
+   {
+      assert(psignal_timer_rearm(s_ids[i], 2000000000u + (uint64_t)(TIMERS_COUNT - i) * 1000000u));
+   }
+   uint64_t const rearmEnd = now_ns();
+
+   for (unsigned i = 0; i < TIMERS_COUNT; ++i)
+   {
+      assert(psignal_timer_cancel(s_ids[i]));
+   }
+   uint64_t const cancelEnd = now_ns();
+
+   printf("add:    %6.1f ns/op\n", (double)(addEnd - addStart) / TIMERS_COUNT);
+   printf("rearm:  %6.1f ns/op\n", (double)(rearmEnd - addEnd) / TIMERS_COUNT);
+   printf("cancel: %6.1f ns/op\n", (double)(cancelEnd - rearmEnd) / TIMERS_COUNT);
+}
+
+static void bench_jitter(PSigTimerDelivery const delivery, char const *const label)
+{
+   atomic_store(&s_jitterCount, 0u);
+
+   PSigTimerSpec spec = {
+      .delivery = delivery,
+      .callback = jitter_callback
+   };
+
+   srand(42);
+   for (unsigned i = 0; i < JITTER_SAMPLES; ++i)
+   {
+      spec.delayNs = 1000000u + (uint64_t)(rand() % 200) * 1000000u;
+      assert(psignal_timer_add(&spec, nullptr));
+   }
+
+   while (atomic_load(&s_jitterCount) < JITTER_SAMPLES)
+   {
+      nanosleep(&(struct timespec) { .tv_nsec = 10000000 }, nullptr);
+   }
+
+   qsort(s_jitters, JITTER_SAMPLES, sizeof(*s_jitters), &compare_u64);
+   printf("%-8s jitter: p50 %7.1f us | p99 %7.1f us | max %7.1f us\n", label,
+      s_jitters[JITTER_SAMPLES / 2] / 1000.0,
+      s_jitters[(JITTER_SAMPLES * 99) / 100] / 1000.0,
+      s_jitters[JITTER_SAMPLES - 1] / 1000.0
+   );
+}
+
+
+int main(void)
+{
+   printf("Timers benchmark (%u logical timers)...\n", TIMERS_COUNT);
+
+   assert(psignal_library_init());
+   assert(psignal_timers_init(&(PSigTimersConfig) {
+      .capacity = TIMERS_COUNT,
+      .resolutionNs = 100000u // 100us
+   }));
+
+   bench_arm_cancel();
+   bench_jitter(PSigTimerDelivery_HANDLER, "handler");
+   bench_jitter(PSigTimerDelivery_DEFERRED, "deferred");
+
+   psignal_timers_shutdown();
+   psignal_library_shutdown();
+
+   return 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Usage: ./run_benchmarks.sh [bench_name...]
+# Without arguments, every bench_*.c file of this folder is built and executed.
+
+BENCHES=("$@")
+if [[ ${#BENCHES[@]} == 0 ]]; then
+   for file in bench_*.c; do
+      BENCHES+=("${file%.c}")
+   done
+fi
+
+for bench in "${BENCHES[@]}"; do
+   gcc -std=c23 -O2 -Wall -Wextra -Werror "$bench.c" -L./../ -l:libposix-signals.a -pthread -lm -I../include/ -o "$bench.out"
+
+   if [[ $? == 0 ]]; then
+      ./"$bench.out"
+      rm ./"$bench.out"
+   fi
+done
@@ -4,9 +4,29 @@
 // Libposix-signals
 //================================================================================================
 
+#include "posix_signal_arena.h"
 #include "posix_signal_callbacks.h"
+#include "posix_signal_channels.h"
+#include "posix_signal_children.h"
 #include "posix_signal_dispositions.h"
 #include "posix_signal_emission_reasons.h"
+#include "posix_signal_fpe.h"
+#include "posix_signal_governor.h"
+#include "posix_signal_graceful.h"
+#include "posix_signal_io.h"
 #include "posix_signal_library.h"
+#include "posix_signal_masks.h"
+#include "posix_signal_pid1.h"
+#include "posix_signal_preemption.h"
+#include "posix_signal_proc.h"
+#include "posix_signal_reload.h"
 #include "posix_signal_safe_functions.h"
+#include "posix_signal_seccomp.h"
+#include "posix_signal_simulator.h"
+#include "posix_signal_spawn.h"
+#include "posix_signal_stack.h"
+#include "posix_signal_threads.h"
+#include "posix_signal_timers.h"
+#include "posix_signal_watchdog.h"
+#include "posix_signal_winsize.h"
 #include "posix_signals.h"
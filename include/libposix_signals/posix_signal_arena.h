@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Arena
+//================================================================================================
+
+/*
+   Emergency memory for signal callbacks, which can't call malloc: formatting, unwinding,
+   building crash records, ...
+
+   The arena is mapped and prefaulted at psignal_library_init, so that allocating from it never
+   page faults, even when the process is out of memory. Registered threads
+   (posix_signal_threads.h) can get an arena of their own, other threads share the process one.
+   Sizes are set through PSigLibraryConfig.
+
+   Allocations are made within a scope, opened with psignal_arena_mark and closed with
+   psignal_arena_reset. Every operation is lock-free and async-signal-safe, and a signal nested in
+   a callback (SA_NODEFER) can open its own scope at any point:
+   - A thread arena is only used by its thread, whose scopes are strictly nested: closing one
+     frees everything allocated since its mark.
+   - The process arena is shared between threads, whose scopes overlap: its memory is only freed
+     once every scope is closed.
+*/
+
+typedef struct PSigArena PSigArena;
+
+typedef struct PSigArenaMark
+{
+   PSigArena *arena;
+   uint32_t offset;
+} PSigArenaMark;
+
+typedef struct PSigArenaStats
+{
+   size_t capacity;      // Of the calling thread's arena.
+   size_t used;
+   size_t peak;
+   uint64_t allocations; // Over every arena.
+   uint64_t exhaustions; // Allocations failed for lack of space, over every arena.
+} PSigArenaStats;
+
+static constexpr size_t PSIG_ARENA_DEFAULT_SIZE = 64u * 1024u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Opens a scope on the calling thread's arena. Every mark must be reset, from the same thread,
+   before the callback that took it returns.
+*/
+[[nodiscard]] PSigArenaMark psignal_arena_mark(void);
+void psignal_arena_reset(PSigArenaMark);
+
+/*
+   Returns nullptr when the arena is exhausted or no scope is open. The alignment must be a power
+   of two, 0 for alignof(max_align_t).
+*/
+[[nodiscard]] void *psignal_arena_alloc(size_t size, size_t alignment);
+
+void psignal_arena_stats(PSigArenaStats *);
@@ -3,6 +3,8 @@
 #include "posix_signal_dispositions.h"
 #include "posix_signals.h"
 
+#include <stdint.h>
+
 
 //================================================================================================
 // POSIX Signal Callbacks
@@ -12,6 +14,11 @@ typedef struct PSigCallbackInfo
 {
    PSignal sig;
    int sigCode;
+   // Deliveries aggregated by the dispatch policy of the signal, 1 without policy.
+   unsigned count;
+   // CLOCK_MONOTONIC time of the first and last aggregated deliveries, 0 without policy.
+   uint64_t firstNs;
+   uint64_t lastNs;
    // TODO to fill with more information given by sigaction's callback.
 } PSigCallbackInfo;
 
@@ -20,15 +27,58 @@ typedef void (*PSigCallback)(PSigCallbackInfo const *);
 /*
    Controls the number of callbacks that can be supported at the same time.
    Having the same callback hooked on multiple signals (even through multiple calls) only count
-   as one.
+   as one. Set at build time, see posix_signal_config.h.
+*/
+static constexpr unsigned PSIG_CALLBACKS_MAX_CAPACITY = PSIG_CONFIG_CALLBACKS_CAPACITY;
+
+/*
+   Dispatch policies bound the time spent in callbacks under signal storms (SIGWINCH bursts,
+   SIGCHLD floods, ...). Deliveries are counted, and the callbacks hooked on the signal are called
+   once for a whole batch of them:
+   - COALESCE:    the first delivery opens a window of windowNs, the batch is dispatched when it
+                  closes.
+   - RATE_LIMIT:  at most maxPerSecond calls, deliveries in between are dispatched as soon as the
+                  next call is allowed.
+   - LATEST_ONLY: deliveries received while the callbacks run (nested or from another thread) are
+                  dispatched in a single call right after them.
+   Batches whose time comes without any new delivery are dispatched from a library thread, not
+   from a signal handler. Synchronous faults (SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGTRAP) can't have
+   a policy.
 */
-static constexpr unsigned PSIG_CALLBACKS_MAX_CAPACITY = 16u;
+typedef enum PSigDispatchMode : unsigned char
+{
+     PSigDispatchMode_IMMEDIATE // Default: one call per delivery.
+   , PSigDispatchMode_COALESCE
+   , PSigDispatchMode_RATE_LIMIT
+   , PSigDispatchMode_LATEST_ONLY
+} PSigDispatchMode;
+
+typedef struct PSigDispatchPolicy
+{
+   PSigDispatchMode mode;
+   uint64_t windowNs;     // COALESCE only.
+   unsigned maxPerSecond; // RATE_LIMIT only.
+} PSigDispatchPolicy;
+
+typedef struct PSigDispatchStats
+{
+   uint64_t received;   // Deliveries counted by the policy.
+   uint64_t dispatched; // Calls of the hooked callbacks.
+} PSigDispatchStats;
 
 // ===============================================================================================
 // Public API Functions
 // ===============================================================================================
 
 [[nodiscard]] bool psignal_callback_is_authorized(PSignal);
+/*
+   Signals can be reserved by library subsystems: Real-Time ones (timers, ...) or the standard
+   signal they are built on (SIGCHLD for the children reaper, ...).
+   A reserved signal is never dispatched to user callbacks and can't be hooked on directly, unless
+   its subsystem only owns some of its occurrences (SIGSEGV for the stack overflows, SIGFPE for
+   the traps, ...): the other ones are forwarded to the callbacks hooked on it.
+*/
+[[nodiscard]] bool psignal_callback_is_reserved(PSignal);
 [[nodiscard]] bool psignal_callback_is_hooked_on(PSignal, PSigCallback);
 
 [[nodiscard]] bool psignal_callback_hook_on_sig(PSignal, PSigCallback);
@@ -38,3 +88,10 @@ static constexpr unsigned PSIG_CALLBACKS_MAX_CAPACITY = 16u;
 void psignal_callback_remove_from_sig(PSignal, PSigCallback);
 void psignal_callback_remove_from_disposition(PSigDisposition, PSigCallback);
 void psignal_callback_remove_from_all(PSigCallback);
+
+/*
+   Applies to every callback hooked on the signal, passing nullptr restores the IMMEDIATE mode.
+   Deliveries still pending are dispatched by the new policy.
+*/
+[[nodiscard]] bool psignal_callback_set_policy(PSignal, PSigDispatchPolicy const *);
+void psignal_callback_policy_stats(PSignal, PSigDispatchStats *);
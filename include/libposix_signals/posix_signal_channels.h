@@ -0,0 +1,94 @@
+#pragma once
+
+#include "posix_signals.h"
+
+//================================================================================================
+// POSIX Signal Channels
+//================================================================================================
+
+/*
+   Message channels between processes (supervisor and workers, ...), without the two syscalls and
+   two copies per message of a pipe.
+
+   A channel is a bounded multi-producer single-consumer ring living in a shared memory segment
+   (memfd): it is inherited across fork() or can be opened from its file descriptor. Sending a
+   message is a copy into the ring and a few atomic operations.
+
+   The consumer is a thread owned by the library in the consuming process. It drains the ring in
+   batches, handing each message to a callback straight from the shared memory, and parks when
+   the ring is empty. Only a producer finding the consumer parked rings the doorbell: a reserved
+   RT signal queued to the consumer thread (rt_tgsigqueueinfo). While the consumer is busy,
+   messages flow without any syscall.
+
+   The channels subsystem must be initialized in the consuming process. The signal it reserves is
+   published in the channel, producers don't need to agree on it beforehand.
+*/
+
+typedef struct PSigChannel PSigChannel;
+
+// Called from the consumer thread. The message is only valid during the call.
+typedef void (*PSigChannelCallback)(void const *message, unsigned length, void *arg);
+
+typedef struct PSigChannelConfig
+{
+   unsigned capacity;    // Number of messages the ring holds, rounded up to a power of two.
+   unsigned messageSize; // Maximum size of a message.
+} PSigChannelConfig;
+
+static constexpr unsigned PSIG_CHANNEL_DEFAULT_CAPACITY     = 1024u;
+static constexpr unsigned PSIG_CHANNEL_DEFAULT_MESSAGE_SIZE = 240u;
+
+typedef struct PSigChannelStats
+{
+   unsigned long long sent;      // Messages written into the ring.
+   unsigned long long received;  // Messages given to the consumer callback.
+   unsigned long long batches;   // Consumer wake-ups that drained at least one message.
+   unsigned long long doorbells; // Signals sent to wake the consumer up.
+   unsigned long long full;      // Sends refused because the ring was full.
+} PSigChannelStats;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves the doorbell RT signal of the process. The library must be running and the channels
+   must be shut down before it.
+*/
+[[nodiscard]] bool psignal_channels_init(void);
+[[nodiscard]] bool psignal_channels_is_running(void);
+void psignal_channels_shutdown(void);
+
+/*
+   Creates a channel in a new shared memory segment. Passing nullptr uses the default
+   configuration. Forked children can use it directly.
+*/
+[[nodiscard]] bool psignal_channel_create(PSigChannelConfig const *, PSigChannel **);
+
+/*
+   Maps the channel behind a file descriptor obtained from psignal_channel_fd (passed through a
+   unix socket, inherited across exec, ...). The descriptor is duplicated.
+*/
+[[nodiscard]] bool psignal_channel_open(int fd, PSigChannel **);
+[[nodiscard]] int psignal_channel_fd(PSigChannel const *);
+
+/*
+   Unmaps the channel. Stops consuming first if the calling process was the consumer.
+*/
+void psignal_channel_close(PSigChannel *);
+
+/*
+   Copies the message into the ring. Fails when the ring is full or the message too large.
+   Can be called from any thread of any process having the channel.
+*/
+[[nodiscard]] bool psignal_channel_send(PSigChannel *, void const *message, unsigned length);
+
+/*
+   Starts the consumer thread of the channel in the calling process.
+   A channel has at most one consumer at a time.
+*/
+[[nodiscard]] bool psignal_channel_consume(PSigChannel *, PSigChannelCallback, void *arg);
+void psignal_channel_stop_consuming(PSigChannel *);
+
+[[nodiscard]] PSigChannelStats psignal_channel_stats(PSigChannel const *);
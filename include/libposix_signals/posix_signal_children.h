@@ -0,0 +1,83 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <sys/resource.h> // Necessary for struct rusage
+
+//================================================================================================
+// POSIX Signal Children
+//================================================================================================
+
+/*
+   Child processes management for large process pools.
+
+   SIGCHLD is a standard signal: several children exiting at the same time only raise it once,
+   so handling one exit per delivery loses exits. Instead, this subsystem claims SIGCHLD and uses
+   it as a wake-up only: a reaper thread then collects every exited child in a single
+   waitid(P_ALL, WNOHANG) pass, along with its resource usage.
+
+   Exits are dispatched to per-child callbacks, found in O(1) through a pid hash table. A child
+   exiting before being watched is kept aside and dispatched as soon as it gets watched. Only the
+   most recent unwatched exits are kept, so orphans reparented to the process (PID 1, subreaper)
+   can't fill the table.
+
+   IMPORTANT: The reaper collects EVERY child of the process. Waiting for children elsewhere
+   (waitpid, system(), ...) will compete with it.
+*/
+
+typedef struct PSigChildExit
+{
+   pid_t pid;
+   int code;                  // si_code: CLD_EXITED, CLD_KILLED, CLD_DUMPED.
+   int status;                // Exit status for CLD_EXITED, signal number otherwise.
+   char const *reason;        // Decoded code, see psignal_emission_reason.
+   struct rusage const *usage;
+   void *userData;            // Given when watching the child.
+} PSigChildExit;
+
+// Called from the reaper thread.
+typedef void (*PSigChildCallback)(PSigChildExit const *);
+
+typedef struct PSigChildrenConfig
+{
+   unsigned capacity;      // Maximum number of children tracked (watched or exited unwatched).
+   unsigned keptUnwatched; // Unwatched exits kept, the oldest are discarded. 0 for capacity / 4.
+} PSigChildrenConfig;
+
+static constexpr unsigned PSIG_CHILDREN_DEFAULT_CAPACITY = 4096u;
+
+typedef struct PSigChildrenStats
+{
+   unsigned long long reaped;    // Children collected.
+   unsigned long long dispatched; // Exit callbacks invoked.
+   unsigned long long dropped;   // Unwatched exits discarded.
+   unsigned tracked;             // Records currently in the table.
+} PSigChildrenStats;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims SIGCHLD and starts the reaper thread. Passing nullptr uses the default configuration.
+   The library must be running and the children must be shut down before it.
+*/
+[[nodiscard]] bool psignal_children_init(PSigChildrenConfig const *);
+[[nodiscard]] bool psignal_children_is_running(void);
+void psignal_children_shutdown(void);
+
+/*
+   Calls the callback once the given child exits. A child can only be watched once.
+   If the child already exited, the callback is invoked right away from the calling thread.
+*/
+[[nodiscard]] bool psignal_children_watch(pid_t, PSigChildCallback, void *userData);
+void psignal_children_unwatch(pid_t);
+
+/*
+   Runs a reaping pass from the calling thread, without waiting for the reaper thread.
+   Returns the number of children collected.
+*/
+unsigned psignal_children_reap(void);
+
+[[nodiscard]] PSigChildrenStats psignal_children_stats(void);
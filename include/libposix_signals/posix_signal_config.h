@@ -0,0 +1,62 @@
+#pragma once
+
+//================================================================================================
+// POSIX Signal Build Configuration
+//================================================================================================
+
+/*
+   Build-time configuration of the library. Every value can be overridden from the compiler
+   command line (-DPSIG_CONFIG_...=...), the makefiles forward the variables of the same name
+   without the CONFIG_ part (make PSIG_CALLBACKS_CAPACITY=256, ...).
+
+   The library and the code using it must be built with the same values: rebuild from clean after
+   changing them.
+*/
+
+/*
+   Number of callbacks that can be registered at the same time.
+*/
+#ifndef PSIG_CONFIG_CALLBACKS_CAPACITY
+   #define PSIG_CONFIG_CALLBACKS_CAPACITY 16
+#endif
+
+/*
+   PSignal ranges handled by the library, each one can be left out (0):
+   - STD_SIGNALS:    SIGHUP to SIGSYS.
+   - RT_MIN_SIGNALS: SIGRTMIN to SIGRTMIN + 15.
+   - RT_MAX_SIGNALS: SIGRTMAX - 14 to SIGRTMAX, where subsystems reserve their signals from.
+   The PSignal enum and PSignalMask don't change. A signal left out keeps its default disposition:
+   it can't be hooked, claimed nor reserved, and the subsystems needing it fail to init.
+*/
+#ifndef PSIG_CONFIG_STD_SIGNALS
+   #define PSIG_CONFIG_STD_SIGNALS 1
+#endif
+
+#ifndef PSIG_CONFIG_RT_MIN_SIGNALS
+   #define PSIG_CONFIG_RT_MIN_SIGNALS 1
+#endif
+
+#ifndef PSIG_CONFIG_RT_MAX_SIGNALS
+   #define PSIG_CONFIG_RT_MAX_SIGNALS 1
+#endif
+
+/*
+   Exposes the disposition masks as constexpr values (PSigDispositionMask_TERMINATE, ...), folded
+   at compile time instead of calling psignal_disposition_mask().
+*/
+#ifndef PSIG_CONFIG_CONSTEXPR_DISPOSITIONS
+   #define PSIG_CONFIG_CONSTEXPR_DISPOSITIONS 0
+#endif
+
+/*
+   Test-mode backend (posix_signal_simulator.h): synthetic deliveries through the signal handler
+   entry point, on a virtual clock. Meant for a dedicated test build, never for production.
+*/
+#ifndef PSIG_CONFIG_SIMULATOR
+   #define PSIG_CONFIG_SIMULATOR 0
+#endif
+
+
+#if PSIG_CONFIG_CALLBACKS_CAPACITY < 1 || PSIG_CONFIG_CALLBACKS_CAPACITY > 65536
+   #error "PSIG_CONFIG_CALLBACKS_CAPACITY must be within [1, 65536]."
+#endif
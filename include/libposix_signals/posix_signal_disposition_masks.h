@@ -0,0 +1,55 @@
+#pragma once
+
+#include "posix_signals.h"
+
+//================================================================================================
+// POSIX Signal Disposition Masks
+//================================================================================================
+
+/*
+   Signals associated to each default disposition, as returned by psignal_disposition_mask().
+   Only exposed by posix_signal_dispositions.h with PSIG_CONFIG_CONSTEXPR_DISPOSITIONS set.
+*/
+
+static constexpr PSignalMask PSigDispositionMask_CONTINUE =
+     (1ul << PSignal_SIGCHLD) | (1ul << PSignal_SIGCONT);
+
+static constexpr PSignalMask PSigDispositionMask_CORE_DUMP =
+     (1ul << PSignal_SIGQUIT) | (1ul << PSignal_SIGILL)  | (1ul << PSignal_SIGTRAP)
+   | (1ul << PSignal_SIGABRT) | (1ul << PSignal_SIGBUS)  | (1ul << PSignal_SIGFPE)
+   | (1ul << PSignal_SIGSEGV) | (1ul << PSignal_SIGXCPU) | (1ul << PSignal_SIGXFSZ)
+   | (1ul << PSignal_SIGSYS);
+
+static constexpr PSignalMask PSigDispositionMask_IGNORE =
+     (1ul << PSignal_SIGURG) | (1ul << PSignal_SIGWINCH);
+
+static constexpr PSignalMask PSigDispositionMask_STOP =
+     (1ul << PSignal_SIGSTOP) | (1ul << PSignal_SIGTSTP) | (1ul << PSignal_SIGTTIN)
+   | (1ul << PSignal_SIGTTOU);
+
+static constexpr PSignalMask PSigDispositionMask_TERMINATE = 
+     (1ul << PSignal_SIGHUP)    | (1ul << PSignal_SIGINT)  | (1ul << PSignal_SIGKILL)
+   | (1ul << PSignal_SIGUSR1)   | (1ul << PSignal_SIGUSR2) | (1ul << PSignal_SIGPIPE)
+   | (1ul << PSignal_SIGALRM)   | (1ul << PSignal_SIGTERM) | (1ul << PSignal_SIGSTKFLT)
+   | (1ul << PSignal_SIGVTALRM) | (1ul << PSignal_SIGPROF) | (1ul << PSignal_SIGIO)
+   | (1ul << PSignal_SIGPWR);
+
+static constexpr PSignalMask PSigDispositionMask_UNSPECIFIED =
+     (1ul << PSignal_SIGRTMIN )   | (1ul << PSignal_SIGRTMIN_1)  | (1ul << PSignal_SIGRTMIN_2)
+   | (1ul << PSignal_SIGRTMIN_3)  | (1ul << PSignal_SIGRTMIN_4)  | (1ul << PSignal_SIGRTMIN_5)
+   | (1ul << PSignal_SIGRTMIN_6)  | (1ul << PSignal_SIGRTMIN_7)  | (1ul << PSignal_SIGRTMIN_8)
+   | (1ul << PSignal_SIGRTMIN_9)  | (1ul << PSignal_SIGRTMIN_10) | (1ul << PSignal_SIGRTMIN_11)
+   | (1ul << PSignal_SIGRTMIN_12) | (1ul << PSignal_SIGRTMIN_13) | (1ul << PSignal_SIGRTMIN_14)
+   | (1ul << PSignal_SIGRTMIN_15) | (1ul << PSignal_SIGRTMAX_14) | (1ul << PSignal_SIGRTMAX_13)
+   | (1ul << PSignal_SIGRTMAX_12) | (1ul << PSignal_SIGRTMAX_11) | (1ul << PSignal_SIGRTMAX_10)
+   | (1ul << PSignal_SIGRTMAX_9)  | (1ul << PSignal_SIGRTMAX_8)  | (1ul << PSignal_SIGRTMAX_7)
+   | (1ul << PSignal_SIGRTMAX_6)  | (1ul << PSignal_SIGRTMAX_5)  | (1ul << PSignal_SIGRTMAX_4)
+   | (1ul << PSignal_SIGRTMAX_3)  | (1ul << PSignal_SIGRTMAX_2)  | (1ul << PSignal_SIGRTMAX_1)
+   | (1ul << PSignal_SIGRTMAX);
+
+
+static constexpr PSignalMask PSigDispositionMask_NONE = 0ul;
+static constexpr PSignalMask PSigDispositionMask_ALL =
+     PSigDispositionMask_CONTINUE  | PSigDispositionMask_CORE_DUMP
+   | PSigDispositionMask_IGNORE    | PSigDispositionMask_STOP
+   | PSigDispositionMask_TERMINATE | PSigDispositionMask_UNSPECIFIED;
@@ -37,6 +37,10 @@ static constexpr unsigned PSigDisposition_ENUM_COUNT = (PSigDisposition_ENUM_LAS
 
 typedef char ascii;
 
+/*
+   As for posix_signals.h, pure queries are inline definitions.
+*/
+
 
 //------------------------------------------------------------------------------------------------
 // Validation
@@ -47,7 +51,11 @@ typedef char ascii;
    All the functions taking a PSigDisposition WILL ASSUME that the given enum value is VALID.
 */
 [[nodiscard]]
-bool psignal_disposition_validate(unsigned);
+inline bool psignal_disposition_validate(unsigned const v)
+{
+   // PSigDisposition starts from 0 and is unsigned.
+   return v <= PSigDisposition_UNSPECIFIED;
+}
 
 
 //------------------------------------------------------------------------------------------------
@@ -58,7 +66,46 @@ bool psignal_disposition_validate(unsigned);
    Returns the default disposition defined for the given signal.
 */
 [[nodiscard]]
-PSigDisposition psignal_disposition_default(PSignal);
+inline PSigDisposition psignal_disposition_default(PSignal const psig)
+{
+   static constexpr PSigDisposition S_STD_DISPS[] =
+   {
+        [PSignal_SIGHUP]    = PSigDisposition_TERMINATE
+      , [PSignal_SIGINT]    = PSigDisposition_TERMINATE
+      , [PSignal_SIGQUIT]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGILL]    = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGTRAP]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGABRT]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGBUS]    = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGFPE]    = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGKILL]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGUSR1]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGSEGV]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGUSR2]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGPIPE]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGALRM]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGTERM]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGSTKFLT] = PSigDisposition_TERMINATE
+      , [PSignal_SIGCHLD]   = PSigDisposition_CONTINUE
+      , [PSignal_SIGCONT]   = PSigDisposition_CONTINUE
+      , [PSignal_SIGSTOP]   = PSigDisposition_STOP
+      , [PSignal_SIGTSTP]   = PSigDisposition_STOP
+      , [PSignal_SIGTTIN]   = PSigDisposition_STOP
+      , [PSignal_SIGTTOU]   = PSigDisposition_STOP
+      , [PSignal_SIGURG]    = PSigDisposition_IGNORE
+      , [PSignal_SIGXCPU]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGXFSZ]   = PSigDisposition_CORE_DUMP
+      , [PSignal_SIGVTALRM] = PSigDisposition_TERMINATE
+      , [PSignal_SIGPROF]   = PSigDisposition_TERMINATE
+      , [PSignal_SIGWINCH]  = PSigDisposition_IGNORE
+      , [PSignal_SIGIO]     = PSigDisposition_TERMINATE
+      , [PSignal_SIGPWR]    = PSigDisposition_TERMINATE
+      , [PSignal_SIGSYS]    = PSigDisposition_CORE_DUMP
+   };
+   static_assert(sizeof(S_STD_DISPS) / sizeof(S_STD_DISPS[0]) == PSignal_SIGSYS + 1u);
+
+   return psignal_is_standard(psig) ? S_STD_DISPS[psig] : PSigDisposition_UNSPECIFIED;
+}
 
 /*
    Returns a simple description for the given disposition. Useful for logging/debugging.
@@ -77,3 +124,7 @@ PSignalMask psignal_disposition_mask(PSigDisposition);
 PSignalMask psignal_disposition_mask_all(void);
 [[nodiscard]]
 PSignalMask psignal_disposition_mask_none(void);
+
+#if PSIG_CONFIG_CONSTEXPR_DISPOSITIONS
+   #include "posix_signal_disposition_masks.h"
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Floating Point Exceptions
+//================================================================================================
+
+/*
+   Finds where NaNs, infinities, ... come from in numeric code, without a debugger.
+
+   A scope enables floating point traps (feenableexcept) for the given exception classes on the
+   calling thread only. An operation raising one of them then delivers SIGFPE: the library
+   records the faulting instruction, the exception and a short stack into a lock-free table
+   deduplicated per call site, then resumes the execution with the exception masked, so the
+   operation completes with its IEEE default result (NaN, infinity, ...):
+   - PSigFpeAction_MASK: the exception stays masked until the end of the scope. Cheapest, but
+     only the first faulting site of each exception class is found.
+   - PSigFpeAction_STEP: the exception is masked for the faulting instruction only, which is
+     single-stepped (SIGTRAP) before unmasking it again. Every faulting site is found
+     (x86_64 only, MASK elsewhere).
+
+   SIGFPE and SIGTRAP raised outside of a scope (integer division by zero, ...) still reach the
+   user callbacks hooked on them.
+*/
+
+typedef enum PSigFpeAction : unsigned char
+{
+     PSigFpeAction_MASK
+   , PSigFpeAction_STEP
+} PSigFpeAction;
+
+// Saved state of the enclosing scope, restored when the scope ends.
+typedef struct PSigFpeScope
+{
+   int previousEnabled;  // Traps enabled in the FPU.
+   int previousTrapped;  // Traps handled by the library.
+   int excepts;
+   PSigFpeAction previousAction;
+   bool active;
+} PSigFpeScope;
+
+typedef struct PSigFpeSite
+{
+   uintptr_t pc;          // Faulting instruction.
+   int excepts;           // FE_* exceptions raised at this site.
+   int code;              // si_code of the first trap (FPE_FLTINV, ...).
+   char const *reason;    // Decoded code, see psignal_emission_reason.
+   uint64_t count;        // Traps at this site.
+   void *const *frames;   // Return addresses at the first trap, innermost first.
+   unsigned frameCount;
+} PSigFpeSite;
+
+typedef void (*PSigFpeSiteVisitor)(PSigFpeSite const *, void *arg);
+
+static constexpr unsigned PSIG_FPE_MAX_SITES  = 1024u;
+static constexpr unsigned PSIG_FPE_MAX_FRAMES = 16u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims SIGFPE and SIGTRAP. The library must be running and the module must be shut down
+   before it.
+*/
+[[nodiscard]] bool psignal_fpe_init(void);
+[[nodiscard]] bool psignal_fpe_is_running(void);
+void psignal_fpe_shutdown(void);
+
+/*
+   Traps the given FE_* exceptions on the calling thread until the scope ends. Scopes can be
+   nested, ending one restores the traps and action of the enclosing one.
+   Fails when the platform can't trap floating point exceptions.
+*/
+[[nodiscard]] bool psignal_fpe_scope_begin(int excepts, PSigFpeAction, PSigFpeScope *);
+void psignal_fpe_scope_end(PSigFpeScope *);
+
+/*
+   Recorded faulting sites. Sites are never removed while traps may happen: resetting must not
+   race with any scope.
+*/
+void psignal_fpe_for_each_site(PSigFpeSiteVisitor, void *arg);
+[[nodiscard]] unsigned psignal_fpe_sites_count(void);
+[[nodiscard]] uint64_t psignal_fpe_dropped_count(void);
+void psignal_fpe_reset_sites(void);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Resource Governor
+//================================================================================================
+
+/*
+   Graceful degradation on SIGXCPU and SIGXFSZ, instead of their default core dump.
+
+   The governor sets the soft CPU time and file size limits below the hard ones, and claims the
+   signals of the governed resources. When a soft limit is exceeded, the signal handler raises it
+   right away by one step, so that the work goes on, and the governor thread calls the registered
+   throttle callbacks (shrink thread pools, rotate output files, checkpoint, ...), never from the
+   signal handler. The last step reaches the hard limit: past it, the kernel kills the process
+   (CPU) or fails the writes with EFBIG (file size).
+
+   Steps are evenly spaced from the initial soft limit to the hard one. With an infinite hard
+   limit, each step raises the soft limit by its initial value, and the last one removes it.
+
+   Soft limits are inherited by children. A child forked with fork() gets them restored to their
+   value before init. A child started without the fork handlers (psignal_spawn, posix_spawn,
+   vfork) and then exec'd keeps the lowered ones, with no governor to raise them: exceeding them
+   takes the default SIGXCPU/SIGXFSZ disposition. Raise them in the child if it must not be bound.
+*/
+
+typedef enum PSigGovernorResource : unsigned char
+{
+     PSigGovernorResource_CPU        // RLIMIT_CPU in seconds, SIGXCPU.
+   , PSigGovernorResource_FILE_SIZE  // RLIMIT_FSIZE in bytes, SIGXFSZ.
+
+   , PSigGovernorResource_ENUM_COUNT
+} PSigGovernorResource;
+
+typedef struct PSigGovernorLimit
+{
+   uint64_t soft;   // Initial soft limit, below the hard one. 0: the resource isn't governed.
+   unsigned steps;  // Raises up to the hard limit, 0 behaves as 1.
+} PSigGovernorLimit;
+
+typedef struct PSigGovernorConfig
+{
+   PSigGovernorLimit limits[PSigGovernorResource_ENUM_COUNT];
+} PSigGovernorConfig;
+
+typedef struct PSigGovernorEvent
+{
+   PSigGovernorResource resource;
+   unsigned step;        // From 1 to steps.
+   unsigned steps;
+   uint64_t softLimit;   // After the raise, UINT64_MAX for an infinite limit.
+   uint64_t hardLimit;
+   uint64_t signalNs;    // CLOCK_MONOTONIC time the signal was handled at.
+} PSigGovernorEvent;
+
+/*
+   Runs on the governor thread, once per step, in registration order.
+*/
+typedef void (*PSigGovernorThrottleFn)(PSigGovernorEvent const *, void *arg);
+
+typedef struct PSigGovernorStats
+{
+   uint64_t signals[PSigGovernorResource_ENUM_COUNT];
+   uint64_t raises;
+   uint64_t exhausted;         // Signals received once at the hard limit.
+   uint64_t lastReactionNs;    // From the signal to the throttle callbacks.
+   uint64_t maxReactionNs;
+} PSigGovernorStats;
+
+static constexpr unsigned PSIG_GOVERNOR_MAX_THROTTLES = 8u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Sets the initial soft limits, claims the signals of the governed resources and starts the
+   governor thread. Fails if a soft limit isn't below its hard limit. The library must be running
+   and the module must be shut down before it.
+   Shutting the module down raises the soft limits back to their value before init, they are
+   never lowered under the usage reached.
+*/
+[[nodiscard]] bool psignal_governor_init(PSigGovernorConfig const *);
+[[nodiscard]] bool psignal_governor_is_running(void);
+void psignal_governor_shutdown(void);
+
+/*
+   Throttles can be registered before init, shutting the module down removes them.
+*/
+[[nodiscard]] bool psignal_governor_add_throttle(PSigGovernorThrottleFn, void *arg);
+void psignal_governor_remove_throttle(PSigGovernorThrottleFn, void *arg);
+
+void psignal_governor_stats(PSigGovernorStats *);
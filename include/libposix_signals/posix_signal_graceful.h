@@ -0,0 +1,108 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Graceful Shutdown
+//================================================================================================
+
+/*
+   Staged shutdown on termination signals.
+
+   The module claims the trigger signals, a subset of psignal_disposition_mask(TERMINATE). The
+   first one received starts the shutdown sequence: the registered phases (stop accepting, drain
+   in-flight work, flush, ...) run in registration order, each one on a thread of its own, never
+   from the signal handler. Once every phase is over, the process exits.
+
+   A phase that outlives its deadline is abandoned and the next one starts: the abandoned phase
+   keeps running on its thread and should poll psignal_graceful_phase_abandoned to give up early.
+   Any further trigger signal escalates, either by abandoning the current phase as if its deadline
+   expired, or by exiting right away from the signal handler.
+
+   Every phase is timed, so that deadlines can be tuned from the reports of real shutdowns.
+*/
+
+/*
+   Runs on a phase thread. Returns false on failure, the sequence continues anyway.
+*/
+typedef bool (*PSigGracefulPhaseFn)(void *arg);
+
+typedef enum PSigGracefulEscalation : unsigned char
+{
+     PSigGracefulEscalation_NEXT_PHASE
+   , PSigGracefulEscalation_EXIT
+} PSigGracefulEscalation;
+
+typedef enum PSigGracefulOutcome : unsigned char
+{
+     PSigGracefulOutcome_PENDING
+   , PSigGracefulOutcome_COMPLETED
+   , PSigGracefulOutcome_FAILED
+   , PSigGracefulOutcome_TIMED_OUT
+   , PSigGracefulOutcome_ESCALATED
+   , PSigGracefulOutcome_CANCELLED // Abandoned by the module shutdown.
+} PSigGracefulOutcome;
+
+typedef struct PSigGracefulReport
+{
+   char const *name;
+   PSigGracefulOutcome outcome;
+   uint64_t durationNs;  // Until the phase returned or was abandoned.
+   uint64_t deadlineNs;
+} PSigGracefulReport;
+
+/*
+   Called once every phase is over, right before exiting (or shutting the module down).
+*/
+typedef void (*PSigGracefulCompleteFn)(PSigGracefulReport const *reports, unsigned count, void *arg);
+
+typedef struct PSigGracefulConfig
+{
+   PSignalMask triggerMask;           // 0 for SIGTERM and SIGINT.
+   PSigGracefulEscalation escalation; // On each trigger signal after the first one.
+   int exitCode;
+   bool keepRunning;                  // Don't exit once the sequence is over.
+   PSigGracefulCompleteFn onComplete;
+   void *onCompleteArg;
+} PSigGracefulConfig;
+
+static constexpr unsigned PSIG_GRACEFUL_MAX_PHASES = 8u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims the trigger signals and starts the sequencer thread. Passing nullptr uses the default
+   configuration. The library must be running and the module must be shut down before it.
+   Shutting the module down ends a sequence in progress: the current phase is abandoned, the
+   remaining ones never start (their reports stay PENDING) and the process doesn't exit.
+*/
+[[nodiscard]] bool psignal_graceful_init(PSigGracefulConfig const *);
+[[nodiscard]] bool psignal_graceful_is_running(void);
+void psignal_graceful_shutdown(void);
+
+/*
+   Appends a phase, before the sequence starts. A deadline of 0 never expires, only an escalation
+   ends such a phase early. The name must outlive the module.
+*/
+[[nodiscard]] bool psignal_graceful_add_phase(char const *name, PSigGracefulPhaseFn, void *arg, uint64_t deadlineNs);
+
+/*
+   Starts the sequence as if a trigger signal was received.
+*/
+[[nodiscard]] bool psignal_graceful_request(void);
+[[nodiscard]] bool psignal_graceful_requested(void);
+
+/*
+   Called from a phase: whether it has been abandoned (deadline or escalation).
+*/
+[[nodiscard]] bool psignal_graceful_phase_abandoned(void);
+
+/*
+   Waits for the end of the sequence, with keepRunning set. Returns the number of reports.
+*/
+unsigned psignal_graceful_wait(PSigGracefulReport *reports, unsigned capacity);
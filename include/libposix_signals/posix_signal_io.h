@@ -0,0 +1,92 @@
+#pragma once
+
+#include "posix_signals.h"
+
+//================================================================================================
+// POSIX Signal I/O
+//================================================================================================
+
+/*
+   I/O readiness notification through Real-Time signals (F_SETSIG).
+
+   Armed file descriptors are switched to O_ASYNC with a reserved RT PSignal as their readiness
+   signal. The kernel then queues one siginfo per readiness change, carrying the descriptor
+   (si_fd) and the poll events (si_band): nothing is spent on idle descriptors, however many are
+   armed.
+
+   The signals are all routed to a dispatcher thread owned by the subsystem (F_SETOWN_EX), which
+   blocks them and collects them synchronously in batches (sigtimedwait), without running any
+   signal handler. Each batch is either given to a callback, or pushed to a queue polled with
+   psignal_io_poll.
+
+   When the RT signal queue of the process overflows, the kernel falls back to a plain SIGIO and
+   events are lost: the dispatcher then rescans every armed descriptor with poll() and reports the
+   ready ones.
+
+   A descriptor already ready when armed is reported right away.
+   Readiness is edge-triggered and can be stale (descriptor disarmed then reused): descriptors
+   must be non-blocking and read until EAGAIN.
+*/
+
+typedef struct PSigIoEvent
+{
+   int fd;
+   short revents;      // Poll events (POLLIN, POLLOUT, ...), filtered by the armed interest.
+   int code;           // si_code: POLL_IN, POLL_OUT, ... or 0 for events found by a rescan.
+   char const *reason; // Decoded code, see psignal_emission_reason.
+   void *userData;     // Given when arming the descriptor.
+} PSigIoEvent;
+
+// Called from the dispatcher thread with up to batchSize events.
+typedef void (*PSigIoCallback)(PSigIoEvent const *events, unsigned count, void *arg);
+
+typedef struct PSigIoConfig
+{
+   unsigned maxFds;         // Armed descriptors must be lower than maxFds.
+   unsigned batchSize;      // Maximum number of events gathered before being dispatched.
+   unsigned queueCapacity;  // Events queued for psignal_io_poll, when there's no callback.
+   PSigIoCallback callback; // nullptr to queue events for psignal_io_poll.
+   void *callbackArg;
+} PSigIoConfig;
+
+static constexpr unsigned PSIG_IO_DEFAULT_MAX_FDS        = 65536u;
+static constexpr unsigned PSIG_IO_DEFAULT_BATCH_SIZE     = 64u;
+static constexpr unsigned PSIG_IO_DEFAULT_QUEUE_CAPACITY = 4096u;
+
+typedef struct PSigIoStats
+{
+   unsigned long long events;  // Events dispatched or queued.
+   unsigned long long batches; // Batches dispatched or queued.
+   unsigned long long rescans; // Full rescans after a RT signal queue overflow.
+   unsigned long long dropped; // Events lost because the poll queue was full.
+} PSigIoStats;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves a RT signal and starts the dispatcher thread. Passing nullptr uses the default
+   configuration. The library must be running and the I/O subsystem must be shut down before it.
+*/
+[[nodiscard]] bool psignal_io_init(PSigIoConfig const *);
+[[nodiscard]] bool psignal_io_is_running(void);
+void psignal_io_shutdown(void);
+
+[[nodiscard]] PSignal psignal_io_signal(void);
+
+/*
+   Starts notifying the readiness of the given descriptor for the given poll events.
+   Arming an already armed descriptor updates its interest and user data.
+*/
+[[nodiscard]] bool psignal_io_arm(int fd, short events, void *userData);
+void psignal_io_disarm(int fd);
+
+/*
+   Takes up to maxEvents queued events, waiting up to timeoutMs for the first one
+   (0 doesn't wait, -1 waits forever). Only available when no callback is configured.
+*/
+[[nodiscard]] unsigned psignal_io_poll(PSigIoEvent *events, unsigned maxEvents, int timeoutMs);
+
+[[nodiscard]] PSigIoStats psignal_io_stats(void);
@@ -1,10 +1,22 @@
 #pragma once
 
+#include <stddef.h>
+
 //================================================================================================
 // POSIX Signal Library
 //================================================================================================
 
+typedef struct PSigLibraryConfig
+{
+   size_t arenaSize;       // Process emergency arena. 0 for the default size.
+   size_t threadArenaSize; // Arena of each registered thread. 0 to share the process arena.
+} PSigLibraryConfig;
+
+/*
+   psignal_library_init uses the default configuration, see posix_signal_arena.h.
+*/
 [[nodiscard]] bool psignal_library_init(void);
+[[nodiscard]] bool psignal_library_init_with_config(PSigLibraryConfig const *);
 [[nodiscard]] bool psignal_library_is_running(void);
 void psignal_library_shutdown(void);
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <signal.h> // Necessary for sigset_t
+
+//================================================================================================
+// POSIX Signal Masks
+//================================================================================================
+
+/*
+   PSignalMask algebra, with a bit set for each PSignal: (1 << PSignal).
+
+   Walking a mask only visits its set bits:
+      PSignal psig;
+      for (PSignalMask it = mask; psignal_mask_next(&it, &psig);) { ... }
+
+   Conversions from and to sigset_t go through lookup tables, and a scope blocks or unblocks a
+   whole mask with a single pthread_sigmask() call, restoring the previous mask when it ends.
+*/
+
+static_assert(PSignal_ENUM_COUNT <= 64u, "Mask bit scans work on 64 bits integers.");
+
+/*
+   Only the signals whose state the scope changed are kept, restoring them is the exact inverse
+   call and leaves alone the signals PSignal doesn't cover.
+*/
+typedef struct PSigMaskScope
+{
+   PSignalMask changed;
+   bool blocked;
+   bool active;
+} PSigMaskScope;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Algebra
+//------------------------------------------------------------------------------------------------
+
+/*
+   As for posix_signals.h, these are inline definitions.
+*/
+
+[[nodiscard]]
+inline PSignalMask psignal_mask_of(PSignal const psig)
+{
+   return (PSignalMask)1u << psig;
+}
+
+[[nodiscard]]
+inline PSignalMask psignal_mask_union(PSignalMask const a, PSignalMask const b)
+{
+   return a | b;
+}
+
+[[nodiscard]]
+inline PSignalMask psignal_mask_intersect(PSignalMask const a, PSignalMask const b)
+{
+   return a & b;
+}
+
+// Signals of a that aren't in b.
+[[nodiscard]]
+inline PSignalMask psignal_mask_diff(PSignalMask const a, PSignalMask const b)
+{
+   return a & ~b;
+}
+
+[[nodiscard]]
+inline bool psignal_mask_has(PSignalMask const mask, PSignal const psig)
+{
+   return (mask >> psig) & 1u;
+}
+
+[[nodiscard]]
+inline unsigned psignal_mask_count(PSignalMask const mask)
+{
+   return (unsigned)__builtin_popcountll((unsigned long long)mask);
+}
+
+/*
+   Pops the lowest signal of the mask. Returns false once the mask is empty.
+*/
+[[nodiscard]]
+inline bool psignal_mask_next(PSignalMask *const mask, PSignal *const out)
+{
+   if (*mask == 0u)
+      return false;
+
+   *out = (PSignal)__builtin_ctzll((unsigned long long)*mask);
+   *mask &= *mask - 1u;
+   return true;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// sigset_t bridging
+//------------------------------------------------------------------------------------------------
+
+/*
+   Signals that can't be blocked nor caught (SIGKILL, SIGSTOP) are converted like any other one.
+*/
+void psignal_mask_to_sigset(PSignalMask, sigset_t *);
+[[nodiscard]]
+PSignalMask psignal_mask_from_sigset(sigset_t const *);
+
+/*
+   Signals blocked on the calling thread.
+*/
+[[nodiscard]]
+PSignalMask psignal_mask_blocked(void);
+
+
+//------------------------------------------------------------------------------------------------
+// Scoped blocking
+//------------------------------------------------------------------------------------------------
+
+/*
+   Blocks or unblocks the mask on the calling thread, until psignal_mask_restore(). Scopes can be
+   nested, and must be restored in reverse order. Restoring a scope that changed nothing doesn't
+   issue any call.
+*/
+[[nodiscard]] bool psignal_mask_block(PSignalMask, PSigMaskScope *);
+[[nodiscard]] bool psignal_mask_unblock(PSignalMask, PSigMaskScope *);
+void psignal_mask_restore(PSigMaskScope *);
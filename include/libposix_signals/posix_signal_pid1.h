@@ -0,0 +1,60 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal PID 1
+//================================================================================================
+
+/*
+   Entry process mode for containers.
+
+   As PID 1 of a container, the process inherits every orphaned descendant and is expected to reap
+   them, and the signals asking the container to stop are only sent to it. This mode:
+   - Reaps every zombie through the children subsystem, started if it isn't running yet. Outside
+     of PID 1, the process is made a child subreaper so that orphans are still reparented to it.
+   - Forwards the termination signals it receives to the supervised process group, with one kill()
+     for the whole group whatever the number of processes in it.
+   - Escalates to SIGKILL on the group when it is still alive after a grace period following a
+     shutdown request (SIGTERM, SIGINT or psignal_pid1_terminate).
+
+   Signals the process sends to itself (SIGPIPE from a write, raise(), ...) aren't forwarded.
+*/
+
+typedef struct PSigPid1Config
+{
+   PSignalMask forwardMask; // 0 for every catchable signal of psignal_disposition_mask(TERMINATE).
+   uint64_t gracePeriodNs;  // 0 for the default grace period.
+   pid_t processGroup;      // Supervised process group, can be set later. Must not be our group.
+} PSigPid1Config;
+
+static constexpr uint64_t PSIG_PID1_DEFAULT_GRACE_PERIOD_NS = 10000000000u; // 10s
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims the forwarded signals and starts the escalation thread. Passing nullptr uses the default
+   configuration. The library must be running and PID 1 mode must be shut down before it.
+*/
+[[nodiscard]] bool psignal_pid1_init(PSigPid1Config const *);
+[[nodiscard]] bool psignal_pid1_is_running(void);
+void psignal_pid1_shutdown(void);
+
+/*
+   Sets the process group the signals are forwarded to, typically the one of the main child.
+*/
+[[nodiscard]] bool psignal_pid1_set_process_group(pid_t);
+[[nodiscard]] pid_t psignal_pid1_process_group(void);
+
+/*
+   Forwards SIGTERM to the process group and starts the grace period, as if SIGTERM was received.
+*/
+[[nodiscard]] bool psignal_pid1_terminate(void);
+
+[[nodiscard]] bool psignal_pid1_shutdown_requested(void);
+[[nodiscard]] bool psignal_pid1_escalated(void);
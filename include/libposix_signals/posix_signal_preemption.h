@@ -0,0 +1,101 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Preemption
+//================================================================================================
+
+/*
+   User-space schedulers (green threads, fibers, ...) can't take a long running task off a worker
+   thread unless the task cooperates by yielding regularly.
+
+   This service gives each registered worker a timer on its own CPU-time clock, delivering a
+   reserved RT signal to that worker only. Starting a task is syscall free: the timer keeps
+   ticking while the worker burns CPU, and a task seen running over a whole time slice is
+   preempted. Idle workers don't consume any tick.
+
+   When a task is preempted, the handler looks at the interrupted program counter:
+   - If a hook is registered and the PC is inside a declared safe range, the hook is called from
+     the signal handler, with the interrupted context, and may redirect it to another task.
+   - Otherwise, a thread-local "yield requested" flag is raised, for the task to check at its
+     next convenient point.
+
+   The handler runs on the thread's alternate signal stack, shared by every signal the library
+   handles: a task switched to from the handler itself (swapcontext, longjmp, ...) would leave its
+   frames there, overwritten by the next signal. The hook only rewrites the interrupted context
+   (psignal_preemption_redirect), the switch happens when the handler returns.
+*/
+
+typedef struct PSigPreemptInfo
+{
+   void *ucontext;    // Interrupted context.
+   uintptr_t pc;      // Interrupted program counter, 0 if unknown on this architecture.
+   void *userData;    // Given at registration.
+   uint64_t taskId;   // Sequence number of the preempted task, see psignal_preemption_task_begin.
+} PSigPreemptInfo;
+
+/*
+   Called from signal handler context. Returns true if the interrupted context has been redirected
+   to another task, false to fall back on the yield flag. It must not switch tasks itself.
+*/
+typedef bool (*PSigPreemptHook)(PSigPreemptInfo const *);
+
+static constexpr unsigned PSIG_PREEMPTION_MAX_SAFE_RANGES = 32u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves the RT signal delivered by the workers CPU timers.
+   The library must be running and the preemption must be shut down before the library.
+*/
+[[nodiscard]] bool psignal_preemption_init(void);
+[[nodiscard]] bool psignal_preemption_is_running(void);
+void psignal_preemption_shutdown(void);
+
+[[nodiscard]] PSignal psignal_preemption_signal(void);
+
+/*
+   Declares [start, end) as code where the hook may safely switch context.
+   Meant to be called before starting workers.
+*/
+[[nodiscard]] bool psignal_preemption_add_safe_range(void const *start, void const *end);
+
+/*
+   From a hook: on return from the handler, the worker calls entry(arg) on the stack ending at
+   stackTop instead of resuming the interrupted code, whose registers are left in
+   info->ucontext for the scheduler to save beforehand. entry must never return.
+   Fails on architectures without context support (x86_64 and aarch64 only).
+*/
+[[nodiscard]] bool psignal_preemption_redirect(PSigPreemptInfo const *, void (*entry)(void *), void *arg, void *stackTop);
+
+//------------------------------------------------------------------------------------------------
+// Workers (calling thread)
+//------------------------------------------------------------------------------------------------
+
+/*
+   Registers the calling thread as a worker, preempting tasks running for longer than sliceNs of
+   CPU time. The hook is optional.
+*/
+[[nodiscard]] bool psignal_preemption_register_worker(uint64_t sliceNs, PSigPreemptHook, void *userData);
+void psignal_preemption_unregister_worker(void);
+
+/*
+   Marks the start/end of a task on the calling worker. Both are syscall free.
+   task_begin also clears the yield flag and returns the task sequence number.
+*/
+uint64_t psignal_preemption_task_begin(void);
+void psignal_preemption_task_end(void);
+
+[[nodiscard]] bool psignal_preemption_yield_requested(void);
+void psignal_preemption_clear_yield(void);
+
+/*
+   Number of preemptions (hook or flag) on the calling worker since its registration.
+*/
+[[nodiscard]] uint64_t psignal_preemption_count(void);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+//================================================================================================
+// POSIX Signal Proc
+//================================================================================================
+
+/*
+   Signal state of the processes and threads of a host, parsed from /proc/<pid>/status and
+   /proc/<pid>/task/<tid>/status into PSignalMasks.
+
+   The scan reads the pid directories in batches with getdents64() and reuses the same buffers
+   for every pid: nothing is allocated per task. It can be spread over several threads, each one
+   taking the next batch of pids. Tasks exiting during the scan are skipped.
+   Raw signals PSignal doesn't cover (the ones reserved by the libc) are left out of the masks.
+*/
+
+typedef struct PSigProcState
+{
+   pid_t pid;
+   pid_t tid;                 // Equals pid for a process entry.
+   PSignalMask pending;       // SigPnd: directed at the thread.
+   PSignalMask sharedPending; // ShdPnd: directed at the process.
+   PSignalMask blocked;       // SigBlk
+   PSignalMask ignored;       // SigIgn
+   PSignalMask caught;        // SigCgt
+   uint32_t queued;           // SigQ: RT signals queued for the real user id of the task.
+   uint32_t queueLimit;
+} PSigProcState;
+
+typedef struct PSigProcScanConfig
+{
+   char const *root;          // nullptr: "/proc".
+   bool threads;              // One entry per thread instead of one per process.
+   unsigned workers;          // Threads scanning in parallel, the caller included. 0 behaves as 1.
+} PSigProcScanConfig;
+
+/*
+   With several workers, the visitor is called concurrently from all of them.
+*/
+typedef void (*PSigProcVisitor)(PSigProcState const *, void *arg);
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Parses the signal lines of a status file content, which doesn't need to be null terminated.
+   pid and tid are left untouched. Returns false if any of them is missing or malformed.
+*/
+[[nodiscard]] bool psignal_proc_parse_status(char const *content, size_t size, PSigProcState *);
+
+/*
+   Reads /proc/<pid>/status, or /proc/<pid>/task/<tid>/status if tid isn't 0.
+*/
+[[nodiscard]] bool psignal_proc_read(pid_t pid, pid_t tid, PSigProcState *);
+
+/*
+   Visits every process, or thread, of the tree. Passing nullptr uses the default configuration.
+   Returns false if the root can't be opened.
+*/
+[[nodiscard]] bool psignal_proc_scan(PSigProcScanConfig const *, PSigProcVisitor, void *arg);
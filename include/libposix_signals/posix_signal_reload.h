@@ -0,0 +1,96 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Reload
+//================================================================================================
+
+/*
+   Configuration hot reload on SIGHUP, without restarting the process.
+
+   The module claims SIGHUP. A reload thread calls the user load function, outside of the signal
+   handler, and publishes the new configuration with an atomic pointer swap. Signals received
+   while a reload is pending are coalesced into it.
+
+   Two ways to read the current configuration:
+   - Hot path readers register as online and get it with a single acquire load
+     (psignal_reload_current). The pointer stays valid until the thread reports a quiescent state,
+     a point where it holds no configuration pointer (between two requests, ...).
+   - Other threads take a reference on it, released explicitly.
+   A replaced configuration is freed once every online reader went through a quiescent state and
+   no reference on it is left.
+*/
+
+/*
+   Builds a new configuration, from the reload thread. Returns nullptr on failure, the current
+   configuration is then kept.
+*/
+typedef void *(*PSigReloadLoadFn)(void *arg);
+typedef void (*PSigReloadFreeFn)(void *config, void *arg);
+
+typedef struct PSigReloadConfig
+{
+   PSigReloadLoadFn load;
+   PSigReloadFreeFn free; // Optional.
+   void *arg;
+} PSigReloadConfig;
+
+typedef struct PSigReloadHandle PSigReloadHandle;
+
+typedef struct PSigReloadStats
+{
+   uint64_t version;        // Number of configurations published, including the initial one.
+   uint64_t reloads;
+   uint64_t failures;
+   uint64_t coalesced;      // Requests merged into a pending reload.
+   uint64_t lastLatencyNs;  // From the request to the publication.
+   uint64_t maxLatencyNs;
+   unsigned retired;        // Replaced configurations not freed yet.
+} PSigReloadStats;
+
+static constexpr unsigned PSIG_RELOAD_MAX_READERS = 256u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Loads the initial configuration on the calling thread, then claims SIGHUP and starts the reload
+   thread. Fails if the first load does. The library must be running and the module must be shut
+   down before it. Shutting the module down frees every configuration: readers must be done.
+*/
+[[nodiscard]] bool psignal_reload_init(PSigReloadConfig const *);
+[[nodiscard]] bool psignal_reload_is_running(void);
+void psignal_reload_shutdown(void);
+
+// Reloads as if SIGHUP was received.
+[[nodiscard]] bool psignal_reload_request(void);
+
+//------------------------------------------------------------------------------------------------
+// Online readers
+//------------------------------------------------------------------------------------------------
+
+/*
+   An online reader holds back the reclamation of replaced configurations until its next quiescent
+   state: readers going idle for long should go offline.
+*/
+[[nodiscard]] bool psignal_reload_reader_online(void);
+void psignal_reload_reader_offline(void);
+void psignal_reload_quiescent(void);
+
+// Only valid on an online reader, until its next quiescent state.
+[[nodiscard]] void const *psignal_reload_current(void);
+
+//------------------------------------------------------------------------------------------------
+// References
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]] PSigReloadHandle *psignal_reload_acquire(void);
+[[nodiscard]] void const *psignal_reload_handle_config(PSigReloadHandle const *);
+void psignal_reload_release(PSigReloadHandle *);
+
+void psignal_reload_stats(PSigReloadStats *);
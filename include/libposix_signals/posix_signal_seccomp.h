@@ -0,0 +1,82 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Seccomp
+//================================================================================================
+
+/*
+   In-process syscall interposition through seccomp traps.
+
+   A seccomp BPF filter makes the chosen syscalls return SECCOMP_RET_TRAP: instead of entering the
+   kernel, the calling thread receives SIGSYS. The library claims SIGSYS and dispatches it through
+   a table indexed by syscall number to the handler of the syscall, which reads the arguments from
+   the interrupted context and either emulates the syscall (its result is written back as the
+   syscall return value) or lets it run for real.
+
+   Syscalls run for real go through a single syscall instruction inside the library that the
+   filter always allows, so they aren't trapped again (x86_64 and aarch64 only).
+
+   Syscalls issued through another ABI than the native one (ia32 or x32 on x86_64, ...) would
+   escape the filter: they kill the process instead.
+
+   IMPORTANT: A seccomp filter can't be removed. Once installed, it applies to every thread of the
+   process and its future children, and survives the library shutdown: SIGSYS stays dispatched to
+   the syscall handlers, the module keeps running until the process exits.
+*/
+
+typedef struct PSigSyscall
+{
+   long nr;
+   long args[6];
+   long result;    // Set by an emulating handler: value or -errno, as returned by the kernel.
+   void *ucontext; // Interrupted context.
+   void *userData; // Given when setting the handler.
+} PSigSyscall;
+
+/*
+   Called from signal handler context: only async-signal-safe functions can be used, and trapped
+   syscalls must go through psignal_seccomp_syscall.
+   Returns true when the syscall was emulated, false to run it for real.
+*/
+typedef bool (*PSigSyscallHandler)(PSigSyscall *);
+
+static constexpr unsigned PSIG_SECCOMP_MAX_SYSCALLS = 512u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims SIGSYS. The library must be running. The module can't be shut down once a filter was
+   installed.
+*/
+[[nodiscard]] bool psignal_seccomp_init(void);
+[[nodiscard]] bool psignal_seccomp_is_running(void);
+void psignal_seccomp_shutdown(void);
+
+/*
+   Sets the handler of a syscall, nullptr to run it for real. Only the syscalls having a handler
+   when psignal_seccomp_install is called are trapped, their handlers can be changed afterwards.
+*/
+[[nodiscard]] bool psignal_seccomp_set_handler(long nr, PSigSyscallHandler, void *userData);
+
+/*
+   Installs a filter trapping the syscalls having a handler and not trapped yet, on every thread
+   of the process. Sets PR_SET_NO_NEW_PRIVS, required by unprivileged filters.
+*/
+[[nodiscard]] bool psignal_seccomp_install(void);
+[[nodiscard]] bool psignal_seccomp_is_trapped(long nr);
+
+/*
+   Runs a syscall for real, even if it is trapped. Returns the value or -errno, or -ENOSYS when
+   unsupported by the architecture.
+*/
+long psignal_seccomp_syscall(long nr, long const args[6]);
+
+// Number of syscalls dispatched through SIGSYS.
+[[nodiscard]] uint64_t psignal_seccomp_trap_count(void);
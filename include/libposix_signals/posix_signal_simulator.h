@@ -0,0 +1,135 @@
+#pragma once
+
+#include "posix_signal_callbacks.h"
+#include "posix_signals.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Simulator
+//================================================================================================
+
+/*
+   Deterministic signal injection, for testing the callback dispatch at high volume. Only built
+   with PSIG_CONFIG_SIMULATOR (make simulate).
+
+   The simulator feeds a stream of events to the signal handler entry point, the kernel is never
+   involved: synthetic siginfo records (any si_code, fault codes included) are delivered to
+   PSIG_SIM_CALLBACKS simulated callbacks, hooked and unhooked by the stream itself. Events can be
+   nested: they then run inside the next callback call, as an SA_NODEFER delivery interrupting it
+   or a hook/unhook racing with the dispatch in progress.
+   The dispatch policies run on a virtual clock only moved by the stream, the batches due being
+   dispatched by the simulator instead of the flusher thread. The same stream always gives the same
+   run, and a seed always gives the same stream.
+
+   Each callback call is checked against a model of the hooks:
+   - a callback is only called while hooked on the signal, with the signal and code delivered,
+   - every callback hooked during a whole IMMEDIATE delivery is called once,
+   - the counts of the calls add up to the deliveries, for the callbacks hooked all along.
+
+   Corpus format, one event per line, '#' starting a comment, signals by name (psignal_from_name)
+   and codes by value or name (SI_USER, SEGV_MAPERR, ...), SI_USER by default:
+
+      deliver SIGSEGV SEGV_MAPERR
+      hook 2 SIGUSR1
+      unhook 2 SIGUSR1
+      policy SIGCHLD coalesce 5000000     # immediate, coalesce <ns>, rate <per second>, latest
+      advance 1000000                     # Virtual nanoseconds.
+      > deliver SIGUSR2                   # Nested: runs inside the next callback call.
+
+   The simulator drives the global callback table: the library must not be running, and the
+   callbacks hooked by the application see the synthetic deliveries too.
+*/
+
+#if PSIG_CONFIG_SIMULATOR
+
+static constexpr unsigned PSIG_SIM_CALLBACKS = 8u;
+static constexpr unsigned PSIG_SIM_MAX_DEPTH = 32u; // Nested events past it are skipped.
+
+typedef enum PSigSimOp : unsigned char
+{
+     PSigSimOp_DELIVER // sig, code.
+   , PSigSimOp_HOOK    // callback, sig.
+   , PSigSimOp_UNHOOK  // callback, sig.
+   , PSigSimOp_POLICY  // sig, mode, value: window ns (COALESCE) or deliveries per second (RATE_LIMIT).
+   , PSigSimOp_ADVANCE // value ns, then dispatches the batches due.
+} PSigSimOp;
+
+typedef struct PSigSimEvent
+{
+   PSigSimOp op;
+   bool nested;           // DELIVER, HOOK and UNHOOK only.
+   PSigDispatchMode mode;
+   unsigned char callback;
+   PSignal sig;
+   int code;
+   uint64_t value;
+} PSigSimEvent;
+
+typedef enum PSigSimViolation : unsigned char
+{
+     PSigSimViolation_NONE
+   , PSigSimViolation_INVALID_EVENT  // Reserved or unauthorized signal, unknown callback, ...
+   , PSigSimViolation_SPURIOUS       // Callback called while not hooked on the signal.
+   , PSigSimViolation_WRONG_SIGNAL
+   , PSigSimViolation_WRONG_CODE
+   , PSigSimViolation_DUPLICATE      // Callback called twice for one IMMEDIATE delivery.
+   , PSigSimViolation_MISSED         // Callback hooked during a whole IMMEDIATE delivery not called.
+   , PSigSimViolation_LOST           // Call counts not adding up to the deliveries.
+} PSigSimViolation;
+
+typedef struct PSigSimReport
+{
+   uint64_t events;
+   uint64_t deliveries;
+   uint64_t calls;
+   uint64_t skipped;              // Nested events without a callback call to run in.
+   unsigned maxDepth;             // Deepest delivery nesting.
+   uint64_t violations;
+   PSigSimViolation firstViolation;
+   size_t firstViolationEvent;    // Index of the top-level event it happened in.
+   uint64_t checksum;             // Of the calls made, equal for equal runs.
+} PSigSimReport;
+
+typedef struct PSigSimGenConfig
+{
+   uint64_t seed;
+   PSignalMask signals;    // 0: SIGHUP, SIGINT, SIGSEGV, SIGUSR1, SIGUSR2, SIGCHLD, SIGWINCH, SIGRTMIN.
+   unsigned callbacks;     // Simulated callbacks used, 0: all of them.
+   unsigned nestPercent;   // Deliveries, hooks and unhooks run inside a callback.
+   unsigned hookPercent;   // Hook and unhook events.
+   unsigned policyPercent; // Policy changes and clock advances.
+} PSigSimGenConfig;
+
+typedef enum PSigSimParse : unsigned char
+{
+     PSigSimParse_EVENT
+   , PSigSimParse_BLANK // Empty line or comment.
+   , PSigSimParse_ERROR
+} PSigSimParse;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Runs the events from a clean state: no simulated callback hooked, IMMEDIATE policies, and
+   restores it afterwards. Returns false on violations, or if the library is running.
+*/
+[[nodiscard]] bool psignal_sim_run(PSigSimEvent const *, size_t count, PSigSimReport *);
+
+/*
+   Fills the events with a stream drawn from the seed.
+*/
+void psignal_sim_generate(PSigSimGenConfig const *, PSigSimEvent *, size_t count);
+
+/*
+   Parses one line of a corpus.
+*/
+[[nodiscard]] PSigSimParse psignal_sim_parse(char const *line, PSigSimEvent *);
+
+[[nodiscard]] char const *psignal_sim_violation_name(PSigSimViolation);
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Stack
+//================================================================================================
+
+/*
+   Stack overflow detection and stack usage of the registered threads (posix_signal_threads.h).
+
+   The module claims SIGSEGV. A fault of a registered thread hitting the guard region below its
+   stack, or happening while its stack pointer is already there, is classified as a stack
+   overflow: it is counted and the SIGSEGV callbacks can retrieve the thread and its depth with
+   psignal_stack_overflow_current. As resuming would only fault again, the default action then
+   terminates the process. Any other SIGSEGV is dispatched to the callbacks as usual.
+
+   The high-water mark of a stack is the deepest page the thread ever touched, found with
+   mincore() from any thread: nothing is written to the stacks beforehand, so measuring them
+   doesn't commit memory. Pages given back to the kernel (swapped out, ...) are missed, which
+   makes it a lower bound.
+   An optional sampler thread measures every registered stack periodically and keeps the peak,
+   which outlives the threads that reached it.
+*/
+
+typedef struct PSigStackConfig
+{
+   uint64_t samplePeriodNs; // 0 disables the sampler.
+} PSigStackConfig;
+
+typedef struct PSigStackOverflow
+{
+   pid_t tid;
+   void *userData;      // Given at thread registration.
+   void *faultAddress;
+   size_t depth;        // Bytes of stack in use when the fault happened.
+   size_t stackSize;
+   size_t guardSize;
+} PSigStackOverflow;
+
+typedef struct PSigStackUsage
+{
+   pid_t tid;
+   void *userData;
+   size_t stackSize;
+   size_t highWater;    // Bytes, rounded up to pages.
+} PSigStackUsage;
+
+typedef void (*PSigStackVisitor)(PSigStackUsage const *, void *arg);
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Claims SIGSEGV and starts the sampler if enabled. Passing nullptr uses the default
+   configuration. The library must be running and the module must be shut down before it.
+*/
+[[nodiscard]] bool psignal_stack_init(PSigStackConfig const *);
+[[nodiscard]] bool psignal_stack_is_running(void);
+void psignal_stack_shutdown(void);
+
+/*
+   Called from a SIGSEGV callback: whether the fault being dispatched on the calling thread is a
+   stack overflow, and its details.
+*/
+[[nodiscard]] bool psignal_stack_overflow_current(PSigStackOverflow *);
+[[nodiscard]] uint64_t psignal_stack_overflow_count(void);
+
+/*
+   Measures the high-water mark of every registered thread. Stacks are walked page by page: this
+   is meant for diagnostics, not hot paths.
+*/
+void psignal_stack_for_each(PSigStackVisitor, void *arg);
+
+/*
+   Deepest high-water mark measured by the sampler so far, and the size of the stack it was
+   measured on.
+*/
+[[nodiscard]] size_t psignal_stack_peak_high_water(size_t *stackSize);
+[[nodiscard]] uint64_t psignal_stack_samples_count(void);
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Threads
+//================================================================================================
+
+/*
+   Signals sent to a process are delivered to whichever thread doesn't block them. Some features
+   need to interrupt specific threads instead, which requires knowing which threads take part.
+
+   Threads opt-in by registering themselves. A registered thread that exits is automatically
+   unregistered.
+
+   On top of that registry, the library provides a "stop the world" primitive: every registered
+   thread (except the caller) is interrupted with a reserved RT signal and parked inside the
+   signal handler. Once all of them are parked, the given function is executed, then all the
+   threads are released.
+
+   The same signal is used to broadcast a function call to every registered thread. Each thread
+   runs it from its signal handler, which makes it a cheap way to flush or reconfigure per-thread
+   state without having the threads poll for it.
+
+   Registered threads must not block the reserved signal (psignal_threads_signal), otherwise a
+   stop the world or a broadcast would wait for them forever.
+
+   Registering also records the stack bounds of the thread and gives it an alternate signal stack
+   if it has none, so that its stack overflows can be handled (see posix_signal_stack.h).
+*/
+
+typedef struct PSigThreadInfo
+{
+   pthread_t thread;
+   pid_t tid;
+   void *userData; // Given at registration.
+   void *ucontext; // Interrupted context. Only set while the thread is parked.
+   void *stackAddr; // Lowest address of the stack, the guard region lies right below it.
+   size_t stackSize;
+   size_t guardSize;
+} PSigThreadInfo;
+
+typedef void (*PSigThreadsWorldFn)(void *arg);
+typedef void (*PSigThreadVisitor)(PSigThreadInfo const *, void *arg);
+typedef void (*PSigBroadcastFn)(void *arg);
+
+/*
+   Handle of an asynchronous broadcast. It stays usable after completion: waiting on a completed
+   broadcast returns immediately.
+*/
+typedef uint64_t PSigBroadcastId;
+
+static constexpr PSigBroadcastId PSIG_BROADCAST_INVALID_ID = 0u;
+
+/*
+   Maximum number of threads registered at the same time.
+*/
+static constexpr unsigned PSIG_THREADS_MAX_CAPACITY = 1024u;
+
+/*
+   Maximum number of asynchronous broadcasts not completed yet.
+*/
+static constexpr unsigned PSIG_BROADCASTS_MAX_IN_FLIGHT = 64u;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves the RT signal used to interrupt registered threads.
+   The library must be running and the threads must be shut down before the library.
+*/
+[[nodiscard]] bool psignal_threads_init(void);
+[[nodiscard]] bool psignal_threads_is_running(void);
+void psignal_threads_shutdown(void);
+
+[[nodiscard]] PSignal psignal_threads_signal(void);
+
+//------------------------------------------------------------------------------------------------
+// Registry
+//------------------------------------------------------------------------------------------------
+
+/*
+   Registers the calling thread. Registering twice only updates the user data.
+   Returns false if the registry is full.
+*/
+[[nodiscard]] bool psignal_thread_register(void *userData);
+void psignal_thread_unregister(void);
+[[nodiscard]] bool psignal_thread_is_registered(void);
+
+[[nodiscard]] unsigned psignal_threads_registered_count(void);
+
+/*
+   Calls the visitor for every registered thread.
+   Mostly meant to be used from a stop the world function, where the set of threads is frozen and
+   their interrupted context available.
+*/
+void psignal_threads_for_each(PSigThreadVisitor, void *arg);
+
+//------------------------------------------------------------------------------------------------
+// Stop the world
+//------------------------------------------------------------------------------------------------
+
+/*
+   Parks every other registered thread inside the signal handler, runs fn(arg) on the calling
+   thread, then releases them. Only one stop the world can be in progress at a time.
+   Returns false (and doesn't call fn) if a thread couldn't be interrupted.
+   Parked threads may have been interrupted while holding any lock (including malloc's ones),
+   fn must not wait on anything they could own.
+   Must not be called from a signal handler.
+*/
+[[nodiscard]] bool psignal_threads_stop_the_world(PSigThreadsWorldFn, void *arg);
+
+//------------------------------------------------------------------------------------------------
+// Broadcast
+//------------------------------------------------------------------------------------------------
+
+/*
+   Runs fn(arg) on every registered thread: from the signal handler for the other threads, so fn
+   must be async-signal-safe, and directly if the caller is registered itself.
+   Returns once every thread has executed it.
+   Returns false if a thread couldn't be interrupted, the others are still served.
+*/
+[[nodiscard]] bool psignal_broadcast_call(PSigBroadcastFn, void *arg);
+
+/*
+   Same as psignal_broadcast_call, without waiting for the threads.
+   onComplete(arg) (optional) is called once by the last thread acknowledging the broadcast,
+   possibly from its signal handler.
+   The given id is set whenever the broadcast has been started, even if false is returned.
+*/
+[[nodiscard]] bool psignal_broadcast_call_async(PSigBroadcastFn, void *arg, PSigBroadcastFn onComplete, PSigBroadcastId *);
+[[nodiscard]] bool psignal_broadcast_is_done(PSigBroadcastId);
+void psignal_broadcast_wait(PSigBroadcastId);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Timers
+//================================================================================================
+
+/*
+   A single POSIX timer (timer_create) is a scarce, per-process kernel resource and arming one
+   costs a syscall. When thousands of short timeouts are needed, creating one timer per timeout
+   doesn't scale.
+
+   This subsystem multiplexes any number of logical timers over one POSIX timer, delivering a
+   reserved Real-Time PSignal. The logical timers are stored in a hierarchical timer wheel, making
+   add, cancel and rearm O(1). The POSIX timer is only reprogrammed when the earliest deadline
+   moves forward.
+
+   Expired timers are delivered either:
+   - directly from the signal handler (PSigTimerDelivery_HANDLER): lowest latency, but the
+     callback must restrict itself to async-signal-safe functions.
+   - from a dedicated thread owned by the subsystem (PSigTimerDelivery_DEFERRED).
+
+   The library must be running (psignal_library_init) before initializing the timers, and the
+   timers must be shut down before the library.
+*/
+
+typedef enum PSigTimerDelivery : unsigned char
+{
+     PSigTimerDelivery_HANDLER  // Callback invoked from signal handler context.
+   , PSigTimerDelivery_DEFERRED // Callback invoked from the timers thread.
+} PSigTimerDelivery;
+
+/*
+   Opaque handle of a logical timer. A handle stays valid until the timer is cancelled or, for
+   one-shot timers, until its callback returns without rearming it.
+   Stale handles are detected and rejected.
+*/
+typedef uint64_t PSigTimerId;
+
+static constexpr PSigTimerId PSIG_TIMER_INVALID_ID = 0u;
+
+typedef struct PSigTimerInfo
+{
+   PSigTimerId id;
+   void *userData;
+   uint64_t deadlineNs; // CLOCK_MONOTONIC time at which the timer was due.
+   uint64_t firedNs;    // CLOCK_MONOTONIC time at which the expiration was processed.
+} PSigTimerInfo;
+
+typedef void (*PSigTimerCallback)(PSigTimerInfo const *);
+
+typedef struct PSigTimerSpec
+{
+   uint64_t delayNs;    // Time before the first expiration.
+   uint64_t intervalNs; // Period of the following expirations. 0 for a one-shot timer.
+   PSigTimerDelivery delivery;
+   PSigTimerCallback callback;
+   void *userData;
+} PSigTimerSpec;
+
+typedef struct PSigTimersConfig
+{
+   unsigned capacity;     // Maximum number of logical timers alive at the same time.
+   uint64_t resolutionNs; // Granularity of the timer wheel. Deadlines are rounded up to it.
+} PSigTimersConfig;
+
+static constexpr unsigned PSIG_TIMERS_DEFAULT_CAPACITY      = 65536u;
+static constexpr uint64_t PSIG_TIMERS_DEFAULT_RESOLUTION_NS = 1000000u; // 1ms
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves a RT signal, creates the POSIX timer and the delivery thread.
+   Passing nullptr uses the default configuration.
+*/
+[[nodiscard]] bool psignal_timers_init(PSigTimersConfig const *);
+[[nodiscard]] bool psignal_timers_is_running(void);
+void psignal_timers_shutdown(void);
+
+/*
+   Returns the RT signal reserved by the timers. Only meaningful while running.
+*/
+[[nodiscard]] PSignal psignal_timers_signal(void);
+
+/*
+   Safe to call from any thread, including from a timer callback.
+   Cancelling a timer whose deferred callback is already executing doesn't wait for it.
+*/
+[[nodiscard]] bool psignal_timer_add(PSigTimerSpec const *, PSigTimerId *);
+[[nodiscard]] bool psignal_timer_cancel(PSigTimerId);
+[[nodiscard]] bool psignal_timer_rearm(PSigTimerId, uint64_t delayNs);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Watchdog
+//================================================================================================
+
+/*
+   Detects stalled threads and tells where they are stuck.
+
+   Monitored threads bump a heartbeat while they make progress (a single relaxed store, cheap
+   enough to be done for every request). A monitor thread owned by the library checks that every
+   monitored thread did beat within its own deadline.
+   When a deadline is missed, the stalled thread is interrupted with a reserved RT signal and its
+   handler captures the thread's stack into a buffer preallocated at registration.
+   The report is then built and delivered from the monitor thread, off the hot path.
+
+   A thread with nothing to do (waiting for requests, ...) can declare itself idle, it won't be
+   monitored until its next heartbeat.
+*/
+
+typedef struct PSigWatchdogReport
+{
+   pthread_t thread;
+   pid_t tid;
+   uint64_t deadlineNs;     // Deadline given at registration.
+   uint64_t stalledNs;      // Time since the last heartbeat.
+   void *const *frames;     // Return addresses, innermost first. Only valid during the report.
+   unsigned frameCount;     // 0 if the stack couldn't be captured in time.
+} PSigWatchdogReport;
+
+typedef void (*PSigWatchdogReporter)(PSigWatchdogReport const *, void *arg);
+
+typedef struct PSigWatchdogConfig
+{
+   uint64_t checkIntervalNs;      // How often heartbeats are checked.
+   PSigWatchdogReporter reporter; // nullptr to print the stack on stderr.
+   void *reporterArg;
+} PSigWatchdogConfig;
+
+static constexpr unsigned PSIG_WATCHDOG_MAX_THREADS = 1024u;
+static constexpr unsigned PSIG_WATCHDOG_MAX_FRAMES  = 64u;
+static constexpr uint64_t PSIG_WATCHDOG_DEFAULT_CHECK_INTERVAL_NS = 10000000u; // 10ms
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Reserves a RT signal and starts the monitor thread. Passing nullptr uses the default
+   configuration. The library must be running and the watchdog must be shut down before it.
+*/
+[[nodiscard]] bool psignal_watchdog_init(PSigWatchdogConfig const *);
+[[nodiscard]] bool psignal_watchdog_is_running(void);
+void psignal_watchdog_shutdown(void);
+
+[[nodiscard]] PSignal psignal_watchdog_signal(void);
+
+//------------------------------------------------------------------------------------------------
+// Monitored threads (calling thread)
+//------------------------------------------------------------------------------------------------
+
+/*
+   Starts monitoring the calling thread: it is considered stalled when it doesn't beat for more
+   than deadlineNs. A monitored thread that exits is automatically unregistered.
+*/
+[[nodiscard]] bool psignal_watchdog_register(uint64_t deadlineNs);
+void psignal_watchdog_unregister(void);
+
+void psignal_watchdog_heartbeat(void);
+void psignal_watchdog_idle(void);
+
+/*
+   Number of stalls reported since the watchdog started.
+*/
+[[nodiscard]] uint64_t psignal_watchdog_stall_count(void);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "posix_signals.h"
+
+#include <stdint.h>
+
+//================================================================================================
+// POSIX Signal Window Size
+//================================================================================================
+
+/*
+   Terminal size cache, refreshed on SIGWINCH instead of an ioctl(TIOCGWINSZ) on every redraw.
+
+   The module hooks a callback on SIGWINCH (posix_signal_callbacks.h) which queries the terminal
+   and publishes its size in a single 64 bits atomic word: any thread reads a consistent size with
+   one load. The generation of the size only changes when the size itself does, renderers
+   comparing it to the one they last drew skip the redraws nothing asked for.
+
+   Resize bursts (a window being dragged) can be coalesced with a dispatch window: the SIGWINCH
+   dispatch policy is then set to COALESCE, for every callback hooked on it.
+*/
+
+typedef struct PSigWinsizeConfig
+{
+   int fd;              // Terminal queried, usually STDOUT_FILENO.
+   uint64_t coalesceNs; // 0: refreshed on every SIGWINCH.
+} PSigWinsizeConfig;
+
+typedef struct PSigWinsize
+{
+   uint16_t rows;
+   uint16_t cols;
+   uint32_t generation; // Incremented on each size change, wraps around.
+} PSigWinsize;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+/*
+   Queries the terminal and hooks the SIGWINCH callback. Passing nullptr queries STDOUT_FILENO,
+   without coalescing. Fails if the fd isn't a terminal. The library must be running and the
+   module must be shut down before it. The fd must stay open until shutdown.
+*/
+[[nodiscard]] bool psignal_winsize_init(PSigWinsizeConfig const *);
+[[nodiscard]] bool psignal_winsize_is_running(void);
+void psignal_winsize_shutdown(void);
+
+/*
+   Cached size, a single atomic load. Rows and columns are 0 while the module isn't running.
+*/
+[[nodiscard]] PSigWinsize psignal_winsize_get(void);
+
+/*
+   Whether the size changed since the generation given, which is then updated.
+*/
+[[nodiscard]] bool psignal_winsize_changed(uint32_t *generation, PSigWinsize *);
+
+/*
+   Queries the terminal right away, as if SIGWINCH was received. Async-signal-safe.
+*/
+[[nodiscard]] bool psignal_winsize_refresh(void);
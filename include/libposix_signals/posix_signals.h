@@ -1,6 +1,8 @@
 #pragma once
 
-#include <sys/types.h> // Necessary for pid_t
+#include "posix_signal_config.h"
+
+#include <sys/types.h> // Necessary for pid_t, pthread_t
 
 //================================================================================================
 // POSIX Signals
@@ -126,10 +128,40 @@ static constexpr unsigned PSignal_ENUM_RT_COUNT  = (PSignal_ENUM_RT_LAST - PSign
 typedef unsigned _BitInt(PSignal_ENUM_COUNT) PSignalMask;
 
 
+//================================================================================================
+// POSIX Signal Build Mask
+//================================================================================================
+
+#define PSIG_RANGE_MASK(first, last) \
+   (((((PSignalMask)1u) << ((last) - (first) + 1u)) - 1u) << (first))
+
+/*
+   Signals handled by this build, see posix_signal_config.h.
+*/
+static constexpr PSignalMask PSignal_BUILD_MASK = 0u
+#if PSIG_CONFIG_STD_SIGNALS
+   | PSIG_RANGE_MASK(PSignal_ENUM_STD_FIRST, PSignal_ENUM_STD_LAST)
+#endif
+#if PSIG_CONFIG_RT_MIN_SIGNALS
+   | PSIG_RANGE_MASK(PSignal_SIGRTMIN, PSignal_SIGRTMIN_15)
+#endif
+#if PSIG_CONFIG_RT_MAX_SIGNALS
+   | PSIG_RANGE_MASK(PSignal_SIGRTMAX_14, PSignal_SIGRTMAX)
+#endif
+   ;
+
+#undef PSIG_RANGE_MASK
+
+
 //================================================================================================
 // API Functions
 //================================================================================================
 
+/*
+   Pure queries are inline definitions, to be folded into the caller. posix_signals.c provides
+   their external definitions, for function pointers and builds without inlining.
+*/
+
 //------------------------------------------------------------------------------------------------
 // Identification
 //------------------------------------------------------------------------------------------------
@@ -142,7 +174,11 @@ typedef unsigned _BitInt(PSignal_ENUM_COUNT) PSignalMask;
    - All the functions taking a PSignal WILL ASSUME that the given enum value is VALID.
 */
 [[nodiscard]]
-bool psignal_validate(unsigned);
+inline bool psignal_validate(unsigned const v)
+{
+   // PSignal starts from 0 and is unsigned.
+   return v <= PSignal_SIGRTMAX;
+}
 
 
 //------------------------------------------------------------------------------------------------
@@ -157,6 +193,13 @@ bool psignal_validate(unsigned);
 [[nodiscard]] bool psignal_raise(PSignal);
 [[nodiscard]] bool psignal_raise_on_pid(PSignal, pid_t);
 
+/*
+   Raise the given signal to a specific thread of your own process.
+   While pthread_kill() is used for STD signals, pthread_sigqueue() is used for RT signals.
+   The thread must still be alive: targeting a joined/detached and exited thread is undefined.
+*/
+[[nodiscard]] bool psignal_raise_on_thread(PSignal, pthread_t);
+
 
 //------------------------------------------------------------------------------------------------
 // Properties
@@ -166,13 +209,25 @@ bool psignal_validate(unsigned);
    Returns true if the given PSignal is mapped to a standard POSIX signal.
 */
 [[nodiscard]]
-bool psignal_is_standard(PSignal);
+inline bool psignal_is_standard(PSignal const psig)
+{
+   return psig <= PSignal_SIGSYS;
+}
 
 /*
    Returns true if the given PSignal is mapped to a Real-Time POSIX signal.
 */
 [[nodiscard]]
-bool psignal_is_real_time(PSignal);
+inline bool psignal_is_real_time(PSignal const psig)
+{
+   return psig >= PSignal_SIGRTMIN && psig <= PSignal_SIGRTMAX;
+}
+
+/*
+   Returns true if the given PSignal is handled by this build (PSignal_BUILD_MASK).
+*/
+[[nodiscard]]
+bool psignal_is_compiled(PSignal);
 
 /*
    Returns the "raw" signal value mapped to the enum.
@@ -208,3 +263,13 @@ char const *psignal_desc(PSignal);
 */
 [[nodiscard]]
 bool psignal_from_raw_signal(int, PSignal *);
+
+/*
+   Try to convert the given signal name into one of the defined PSignal value, ignoring case and
+   with or without the "SIG" prefix. Real-Time signals are named relatively to SIGRTMIN/SIGRTMAX,
+   spaces allowed around the sign. Aliases (SIGIOT, SIGCLD, SIGPOLL, SIGUNUSED) are accepted.
+   If the name is unknown, false will be returned and nothing will be set in pointed param.
+   Example: "SIGTERM", "term", "RTMIN+3", "SIGRTMAX - 2" and psignal_name() results are accepted.
+*/
+[[nodiscard]]
+bool psignal_from_name(char const *, PSignal *);
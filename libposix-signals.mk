@@ -5,8 +5,12 @@ LIBPOSIX_SIGNALS_INCLUDE := 1
 LIBPOSIX_SIGNALS_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
 
 CFLAGS  += -I$(LIBPOSIX_SIGNALS_DIR)include
+# Same build configuration as the library, see its Makefile.
+PSIG_CONFIG_VARS := PSIG_CALLBACKS_CAPACITY PSIG_STD_SIGNALS PSIG_RT_MIN_SIGNALS \
+                    PSIG_RT_MAX_SIGNALS PSIG_CONSTEXPR_DISPOSITIONS PSIG_SIMULATOR
+CFLAGS  += $(foreach var,$(PSIG_CONFIG_VARS),$(if $($(var)),-D$(var:PSIG_%=PSIG_CONFIG_%)=$($(var))))
 LDFLAGS += -L$(LIBPOSIX_SIGNALS_DIR)
-LDLIBS  += -lposix-signals
+LDLIBS  += -lposix-signals -pthread -lm
 
 
 endif 
\ No newline at end of file
@@ -1,5 +1,136 @@
 #pragma once
 
+#include "libposix_signals/posix_signal_threads.h"
+#include "libposix_signals/posix_signals.h"
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Shared between the library translation units only, never exported by the shared library.
+#pragma GCC visibility push(hidden)
+
 [[nodiscard]]
 bool psignal_callback_internal_init(void);
 void psignal_callback_internal_shutdown(void);
+
+/*
+   Library subsystems (timers, ...) need signals that user callbacks will never see.
+   A reserved RT signal is dispatched straight to its internal handler, with the raw siginfo and
+   ucontext, bypassing the callback slots entirely.
+   Signals are taken starting from SIGRTMAX, leaving the low RT signals to the user.
+   A subsystem owning a specific signal (SIGCHLD, ...) can claim it instead.
+*/
+typedef void (*PSigInternalHandler)(siginfo_t *, void *ucontext);
+
+[[nodiscard]]
+bool psignal_callback_internal_reserve(PSigInternalHandler, PSignal *);
+[[nodiscard]]
+bool psignal_callback_internal_claim(PSignal, PSigInternalHandler);
+void psignal_callback_internal_release(PSignal);
+
+/*
+   Keeps a claimed signal dispatched to its handler across the library shutdown, for the claims
+   that can't be given up (a seccomp filter trapping syscalls, ...). Released along with the claim.
+*/
+void psignal_callback_internal_pin(PSignal);
+
+/*
+   Claims every signal of the mask for the same handler, none of them on failure.
+*/
+[[nodiscard]]
+bool psignal_callback_internal_claim_mask(PSignalMask, PSigInternalHandler);
+void psignal_callback_internal_release_mask(PSignalMask);
+
+/*
+   A forked child only inherits the forking thread. Its user callback table is reset, and the
+   subsystems owning threads register a handler run in the child that forgets their state: they
+   are stopped there, their signals released, and can be initialized again.
+   Locks may have been held by threads that don't exist in the child: handlers must not take them,
+   they initialize them again instead.
+*/
+typedef void (*PSigInternalForkHandler)(void);
+
+void psignal_callback_internal_on_fork_child(PSigInternalForkHandler);
+
+/*
+   A subsystem claiming a signal only for some of its occurrences (faults of a given thread, ...)
+   hands the other ones over to the user callbacks hooked on it. Its claim leaves the signal
+   reserved, but user callbacks can still be hooked on it.
+*/
+[[nodiscard]]
+bool psignal_callback_internal_claim_forwarding(PSignal, PSigInternalHandler);
+void psignal_callback_internal_forward(PSignal, siginfo_t const *);
+
+#if PSIG_CONFIG_SIMULATOR
+/*
+   Simulator backend. A non-zero virtual time replaces CLOCK_MONOTONIC for the dispatch policies
+   and turns the flusher thread off: the simulator flushes the batches due itself, the returned
+   time being the next one's (UINT64_MAX if none). Deliveries go through the handler entry point.
+*/
+void psignal_callback_internal_sim_set_time(uint64_t ns);
+void psignal_callback_internal_sim_deliver(siginfo_t *);
+uint64_t psignal_callback_internal_sim_flush(void);
+#endif
+
+/*
+   Emergency arenas, mapped with the library. Registered threads attach their own arena, if
+   configured, and detach it themselves.
+*/
+[[nodiscard]]
+bool psignal_arena_internal_init(size_t arenaSize, size_t threadArenaSize);
+void psignal_arena_internal_shutdown(void);
+void psignal_arena_internal_thread_attach(void);
+void psignal_arena_internal_thread_detach(void);
+
+/*
+   Mask of the raw signals set in bits, signal n being bit (n - 1) as in the glibc sigset_t words
+   and /proc/<pid>/status. Raw signals PSignal doesn't cover are left out.
+*/
+[[nodiscard]]
+PSignalMask psignal_mask_internal_from_raw_bits(uint64_t bits);
+
+/*
+   Registry entry of the calling thread, without its ucontext. Async-signal-safe.
+   Returns false if the thread isn't registered.
+*/
+[[nodiscard]]
+bool psignal_threads_internal_self(PSigThreadInfo *);
+
+/*
+   Architecture specific accessors to the interrupted context given to a signal handler.
+   They return 0 on unsupported architectures.
+*/
+[[nodiscard]]
+uintptr_t psignal_internal_context_pc(void const *ucontext);
+[[nodiscard]]
+uintptr_t psignal_internal_context_sp(void const *ucontext);
+
+/*
+   Syscall arguments and return value of a context interrupted by a seccomp trap (SIGSYS).
+   They return false on unsupported architectures.
+*/
+[[nodiscard]]
+bool psignal_internal_context_syscall_args(void const *ucontext, long args[6]);
+[[nodiscard]]
+bool psignal_internal_context_set_syscall_result(void *ucontext, long result);
+
+/*
+   Floating point traps of the interrupted context, applied when the handler returns.
+   Masking also clears the raised flags of the given exceptions (FE_INVALID, ...).
+*/
+[[nodiscard]]
+bool psignal_internal_context_fpe_mask(void *ucontext, int excepts);
+[[nodiscard]]
+bool psignal_internal_context_fpe_unmask(void *ucontext, int excepts);
+[[nodiscard]]
+bool psignal_internal_context_single_step(void *ucontext, bool enable);
+
+/*
+   Makes the interrupted context call entry(arg) on the stack ending at stackTop when the handler
+   returns, as if it had been called from there.
+*/
+[[nodiscard]]
+bool psignal_internal_context_redirect(void *ucontext, void (*entry)(void *), void *arg, void *stackTop);
+
+#pragma GCC visibility pop
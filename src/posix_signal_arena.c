@@ -0,0 +1,238 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_arena.h"
+
+#include "../src/internal.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+/*
+   The whole state of an arena fits in one word, so that a signal interrupting an operation at any
+   point sees it either done or not started: open scopes in the high half, allocated bytes in the
+   low half.
+*/
+struct PSigArena
+{
+   _Atomic(uint64_t) state;
+   atomic_uint peak;
+   uint32_t capacity;
+   uint32_t mappedSize;
+   bool perThread;
+   alignas(max_align_t) unsigned char data[];
+};
+
+// Arenas are addressed with 32 bits offsets.
+static constexpr size_t S_MAX_ARENA_SIZE = (size_t)1u << 31;
+
+static _Atomic(PSigArena *) s_processArena = nullptr;
+static size_t s_threadArenaSize = 0u;
+
+static thread_local PSigArena *s_threadArena = nullptr;
+
+static atomic_uint_fast64_t s_allocations = 0u;
+static atomic_uint_fast64_t s_exhaustions = 0u;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static inline uint32_t state_top(uint64_t const state)
+{
+   return (uint32_t)state;
+}
+
+[[nodiscard]]
+static inline uint32_t state_scopes(uint64_t const state)
+{
+   return (uint32_t)(state >> 32);
+}
+
+[[nodiscard]]
+static inline uint64_t make_state(uint32_t const scopes, uint32_t const top)
+{
+   return ((uint64_t)scopes << 32) | top;
+}
+
+[[nodiscard]]
+static PSigArena *arena_create(size_t const size, bool const perThread)
+{
+   size_t const requested = (size < S_MAX_ARENA_SIZE) ? size : S_MAX_ARENA_SIZE;
+   size_t const mappedSize = offsetof(PSigArena, data) + requested;
+
+   // Prefaulted: the pages are never touched for the first time from a crashing process.
+   void *const memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+   if (memory == MAP_FAILED)
+      return nullptr;
+
+   PSigArena *const arena = memory;
+   atomic_init(&arena->state, make_state(0u, 0u));
+   atomic_init(&arena->peak, 0u);
+   arena->capacity = (uint32_t)requested;
+   arena->mappedSize = (uint32_t)mappedSize;
+   arena->perThread = perThread;
+   return arena;
+}
+
+static void arena_destroy(PSigArena *const arena)
+{
+   if (arena != nullptr)
+   {
+      munmap(arena, arena->mappedSize);
+   }
+}
+
+[[nodiscard]]
+static inline PSigArena *current_arena(void)
+{
+   PSigArena *const own = s_threadArena;
+   return (own != nullptr) ? own : atomic_load(&s_processArena);
+}
+
+static void update_peak(PSigArena *const arena, uint32_t const top)
+{
+   unsigned peak = atomic_load_explicit(&arena->peak, memory_order_relaxed);
+   while (top > peak && !atomic_compare_exchange_weak(&arena->peak, &peak, top)) {}
+}
+
+
+//================================================================================================
+// Internal API Functions
+//================================================================================================
+
+bool psignal_arena_internal_init(size_t const arenaSize, size_t const threadArenaSize)
+{
+   PSigArena *const arena = arena_create((arenaSize != 0u) ? arenaSize : PSIG_ARENA_DEFAULT_SIZE, false);
+   if (arena == nullptr)
+      return false;
+
+   s_threadArenaSize = threadArenaSize;
+   atomic_store(&s_processArena, arena);
+   return true;
+}
+
+void psignal_arena_internal_shutdown(void)
+{
+   // Thread arenas are released by their threads.
+   arena_destroy(atomic_exchange(&s_processArena, nullptr));
+   s_threadArenaSize = 0u;
+}
+
+void psignal_arena_internal_thread_attach(void)
+{
+   if (s_threadArena == nullptr && s_threadArenaSize != 0u)
+   {
+      s_threadArena = arena_create(s_threadArenaSize, true);
+   }
+}
+
+void psignal_arena_internal_thread_detach(void)
+{
+   PSigArena *const arena = s_threadArena;
+   s_threadArena = nullptr;
+   arena_destroy(arena);
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+PSigArenaMark psignal_arena_mark(void)
+{
+   PSigArena *const arena = current_arena();
+   if (arena == nullptr)
+      return (PSigArenaMark) {};
+
+   uint64_t state = atomic_load(&arena->state);
+   while (!atomic_compare_exchange_weak(&arena->state, &state, make_state(state_scopes(state) + 1u, state_top(state)))) {}
+
+   return (PSigArenaMark) { .arena = arena, .offset = state_top(state) };
+}
+
+void psignal_arena_reset(PSigArenaMark const mark)
+{
+   PSigArena *const arena = mark.arena;
+   if (arena == nullptr)
+      return;
+
+   uint64_t state = atomic_load(&arena->state);
+   uint64_t desired;
+   do
+   {
+      uint32_t const scopes = state_scopes(state);
+      if (scopes == 0u)
+         return;
+
+      // Other threads may still use what was allocated after the mark of a shared arena.
+      uint32_t top = state_top(state);
+      if (arena->perThread)
+         top = mark.offset;
+      else if (scopes == 1u)
+         top = 0u;
+
+      desired = make_state(scopes - 1u, top);
+   } while (!atomic_compare_exchange_weak(&arena->state, &state, desired));
+}
+
+void *psignal_arena_alloc(size_t const size, size_t alignment)
+{
+   PSigArena *const arena = current_arena();
+   if (arena == nullptr)
+      return nullptr;
+
+   if (alignment == 0u)
+   {
+      alignment = alignof(max_align_t);
+   }
+   if ((alignment & (alignment - 1u)) != 0u || alignment > 4096u)
+      return nullptr;
+
+   uintptr_t const base = (uintptr_t)arena->data;
+   uint64_t state = atomic_load(&arena->state);
+   uint64_t end;
+   do
+   {
+      if (state_scopes(state) == 0u)
+         return nullptr;
+
+      uintptr_t const address = (base + state_top(state) + alignment - 1u) & ~(uintptr_t)(alignment - 1u);
+      end = (uint64_t)(address - base) + size;
+      if (size > arena->capacity || end > arena->capacity)
+      {
+         atomic_fetch_add_explicit(&s_exhaustions, 1u, memory_order_relaxed);
+         return nullptr;
+      }
+   } while (!atomic_compare_exchange_weak(&arena->state, &state, make_state(state_scopes(state), (uint32_t)end)));
+
+   atomic_fetch_add_explicit(&s_allocations, 1u, memory_order_relaxed);
+   update_peak(arena, (uint32_t)end);
+   return arena->data + (end - size);
+}
+
+void psignal_arena_stats(PSigArenaStats *const stats)
+{
+   PSigArena const *const arena = current_arena();
+
+   *stats = (PSigArenaStats) {
+      .allocations = atomic_load(&s_allocations),
+      .exhaustions = atomic_load(&s_exhaustions)
+   };
+
+   if (arena != nullptr)
+   {
+      stats->capacity = arena->capacity;
+      stats->used = state_top(atomic_load(&arena->state));
+      stats->peak = atomic_load(&arena->peak);
+   }
+}
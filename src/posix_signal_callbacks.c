@@ -6,10 +6,18 @@
 
 #include "libmacros/macro_utils.h"
 
+#include "../src/internal.h"
+
 #include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 
 // ===============================================================================================
@@ -25,6 +33,58 @@ typedef struct CallbackSlot
 static CallbackSlot s_cbSlots[PSIG_CALLBACKS_MAX_CAPACITY] = {};
 static unsigned s_cbSlotsUsed = 0u;
 
+/*
+   Dispatches in progress, nested ones included. Meanwhile, a callback removed from its last
+   signal keeps its slot with an empty mask: moving slots around would make the dispatch loop skip
+   a callback still hooked.
+*/
+static atomic_uint s_dispatchDepth = 0u;
+
+// Indexed by PSignal. A non-null handler means the signal is reserved by the library.
+static _Atomic(PSigInternalHandler) s_reservedHandlers[PSignal_ENUM_COUNT] = {};
+// Reserved signals whose handler forwards the occurrences it doesn't own: they can be hooked on.
+static atomic_bool s_forwarded[PSignal_ENUM_COUNT] = {};
+// Reserved signals still dispatched to their handler after the library shutdown.
+static atomic_bool s_pinned[PSignal_ENUM_COUNT] = {};
+
+// One per subsystem owning threads, never unregistered.
+static constexpr unsigned MAX_FORK_HANDLERS = 32u;
+
+static PSigInternalForkHandler s_forkHandlers[MAX_FORK_HANDLERS] = {};
+static unsigned s_forkHandlersCount = 0u;
+static pthread_mutex_t s_forkHandlersMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t s_atforkOnce = PTHREAD_ONCE_INIT;
+
+// Indexed by PSignal, only used by signals with a dispatch policy.
+typedef struct DispatchState
+{
+   _Atomic(PSigDispatchMode) mode;
+   atomic_uint_fast64_t windowNs;   // COALESCE: window, RATE_LIMIT: interval between calls.
+   atomic_uint pending;
+   atomic_uint_fast64_t firstNs;    // 0 while no batch is open.
+   atomic_uint_fast64_t lastNs;
+   atomic_uint_fast64_t readyNs;    // RATE_LIMIT: next call allowed.
+   atomic_int sigCode;
+   atomic_bool dispatching;
+   atomic_uint_fast64_t received;
+   atomic_uint_fast64_t dispatched;
+} DispatchState;
+
+static DispatchState s_dispatch[PSignal_ENUM_COUNT] = {};
+
+// Dispatches the batches due without new delivery. The semaphore is never destroyed.
+static sem_t s_flusherSem;
+static pthread_once_t s_flusherSemOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t s_flusherMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t s_flusher;
+static bool s_flusherStarted = false;
+static atomic_bool s_flusherStop = false;
+
+#if PSIG_CONFIG_SIMULATOR
+// Virtual time of the simulator, 0 outside of a simulation.
+static uint64_t s_simNowNs = 0u;
+#endif
+
 
 // ===============================================================================================
 // Internal Functions
@@ -93,11 +153,30 @@ static void remove_from_slot(PSigCallback const cb)
    // Slot not found, do we want to emit an error here or simply discard that fact ?
 }
 
+// Frees the slots left empty by removals during dispatches.
+static void purge_empty_slots(void)
+{
+   if (atomic_load(&s_dispatchDepth) != 0u)
+      return;
+
+   for (unsigned i = s_cbSlotsUsed; i > 0u; --i)
+   {
+      if (s_cbSlots[i - 1u].hookedMask == psignal_disposition_mask_none())
+      {
+         remove_from_slot(s_cbSlots[i - 1u].callback);
+      }
+   }
+}
+
 [[nodiscard]]
 static CallbackSlot *try_get_or_register_new_slot(PSigCallback const cb)
 {
    CallbackSlot *regCb = try_get_slot(cb);
 
+   if (regCb == nullptr && !has_available_slot())
+   {
+      purge_empty_slots();
+   }
    if (regCb == nullptr && has_available_slot())
    {
       regCb = register_new_slot(cb);
@@ -125,13 +204,40 @@ static void downgrade_slot(PSigCallback const cb, PSignalMask const mask)
    if (regCb)
    {
       regCb->hookedMask &= ~(mask);
-      if (regCb->hookedMask == psignal_disposition_mask_none())
+      if (regCb->hookedMask == psignal_disposition_mask_none() && atomic_load(&s_dispatchDepth) == 0u)
       {
          remove_from_slot(cb);
       }
    }
 }
 
+[[nodiscard]]
+static inline PSigInternalHandler reserved_handler(PSignal const psig)
+{
+   return atomic_load(&s_reservedHandlers[psig]);
+}
+
+// Reserved signals user callbacks can't be hooked on: their handler doesn't forward anything.
+[[nodiscard]]
+static inline bool is_exclusive(PSignal const psig)
+{
+   return reserved_handler(psig) != nullptr && !atomic_load(&s_forwarded[psig]);
+}
+
+[[nodiscard]]
+static PSignalMask exclusive_mask(void)
+{
+   PSignalMask mask = 0u;
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (is_exclusive(idx))
+      {
+         mask |= (1lu << idx);
+      }
+   }
+   return mask;
+}
+
 [[nodiscard]]
 static bool setup_alternate_stack(void)
 {
@@ -152,6 +258,272 @@ static bool setup_alternate_stack(void)
    return (sigaltstack(&stack, nullptr) == 0);
 }
 
+static void dispatch_to_callbacks(PSigCallbackInfo const *const cbInfo)
+{
+   PSignal const psig = cbInfo->sig;
+
+   atomic_fetch_add(&s_dispatchDepth, 1u);
+   for (unsigned i = 0; i < s_cbSlotsUsed; ++i)
+   {
+      CallbackSlot const *regCb = &s_cbSlots[i];
+      if (is_signal_hooked(regCb->hookedMask, psig))
+      {
+         regCb->callback(cbInfo);
+      }
+   }
+   atomic_fetch_sub(&s_dispatchDepth, 1u);
+}
+
+//------------------------------------------------------------------------------------------------
+// Dispatch policies
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+#if PSIG_CONFIG_SIMULATOR
+   if (s_simNowNs != 0u)
+      return s_simNowNs;
+#endif
+
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+[[nodiscard]]
+static inline bool is_synchronous_fault(PSignal const psig)
+{
+   return psig == PSignal_SIGSEGV || psig == PSignal_SIGBUS || psig == PSignal_SIGILL
+      || psig == PSignal_SIGFPE || psig == PSignal_SIGTRAP;
+}
+
+[[nodiscard]]
+static inline bool is_timed(PSigDispatchMode const mode)
+{
+   return mode == PSigDispatchMode_COALESCE || mode == PSigDispatchMode_RATE_LIMIT;
+}
+
+// Time from which the pending batch can be dispatched.
+[[nodiscard]]
+static uint64_t ready_at(DispatchState *const state, uint64_t const now)
+{
+   switch (atomic_load(&state->mode))
+   {
+      case PSigDispatchMode_COALESCE:
+      {
+         uint64_t const firstNs = atomic_load(&state->firstNs);
+         return ((firstNs != 0u) ? firstNs : now) + atomic_load(&state->windowNs);
+      }
+      case PSigDispatchMode_RATE_LIMIT:
+         return atomic_load(&state->readyNs);
+
+      case PSigDispatchMode_IMMEDIATE:
+      case PSigDispatchMode_LATEST_ONLY:
+         return 0u;
+   }
+
+   unreachable();
+}
+
+static void wake_flusher(void)
+{
+#if PSIG_CONFIG_SIMULATOR
+   // The simulator flushes the batches itself, there is no flusher thread to wake.
+   if (s_simNowNs != 0u)
+      return;
+#endif
+
+   sem_post(&s_flusherSem);
+}
+
+/*
+   Only one dispatcher per signal at a time: a delivery finding another one running leaves its
+   count to it (LATEST_ONLY) or to the flusher.
+*/
+static void dispatch_pending(PSignal const psig, DispatchState *const state)
+{
+   bool expected = false;
+   while (atomic_compare_exchange_strong(&state->dispatching, &expected, true))
+   {
+      PSigDispatchMode const mode = atomic_load(&state->mode);
+      for (;;)
+      {
+         uint64_t const firstNs = atomic_exchange(&state->firstNs, 0u);
+         uint64_t const lastNs = atomic_load(&state->lastNs);
+         unsigned const count = atomic_exchange(&state->pending, 0u);
+         if (count == 0u)
+            break;
+
+         if (mode == PSigDispatchMode_RATE_LIMIT)
+         {
+            atomic_store(&state->readyNs, now_ns() + atomic_load(&state->windowNs));
+         }
+
+         atomic_fetch_add(&state->dispatched, 1u);
+         dispatch_to_callbacks(&(PSigCallbackInfo) {
+            .sig = psig,
+            .sigCode = atomic_load(&state->sigCode),
+            .count = count,
+            .firstNs = firstNs,
+            .lastNs = lastNs
+         });
+
+         if (mode != PSigDispatchMode_LATEST_ONLY)
+            break;
+      }
+      atomic_store(&state->dispatching, false);
+
+      if (atomic_load(&state->pending) == 0u)
+         return;
+
+      // Deliveries that came after the batch: theirs to wait for the flusher, or ours to take.
+      if (is_timed(mode))
+      {
+         wake_flusher();
+         return;
+      }
+      expected = false;
+   }
+}
+
+static void deliver(PSignal const psig, siginfo_t const *const info)
+{
+   DispatchState *const state = &s_dispatch[psig];
+   int const sigCode = (info ? info->si_code : 0);
+
+   PSigDispatchMode const mode = atomic_load(&state->mode);
+   if (mode == PSigDispatchMode_IMMEDIATE)
+   {
+      dispatch_to_callbacks(&(PSigCallbackInfo) { .sig = psig, .sigCode = sigCode, .count = 1u });
+      return;
+   }
+
+   uint64_t const now = now_ns();
+   atomic_fetch_add(&state->received, 1u);
+   atomic_store(&state->sigCode, sigCode);
+   atomic_store(&state->lastNs, now);
+
+   uint64_t noBatch = 0u;
+   bool const opened = atomic_compare_exchange_strong(&state->firstNs, &noBatch, now);
+   atomic_fetch_add(&state->pending, 1u);
+
+   if (ready_at(state, now) <= now)
+   {
+      dispatch_pending(psig, state);
+   }
+   else if (opened)
+   {
+      wake_flusher();
+   }
+}
+
+// Dispatches the batches due, returns when the next one will be, UINT64_MAX if none is pending.
+static uint64_t flush_due_batches(uint64_t const now)
+{
+   uint64_t next = UINT64_MAX;
+
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      DispatchState *const state = &s_dispatch[idx];
+      if (!is_timed(atomic_load(&state->mode)) || atomic_load(&state->pending) == 0u)
+         continue;
+
+      uint64_t const readyNs = ready_at(state, now);
+      if (readyNs <= now)
+      {
+         dispatch_pending(idx, state);
+      }
+      else if (readyNs < next)
+      {
+         next = readyNs;
+      }
+   }
+
+   return next;
+}
+
+static void *flusher_main(void *const arg)
+{
+   while (!atomic_load(&s_flusherStop))
+   {
+      uint64_t const next = flush_due_batches(now_ns());
+      if (next == UINT64_MAX)
+      {
+         sem_wait(&s_flusherSem);
+         continue;
+      }
+
+      struct timespec const deadline = (struct timespec) {
+         .tv_sec = (time_t)(next / 1000000000u),
+         .tv_nsec = (long)(next % 1000000000u)
+      };
+      sem_clockwait(&s_flusherSem, CLOCK_MONOTONIC, &deadline);
+   }
+
+   return nullptr;
+}
+
+static void init_flusher_sem(void)
+{
+   sem_init(&s_flusherSem, 0, 0u);
+}
+
+[[nodiscard]]
+static bool start_flusher(void)
+{
+#if PSIG_CONFIG_SIMULATOR
+   if (s_simNowNs != 0u)
+      return true;
+#endif
+
+   pthread_once(&s_flusherSemOnce, &init_flusher_sem);
+
+   pthread_mutex_lock(&s_flusherMutex);
+   if (!s_flusherStarted)
+   {
+      atomic_store(&s_flusherStop, false);
+      s_flusherStarted = (pthread_create(&s_flusher, nullptr, &flusher_main, nullptr) == 0);
+   }
+   bool const started = s_flusherStarted;
+   pthread_mutex_unlock(&s_flusherMutex);
+
+   return started;
+}
+
+static void stop_flusher(void)
+{
+   pthread_mutex_lock(&s_flusherMutex);
+   if (s_flusherStarted)
+   {
+      atomic_store(&s_flusherStop, true);
+      sem_post(&s_flusherSem);
+      pthread_join(s_flusher, nullptr);
+      s_flusherStarted = false;
+   }
+   pthread_mutex_unlock(&s_flusherMutex);
+}
+
+static void reset_dispatch_states(void)
+{
+   for (unsigned i = 0; i < PSignal_ENUM_COUNT; ++i)
+   {
+      DispatchState *const state = &s_dispatch[i];
+      atomic_store(&state->mode, PSigDispatchMode_IMMEDIATE);
+      atomic_store(&state->pending, 0u);
+      atomic_store(&state->firstNs, 0u);
+      atomic_store(&state->readyNs, 0u);
+      atomic_store(&state->dispatching, false);
+      atomic_store(&state->received, 0u);
+      atomic_store(&state->dispatched, 0u);
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Entry point
+//------------------------------------------------------------------------------------------------
+
 static void sigaction_callback_entry_point(int const sig, siginfo_t *info, void *context)
 {
    PSignal psig;
@@ -161,21 +533,41 @@ static void sigaction_callback_entry_point(int const sig, siginfo_t *info, void
       exit(sig);
    }
 
-   PSigCallbackInfo const cbInfo = (PSigCallbackInfo) {
-      .sig = psig,
-      .sigCode = (info ? info->si_signo : 0)
-   };
+   PSigInternalHandler const internalHandler = reserved_handler(psig);
+   if (internalHandler != nullptr)
+   {
+      // Internal handlers issue syscalls, don't let them clobber the interrupted code's errno.
+      int const savedErrno = errno;
+      internalHandler(info, context);
+      errno = savedErrno;
+      return;
+   }
 
-   for (unsigned i = 0; i < s_cbSlotsUsed; ++i)
+   deliver(psig, info);
+}
+
+static void on_fork_child(void)
+{
+   s_cbSlotsUsed = 0u;
+
+   // The flusher thread isn't inherited.
+   s_flusherStarted = false;
+   pthread_mutex_init(&s_flusherMutex, nullptr);
+   reset_dispatch_states();
+
+   // The forking thread may have been registering a handler.
+   pthread_mutex_init(&s_forkHandlersMutex, nullptr);
+   for (unsigned i = 0; i < s_forkHandlersCount; ++i)
    {
-      CallbackSlot const *regCb = &s_cbSlots[i];
-      if (is_signal_hooked(regCb->hookedMask, psig))
-      {
-         regCb->callback(&cbInfo);
-      }
+      s_forkHandlers[i]();
    }
 }
 
+static void register_atfork(void)
+{
+   pthread_atfork(nullptr, nullptr, &on_fork_child);
+}
+
 // ===============================================================================================
 // Internal API Functions
 // ===============================================================================================
@@ -185,6 +577,8 @@ bool psignal_callback_internal_init(void)
    if (!setup_alternate_stack())
       return false;
 
+   pthread_once(&s_atforkOnce, &register_atfork);
+
    struct sigaction sa = {};
    sigemptyset(&sa.sa_mask);
    // SA_NODEFER: Allows receiving the same signal during handler.
@@ -217,15 +611,145 @@ void psignal_callback_internal_shutdown(void)
 
    for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
    {
-      if (psignal_callback_is_authorized(idx))
+      if (psignal_callback_is_authorized(idx) && !atomic_load(&s_pinned[idx]))
       {
          sigaction(psignal_to_raw_signal(idx), &sa, nullptr);
       }
    }
 
    s_cbSlotsUsed = 0;
+
+   stop_flusher();
+   reset_dispatch_states();
+
+   for (unsigned i = 0; i < PSignal_ENUM_COUNT; ++i)
+   {
+      if (atomic_load(&s_pinned[i]))
+         continue;
+
+      atomic_store(&s_forwarded[i], false);
+      atomic_store(&s_reservedHandlers[i], nullptr);
+   }
 }
 
+bool psignal_callback_internal_reserve(PSigInternalHandler const handler, PSignal *const out)
+{
+   assert(handler != nullptr);
+
+   for (PSignal idx = PSignal_ENUM_RT_LAST; idx >= PSignal_ENUM_RT_FIRST; --idx)
+   {
+      if (psignal_callback_internal_claim(idx, handler))
+      {
+         *out = idx;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool psignal_callback_internal_claim(PSignal const psig, PSigInternalHandler const handler)
+{
+   assert(handler != nullptr);
+
+   if (!psignal_callback_is_authorized(psig))
+      return false;
+
+   PSigInternalHandler expected = nullptr;
+   return atomic_compare_exchange_strong(&s_reservedHandlers[psig], &expected, handler);
+}
+
+bool psignal_callback_internal_claim_forwarding(PSignal const psig, PSigInternalHandler const handler)
+{
+   if (!psignal_callback_internal_claim(psig, handler))
+      return false;
+
+   atomic_store(&s_forwarded[psig], true);
+   return true;
+}
+
+void psignal_callback_internal_pin(PSignal const psig)
+{
+   atomic_store(&s_pinned[psig], true);
+}
+
+void psignal_callback_internal_release(PSignal const psig)
+{
+   atomic_store(&s_pinned[psig], false);
+   atomic_store(&s_forwarded[psig], false);
+   atomic_store(&s_reservedHandlers[psig], nullptr);
+}
+
+bool psignal_callback_internal_claim_mask(PSignalMask const mask, PSigInternalHandler const handler)
+{
+   PSignalMask claimed = 0u;
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (!is_signal_hooked(mask, idx))
+         continue;
+
+      if (!psignal_callback_internal_claim(idx, handler))
+      {
+         psignal_callback_internal_release_mask(claimed);
+         return false;
+      }
+      claimed |= (PSignalMask)1u << idx;
+   }
+   return true;
+}
+
+void psignal_callback_internal_release_mask(PSignalMask const mask)
+{
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (is_signal_hooked(mask, idx))
+      {
+         psignal_callback_internal_release(idx);
+      }
+   }
+}
+
+void psignal_callback_internal_on_fork_child(PSigInternalForkHandler const handler)
+{
+   pthread_mutex_lock(&s_forkHandlersMutex);
+
+   bool known = false;
+   for (unsigned i = 0; i < s_forkHandlersCount && !known; ++i)
+   {
+      known = (s_forkHandlers[i] == handler);
+   }
+   assert(known || s_forkHandlersCount < MAX_FORK_HANDLERS);
+   if (!known && s_forkHandlersCount < MAX_FORK_HANDLERS)
+   {
+      s_forkHandlers[s_forkHandlersCount++] = handler;
+   }
+
+   pthread_mutex_unlock(&s_forkHandlersMutex);
+}
+
+void psignal_callback_internal_forward(PSignal const psig, siginfo_t const *const info)
+{
+   deliver(psig, info);
+}
+
+#if PSIG_CONFIG_SIMULATOR
+
+void psignal_callback_internal_sim_set_time(uint64_t const ns)
+{
+   s_simNowNs = ns;
+}
+
+void psignal_callback_internal_sim_deliver(siginfo_t *const info)
+{
+   sigaction_callback_entry_point(info->si_signo, info, nullptr);
+}
+
+uint64_t psignal_callback_internal_sim_flush(void)
+{
+   return flush_due_batches(now_ns());
+}
+
+#endif
 
 // ===============================================================================================
 // Public API Functions
@@ -233,7 +757,12 @@ void psignal_callback_internal_shutdown(void)
 
 bool psignal_callback_is_authorized(PSignal const psig)
 {
-   return (psig != PSignal_SIGKILL && psig != PSignal_SIGSTOP);
+   return (psig != PSignal_SIGKILL && psig != PSignal_SIGSTOP) && psignal_is_compiled(psig);
+}
+
+bool psignal_callback_is_reserved(PSignal const psig)
+{
+   return reserved_handler(psig) != nullptr;
 }
 
 bool psignal_callback_is_hooked_on(PSignal const psig, PSigCallback const cb)
@@ -245,17 +774,20 @@ bool psignal_callback_is_hooked_on(PSignal const psig, PSigCallback const cb)
 
 bool psignal_callback_hook_on_sig(PSignal const psig, PSigCallback const cb)
 {
+   if (is_exclusive(psig) || !psignal_is_compiled(psig))
+      return false;
+
    return upgrade_slot(cb, (1lu << psig));
 }
 
 bool psignal_callback_hook_on_disposition(PSigDisposition const disp, PSigCallback const cb)
 {
-   return upgrade_slot(cb, psignal_disposition_mask(disp));
+   return upgrade_slot(cb, psignal_disposition_mask(disp) & PSignal_BUILD_MASK & ~exclusive_mask());
 }
 
 bool psignal_callback_hook_on_all(PSigCallback const cb)
 {
-   return upgrade_slot(cb, psignal_disposition_mask_all());
+   return upgrade_slot(cb, psignal_disposition_mask_all() & PSignal_BUILD_MASK & ~exclusive_mask());
 }
 
 
@@ -273,3 +805,60 @@ void psignal_callback_remove_from_all(PSigCallback const cb)
 {
    downgrade_slot(cb, psignal_disposition_mask_all());
 }
+
+bool psignal_callback_set_policy(PSignal const psig, PSigDispatchPolicy const *const policy)
+{
+   PSigDispatchPolicy const applied = (policy != nullptr)
+      ? *policy
+      : (PSigDispatchPolicy) { .mode = PSigDispatchMode_IMMEDIATE };
+
+   uint64_t windowNs = 0u;
+   switch (applied.mode)
+   {
+      case PSigDispatchMode_COALESCE:
+         windowNs = applied.windowNs;
+         if (windowNs == 0u)
+            return false;
+         break;
+
+      case PSigDispatchMode_RATE_LIMIT:
+         if (applied.maxPerSecond == 0u)
+            return false;
+         windowNs = 1000000000u / applied.maxPerSecond;
+         break;
+
+      case PSigDispatchMode_IMMEDIATE:
+      case PSigDispatchMode_LATEST_ONLY:
+         break;
+
+      default:
+         return false;
+   }
+
+   if (!psignal_callback_is_authorized(psig)
+      || (applied.mode != PSigDispatchMode_IMMEDIATE && is_synchronous_fault(psig)))
+      return false;
+
+   if (is_timed(applied.mode) && !start_flusher())
+      return false;
+
+   DispatchState *const state = &s_dispatch[psig];
+   atomic_store(&state->windowNs, windowNs);
+   atomic_store(&state->readyNs, 0u);
+   atomic_store(&state->mode, applied.mode);
+
+   if (atomic_load(&state->pending) != 0u)
+   {
+      dispatch_pending(psig, state);
+   }
+   return true;
+}
+
+void psignal_callback_policy_stats(PSignal const psig, PSigDispatchStats *const stats)
+{
+   DispatchState *const state = &s_dispatch[psig];
+   *stats = (PSigDispatchStats) {
+      .received = atomic_load(&state->received),
+      .dispatched = atomic_load(&state->dispatched)
+   };
+}
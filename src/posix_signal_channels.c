@@ -0,0 +1,529 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_channels.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+static constexpr uint32_t CHANNEL_MAGIC = 0x50534348u; // "PSCH"
+static constexpr size_t CACHE_LINE = 64u;
+
+/*
+   Bounded MPSC ring with a sequence number per slot (Vyukov): a slot is free for the producer at
+   position pos when seq == pos, and holds a message for the consumer when seq == pos + 1.
+*/
+typedef struct ChannelSlot
+{
+   _Atomic(uint64_t) seq;
+   uint32_t length;
+   unsigned char data[];
+} ChannelSlot;
+
+// Layout of the ring, set by the creator.
+typedef struct ChannelHeader
+{
+   uint32_t magic;
+   uint32_t capacity;
+   uint32_t messageSize;
+   uint32_t slotStride;
+} ChannelHeader;
+
+// Lives in the shared memory segment, identical for every process mapping it.
+typedef struct ChannelShared
+{
+   ChannelHeader header;
+
+   alignas(CACHE_LINE) _Atomic(uint64_t) tail; // Next position reserved by producers.
+   alignas(CACHE_LINE) _Atomic(uint64_t) head; // Next position read by the consumer.
+
+   alignas(CACHE_LINE) _Atomic(uint32_t) parked;
+   _Atomic(int32_t) consumerPid;
+   _Atomic(int32_t) consumerTid;
+   _Atomic(int32_t) consumerSignal;
+
+   _Atomic(uint64_t) sent;
+   _Atomic(uint64_t) received;
+   _Atomic(uint64_t) batches;
+   _Atomic(uint64_t) doorbells;
+   _Atomic(uint64_t) full;
+
+   alignas(CACHE_LINE) unsigned char slots[];
+} ChannelShared;
+
+// Process local handle.
+struct PSigChannel
+{
+   ChannelShared *shared;
+   size_t mappedSize;
+
+   // Validated copy of the header: any peer can rewrite the shared one, it is never read back.
+   uint64_t capacityMask;
+   uint32_t messageSize;
+   uint32_t slotStride;
+   int fd;
+
+   PSigChannelCallback callback;
+   void *callbackArg;
+   pthread_t consumer;
+   sem_t consumerStarted;
+   atomic_bool consumerStop;
+   pid_t consumingPid; // Process running the consumer thread, 0 if none.
+};
+
+static PSignal s_signal;
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static inline ChannelSlot *slot_at(PSigChannel const *const channel, uint64_t const pos)
+{
+   size_t const idx = (size_t)(pos & channel->capacityMask);
+   return (ChannelSlot *)(channel->shared->slots + idx * channel->slotStride);
+}
+
+[[nodiscard]]
+static size_t segment_size(uint32_t const capacity, uint32_t const slotStride)
+{
+   return sizeof(ChannelShared) + (size_t)capacity * slotStride;
+}
+
+/*
+   The header of a segment opened from a descriptor comes from another process: it must describe
+   a ring fitting in the file before anything is indexed with it.
+*/
+[[nodiscard]]
+static bool header_is_valid(ChannelHeader const *const header, size_t const fileSize)
+{
+   uint32_t const capacity = header->capacity;
+   uint32_t const slotStride = header->slotStride;
+   if (header->magic != CHANNEL_MAGIC)
+      return false;
+   if (capacity == 0u || capacity > (1u << 24) || (capacity & (capacity - 1u)) != 0u)
+      return false;
+   if (slotStride % CACHE_LINE != 0u || slotStride < sizeof(ChannelSlot) + header->messageSize)
+      return false;
+   return segment_size(capacity, slotStride) <= fileSize;
+}
+
+static void set_geometry(PSigChannel *const channel, ChannelHeader const *const header)
+{
+   channel->capacityMask = header->capacity - 1u;
+   channel->messageSize = header->messageSize;
+   channel->slotStride = header->slotStride;
+}
+
+[[nodiscard]]
+static bool ring_is_empty(PSigChannel const *const channel)
+{
+   uint64_t const head = atomic_load_explicit(&channel->shared->head, memory_order_relaxed);
+   return atomic_load_explicit(&slot_at(channel, head)->seq, memory_order_acquire) != head + 1u;
+}
+
+static void ring_doorbell(ChannelShared *const shared)
+{
+   int const sig = atomic_load(&shared->consumerSignal);
+   pid_t const pid = atomic_load(&shared->consumerPid);
+   pid_t const tid = atomic_load(&shared->consumerTid);
+   if (tid == 0)
+      return;
+
+   // Queued to the consumer thread itself, even from another process.
+   siginfo_t info = {};
+   info.si_signo = sig;
+   info.si_code = SI_QUEUE;
+   info.si_pid = getpid();
+   info.si_uid = getuid();
+   syscall(SYS_rt_tgsigqueueinfo, pid, tid, sig, &info);
+
+   atomic_fetch_add_explicit(&shared->doorbells, 1u, memory_order_relaxed);
+}
+
+// The doorbell is blocked in consumer threads: only reached by misdirected signals.
+static void doorbell_signal_handler(siginfo_t *const info, void *const context)
+{
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Consumer
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static unsigned drain(PSigChannel *const channel)
+{
+   ChannelShared *const shared = channel->shared;
+   uint64_t head = atomic_load_explicit(&shared->head, memory_order_relaxed);
+
+   unsigned count = 0u;
+   while (true)
+   {
+      ChannelSlot *const slot = slot_at(channel, head);
+      if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1u)
+         break;
+
+      // Handed over straight from the shared memory, the slot is released afterwards. A length
+      // past the slot can only come from a corrupted peer, the message is dropped.
+      uint32_t const length = slot->length;
+      if (length <= channel->messageSize)
+      {
+         channel->callback(slot->data, length, channel->callbackArg);
+      }
+
+      atomic_store_explicit(&slot->seq, head + channel->capacityMask + 1u, memory_order_release);
+      head += 1u;
+      atomic_store_explicit(&shared->head, head, memory_order_relaxed);
+      count += 1u;
+   }
+
+   if (count > 0u)
+   {
+      atomic_fetch_add_explicit(&shared->received, count, memory_order_relaxed);
+      atomic_fetch_add_explicit(&shared->batches, 1u, memory_order_relaxed);
+   }
+   return count;
+}
+
+static void *consumer_main(void *const arg)
+{
+   PSigChannel *const channel = arg;
+   ChannelShared *const shared = channel->shared;
+
+   atomic_store(&shared->consumerSignal, psignal_to_raw_signal(s_signal));
+   atomic_store(&shared->consumerPid, getpid());
+   atomic_store(&shared->consumerTid, gettid());
+   sem_post(&channel->consumerStarted);
+
+   sigset_t set;
+   psignal_mask_to_sigset(psignal_mask_of(s_signal), &set);
+
+   while (true)
+   {
+      (void)drain(channel);
+
+      if (atomic_load(&channel->consumerStop))
+         break;
+
+      // Parked, then checked again: a producer either sees the flag or its message is seen here.
+      atomic_store(&shared->parked, 1u);
+      atomic_thread_fence(memory_order_seq_cst);
+      if (ring_is_empty(channel) && !atomic_load(&channel->consumerStop))
+      {
+         siginfo_t info;
+         while (sigwaitinfo(&set, &info) < 0 && errno == EINTR) {}
+      }
+      atomic_store(&shared->parked, 0u);
+   }
+
+   atomic_store(&shared->consumerTid, 0);
+   atomic_store(&shared->consumerPid, 0);
+   return nullptr;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Mapping
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool map_channel(int const fd, size_t const size, PSigChannel **const out)
+{
+   PSigChannel *const channel = calloc(1, sizeof(*channel));
+   if (channel == nullptr)
+      return false;
+
+   void *const mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (mapping == MAP_FAILED)
+   {
+      free(channel);
+      return false;
+   }
+
+   channel->shared = mapping;
+   channel->mappedSize = size;
+   channel->fd = fd;
+   *out = channel;
+   return true;
+}
+
+
+/*
+   The threads served by the module don't exist in a forked child. The consumer threads belong to
+   the handles, the ones inherited by the child are left to the parent.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_channels_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_channels_init(void)
+{
+   if (psignal_channels_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   if (!psignal_callback_internal_reserve(&doorbell_signal_handler, &s_signal))
+      return false;
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_channels_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_channels_shutdown(void)
+{
+   if (!psignal_channels_is_running())
+      return;
+
+   // Channels consumed by this process must have been closed by now.
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+}
+
+bool psignal_channel_create(PSigChannelConfig const *const config, PSigChannel **const out)
+{
+   if (out == nullptr)
+      return false;
+
+   unsigned const requested = (config != nullptr) ? config->capacity : PSIG_CHANNEL_DEFAULT_CAPACITY;
+   unsigned const messageSize = (config != nullptr) ? config->messageSize : PSIG_CHANNEL_DEFAULT_MESSAGE_SIZE;
+   if (requested == 0u || requested > (1u << 24) || messageSize == 0u || messageSize > (1u << 24))
+      return false;
+
+   uint32_t capacity = 1u;
+   while (capacity < requested)
+   {
+      capacity <<= 1u;
+   }
+
+   size_t const slotSize = sizeof(ChannelSlot) + messageSize;
+   uint32_t const slotStride = (uint32_t)((slotSize + CACHE_LINE - 1u) & ~(CACHE_LINE - 1u));
+   size_t const size = segment_size(capacity, slotStride);
+
+   int const fd = memfd_create("psignal_channel", MFD_CLOEXEC);
+   if (fd < 0)
+      return false;
+
+   if (ftruncate(fd, (off_t)size) != 0 || !map_channel(fd, size, out))
+   {
+      close(fd);
+      return false;
+   }
+
+   ChannelHeader const header = {
+      .magic = CHANNEL_MAGIC,
+      .capacity = capacity,
+      .messageSize = messageSize,
+      .slotStride = slotStride
+   };
+   set_geometry(*out, &header);
+   for (uint64_t pos = 0u; pos < capacity; ++pos)
+   {
+      atomic_init(&slot_at(*out, pos)->seq, pos);
+   }
+
+   ChannelShared *const shared = (*out)->shared;
+   shared->header = (ChannelHeader) { .capacity = capacity, .messageSize = messageSize, .slotStride = slotStride };
+   atomic_thread_fence(memory_order_release);
+   shared->header.magic = CHANNEL_MAGIC;
+   return true;
+}
+
+bool psignal_channel_open(int const fd, PSigChannel **const out)
+{
+   if (out == nullptr)
+      return false;
+
+   int const ownFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+   if (ownFd < 0)
+      return false;
+
+   // The header tells the size of the whole segment.
+   struct stat st;
+   PSigChannel *probe;
+   if (fstat(ownFd, &st) != 0 || st.st_size < (off_t)sizeof(ChannelShared)
+      || !map_channel(ownFd, sizeof(ChannelShared), &probe))
+   {
+      close(ownFd);
+      return false;
+   }
+
+   // Copied once, then only the copy is validated and used.
+   ChannelHeader const copy = probe->shared->header;
+   munmap(probe->shared, probe->mappedSize);
+   free(probe);
+
+   if (!header_is_valid(&copy, (size_t)st.st_size)
+      || !map_channel(ownFd, segment_size(copy.capacity, copy.slotStride), out))
+   {
+      close(ownFd);
+      return false;
+   }
+   set_geometry(*out, &copy);
+   return true;
+}
+
+int psignal_channel_fd(PSigChannel const *const channel)
+{
+   return channel->fd;
+}
+
+void psignal_channel_close(PSigChannel *const channel)
+{
+   if (channel == nullptr)
+      return;
+
+   psignal_channel_stop_consuming(channel);
+   munmap(channel->shared, channel->mappedSize);
+   close(channel->fd);
+   free(channel);
+}
+
+bool psignal_channel_send(PSigChannel *const channel, void const *const message, unsigned const length)
+{
+   ChannelShared *const shared = channel->shared;
+   if (length > channel->messageSize)
+      return false;
+
+   uint64_t pos = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+   ChannelSlot *slot;
+   while (true)
+   {
+      slot = slot_at(channel, pos);
+      uint64_t const seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+      int64_t const diff = (int64_t)(seq - pos);
+      if (diff == 0)
+      {
+         if (atomic_compare_exchange_weak_explicit(&shared->tail, &pos, pos + 1u, memory_order_relaxed, memory_order_relaxed))
+            break;
+      }
+      else if (diff < 0)
+      {
+         atomic_fetch_add_explicit(&shared->full, 1u, memory_order_relaxed);
+         return false;
+      }
+      else
+      {
+         pos = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+      }
+   }
+
+   memcpy(slot->data, message, length);
+   slot->length = length;
+   atomic_store_explicit(&slot->seq, pos + 1u, memory_order_release);
+   atomic_fetch_add_explicit(&shared->sent, 1u, memory_order_relaxed);
+
+   // Pairs with the consumer parking: only the producer clearing the flag rings.
+   atomic_thread_fence(memory_order_seq_cst);
+   uint32_t parked = 1u;
+   if (atomic_load_explicit(&shared->parked, memory_order_relaxed) == 1u
+      && atomic_compare_exchange_strong(&shared->parked, &parked, 0u))
+   {
+      ring_doorbell(shared);
+   }
+   return true;
+}
+
+bool psignal_channel_consume(PSigChannel *const channel, PSigChannelCallback const callback, void *const arg)
+{
+   if (!psignal_channels_is_running() || callback == nullptr || channel->consumingPid == getpid())
+      return false;
+
+   // One consumer per channel, whatever the process.
+   int32_t expected = 0;
+   if (!atomic_compare_exchange_strong(&channel->shared->consumerPid, &expected, getpid()))
+      return false;
+
+   channel->callback = callback;
+   channel->callbackArg = arg;
+   atomic_store(&channel->consumerStop, false);
+
+   if (sem_init(&channel->consumerStarted, 0, 0) != 0)
+   {
+      atomic_store(&channel->shared->consumerPid, 0);
+      return false;
+   }
+
+   // The doorbell is only ever collected synchronously by the consumer thread.
+   PSigMaskScope scope;
+   bool const created = psignal_mask_block(psignal_mask_of(s_signal), &scope)
+      && pthread_create(&channel->consumer, nullptr, &consumer_main, channel) == 0;
+   psignal_mask_restore(&scope);
+
+   if (created)
+   {
+      while (sem_wait(&channel->consumerStarted) != 0 && errno == EINTR) {}
+   }
+   else
+   {
+      atomic_store(&channel->shared->consumerPid, 0);
+   }
+   sem_destroy(&channel->consumerStarted);
+
+   channel->consumingPid = created ? getpid() : 0;
+   return created;
+}
+
+void psignal_channel_stop_consuming(PSigChannel *const channel)
+{
+   // A forked child inherits the handle, not the consumer thread of its parent.
+   if (channel->consumingPid != getpid())
+      return;
+
+   atomic_store(&channel->consumerStop, true);
+   pthread_sigqueue(channel->consumer, psignal_to_raw_signal(s_signal), (union sigval) {});
+   pthread_join(channel->consumer, nullptr);
+   channel->consumingPid = 0;
+}
+
+PSigChannelStats psignal_channel_stats(PSigChannel const *const channel)
+{
+   ChannelShared *const shared = channel->shared;
+   return (PSigChannelStats) {
+      .sent = atomic_load(&shared->sent),
+      .received = atomic_load(&shared->received),
+      .batches = atomic_load(&shared->batches),
+      .doorbells = atomic_load(&shared->doorbells),
+      .full = atomic_load(&shared->full)
+   };
+}
@@ -0,0 +1,487 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_children.h"
+#include "libposix_signals/posix_signal_emission_reasons.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+typedef struct ChildRecord
+{
+   pid_t pid; // 0 for an empty bucket.
+   bool exited;
+   PSigChildCallback callback;
+   void *userData;
+   int code;
+   int status;
+   struct rusage usage;
+   uint64_t keptSeq; // Identifies the exit in the kept ring, for unwatched exits.
+} ChildRecord;
+
+typedef struct KeptExit
+{
+   pid_t pid;
+   uint64_t seq;
+} KeptExit;
+
+/*
+   Open addressing with linear probing. Buckets are twice the capacity, keeping the load factor
+   under 0.5, and removals shift the following records back so that no tombstone is needed.
+*/
+static ChildRecord *s_buckets = nullptr;
+static unsigned s_bucketsMask = 0u;
+static unsigned s_capacity = 0u;
+static unsigned s_tracked = 0u;
+static pthread_mutex_t s_tableMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Unwatched exits in arrival order. Entries of exits watched since then are simply skipped.
+static KeptExit *s_kept = nullptr;
+static unsigned s_keptCapacity = 0u;
+static unsigned s_keptHead = 0u;
+static unsigned s_keptCount = 0u;
+static uint64_t s_keptSeq = 0u;
+
+static pthread_t s_reaper;
+static sem_t s_reaperSem;
+static atomic_bool s_reaperStop = false;
+static atomic_bool s_running = false;
+
+static atomic_ullong s_reapedCount = 0u;
+static atomic_ullong s_dispatchedCount = 0u;
+static atomic_ullong s_droppedCount = 0u;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Hash table (s_tableMutex must be held)
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static inline unsigned bucket_of(pid_t const pid)
+{
+   return ((uint32_t)pid * 2654435761u) & s_bucketsMask;
+}
+
+[[nodiscard]]
+static ChildRecord *table_find(pid_t const pid)
+{
+   for (unsigned idx = bucket_of(pid);; idx = (idx + 1u) & s_bucketsMask)
+   {
+      ChildRecord *const record = &s_buckets[idx];
+      if (record->pid == pid)
+         return record;
+      if (record->pid == 0)
+         return nullptr;
+   }
+}
+
+[[nodiscard]]
+static ChildRecord *table_insert(pid_t const pid)
+{
+   if (s_tracked >= s_capacity)
+      return nullptr;
+
+   unsigned idx = bucket_of(pid);
+   while (s_buckets[idx].pid != 0)
+   {
+      idx = (idx + 1u) & s_bucketsMask;
+   }
+
+   s_tracked += 1u;
+   s_buckets[idx] = (ChildRecord) { .pid = pid };
+   return &s_buckets[idx];
+}
+
+[[nodiscard]]
+static bool allocate_table(unsigned const buckets, unsigned const keptCapacity)
+{
+   s_buckets = calloc(buckets, sizeof(*s_buckets));
+   s_kept = calloc(keptCapacity, sizeof(*s_kept));
+   if (s_buckets == nullptr || s_kept == nullptr)
+   {
+      free(s_buckets);
+      free(s_kept);
+      s_buckets = nullptr;
+      s_kept = nullptr;
+      return false;
+   }
+
+   s_bucketsMask = buckets - 1u;
+   s_tracked = 0u;
+   s_keptCapacity = keptCapacity;
+   s_keptHead = 0u;
+   s_keptCount = 0u;
+   return true;
+}
+
+static void free_table(void)
+{
+   free(s_buckets);
+   free(s_kept);
+   s_buckets = nullptr;
+   s_kept = nullptr;
+   s_bucketsMask = 0u;
+   s_capacity = 0u;
+   s_tracked = 0u;
+   s_keptCapacity = 0u;
+   s_keptCount = 0u;
+}
+
+static void table_remove(ChildRecord *const record)
+{
+   unsigned hole = (unsigned)(record - s_buckets);
+   s_buckets[hole].pid = 0;
+   s_tracked -= 1u;
+
+   for (unsigned idx = (hole + 1u) & s_bucketsMask; s_buckets[idx].pid != 0; idx = (idx + 1u) & s_bucketsMask)
+   {
+      // A record can move back into the hole only if its home bucket isn't between them.
+      unsigned const home = bucket_of(s_buckets[idx].pid);
+      bool const homeInRange = (hole <= idx)
+         ? (home > hole && home <= idx)
+         : (home > hole || home <= idx);
+      if (homeInRange)
+         continue;
+
+      s_buckets[hole] = s_buckets[idx];
+      s_buckets[idx].pid = 0;
+      hole = idx;
+   }
+}
+
+
+static void keep_exit(ChildRecord *const record)
+{
+   assert(s_keptCount < s_keptCapacity);
+
+   s_keptSeq += 1u;
+   record->keptSeq = s_keptSeq;
+
+   unsigned const tail = (s_keptHead + s_keptCount) % s_keptCapacity;
+   s_kept[tail] = (KeptExit) { .pid = record->pid, .seq = s_keptSeq };
+   s_keptCount += 1u;
+}
+
+static void discard_oldest_kept(void)
+{
+   KeptExit const oldest = s_kept[s_keptHead];
+   s_keptHead = (s_keptHead + 1u) % s_keptCapacity;
+   s_keptCount -= 1u;
+
+   ChildRecord *const record = table_find(oldest.pid);
+   if (record != nullptr && record->exited && record->keptSeq == oldest.seq)
+   {
+      table_remove(record);
+      atomic_fetch_add(&s_droppedCount, 1u);
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Reaping
+//------------------------------------------------------------------------------------------------
+
+static void invoke_callback(PSigChildCallback const callback, ChildRecord const *const exit)
+{
+   PSigChildExit const info = (PSigChildExit) {
+      .pid = exit->pid,
+      .code = exit->code,
+      .status = exit->status,
+      .reason = psignal_emission_reason(PSignal_SIGCHLD, exit->code),
+      .usage = &exit->usage,
+      .userData = exit->userData
+   };
+
+   callback(&info);
+   atomic_fetch_add(&s_dispatchedCount, 1u);
+}
+
+static void dispatch_exit(siginfo_t const *const info, struct rusage const *const usage)
+{
+   pthread_mutex_lock(&s_tableMutex);
+
+   ChildRecord *record = table_find(info->si_pid);
+   if (record != nullptr && record->callback != nullptr)
+   {
+      ChildRecord exit = *record;
+      exit.code = info->si_code;
+      exit.status = info->si_status;
+      exit.usage = *usage;
+      table_remove(record);
+      pthread_mutex_unlock(&s_tableMutex);
+
+      invoke_callback(exit.callback, &exit);
+      return;
+   }
+
+   /*
+      Not watched yet: kept aside until it is. A record already there is a reused pid, whose new
+      exit replaces the previous one, but still takes a new place in the ring. Room is made first:
+      discarding may remove or move records, the record is looked up again afterwards.
+   */
+   if (s_keptCount == s_keptCapacity)
+   {
+      discard_oldest_kept();
+      record = table_find(info->si_pid);
+   }
+   if (record == nullptr)
+   {
+      record = table_insert(info->si_pid);
+   }
+
+   if (record != nullptr)
+   {
+      record->exited = true;
+      record->code = info->si_code;
+      record->status = info->si_status;
+      record->usage = *usage;
+      keep_exit(record);
+   }
+   else
+   {
+      atomic_fetch_add(&s_droppedCount, 1u);
+   }
+
+   pthread_mutex_unlock(&s_tableMutex);
+}
+
+[[nodiscard]]
+static unsigned reap_pass(void)
+{
+   unsigned reaped = 0u;
+   while (true)
+   {
+      // The glibc wrapper doesn't expose the resource usage argument of the syscall.
+      siginfo_t info = {};
+      struct rusage usage = {};
+      if (syscall(SYS_waitid, P_ALL, 0, &info, WEXITED | WNOHANG, &usage) != 0)
+         break; // ECHILD: no child left.
+
+      if (info.si_pid == 0)
+         break; // Remaining children are still running.
+
+      reaped += 1u;
+      dispatch_exit(&info, &usage);
+   }
+
+   atomic_fetch_add(&s_reapedCount, reaped);
+   return reaped;
+}
+
+static void sigchld_handler(siginfo_t *const info, void *const context)
+{
+   // Coalesced deliveries don't matter: one wake-up reaps every exited child.
+   sem_post(&s_reaperSem);
+}
+
+static void *reaper_main(void *const arg)
+{
+   while (true)
+   {
+      while (sem_wait(&s_reaperSem) != 0 && errno == EINTR) {}
+
+      if (atomic_load(&s_reaperStop))
+         break;
+
+      (void)reap_pass();
+   }
+   return nullptr;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, where the table lock may have been
+   held by the reaper. The children tracked are the parent's ones.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_children_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGCHLD);
+
+   pthread_mutex_init(&s_tableMutex, nullptr);
+   free_table();
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_children_init(PSigChildrenConfig const *const config)
+{
+   if (psignal_children_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   unsigned const capacity = (config != nullptr) ? config->capacity : PSIG_CHILDREN_DEFAULT_CAPACITY;
+   if (capacity == 0u || capacity > (1u << 30))
+      return false;
+
+   unsigned keptCapacity = (config != nullptr) ? config->keptUnwatched : 0u;
+   if (keptCapacity == 0u)
+   {
+      keptCapacity = (capacity >= 4u) ? capacity / 4u : 1u;
+   }
+   if (keptCapacity > capacity)
+      return false;
+
+   unsigned buckets = 1u;
+   while (buckets < capacity * 2u)
+   {
+      buckets <<= 1u;
+   }
+
+   if (!allocate_table(buckets, keptCapacity))
+      return false;
+
+   s_capacity = capacity;
+
+   if (sem_init(&s_reaperSem, 0, 0) != 0)
+   {
+      free_table();
+      return false;
+   }
+
+   if (!psignal_callback_internal_claim(PSignal_SIGCHLD, &sigchld_handler))
+   {
+      sem_destroy(&s_reaperSem);
+      free_table();
+      return false;
+   }
+
+   atomic_store(&s_reaperStop, false);
+   if (pthread_create(&s_reaper, nullptr, &reaper_main, nullptr) != 0)
+   {
+      psignal_callback_internal_release(PSignal_SIGCHLD);
+      sem_destroy(&s_reaperSem);
+      free_table();
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+
+   // Children may have exited before SIGCHLD was claimed.
+   sem_post(&s_reaperSem);
+   return true;
+}
+
+bool psignal_children_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_children_shutdown(void)
+{
+   if (!psignal_children_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGCHLD);
+
+   atomic_store(&s_reaperStop, true);
+   sem_post(&s_reaperSem);
+   pthread_join(s_reaper, nullptr);
+   sem_destroy(&s_reaperSem);
+
+   pthread_mutex_lock(&s_tableMutex);
+   free_table();
+   pthread_mutex_unlock(&s_tableMutex);
+}
+
+bool psignal_children_watch(pid_t const pid, PSigChildCallback const callback, void *const userData)
+{
+   if (pid <= 0 || callback == nullptr || !psignal_children_is_running())
+      return false;
+
+   pthread_mutex_lock(&s_tableMutex);
+
+   ChildRecord *record = table_find(pid);
+   if (record != nullptr)
+   {
+      if (!record->exited)
+      {
+         // Already watched.
+         pthread_mutex_unlock(&s_tableMutex);
+         return false;
+      }
+
+      ChildRecord exit = *record;
+      exit.userData = userData;
+      table_remove(record);
+      pthread_mutex_unlock(&s_tableMutex);
+
+      invoke_callback(callback, &exit);
+      return true;
+   }
+
+   record = table_insert(pid);
+   if (record != nullptr)
+   {
+      record->callback = callback;
+      record->userData = userData;
+   }
+
+   pthread_mutex_unlock(&s_tableMutex);
+   return record != nullptr;
+}
+
+void psignal_children_unwatch(pid_t const pid)
+{
+   if (!psignal_children_is_running())
+      return;
+
+   pthread_mutex_lock(&s_tableMutex);
+   ChildRecord *const record = table_find(pid);
+   if (record != nullptr && !record->exited)
+   {
+      table_remove(record);
+   }
+   pthread_mutex_unlock(&s_tableMutex);
+}
+
+unsigned psignal_children_reap(void)
+{
+   return psignal_children_is_running() ? reap_pass() : 0u;
+}
+
+PSigChildrenStats psignal_children_stats(void)
+{
+   pthread_mutex_lock(&s_tableMutex);
+   unsigned const tracked = s_tracked;
+   pthread_mutex_unlock(&s_tableMutex);
+
+   return (PSigChildrenStats) {
+      .reaped = atomic_load(&s_reapedCount),
+      .dispatched = atomic_load(&s_dispatchedCount),
+      .dropped = atomic_load(&s_droppedCount),
+      .tracked = tracked
+   };
+}
@@ -1,152 +1,182 @@
 #define _GNU_SOURCE
 
 #include "libposix_signals/posix_signal_emission_reasons.h"
+#include "libmacros/macro_utils.h"
 
 #include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
 
 
 //================================================================================================
 // Private Data
 //================================================================================================
 
-static constexpr ascii UNSPECIFIED_REASON[] = "Unspecified reason";
-
-
-//================================================================================================
-// Private functions
-//================================================================================================
-
-static ascii const *sigill_signal_reason(int const code)
-{
-   switch (code)
-   {
-      case ILL_ILLOPC:   return "Illegal opcode.";
-      case ILL_ILLOPN:   return "Illegal operand.";
-      case ILL_ILLADR:   return "Illegal addressing mode.";
-      case ILL_ILLTRP:   return "Illegal trap.";
-      case ILL_PRVOPC:   return "Privileged opcode.";
-      case ILL_PRVREG:   return "Privileged register.";
-      case ILL_COPROC:   return "Coprocessor error.";
-      case ILL_BADSTK:   return "Internal stack error.";
-      case ILL_BADIADDR: return "Unimplemented instruction address";
-
-      default: return UNSPECIFIED_REASON;
-   }
-}
-
-static ascii const *sigfpe_signal_reason(int const code)
+// Reasons by signal: X(si_code, reason). Kernel codes are small positive values.
+#define CG_SIGILL_REASONS(X)                            \
+   X(ILL_ILLOPC,   "Illegal opcode.")                   \
+   X(ILL_ILLOPN,   "Illegal operand.")                  \
+   X(ILL_ILLADR,   "Illegal addressing mode.")          \
+   X(ILL_ILLTRP,   "Illegal trap.")                     \
+   X(ILL_PRVOPC,   "Privileged opcode.")                \
+   X(ILL_PRVREG,   "Privileged register.")              \
+   X(ILL_COPROC,   "Coprocessor error.")                \
+   X(ILL_BADSTK,   "Internal stack error.")             \
+   X(ILL_BADIADDR, "Unimplemented instruction address")
+
+#define CG_SIGFPE_REASONS(X)                               \
+   X(FPE_INTDIV,   "Integer divide by zero.")              \
+   X(FPE_INTOVF,   "Integer overflow.")                    \
+   X(FPE_FLTDIV,   "Floating-point divide by zero.")       \
+   X(FPE_FLTOVF,   "Floating-point overflow.")             \
+   X(FPE_FLTUND,   "Floating-point underflow.")            \
+   X(FPE_FLTRES,   "Floating-point inexact result.")       \
+   X(FPE_FLTINV,   "Floating-point invalid operation.")    \
+   X(FPE_FLTSUB,   "Subscript out of range.")              \
+   X(FPE_FLTUNK,   "Undiagnosed floating-point exception") \
+   X(FPE_CONDTRAP, "Trap on condition.")
+
+#define CG_SIGSEGV_REASONS(X)                                \
+   X(SEGV_MAPERR,  "Address not mapped to object.")          \
+   X(SEGV_ACCERR,  "Invalid permissions for mapped object.") \
+   X(SEGV_BNDERR,  "Bounds checking failure.")               \
+   X(SEGV_PKUERR,  "Protection key checking failure.")       \
+   X(SEGV_ACCADI,  "ADI not enabled for mapped object.")     \
+   X(SEGV_ADIDERR, "Disrupting MCD Error.")                  \
+   X(SEGV_ADIPERR, "Precise MCD exception.")                 \
+   X(SEGV_MTEAERR, "Asynchronous ARM MTE error.")            \
+   X(SEGV_MTESERR, "Synchronous ARM MTE exception.")         \
+   X(SEGV_CPERR,   "Control protection fault.")
+
+#define CG_SIGBUS_REASONS(X)                                   \
+   X(BUS_ADRALN,    "Invalid address alignement.")             \
+   X(BUS_ADRERR,    "Non-existent physical address.")          \
+   X(BUS_OBJERR,    "Object specific hardware error.")         \
+   X(BUS_MCEERR_AR, "Hardware memory error: action required.") \
+   X(BUS_MCEERR_AO, "Hardware memory error: action optional.")
+
+#define CG_SIGTRAP_REASONS(X)                        \
+   X(TRAP_BRKPT,  "Process breakpoint.")             \
+   X(TRAP_TRACE,  "Process trace trap.")             \
+   X(TRAP_BRANCH, "Process taken branch trap.")      \
+   X(TRAP_HWBKPT, "Hardware breakpoint/watchpoint.") \
+   X(TRAP_UNK,    "Undiagnosed trap.")
+
+#define CG_SIGCHLD_REASONS(X)                       \
+   X(CLD_EXITED,    "Child has exited.")            \
+   X(CLD_KILLED,    "Child was killed.")            \
+   X(CLD_DUMPED,    "Child terminated abnormally.") \
+   X(CLD_TRAPPED,   "Traced child has trapped.")    \
+   X(CLD_STOPPED,   "Child has stopped.")           \
+   X(CLD_CONTINUED, "Stopped child has continued")
+
+#define CG_SIGPOLL_REASONS(X)                    \
+   X(POLL_IN,  "Data input available.")          \
+   X(POLL_OUT, "Output buffers available.")      \
+   X(POLL_MSG, "Input message available.")       \
+   X(POLL_ERR, "I/O error.")                     \
+   X(POLL_PRI, "High priority input available.") \
+   X(POLL_HUP, "Device disconnected.")
+
+#define CG_GENERIC_REASONS(X)                                   \
+   X(SI_ASYNCNL,  "Sent by asynch name lookup completion.")     \
+   X(SI_DETHREAD, "Sent by execve killing subsidiary threads.") \
+   X(SI_TKILL,    "Sent by tkill.")                             \
+   X(SI_SIGIO,    "Sent by queued SIGIO.")                      \
+   X(SI_ASYNCIO,  "Sent by AIO completion.")                    \
+   X(SI_MESGQ,    "Sent by real-time mesq state change.")       \
+   X(SI_TIMER,    "Sent by timer expiration.")                  \
+   X(SI_QUEUE,    "Sent by sigqueue.")                          \
+   X(SI_USER,     "Sent by kill, sigsend.")                     \
+   X(SI_KERNEL,   "Sent by kernel.")
+
+
+/*
+   Every reason is packed in a single blob, referenced by 16 bits offsets: no pointer to relocate
+   at load time in PIE and shared builds. The unspecified reason comes first, at offset 0, so that
+   codes missing from the tables resolve to it.
+*/
+#define CG_REASON_MEMBER(pCode, pReason) char r_##pCode[sizeof(pReason)];
+typedef struct ReasonsStrings
 {
-   switch (code)
-   {
-      case FPE_INTDIV:   return "Integer divide by zero.";
-      case FPE_INTOVF:   return "Integer overflow.";
-      case FPE_FLTDIV:   return "Floating-point divide by zero.";
-      case FPE_FLTOVF:   return "Floating-point overflow.";
-      case FPE_FLTUND:   return "Floating-point underflow.";
-      case FPE_FLTRES:   return "Floating-point inexact result.";
-      case FPE_FLTINV:   return "Floating-point invalid operation.";
-      case FPE_FLTSUB:   return "Subscript out of range.";
-      case FPE_FLTUNK:   return "Undiagnosed floating-point exception";
-      case FPE_CONDTRAP: return "Trap on condition.";
-
-      default: return UNSPECIFIED_REASON;
-   }
-}
-
-static ascii const *sigsegv_signal_reason(int const code)
+   char unspecified[sizeof("Unspecified reason")];
+   CG_SIGILL_REASONS(CG_REASON_MEMBER)
+   CG_SIGFPE_REASONS(CG_REASON_MEMBER)
+   CG_SIGSEGV_REASONS(CG_REASON_MEMBER)
+   CG_SIGBUS_REASONS(CG_REASON_MEMBER)
+   CG_SIGTRAP_REASONS(CG_REASON_MEMBER)
+   CG_SIGCHLD_REASONS(CG_REASON_MEMBER)
+   CG_SIGPOLL_REASONS(CG_REASON_MEMBER)
+   CG_GENERIC_REASONS(CG_REASON_MEMBER)
+} ReasonsStrings;
+#undef CG_REASON_MEMBER
+
+#define CG_REASON_STRING(pCode, pReason) pReason,
+static constexpr ReasonsStrings S_REASONS =
 {
-   switch (code)
-   {
-      case SEGV_MAPERR:  return "Address not mapped to object.";
-      case SEGV_ACCERR:  return "Invalid permissions for mapped object.";
-      case SEGV_BNDERR:  return "Bounds checking failure.";
-      case SEGV_PKUERR:  return "Protection key checking failure.";
-      case SEGV_ACCADI:  return "ADI not enabled for mapped object.";
-      case SEGV_ADIDERR: return "Disrupting MCD Error.";
-      case SEGV_ADIPERR: return "Precise MCD exception.";
-      case SEGV_MTEAERR: return "Asynchronous ARM MTE error.";
-      case SEGV_MTESERR: return "Synchronous ARM MTE exception.";
-      case SEGV_CPERR:   return "Control protection fault.";
-
-      default: return UNSPECIFIED_REASON;
-   }
-}
-
-static ascii const *sigbus_signal_reason(int const code)
+   "Unspecified reason",
+   CG_SIGILL_REASONS(CG_REASON_STRING)
+   CG_SIGFPE_REASONS(CG_REASON_STRING)
+   CG_SIGSEGV_REASONS(CG_REASON_STRING)
+   CG_SIGBUS_REASONS(CG_REASON_STRING)
+   CG_SIGTRAP_REASONS(CG_REASON_STRING)
+   CG_SIGCHLD_REASONS(CG_REASON_STRING)
+   CG_SIGPOLL_REASONS(CG_REASON_STRING)
+   CG_GENERIC_REASONS(CG_REASON_STRING)
+};
+#undef CG_REASON_STRING
+
+static_assert(sizeof(ReasonsStrings) <= UINT16_MAX);
+
+// Indexed by si_code.
+#define CG_REASON_OFFSET(pCode, pReason) [pCode] = offsetof(ReasonsStrings, r_##pCode),
+static constexpr uint16_t S_SIGILL_REASONS[]  = { CG_SIGILL_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGFPE_REASONS[]  = { CG_SIGFPE_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGSEGV_REASONS[] = { CG_SIGSEGV_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGBUS_REASONS[]  = { CG_SIGBUS_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGTRAP_REASONS[] = { CG_SIGTRAP_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGCHLD_REASONS[] = { CG_SIGCHLD_REASONS(CG_REASON_OFFSET) };
+static constexpr uint16_t S_SIGPOLL_REASONS[] = { CG_SIGPOLL_REASONS(CG_REASON_OFFSET) };
+#undef CG_REASON_OFFSET
+
+// Generic codes are negative, except SI_USER (0) and SI_KERNEL (0x80): searched instead.
+typedef struct GenericReason
 {
-   switch (code)
-   {
-      case BUS_ADRALN:    return "Invalid address alignement.";
-      case BUS_ADRERR:    return "Non-existent physical address.";
-      case BUS_OBJERR:    return "Object specific hardware error.";
-      case BUS_MCEERR_AR: return "Hardware memory error: action required.";
-      case BUS_MCEERR_AO: return "Hardware memory error: action optional.";
+   int code;
+   uint16_t reason;
+} GenericReason;
 
-      default: return UNSPECIFIED_REASON;
-   }
-}
+#define CG_GENERIC_REASON(pCode, pReason) (GenericReason) { pCode, offsetof(ReasonsStrings, r_##pCode) },
+static constexpr GenericReason S_GENERIC_REASONS[] = { CG_GENERIC_REASONS(CG_GENERIC_REASON) };
+#undef CG_GENERIC_REASON
 
-static ascii const *sigtrap_signal_reason(int const code)
-{
-   switch (code)
-   {
-      case TRAP_BRKPT:  return "Process breakpoint.";
-      case TRAP_TRACE:  return "Process trace trap.";
-      case TRAP_BRANCH: return "Process taken branch trap.";
-      case TRAP_HWBKPT: return "Hardware breakpoint/watchpoint.";
-      case TRAP_UNK:    return "Undiagnosed trap.";
 
-      default: return UNSPECIFIED_REASON;
-   }
-}
+//================================================================================================
+// Private functions
+//================================================================================================
 
-static ascii const *sigchld_signal_reason(int const code)
+[[nodiscard]] static inline
+ascii const *reason_at(uint16_t const offset)
 {
-   switch (code)
-   {
-      case CLD_EXITED:    return "Child has exited.";
-      case CLD_KILLED:    return "Child was killed.";
-      case CLD_DUMPED:    return "Child terminated abnormally.";
-      case CLD_TRAPPED:   return "Traced child has trapped.";
-      case CLD_STOPPED:   return "Child has stopped.";
-      case CLD_CONTINUED: return "Stopped child has continued";
-
-      default: return UNSPECIFIED_REASON;
-   }
+   return (ascii const *)&S_REASONS + offset;
 }
 
-static ascii const *sigpoll_signal_reason(int const code)
+[[nodiscard]] static
+ascii const *code_reason(uint16_t const *const reasons, unsigned const count, int const code)
 {
-   switch (code)
-   {
-      case POLL_IN:  return "Data input available.";
-      case POLL_OUT: return "Output buffers available.";
-      case POLL_MSG: return "Input message available.";
-      case POLL_ERR: return "I/O error.";
-      case POLL_PRI: return "High priority input available.";
-      case POLL_HUP: return "Device disconnected.";
-
-      default: return UNSPECIFIED_REASON;
-   }
+   return (code >= 0 && (unsigned)code < count) ? reason_at(reasons[code]) : reason_at(0u);
 }
 
-static ascii const *other_signals_reason(int const code)
+[[nodiscard]] static
+ascii const *generic_reason(int const code)
 {
-   switch (code)
+   for (unsigned i = 0; i < array_capacity(S_GENERIC_REASONS); ++i)
    {
-      case SI_ASYNCNL:  return "Sent by asynch name lookup completion.";
-      case SI_DETHREAD: return "Sent by execve killing subsidiary threads.";
-      case SI_TKILL:    return "Sent by tkill.";
-      case SI_SIGIO:    return "Sent by queued SIGIO.";
-      case SI_ASYNCIO:  return "Sent by AIO completion.";
-      case SI_MESGQ:    return "Sent by real-time mesq state change.";
-      case SI_TIMER:    return "Sent by timer expiration.";
-      case SI_QUEUE:    return "Sent by sigqueue.";
-      case SI_USER:     return "Sent by kill, sigsend.";
-      case SI_KERNEL:   return "Sent by kernel.";
-
-      default: return UNSPECIFIED_REASON;
+      if (S_GENERIC_REASONS[i].code == code)
+         return reason_at(S_GENERIC_REASONS[i].reason);
    }
+
+   return reason_at(0u);
 }
 
 
@@ -154,18 +184,22 @@ static ascii const *other_signals_reason(int const code)
 // Public API Functions
 //================================================================================================
 
+#define CODE_REASON(pTable, pCode) code_reason(pTable, array_capacity(pTable), pCode)
+
 ascii const *psignal_emission_reason(PSignal const sig, int const code)
 {
    switch(sig)
    {
-      case PSignal_SIGILL:  return sigill_signal_reason(code);
-      case PSignal_SIGFPE:  return sigfpe_signal_reason(code);
-      case PSignal_SIGSEGV: return sigsegv_signal_reason(code);
-      case PSignal_SIGBUS:  return sigbus_signal_reason(code);
-      case PSignal_SIGTRAP: return sigtrap_signal_reason(code);
-      case PSignal_SIGCHLD: return sigchld_signal_reason(code);
-      case PSignal_SIGPOLL: return sigpoll_signal_reason(code);
-
-      default: return other_signals_reason(code);
+      case PSignal_SIGILL:  return CODE_REASON(S_SIGILL_REASONS, code);
+      case PSignal_SIGFPE:  return CODE_REASON(S_SIGFPE_REASONS, code);
+      case PSignal_SIGSEGV: return CODE_REASON(S_SIGSEGV_REASONS, code);
+      case PSignal_SIGBUS:  return CODE_REASON(S_SIGBUS_REASONS, code);
+      case PSignal_SIGTRAP: return CODE_REASON(S_SIGTRAP_REASONS, code);
+      case PSignal_SIGCHLD: return CODE_REASON(S_SIGCHLD_REASONS, code);
+      case PSignal_SIGPOLL: return CODE_REASON(S_SIGPOLL_REASONS, code);
+
+      default: return generic_reason(code);
    }
 }
+
+#undef CODE_REASON
@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_fpe.h"
+#include "libposix_signals/posix_signal_emission_reasons.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <execinfo.h>
+#include <fenv.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+typedef struct SiteEntry
+{
+   _Atomic(uintptr_t) pc; // 0 for an empty entry.
+   atomic_bool ready;     // Set once the first trap filled the details.
+   atomic_int excepts;
+   _Atomic(uint64_t) count;
+   int code;
+   unsigned frameCount;
+   void *frames[PSIG_FPE_MAX_FRAMES];
+} SiteEntry;
+
+// Open addressing on the faulting PC, entries are only ever claimed with a CAS.
+static SiteEntry s_sites[PSIG_FPE_MAX_SITES] = {};
+static atomic_uint s_sitesCount = 0u;
+static atomic_ullong s_droppedCount = 0u;
+
+typedef struct ThreadFpe
+{
+   int trapped;         // Exceptions whose traps are handled by the library.
+   int steppingExcepts; // Masked for the single-stepped instruction only.
+   PSigFpeAction action;
+} ThreadFpe;
+
+static thread_local ThreadFpe s_thread = {};
+
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static int except_of_code(int const code)
+{
+   switch (code)
+   {
+      case FPE_FLTINV: return FE_INVALID;
+      case FPE_FLTDIV: return FE_DIVBYZERO;
+      case FPE_FLTOVF: return FE_OVERFLOW;
+      case FPE_FLTUND: return FE_UNDERFLOW;
+      case FPE_FLTRES: return FE_INEXACT;
+
+      default: return 0;
+   }
+}
+
+[[nodiscard]]
+static inline unsigned site_index(uintptr_t const pc)
+{
+   return (unsigned)((pc * 0x9E3779B97F4A7C15u) >> 40) & (PSIG_FPE_MAX_SITES - 1u);
+}
+
+static void record_site(uintptr_t const pc, int const code, int const raised)
+{
+   unsigned idx = site_index(pc);
+   for (unsigned probe = 0; probe < PSIG_FPE_MAX_SITES; ++probe, idx = (idx + 1u) & (PSIG_FPE_MAX_SITES - 1u))
+   {
+      SiteEntry *const site = &s_sites[idx];
+
+      uintptr_t current = atomic_load_explicit(&site->pc, memory_order_acquire);
+      if (current == 0u && atomic_compare_exchange_strong(&site->pc, &current, pc))
+      {
+         // First trap at this site: the stack is only captured once.
+         int const count = backtrace(site->frames, (int)PSIG_FPE_MAX_FRAMES);
+         site->frameCount = (count > 0) ? (unsigned)count : 0u;
+         site->code = code;
+         atomic_fetch_or(&site->excepts, raised);
+         atomic_fetch_add(&site->count, 1u);
+         atomic_store_explicit(&site->ready, true, memory_order_release);
+         atomic_fetch_add(&s_sitesCount, 1u);
+         return;
+      }
+
+      if (current == pc)
+      {
+         atomic_fetch_or(&site->excepts, raised);
+         atomic_fetch_add(&site->count, 1u);
+         return;
+      }
+   }
+
+   atomic_fetch_add(&s_droppedCount, 1u);
+}
+
+static void sigfpe_handler(siginfo_t *const info, void *const context)
+{
+   int const raised = (info != nullptr) ? except_of_code(info->si_code) : 0;
+   if ((raised & s_thread.trapped) == 0)
+   {
+      psignal_callback_internal_forward(PSignal_SIGFPE, info);
+      return;
+   }
+
+   record_site(psignal_internal_context_pc(context), info->si_code, raised);
+
+   // Without masking, the instruction would trap again forever.
+   if (!psignal_internal_context_fpe_mask(context, raised))
+   {
+      psignal_callback_internal_forward(PSignal_SIGFPE, info);
+      return;
+   }
+
+   if (s_thread.action == PSigFpeAction_STEP && psignal_internal_context_single_step(context, true))
+   {
+      s_thread.steppingExcepts |= raised;
+   }
+   else
+   {
+      s_thread.trapped &= ~raised;
+   }
+}
+
+static void sigtrap_handler(siginfo_t *const info, void *const context)
+{
+   if (s_thread.steppingExcepts == 0)
+   {
+      psignal_callback_internal_forward(PSignal_SIGTRAP, info);
+      return;
+   }
+
+   // The faulting instruction completed, its exceptions are trapped again.
+   (void)psignal_internal_context_fpe_unmask(context, s_thread.steppingExcepts);
+   (void)psignal_internal_context_single_step(context, false);
+   s_thread.steppingExcepts = 0;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_fpe_init(void)
+{
+   if (psignal_fpe_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   // The first call to backtrace() loads the unwinder, which isn't async-signal-safe.
+   void *warmup[1];
+   backtrace(warmup, 1);
+
+   if (!psignal_callback_internal_claim_forwarding(PSignal_SIGFPE, &sigfpe_handler))
+      return false;
+
+   if (!psignal_callback_internal_claim_forwarding(PSignal_SIGTRAP, &sigtrap_handler))
+   {
+      psignal_callback_internal_release(PSignal_SIGFPE);
+      return false;
+   }
+
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_fpe_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_fpe_shutdown(void)
+{
+   if (!psignal_fpe_is_running())
+      return;
+
+   // Scopes must have ended by now.
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGTRAP);
+   psignal_callback_internal_release(PSignal_SIGFPE);
+}
+
+bool psignal_fpe_scope_begin(int const excepts, PSigFpeAction const action, PSigFpeScope *const scope)
+{
+   if (!psignal_fpe_is_running() || scope == nullptr || excepts == 0 || (excepts & ~FE_ALL_EXCEPT) != 0)
+      return false;
+
+   int const previousEnabled = fegetexcept();
+
+   // Flags raised before the scope must not trap as soon as they are unmasked.
+   feclearexcept(excepts);
+   if (feenableexcept(excepts) == -1)
+      return false;
+
+   *scope = (PSigFpeScope) {
+      .previousEnabled = previousEnabled,
+      .previousTrapped = s_thread.trapped,
+      .excepts = excepts,
+      .previousAction = s_thread.action,
+      .active = true
+   };
+
+   s_thread.trapped |= excepts;
+   s_thread.action = action;
+   return true;
+}
+
+void psignal_fpe_scope_end(PSigFpeScope *const scope)
+{
+   if (scope == nullptr || !scope->active)
+      return;
+
+   s_thread.trapped = scope->previousTrapped;
+   s_thread.action = scope->previousAction;
+
+   fedisableexcept(FE_ALL_EXCEPT);
+   feclearexcept(scope->excepts);
+   if (scope->previousEnabled != 0)
+   {
+      feenableexcept(scope->previousEnabled);
+   }
+
+   scope->active = false;
+}
+
+void psignal_fpe_for_each_site(PSigFpeSiteVisitor const visitor, void *const arg)
+{
+   for (unsigned i = 0; i < PSIG_FPE_MAX_SITES; ++i)
+   {
+      SiteEntry const *const site = &s_sites[i];
+      if (!atomic_load_explicit(&site->ready, memory_order_acquire))
+         continue;
+
+      PSigFpeSite const info = (PSigFpeSite) {
+         .pc = atomic_load(&site->pc),
+         .excepts = atomic_load(&site->excepts),
+         .code = site->code,
+         .reason = psignal_emission_reason(PSignal_SIGFPE, site->code),
+         .count = atomic_load(&site->count),
+         .frames = site->frames,
+         .frameCount = site->frameCount
+      };
+      visitor(&info, arg);
+   }
+}
+
+unsigned psignal_fpe_sites_count(void)
+{
+   return atomic_load(&s_sitesCount);
+}
+
+uint64_t psignal_fpe_dropped_count(void)
+{
+   return atomic_load(&s_droppedCount);
+}
+
+void psignal_fpe_reset_sites(void)
+{
+   memset(s_sites, 0, sizeof(s_sites));
+   atomic_store(&s_sitesCount, 0u);
+   atomic_store(&s_droppedCount, 0u);
+}
@@ -0,0 +1,429 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_governor.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/resource.h>
+#include <time.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+typedef struct GovernedLimit
+{
+   int resource;               // RLIMIT_...
+   PSignal sig;
+   bool governed;
+   unsigned steps;
+   rlim_t initialSoft;
+   rlim_t hard;
+   rlim_t original;            // Soft limit before init.
+   atomic_uint step;           // Raised by the signal handler.
+   unsigned notified;          // Steps the throttles were called for, governor thread only.
+   _Atomic(uint64_t) signalNs;
+} GovernedLimit;
+
+typedef struct Throttle
+{
+   PSigGovernorThrottleFn fn;
+   void *arg;
+} Throttle;
+
+static GovernedLimit s_limits[PSigGovernorResource_ENUM_COUNT] =
+{
+   [PSigGovernorResource_CPU]       = { .resource = RLIMIT_CPU,   .sig = PSignal_SIGXCPU },
+   [PSigGovernorResource_FILE_SIZE] = { .resource = RLIMIT_FSIZE, .sig = PSignal_SIGXFSZ },
+};
+
+static Throttle s_throttles[PSIG_GOVERNOR_MAX_THROTTLES] = {};
+static unsigned s_throttlesCount = 0u;
+static pthread_mutex_t s_throttlesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t s_thread;
+static sem_t s_sem;
+static atomic_bool s_stop = false;
+
+static _Atomic(uint64_t) s_signals[PSigGovernorResource_ENUM_COUNT] = {};
+static _Atomic(uint64_t) s_raises = 0u;
+static _Atomic(uint64_t) s_exhausted = 0u;
+static _Atomic(uint64_t) s_lastReactionNs = 0u;
+static _Atomic(uint64_t) s_maxReactionNs = 0u;
+
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+[[nodiscard]]
+static uint64_t limit_value(rlim_t const limit)
+{
+   return (limit == RLIM_INFINITY) ? UINT64_MAX : (uint64_t)limit;
+}
+
+[[nodiscard]]
+static rlim_t soft_limit_at(GovernedLimit const *const limit, unsigned const step)
+{
+   if (step >= limit->steps)
+      return limit->hard;
+
+   if (limit->hard == RLIM_INFINITY)
+      return limit->initialSoft * (step + 1u);
+
+   // Split so that large byte limits don't overflow.
+   rlim_t const range = limit->hard - limit->initialSoft;
+   return limit->initialSoft + range / limit->steps * step + range % limit->steps * step / limit->steps;
+}
+
+/*
+   Async-signal-safe: setrlimit() is a plain prlimit64 syscall. Handlers raising the limit at the
+   same time all end up applying the highest step.
+*/
+static void apply_soft_limit(GovernedLimit const *const limit)
+{
+   unsigned step;
+   do
+   {
+      step = atomic_load(&limit->step);
+      struct rlimit const rl = { .rlim_cur = soft_limit_at(limit, step), .rlim_max = limit->hard };
+      (void)setrlimit(limit->resource, &rl);
+   } while (atomic_load(&limit->step) != step);
+}
+
+static void limit_exceeded_handler(siginfo_t *const info, void *const context)
+{
+   PSigGovernorResource const resource = (info->si_signo == SIGXCPU)
+      ? PSigGovernorResource_CPU
+      : PSigGovernorResource_FILE_SIZE;
+   GovernedLimit *const limit = &s_limits[resource];
+   atomic_fetch_add(&s_signals[resource], 1u);
+
+   unsigned step = atomic_load(&limit->step);
+   do
+   {
+      if (step >= limit->steps)
+      {
+         atomic_fetch_add(&s_exhausted, 1u);
+         return;
+      }
+   } while (!atomic_compare_exchange_weak(&limit->step, &step, step + 1u));
+
+   atomic_store(&limit->signalNs, now_ns());
+   apply_soft_limit(limit);
+   atomic_fetch_add(&s_raises, 1u);
+   sem_post(&s_sem);
+}
+
+static void call_throttles(PSigGovernorResource const resource, unsigned const step)
+{
+   GovernedLimit const *const limit = &s_limits[resource];
+   PSigGovernorEvent const event = (PSigGovernorEvent) {
+      .resource = resource,
+      .step = step,
+      .steps = limit->steps,
+      .softLimit = limit_value(soft_limit_at(limit, step)),
+      .hardLimit = limit_value(limit->hard),
+      .signalNs = atomic_load(&limit->signalNs),
+   };
+
+   // Copied, a throttle can remove itself.
+   pthread_mutex_lock(&s_throttlesMutex);
+   Throttle throttles[PSIG_GOVERNOR_MAX_THROTTLES];
+   unsigned const count = s_throttlesCount;
+   for (unsigned i = 0; i < count; ++i)
+   {
+      throttles[i] = s_throttles[i];
+   }
+   pthread_mutex_unlock(&s_throttlesMutex);
+
+   uint64_t const reaction = now_ns() - event.signalNs;
+   atomic_store(&s_lastReactionNs, reaction);
+   if (reaction > atomic_load(&s_maxReactionNs))
+   {
+      atomic_store(&s_maxReactionNs, reaction);
+   }
+
+   for (unsigned i = 0; i < count; ++i)
+   {
+      throttles[i].fn(&event, throttles[i].arg);
+   }
+}
+
+static void *governor_main(void *const arg)
+{
+   while (true)
+   {
+      while (sem_wait(&s_sem) != 0 && errno == EINTR) {}
+
+      if (atomic_load(&s_stop))
+         break;
+
+      for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+      {
+         GovernedLimit *const limit = &s_limits[resource];
+         unsigned const raised = atomic_load(&limit->step);
+         while (limit->notified < raised)
+         {
+            limit->notified += 1u;
+            call_throttles(resource, limit->notified);
+         }
+      }
+   }
+
+   return nullptr;
+}
+
+static void release_signals(void)
+{
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      if (s_limits[resource].governed)
+      {
+         psignal_callback_internal_release(s_limits[resource].sig);
+      }
+   }
+}
+
+static void stop_thread(void)
+{
+   atomic_store(&s_stop, true);
+   sem_post(&s_sem);
+   pthread_join(s_thread, nullptr);
+   sem_destroy(&s_sem);
+}
+
+[[nodiscard]]
+static bool prepare_limit(GovernedLimit *const limit, PSigGovernorLimit const *const config)
+{
+   limit->governed = false;
+   if (config->soft == 0u)
+      return true;
+
+   struct rlimit rl;
+   if (getrlimit(limit->resource, &rl) != 0)
+      return false;
+
+   if ((rl.rlim_max != RLIM_INFINITY && config->soft >= rl.rlim_max) || config->soft >= RLIM_INFINITY)
+   {
+      errno = EINVAL;
+      return false;
+   }
+
+   limit->governed = true;
+   limit->steps = (config->steps != 0u) ? config->steps : 1u;
+   limit->initialSoft = (rlim_t)config->soft;
+   limit->hard = rl.rlim_max;
+   limit->original = rl.rlim_cur;
+   limit->notified = 0u;
+   atomic_store(&limit->step, 0u);
+   atomic_store(&limit->signalNs, 0u);
+   return true;
+}
+
+// Raises the soft limits back to their value before init, never under the usage reached.
+static void restore_limits(void)
+{
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      GovernedLimit const *const limit = &s_limits[resource];
+      struct rlimit rl;
+      if (limit->governed && getrlimit(limit->resource, &rl) == 0 && limit->original > rl.rlim_cur)
+      {
+         rl.rlim_cur = limit->original;
+         (void)setrlimit(limit->resource, &rl);
+      }
+   }
+}
+
+/*
+   The thread of the module doesn't exist in a forked child. Nothing would raise the lowered soft
+   limits there: they are restored, before the signals meet their default disposition again.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_governor_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   restore_limits();
+   release_signals();
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_governor_init(PSigGovernorConfig const *const config)
+{
+   if (psignal_governor_is_running())
+      return true;
+
+   if (!psignal_library_is_running() || config == nullptr)
+      return false;
+
+   bool governed = false;
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      if (!prepare_limit(&s_limits[resource], &config->limits[resource]))
+      {
+         for (PSigGovernorResource idx = 0; idx < PSigGovernorResource_ENUM_COUNT; ++idx)
+         {
+            s_limits[idx].governed = false;
+         }
+         return false;
+      }
+      governed |= s_limits[resource].governed;
+   }
+   if (!governed)
+      return false;
+
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      atomic_store(&s_signals[resource], 0u);
+   }
+   atomic_store(&s_raises, 0u);
+   atomic_store(&s_exhausted, 0u);
+   atomic_store(&s_lastReactionNs, 0u);
+   atomic_store(&s_maxReactionNs, 0u);
+   atomic_store(&s_stop, false);
+
+   if (sem_init(&s_sem, 0, 0u) != 0)
+      return false;
+
+   if (pthread_create(&s_thread, nullptr, &governor_main, nullptr) != 0)
+   {
+      sem_destroy(&s_sem);
+      return false;
+   }
+
+   // Claimed before lowering the limits: exceeding them must never reach the default disposition.
+   bool success = true;
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      GovernedLimit *const limit = &s_limits[resource];
+      if (limit->governed && !psignal_callback_internal_claim(limit->sig, &limit_exceeded_handler))
+      {
+         // Only the resources claimed so far are released.
+         for (PSigGovernorResource idx = resource; idx < PSigGovernorResource_ENUM_COUNT; ++idx)
+         {
+            s_limits[idx].governed = false;
+         }
+         success = false;
+         break;
+      }
+   }
+
+   for (PSigGovernorResource resource = 0; success && resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      GovernedLimit const *const limit = &s_limits[resource];
+      struct rlimit const rl = { .rlim_cur = limit->initialSoft, .rlim_max = limit->hard };
+      success = !limit->governed || setrlimit(limit->resource, &rl) == 0;
+   }
+
+   if (!success)
+   {
+      release_signals();
+      stop_thread();
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_governor_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_governor_shutdown(void)
+{
+   if (!psignal_governor_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+
+   // Raised first, the signals would otherwise meet their default disposition.
+   restore_limits();
+   release_signals();
+   stop_thread();
+
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      s_limits[resource].governed = false;
+   }
+
+   pthread_mutex_lock(&s_throttlesMutex);
+   s_throttlesCount = 0u;
+   pthread_mutex_unlock(&s_throttlesMutex);
+}
+
+bool psignal_governor_add_throttle(PSigGovernorThrottleFn const fn, void *const arg)
+{
+   if (fn == nullptr)
+      return false;
+
+   pthread_mutex_lock(&s_throttlesMutex);
+   bool const added = (s_throttlesCount < PSIG_GOVERNOR_MAX_THROTTLES);
+   if (added)
+   {
+      s_throttles[s_throttlesCount++] = (Throttle) { .fn = fn, .arg = arg };
+   }
+   pthread_mutex_unlock(&s_throttlesMutex);
+   return added;
+}
+
+void psignal_governor_remove_throttle(PSigGovernorThrottleFn const fn, void *const arg)
+{
+   pthread_mutex_lock(&s_throttlesMutex);
+   for (unsigned i = 0; i < s_throttlesCount; ++i)
+   {
+      if (s_throttles[i].fn == fn && s_throttles[i].arg == arg)
+      {
+         // Kept in registration order.
+         for (unsigned j = i + 1u; j < s_throttlesCount; ++j)
+         {
+            s_throttles[j - 1u] = s_throttles[j];
+         }
+         s_throttlesCount -= 1u;
+         break;
+      }
+   }
+   pthread_mutex_unlock(&s_throttlesMutex);
+}
+
+void psignal_governor_stats(PSigGovernorStats *const stats)
+{
+   *stats = (PSigGovernorStats) {
+      .raises = atomic_load(&s_raises),
+      .exhausted = atomic_load(&s_exhausted),
+      .lastReactionNs = atomic_load(&s_lastReactionNs),
+      .maxReactionNs = atomic_load(&s_maxReactionNs)
+   };
+   for (PSigGovernorResource resource = 0; resource < PSigGovernorResource_ENUM_COUNT; ++resource)
+   {
+      stats->signals[resource] = atomic_load(&s_signals[resource]);
+   }
+}
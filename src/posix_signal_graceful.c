@@ -0,0 +1,436 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_graceful.h"
+#include "libposix_signals/posix_signal_dispositions.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+typedef struct Phase
+{
+   char const *name;
+   PSigGracefulPhaseFn fn;
+   void *arg;
+   uint64_t deadlineNs;
+} Phase;
+
+/*
+   One execution of a phase, shared by the sequencer and the phase thread. An abandoned phase may
+   outlive the module, so the last one of them frees it.
+*/
+typedef struct PhaseRun
+{
+   Phase phase;
+   atomic_uint refs;
+   atomic_bool done;
+   atomic_bool success;
+   atomic_bool abandoned;
+} PhaseRun;
+
+static constexpr PSignalMask DEFAULT_TRIGGER_MASK =
+     ((PSignalMask)1u << PSignal_SIGTERM) | ((PSignalMask)1u << PSignal_SIGINT);
+
+static Phase s_phases[PSIG_GRACEFUL_MAX_PHASES] = {};
+static unsigned s_phaseCount = 0u;
+static bool s_phasesSealed = false;
+static pthread_mutex_t s_phasesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static PSigGracefulReport s_reports[PSIG_GRACEFUL_MAX_PHASES] = {};
+static unsigned s_reportCount = 0u;
+static bool s_completed = false;
+static pthread_mutex_t s_completedMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_completedCond = PTHREAD_COND_INITIALIZER;
+
+static PSigGracefulConfig s_config = {};
+
+// Never destroyed: abandoned phase threads may still post it after a shutdown.
+static pthread_once_t s_semOnce = PTHREAD_ONCE_INIT;
+static sem_t s_sem;
+
+static pthread_t s_sequencer;
+static atomic_bool s_stop = false;
+static atomic_bool s_requested = false;
+static atomic_uint s_escalations = 0u;
+static atomic_bool s_running = false;
+
+static thread_local PhaseRun *s_selfRun = nullptr;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void init_sem(void)
+{
+   sem_init(&s_sem, 0, 0u);
+}
+
+static void trigger_handler(siginfo_t *const info, void *const context)
+{
+   if (!atomic_exchange(&s_requested, true))
+   {
+      sem_post(&s_sem);
+      return;
+   }
+
+   if (s_config.escalation == PSigGracefulEscalation_EXIT)
+   {
+      _exit(s_config.exitCode);
+   }
+
+   atomic_fetch_add(&s_escalations, 1u);
+   sem_post(&s_sem);
+}
+
+static void release_run(PhaseRun *const run)
+{
+   if (atomic_fetch_sub(&run->refs, 1u) == 1u)
+   {
+      free(run);
+   }
+}
+
+static void *phase_main(void *const arg)
+{
+   PhaseRun *const run = arg;
+   s_selfRun = run;
+
+   bool const success = run->phase.fn(run->phase.arg);
+   atomic_store(&run->success, success);
+   atomic_store(&run->done, true);
+   sem_post(&s_sem);
+
+   s_selfRun = nullptr;
+   release_run(run);
+   return nullptr;
+}
+
+[[nodiscard]]
+static PhaseRun *start_phase(Phase const *const phase)
+{
+   PhaseRun *const run = calloc(1u, sizeof(*run));
+   if (run == nullptr)
+      return nullptr;
+
+   run->phase = *phase;
+   atomic_init(&run->refs, 2u);
+
+   pthread_attr_t attr;
+   pthread_attr_init(&attr);
+   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+   pthread_t thread;
+   bool const started = (pthread_create(&thread, &attr, &phase_main, run) == 0);
+   pthread_attr_destroy(&attr);
+
+   if (!started)
+   {
+      free(run);
+      return nullptr;
+   }
+   return run;
+}
+
+[[nodiscard]]
+static PSigGracefulOutcome await_phase(PhaseRun *const run, uint64_t const startNs, unsigned *const escalationsSeen)
+{
+   struct timespec deadline = {};
+   if (run->phase.deadlineNs != 0u)
+   {
+      uint64_t const deadlineNs = startNs + run->phase.deadlineNs;
+      deadline.tv_sec = (time_t)(deadlineNs / 1000000000u);
+      deadline.tv_nsec = (long)(deadlineNs % 1000000000u);
+   }
+
+   while (true)
+   {
+      if (atomic_load(&run->done))
+         return atomic_load(&run->success) ? PSigGracefulOutcome_COMPLETED : PSigGracefulOutcome_FAILED;
+
+      if (atomic_load(&s_escalations) != *escalationsSeen)
+      {
+         *escalationsSeen += 1u;
+         return PSigGracefulOutcome_ESCALATED;
+      }
+
+      // A phase without deadline could otherwise keep the module shutdown waiting forever.
+      if (atomic_load(&s_stop))
+         return PSigGracefulOutcome_CANCELLED;
+
+      if (run->phase.deadlineNs == 0u)
+      {
+         while (sem_wait(&s_sem) != 0 && errno == EINTR) {}
+      }
+      else if (sem_clockwait(&s_sem, CLOCK_MONOTONIC, &deadline) != 0 && errno == ETIMEDOUT)
+      {
+         // Completion and expiry may race, completion wins.
+         if (atomic_load(&run->done))
+            continue;
+         return PSigGracefulOutcome_TIMED_OUT;
+      }
+   }
+}
+
+static void complete_sequence(unsigned const count)
+{
+   pthread_mutex_lock(&s_completedMutex);
+   s_reportCount = count;
+   s_completed = true;
+   pthread_cond_broadcast(&s_completedCond);
+   pthread_mutex_unlock(&s_completedMutex);
+}
+
+static void run_sequence(void)
+{
+   pthread_mutex_lock(&s_phasesMutex);
+   s_phasesSealed = true;
+   unsigned const count = s_phaseCount;
+   pthread_mutex_unlock(&s_phasesMutex);
+
+   unsigned escalationsSeen = 0u;
+   for (unsigned i = 0; i < count; ++i)
+   {
+      Phase const *const phase = &s_phases[i];
+      PSigGracefulReport *const report = &s_reports[i];
+      *report = (PSigGracefulReport) {
+         .name = phase->name,
+         .outcome = PSigGracefulOutcome_FAILED,
+         .deadlineNs = phase->deadlineNs
+      };
+
+      // Once the module is shut down, the remaining phases never start.
+      if (atomic_load(&s_stop))
+      {
+         report->outcome = PSigGracefulOutcome_PENDING;
+         continue;
+      }
+
+      uint64_t const startNs = now_ns();
+      PhaseRun *const run = start_phase(phase);
+      if (run != nullptr)
+      {
+         report->outcome = await_phase(run, startNs, &escalationsSeen);
+         if (report->outcome == PSigGracefulOutcome_TIMED_OUT
+            || report->outcome == PSigGracefulOutcome_ESCALATED
+            || report->outcome == PSigGracefulOutcome_CANCELLED)
+         {
+            atomic_store(&run->abandoned, true);
+         }
+         release_run(run);
+      }
+      report->durationNs = now_ns() - startNs;
+   }
+
+   if (s_config.onComplete != nullptr)
+   {
+      s_config.onComplete(s_reports, count, s_config.onCompleteArg);
+   }
+
+   // Abandoned phases may still hold locks: nothing runs at exit.
+   if (!s_config.keepRunning && !atomic_load(&s_stop))
+   {
+      _exit(s_config.exitCode);
+   }
+
+   complete_sequence(count);
+}
+
+static void *sequencer_main(void *const arg)
+{
+   while (true)
+   {
+      while (sem_wait(&s_sem) != 0 && errno == EINTR) {}
+
+      if (atomic_load(&s_stop))
+         break;
+
+      if (atomic_load(&s_requested))
+      {
+         run_sequence();
+         break;
+      }
+   }
+
+   return nullptr;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, where the locks may have been held by
+   the sequencer. Abandoned phase threads are lost too, their runs are never freed.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_graceful_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release_mask(s_config.triggerMask);
+
+   pthread_mutex_init(&s_phasesMutex, nullptr);
+   pthread_mutex_init(&s_completedMutex, nullptr);
+   pthread_cond_init(&s_completedCond, nullptr);
+   sem_init(&s_sem, 0, 0);
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_graceful_init(PSigGracefulConfig const *const config)
+{
+   if (psignal_graceful_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   s_config = (config != nullptr) ? *config : (PSigGracefulConfig) {};
+   if (s_config.triggerMask == 0u)
+   {
+      s_config.triggerMask = DEFAULT_TRIGGER_MASK;
+   }
+
+   // Only the signals whose default action terminates the process (SIGKILL can't be caught).
+   PSignalMask const allowed = psignal_disposition_mask(PSigDisposition_TERMINATE)
+      & ~((PSignalMask)1u << PSignal_SIGKILL);
+   if ((s_config.triggerMask & ~allowed) != 0u)
+      return false;
+
+   pthread_once(&s_semOnce, &init_sem);
+   while (sem_trywait(&s_sem) == 0) {}
+
+   pthread_mutex_lock(&s_phasesMutex);
+   s_phaseCount = 0u;
+   s_phasesSealed = false;
+   pthread_mutex_unlock(&s_phasesMutex);
+
+   pthread_mutex_lock(&s_completedMutex);
+   s_reportCount = 0u;
+   s_completed = false;
+   pthread_mutex_unlock(&s_completedMutex);
+
+   atomic_store(&s_stop, false);
+   atomic_store(&s_requested, false);
+   atomic_store(&s_escalations, 0u);
+
+   if (pthread_create(&s_sequencer, nullptr, &sequencer_main, nullptr) != 0)
+      return false;
+
+   if (!psignal_callback_internal_claim_mask(s_config.triggerMask, &trigger_handler))
+   {
+      atomic_store(&s_stop, true);
+      sem_post(&s_sem);
+      pthread_join(s_sequencer, nullptr);
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_graceful_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_graceful_shutdown(void)
+{
+   if (!psignal_graceful_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release_mask(s_config.triggerMask);
+
+   atomic_store(&s_stop, true);
+   sem_post(&s_sem);
+   pthread_join(s_sequencer, nullptr);
+}
+
+bool psignal_graceful_add_phase(char const *const name, PSigGracefulPhaseFn const fn, void *const arg, uint64_t const deadlineNs)
+{
+   if (fn == nullptr || !psignal_graceful_is_running())
+      return false;
+
+   pthread_mutex_lock(&s_phasesMutex);
+
+   bool const added = !s_phasesSealed && s_phaseCount < PSIG_GRACEFUL_MAX_PHASES;
+   if (added)
+   {
+      s_phases[s_phaseCount++] = (Phase) {
+         .name = (name != nullptr) ? name : "",
+         .fn = fn,
+         .arg = arg,
+         .deadlineNs = deadlineNs
+      };
+   }
+
+   pthread_mutex_unlock(&s_phasesMutex);
+   return added;
+}
+
+bool psignal_graceful_request(void)
+{
+   if (!psignal_graceful_is_running())
+      return false;
+
+   if (!atomic_exchange(&s_requested, true))
+   {
+      sem_post(&s_sem);
+   }
+   return true;
+}
+
+bool psignal_graceful_requested(void)
+{
+   return atomic_load(&s_requested);
+}
+
+bool psignal_graceful_phase_abandoned(void)
+{
+   PhaseRun const *const run = s_selfRun;
+   return run != nullptr && atomic_load(&run->abandoned);
+}
+
+unsigned psignal_graceful_wait(PSigGracefulReport *const reports, unsigned const capacity)
+{
+   pthread_mutex_lock(&s_completedMutex);
+   while (!s_completed)
+   {
+      pthread_cond_wait(&s_completedCond, &s_completedMutex);
+   }
+
+   unsigned const count = s_reportCount;
+   for (unsigned i = 0; i < count && i < capacity; ++i)
+   {
+      reports[i] = s_reports[i];
+   }
+   pthread_mutex_unlock(&s_completedMutex);
+   return count;
+}
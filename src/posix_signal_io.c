@@ -0,0 +1,562 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_io.h"
+#include "libposix_signals/posix_signal_emission_reasons.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// Value queued to the dispatcher to wake it up without checking any descriptor.
+static constexpr int WAKE_UP_VALUE = -1;
+
+typedef struct ArmedFd
+{
+   short events;
+   bool armed;
+   void *userData;
+} ArmedFd;
+
+// Indexed by file descriptor.
+static ArmedFd *s_fds = nullptr;
+static unsigned s_fdsHighWater = 0u;
+static pthread_mutex_t s_fdsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Dispatcher thread only.
+static struct pollfd *s_rescanFds = nullptr;
+static PSigIoEvent *s_batch = nullptr;
+static unsigned s_batchCount = 0u;
+
+// Events waiting for psignal_io_poll.
+static PSigIoEvent *s_queue = nullptr;
+static unsigned s_queueHead = 0u;
+static unsigned s_queueCount = 0u;
+static pthread_mutex_t s_queueMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_queueCond;
+
+static PSigIoConfig s_config = {};
+static PSignal s_signal;
+static pthread_t s_dispatcher;
+static pid_t s_dispatcherTid = 0;
+static sem_t s_dispatcherStarted;
+static atomic_bool s_dispatcherStop = false;
+static atomic_bool s_running = false;
+
+static atomic_ullong s_eventsCount = 0u;
+static atomic_ullong s_batchesCount = 0u;
+static atomic_ullong s_rescansCount = 0u;
+static atomic_ullong s_droppedCount = 0u;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static PSignalMask dispatcher_mask(void)
+{
+   return psignal_mask_union(psignal_mask_of(s_signal), psignal_mask_of(PSignal_SIGIO));
+}
+
+// Reached only by signals that weren't routed to the dispatcher, asks it for a rescan.
+static void stray_signal_handler(siginfo_t *const info, void *const context)
+{
+   if (s_dispatcherTid != 0)
+   {
+      pthread_kill(s_dispatcher, SIGIO);
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Dispatching (dispatcher thread)
+//------------------------------------------------------------------------------------------------
+
+static void push_to_queue(PSigIoEvent const *const events, unsigned const count)
+{
+   pthread_mutex_lock(&s_queueMutex);
+
+   unsigned const capacity = s_config.queueCapacity;
+   unsigned const accepted = (count < capacity - s_queueCount) ? count : capacity - s_queueCount;
+   for (unsigned i = 0; i < accepted; ++i)
+   {
+      s_queue[(s_queueHead + s_queueCount + i) % capacity] = events[i];
+   }
+   s_queueCount += accepted;
+
+   pthread_cond_broadcast(&s_queueCond);
+   pthread_mutex_unlock(&s_queueMutex);
+
+   if (accepted < count)
+   {
+      atomic_fetch_add(&s_droppedCount, count - accepted);
+   }
+}
+
+static void flush_batch(void)
+{
+   if (s_batchCount == 0u)
+      return;
+
+   atomic_fetch_add(&s_eventsCount, s_batchCount);
+   atomic_fetch_add(&s_batchesCount, 1u);
+
+   if (s_config.callback != nullptr)
+   {
+      s_config.callback(s_batch, s_batchCount, s_config.callbackArg);
+   }
+   else
+   {
+      push_to_queue(s_batch, s_batchCount);
+   }
+
+   s_batchCount = 0u;
+}
+
+static void emit_event(int const fd, short const revents, int const code)
+{
+   pthread_mutex_lock(&s_fdsMutex);
+   ArmedFd const armed = s_fds[fd];
+   pthread_mutex_unlock(&s_fdsMutex);
+
+   short const filtered = revents & (armed.events | POLLERR | POLLHUP);
+   if (!armed.armed || filtered == 0)
+      return;
+
+   s_batch[s_batchCount] = (PSigIoEvent) {
+      .fd = fd,
+      .revents = filtered,
+      .code = code,
+      .reason = (code != 0) ? psignal_emission_reason(PSignal_SIGPOLL, code) : "Found by a rescan.",
+      .userData = armed.userData
+   };
+
+   s_batchCount += 1u;
+   if (s_batchCount == s_config.batchSize)
+   {
+      flush_batch();
+   }
+}
+
+static void check_fd(int const fd)
+{
+   pthread_mutex_lock(&s_fdsMutex);
+   short const events = s_fds[fd].armed ? s_fds[fd].events : 0;
+   pthread_mutex_unlock(&s_fdsMutex);
+
+   struct pollfd pfd = { .fd = fd, .events = events };
+   if (events != 0 && poll(&pfd, 1, 0) > 0)
+   {
+      emit_event(fd, pfd.revents, 0);
+   }
+}
+
+static void rescan(void)
+{
+   atomic_fetch_add(&s_rescansCount, 1u);
+
+   nfds_t count = 0u;
+   pthread_mutex_lock(&s_fdsMutex);
+   for (unsigned fd = 0; fd < s_fdsHighWater; ++fd)
+   {
+      if (s_fds[fd].armed)
+      {
+         s_rescanFds[count++] = (struct pollfd) { .fd = (int)fd, .events = s_fds[fd].events };
+      }
+   }
+   pthread_mutex_unlock(&s_fdsMutex);
+
+   if (count == 0u || poll(s_rescanFds, count, 0) <= 0)
+      return;
+
+   for (nfds_t i = 0; i < count; ++i)
+   {
+      if (s_rescanFds[i].revents != 0)
+      {
+         emit_event(s_rescanFds[i].fd, s_rescanFds[i].revents, 0);
+      }
+   }
+}
+
+[[nodiscard]]
+static bool handle_siginfo(siginfo_t const *const info)
+{
+   if (info->si_signo == SIGIO)
+      return true; // Queue overflow: events were lost.
+
+   if (info->si_code == SI_QUEUE)
+   {
+      // Only this process queues the signal, anyone with our uid can.
+      int const fd = info->si_value.sival_int;
+      if (info->si_pid == getpid() && fd >= 0 && (unsigned)fd < s_config.maxFds)
+      {
+         check_fd(fd);
+      }
+      return false;
+   }
+
+   if (info->si_code > 0 && info->si_fd >= 0 && (unsigned)info->si_fd < s_config.maxFds)
+   {
+      emit_event(info->si_fd, (short)info->si_band, info->si_code);
+   }
+   return false;
+}
+
+static void *dispatcher_main(void *const arg)
+{
+   s_dispatcherTid = gettid();
+   sem_post(&s_dispatcherStarted);
+
+   // Blocked since the thread creation, they are only collected synchronously.
+   sigset_t set;
+   psignal_mask_to_sigset(dispatcher_mask(), &set);
+   struct timespec const noWait = {};
+
+   while (!atomic_load(&s_dispatcherStop))
+   {
+      siginfo_t info;
+      if (sigwaitinfo(&set, &info) < 0)
+         continue;
+
+      // Gathers everything already queued, up to the end of the batch.
+      bool rescanNeeded = false;
+      do
+      {
+         rescanNeeded |= handle_siginfo(&info);
+      }
+      while (s_batchCount < s_config.batchSize && sigtimedwait(&set, &info, &noWait) > 0);
+
+      if (rescanNeeded)
+      {
+         rescan();
+      }
+      flush_batch();
+   }
+
+   return nullptr;
+}
+
+static void wake_dispatcher(int const value)
+{
+   union sigval const sv = { .sival_int = value };
+   pthread_sigqueue(s_dispatcher, psignal_to_raw_signal(s_signal), sv);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Lifecycle
+//------------------------------------------------------------------------------------------------
+
+static void free_buffers(void)
+{
+   free(s_fds);
+   free(s_rescanFds);
+   free(s_batch);
+   free(s_queue);
+   s_fds = nullptr;
+   s_rescanFds = nullptr;
+   s_batch = nullptr;
+   s_queue = nullptr;
+}
+
+[[nodiscard]]
+static bool allocate_buffers(void)
+{
+   s_fds = calloc(s_config.maxFds, sizeof(*s_fds));
+   s_rescanFds = calloc(s_config.maxFds, sizeof(*s_rescanFds));
+   s_batch = calloc(s_config.batchSize, sizeof(*s_batch));
+   if (s_config.callback == nullptr)
+   {
+      s_queue = calloc(s_config.queueCapacity, sizeof(*s_queue));
+   }
+
+   bool const success = s_fds != nullptr && s_rescanFds != nullptr && s_batch != nullptr
+      && (s_config.callback != nullptr || s_queue != nullptr);
+   if (!success)
+   {
+      free_buffers();
+   }
+   return success;
+}
+
+[[nodiscard]]
+static bool start_dispatcher(void)
+{
+   if (sem_init(&s_dispatcherStarted, 0, 0) != 0)
+      return false;
+
+   // The dispatcher inherits the blocked signals, they never reach it asynchronously.
+   PSigMaskScope scope;
+   bool const created = psignal_mask_block(dispatcher_mask(), &scope)
+      && pthread_create(&s_dispatcher, nullptr, &dispatcher_main, nullptr) == 0;
+   psignal_mask_restore(&scope);
+
+   if (created)
+   {
+      while (sem_wait(&s_dispatcherStarted) != 0 && errno == EINTR) {}
+   }
+   sem_destroy(&s_dispatcherStarted);
+   return created;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, where the locks may have been held by
+   the dispatcher. The armed descriptors are left as they are: their file descriptions are shared
+   with the parent, which still owns their signals.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_io_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGIO);
+   psignal_callback_internal_release(s_signal);
+
+   pthread_mutex_init(&s_fdsMutex, nullptr);
+   pthread_mutex_init(&s_queueMutex, nullptr);
+   s_dispatcherTid = 0;
+   free_buffers();
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_io_init(PSigIoConfig const *const config)
+{
+   if (psignal_io_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   s_config = (config != nullptr) ? *config : (PSigIoConfig) {};
+   if (s_config.maxFds == 0u)
+   {
+      s_config.maxFds = PSIG_IO_DEFAULT_MAX_FDS;
+   }
+   if (s_config.batchSize == 0u)
+   {
+      s_config.batchSize = PSIG_IO_DEFAULT_BATCH_SIZE;
+   }
+   if (s_config.queueCapacity == 0u)
+   {
+      s_config.queueCapacity = PSIG_IO_DEFAULT_QUEUE_CAPACITY;
+   }
+
+   if (!allocate_buffers())
+      return false;
+
+   s_fdsHighWater = 0u;
+   s_batchCount = 0u;
+   s_queueHead = 0u;
+   s_queueCount = 0u;
+   s_dispatcherTid = 0;
+
+   pthread_condattr_t condAttr;
+   pthread_condattr_init(&condAttr);
+   pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+   pthread_cond_init(&s_queueCond, &condAttr);
+   pthread_condattr_destroy(&condAttr);
+
+   if (!psignal_callback_internal_reserve(&stray_signal_handler, &s_signal))
+   {
+      pthread_cond_destroy(&s_queueCond);
+      free_buffers();
+      return false;
+   }
+
+   if (!psignal_callback_internal_claim(PSignal_SIGIO, &stray_signal_handler))
+   {
+      psignal_callback_internal_release(s_signal);
+      pthread_cond_destroy(&s_queueCond);
+      free_buffers();
+      return false;
+   }
+
+   atomic_store(&s_dispatcherStop, false);
+   if (!start_dispatcher())
+   {
+      psignal_callback_internal_release(PSignal_SIGIO);
+      psignal_callback_internal_release(s_signal);
+      pthread_cond_destroy(&s_queueCond);
+      free_buffers();
+      return false;
+   }
+
+   atomic_store(&s_eventsCount, 0u);
+   atomic_store(&s_batchesCount, 0u);
+   atomic_store(&s_rescansCount, 0u);
+   atomic_store(&s_droppedCount, 0u);
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_io_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_io_shutdown(void)
+{
+   if (!psignal_io_is_running())
+      return;
+
+   // Descriptors still armed stop raising signals before the dispatcher goes away.
+   pthread_mutex_lock(&s_fdsMutex);
+   unsigned const highWater = s_fdsHighWater;
+   pthread_mutex_unlock(&s_fdsMutex);
+   for (unsigned fd = 0; fd < highWater; ++fd)
+   {
+      psignal_io_disarm((int)fd);
+   }
+
+   atomic_store(&s_running, false);
+   atomic_store(&s_dispatcherStop, true);
+   wake_dispatcher(WAKE_UP_VALUE);
+   pthread_join(s_dispatcher, nullptr);
+   s_dispatcherTid = 0;
+
+   psignal_callback_internal_release(PSignal_SIGIO);
+   psignal_callback_internal_release(s_signal);
+
+   pthread_mutex_lock(&s_queueMutex);
+   pthread_cond_broadcast(&s_queueCond);
+   pthread_mutex_unlock(&s_queueMutex);
+   pthread_cond_destroy(&s_queueCond);
+
+   free_buffers();
+}
+
+PSignal psignal_io_signal(void)
+{
+   return s_signal;
+}
+
+bool psignal_io_arm(int const fd, short const events, void *const userData)
+{
+   if (!psignal_io_is_running() || fd < 0 || (unsigned)fd >= s_config.maxFds || events == 0)
+      return false;
+
+   struct f_owner_ex const owner = { .type = F_OWNER_TID, .pid = s_dispatcherTid };
+   int const flags = fcntl(fd, F_GETFL);
+   if (flags < 0
+      || fcntl(fd, F_SETOWN_EX, &owner) != 0
+      || fcntl(fd, F_SETSIG, psignal_to_raw_signal(s_signal)) != 0)
+   {
+      return false;
+   }
+
+   pthread_mutex_lock(&s_fdsMutex);
+   s_fds[fd] = (ArmedFd) { .events = events, .armed = true, .userData = userData };
+   if ((unsigned)fd >= s_fdsHighWater)
+   {
+      s_fdsHighWater = (unsigned)fd + 1u;
+   }
+   pthread_mutex_unlock(&s_fdsMutex);
+
+   if ((flags & O_ASYNC) == 0 && fcntl(fd, F_SETFL, flags | O_ASYNC) != 0)
+   {
+      pthread_mutex_lock(&s_fdsMutex);
+      s_fds[fd].armed = false;
+      pthread_mutex_unlock(&s_fdsMutex);
+      return false;
+   }
+
+   // The kernel only signals readiness changes: the dispatcher checks what is already there.
+   wake_dispatcher(fd);
+   return true;
+}
+
+void psignal_io_disarm(int const fd)
+{
+   if (!psignal_io_is_running() || fd < 0 || (unsigned)fd >= s_config.maxFds)
+      return;
+
+   pthread_mutex_lock(&s_fdsMutex);
+   bool const wasArmed = s_fds[fd].armed;
+   s_fds[fd] = (ArmedFd) {};
+   while (s_fdsHighWater > 0u && !s_fds[s_fdsHighWater - 1u].armed)
+   {
+      s_fdsHighWater -= 1u;
+   }
+   pthread_mutex_unlock(&s_fdsMutex);
+
+   int const flags = wasArmed ? fcntl(fd, F_GETFL) : -1;
+   if (flags >= 0)
+   {
+      fcntl(fd, F_SETFL, flags & ~O_ASYNC);
+      fcntl(fd, F_SETSIG, 0);
+   }
+}
+
+unsigned psignal_io_poll(PSigIoEvent *const events, unsigned const maxEvents, int const timeoutMs)
+{
+   if (!psignal_io_is_running() || s_config.callback != nullptr || events == nullptr || maxEvents == 0u)
+      return 0u;
+
+   struct timespec deadline;
+   clock_gettime(CLOCK_MONOTONIC, &deadline);
+   if (timeoutMs > 0)
+   {
+      long const ns = deadline.tv_nsec + (long)(timeoutMs % 1000) * 1000000l;
+      deadline.tv_sec += (time_t)(timeoutMs / 1000) + (time_t)(ns / 1000000000l);
+      deadline.tv_nsec = ns % 1000000000l;
+   }
+
+   pthread_mutex_lock(&s_queueMutex);
+   while (s_queueCount == 0u && timeoutMs != 0 && psignal_io_is_running())
+   {
+      if (timeoutMs < 0)
+      {
+         pthread_cond_wait(&s_queueCond, &s_queueMutex);
+      }
+      else if (pthread_cond_timedwait(&s_queueCond, &s_queueMutex, &deadline) == ETIMEDOUT)
+      {
+         break;
+      }
+   }
+
+   unsigned const count = (s_queueCount < maxEvents) ? s_queueCount : maxEvents;
+   for (unsigned i = 0; i < count; ++i)
+   {
+      events[i] = s_queue[(s_queueHead + i) % s_config.queueCapacity];
+   }
+   s_queueHead = (s_queueHead + count) % s_config.queueCapacity;
+   s_queueCount -= count;
+   pthread_mutex_unlock(&s_queueMutex);
+
+   return count;
+}
+
+PSigIoStats psignal_io_stats(void)
+{
+   return (PSigIoStats) {
+      .events = atomic_load(&s_eventsCount),
+      .batches = atomic_load(&s_batchesCount),
+      .rescans = atomic_load(&s_rescansCount),
+      .dropped = atomic_load(&s_droppedCount)
+   };
+}
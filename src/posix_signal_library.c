@@ -20,13 +20,25 @@ static atomic_char s_libStatus = LibStatus_NOT_INITIALIZED;
 
 
 bool psignal_library_init(void)
+{
+   return psignal_library_init_with_config(nullptr);
+}
+
+bool psignal_library_init_with_config(PSigLibraryConfig const *const config)
 {
    char expected = LibStatus_NOT_INITIALIZED;
    char const desired = LibStatus_INITIALIZING;
 
    if (atomic_compare_exchange_strong(&s_libStatus, &expected, desired))
    {
-      bool const success = psignal_callback_internal_init();
+      PSigLibraryConfig const cfg = (config != nullptr) ? *config : (PSigLibraryConfig) {};
+
+      bool success = psignal_arena_internal_init(cfg.arenaSize, cfg.threadArenaSize);
+      if (success && !psignal_callback_internal_init())
+      {
+         psignal_arena_internal_shutdown();
+         success = false;
+      }
       atomic_store(&s_libStatus, success ? LibStatus_RUNNING : LibStatus_NOT_INITIALIZED);
       return success;
    }
@@ -49,6 +61,7 @@ void psignal_library_shutdown(void)
    if (atomic_compare_exchange_strong(&s_libStatus, &expected, desired))
    {
       psignal_callback_internal_shutdown();
+      psignal_arena_internal_shutdown();
       atomic_store(&s_libStatus, LibStatus_NOT_INITIALIZED);
    }
 }
@@ -0,0 +1,182 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// Raw signals fitting the 64 bits of a glibc sigset_t word pair, bit (n - 1) for signal n.
+static constexpr int MAX_RAW_SIGNAL = 64;
+
+/*
+   Built once: SIGRTMIN is a libc call, and RT signals are offset from it.
+   A raw signal PSignal doesn't cover maps to an empty mask.
+*/
+static int s_rawOfPSignal[PSignal_ENUM_COUNT] = {};
+static PSignalMask s_maskOfRaw[MAX_RAW_SIGNAL + 1] = {};
+static pthread_once_t s_tablesOnce = PTHREAD_ONCE_INIT;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+static void build_tables(void)
+{
+   int const rtFirst = SIGRTMIN;
+
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      int const signal = psignal_is_standard(idx)
+         ? psignal_to_raw_signal(idx)
+         : rtFirst + (int)(idx - PSignal_ENUM_RT_FIRST);
+
+      s_rawOfPSignal[idx] = signal;
+      if (signal > 0 && signal <= MAX_RAW_SIGNAL)
+      {
+         s_maskOfRaw[signal] = psignal_mask_of(idx);
+      }
+   }
+}
+
+static bool change_mask(int const how, PSignalMask const mask, PSigMaskScope *const scope)
+{
+   // Restoring a scope that failed is a no-op.
+   *scope = (PSigMaskScope) {};
+
+   sigset_t set, previous;
+   psignal_mask_to_sigset(mask, &set);
+   if (pthread_sigmask(how, &set, &previous) != 0)
+      return false;
+
+   PSignalMask const wasBlocked = psignal_mask_from_sigset(&previous);
+   bool const blocked = (how == SIG_BLOCK);
+   *scope = (PSigMaskScope) {
+      .changed = blocked ? psignal_mask_diff(mask, wasBlocked) : psignal_mask_intersect(mask, wasBlocked),
+      .blocked = blocked,
+      .active = true,
+   };
+   return true;
+}
+
+
+//================================================================================================
+// Internal API Functions
+//================================================================================================
+
+PSignalMask psignal_mask_internal_from_raw_bits(uint64_t bits)
+{
+   pthread_once(&s_tablesOnce, &build_tables);
+
+   PSignalMask mask = 0u;
+   while (bits != 0u)
+   {
+      mask |= s_maskOfRaw[__builtin_ctzll(bits) + 1];
+      bits &= bits - 1u;
+   }
+   return mask;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Algebra
+//------------------------------------------------------------------------------------------------
+
+extern inline PSignalMask psignal_mask_of(PSignal);
+extern inline PSignalMask psignal_mask_union(PSignalMask, PSignalMask);
+extern inline PSignalMask psignal_mask_intersect(PSignalMask, PSignalMask);
+extern inline PSignalMask psignal_mask_diff(PSignalMask, PSignalMask);
+extern inline bool psignal_mask_has(PSignalMask, PSignal);
+extern inline unsigned psignal_mask_count(PSignalMask);
+extern inline bool psignal_mask_next(PSignalMask *, PSignal *);
+
+
+//------------------------------------------------------------------------------------------------
+// sigset_t bridging
+//------------------------------------------------------------------------------------------------
+
+void psignal_mask_to_sigset(PSignalMask const mask, sigset_t *const set)
+{
+   pthread_once(&s_tablesOnce, &build_tables);
+   sigemptyset(set);
+
+   PSignal psig;
+   for (PSignalMask it = mask; psignal_mask_next(&it, &psig);)
+   {
+      sigaddset(set, s_rawOfPSignal[psig]);
+   }
+}
+
+PSignalMask psignal_mask_from_sigset(sigset_t const *const set)
+{
+#ifdef __GLIBC__
+   // Signal n is bit (n - 1) of the glibc words: only the set bits are visited.
+   uint64_t bits = set->__val[0];
+#if ULONG_MAX == UINT32_MAX
+   bits |= (uint64_t)set->__val[1] << 32;
+#endif
+   return psignal_mask_internal_from_raw_bits(bits);
+#else
+   pthread_once(&s_tablesOnce, &build_tables);
+
+   PSignalMask mask = 0u;
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (sigismember(set, s_rawOfPSignal[idx]) == 1)
+      {
+         mask |= psignal_mask_of(idx);
+      }
+   }
+   return mask;
+#endif
+}
+
+PSignalMask psignal_mask_blocked(void)
+{
+   sigset_t set;
+   pthread_sigmask(SIG_BLOCK, nullptr, &set);
+   return psignal_mask_from_sigset(&set);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Scoped blocking
+//------------------------------------------------------------------------------------------------
+
+bool psignal_mask_block(PSignalMask const mask, PSigMaskScope *const scope)
+{
+   return change_mask(SIG_BLOCK, mask, scope);
+}
+
+bool psignal_mask_unblock(PSignalMask const mask, PSigMaskScope *const scope)
+{
+   return change_mask(SIG_UNBLOCK, mask, scope);
+}
+
+void psignal_mask_restore(PSigMaskScope *const scope)
+{
+   if (!scope->active)
+      return;
+
+   scope->active = false;
+   if (scope->changed == 0u)
+      return;
+
+   sigset_t set;
+   psignal_mask_to_sigset(scope->changed, &set);
+   pthread_sigmask(scope->blocked ? SIG_UNBLOCK : SIG_BLOCK, &set, nullptr);
+}
@@ -0,0 +1,287 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_pid1.h"
+#include "libposix_signals/posix_signal_callbacks.h"
+#include "libposix_signals/posix_signal_children.h"
+#include "libposix_signals/posix_signal_dispositions.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// Terminate signals generated by the kernel for the process itself, not for the container.
+static constexpr PSignalMask SELF_GENERATED_MASK =
+     ((PSignalMask)1u << PSignal_SIGPIPE)   | ((PSignalMask)1u << PSignal_SIGALRM)
+   | ((PSignalMask)1u << PSignal_SIGVTALRM) | ((PSignalMask)1u << PSignal_SIGPROF)
+   | ((PSignalMask)1u << PSignal_SIGIO);
+
+static PSignalMask s_forwardMask = 0u;
+static uint64_t s_gracePeriodNs = 0u;
+static pid_t s_selfPid = 0;
+static atomic_int s_processGroup = 0;
+
+static bool s_ownsChildren = false;
+static bool s_madeSubreaper = false;
+
+static pthread_t s_escalation;
+static sem_t s_escalationSem;
+static atomic_bool s_escalationStop = false;
+static atomic_bool s_shutdownRequested = false;
+static atomic_bool s_escalated = false;
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static inline bool is_shutdown_signal(int const rawSignal)
+{
+   return rawSignal == SIGTERM || rawSignal == SIGINT;
+}
+
+static void forward_signal_handler(siginfo_t *const info, void *const context)
+{
+   if (info == nullptr)
+      return;
+
+   // Sent by the process to itself.
+   if (info->si_code <= 0 && info->si_pid == s_selfPid)
+      return;
+
+   // A single kill() reaches the whole group, however many processes are in it.
+   pid_t const group = atomic_load(&s_processGroup);
+   if (group > 0)
+   {
+      kill(-group, info->si_signo);
+   }
+
+   if (is_shutdown_signal(info->si_signo))
+   {
+      atomic_store(&s_shutdownRequested, true);
+      sem_post(&s_escalationSem);
+   }
+}
+
+static void escalate(void)
+{
+   pid_t const group = atomic_load(&s_processGroup);
+
+   // Nothing left to kill once the whole group exited.
+   if (group > 0 && kill(-group, 0) == 0)
+   {
+      kill(-group, SIGKILL);
+      atomic_store(&s_escalated, true);
+   }
+}
+
+static void *escalation_main(void *const arg)
+{
+   bool armed = false;
+   struct timespec deadline = {};
+
+   while (true)
+   {
+      if (armed)
+      {
+         if (sem_clockwait(&s_escalationSem, CLOCK_MONOTONIC, &deadline) != 0 && errno == ETIMEDOUT)
+         {
+            escalate();
+            armed = false;
+         }
+      }
+      else
+      {
+         while (sem_wait(&s_escalationSem) != 0 && errno == EINTR) {}
+      }
+
+      if (atomic_load(&s_escalationStop))
+         break;
+
+      // The grace period starts with the first shutdown request.
+      if (!armed && atomic_load(&s_shutdownRequested) && !atomic_load(&s_escalated))
+      {
+         clock_gettime(CLOCK_MONOTONIC, &deadline);
+         uint64_t const ns = (uint64_t)deadline.tv_nsec + s_gracePeriodNs;
+         deadline.tv_sec += (time_t)(ns / 1000000000u);
+         deadline.tv_nsec = (long)(ns % 1000000000u);
+         armed = true;
+      }
+   }
+
+   return nullptr;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child. Neither does the subreaper attribute,
+   and the children module forgets itself there.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_pid1_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release_mask(s_forwardMask);
+
+   s_madeSubreaper = false;
+   s_ownsChildren = false;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_pid1_init(PSigPid1Config const *const config)
+{
+   if (psignal_pid1_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   PSigPid1Config const cfg = (config != nullptr) ? *config : (PSigPid1Config) {};
+
+   s_forwardMask = cfg.forwardMask;
+   if (s_forwardMask == 0u)
+   {
+      s_forwardMask = psignal_disposition_mask(PSigDisposition_TERMINATE) & ~SELF_GENERATED_MASK;
+   }
+   s_forwardMask &= ~((PSignalMask)1u << PSignal_SIGKILL);
+   s_forwardMask &= ~((PSignalMask)1u << PSignal_SIGSTOP);
+
+   s_gracePeriodNs = (cfg.gracePeriodNs != 0u) ? cfg.gracePeriodNs : PSIG_PID1_DEFAULT_GRACE_PERIOD_NS;
+   s_selfPid = getpid();
+
+   atomic_store(&s_processGroup, 0);
+   if (cfg.processGroup != 0 && !psignal_pid1_set_process_group(cfg.processGroup))
+      return false;
+
+   s_ownsChildren = !psignal_children_is_running();
+   if (s_ownsChildren && !psignal_children_init(nullptr))
+      return false;
+
+   // Outside of PID 1, orphans are only reparented to a subreaper.
+   s_madeSubreaper = (s_selfPid != 1 && prctl(PR_SET_CHILD_SUBREAPER, 1) == 0);
+
+   atomic_store(&s_escalationStop, false);
+   atomic_store(&s_shutdownRequested, false);
+   atomic_store(&s_escalated, false);
+
+   bool success = (sem_init(&s_escalationSem, 0, 0) == 0);
+   if (success && pthread_create(&s_escalation, nullptr, &escalation_main, nullptr) != 0)
+   {
+      sem_destroy(&s_escalationSem);
+      success = false;
+   }
+
+   if (success && !psignal_callback_internal_claim_mask(s_forwardMask, &forward_signal_handler))
+   {
+      atomic_store(&s_escalationStop, true);
+      sem_post(&s_escalationSem);
+      pthread_join(s_escalation, nullptr);
+      sem_destroy(&s_escalationSem);
+      success = false;
+   }
+
+   if (!success)
+   {
+      if (s_madeSubreaper)
+      {
+         prctl(PR_SET_CHILD_SUBREAPER, 0);
+      }
+      if (s_ownsChildren)
+      {
+         psignal_children_shutdown();
+      }
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_pid1_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_pid1_shutdown(void)
+{
+   if (!psignal_pid1_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release_mask(s_forwardMask);
+
+   atomic_store(&s_escalationStop, true);
+   sem_post(&s_escalationSem);
+   pthread_join(s_escalation, nullptr);
+   sem_destroy(&s_escalationSem);
+
+   if (s_madeSubreaper)
+   {
+      prctl(PR_SET_CHILD_SUBREAPER, 0);
+   }
+   if (s_ownsChildren)
+   {
+      psignal_children_shutdown();
+   }
+}
+
+bool psignal_pid1_set_process_group(pid_t const group)
+{
+   // Forwarding to our own group would send the signals back to us.
+   if (group <= 0 || group == getpgrp())
+      return false;
+
+   atomic_store(&s_processGroup, group);
+   return true;
+}
+
+pid_t psignal_pid1_process_group(void)
+{
+   return atomic_load(&s_processGroup);
+}
+
+bool psignal_pid1_terminate(void)
+{
+   if (!psignal_pid1_is_running())
+      return false;
+
+   pid_t const group = atomic_load(&s_processGroup);
+   bool const forwarded = (group > 0 && kill(-group, SIGTERM) == 0);
+
+   atomic_store(&s_shutdownRequested, true);
+   sem_post(&s_escalationSem);
+   return forwarded;
+}
+
+bool psignal_pid1_shutdown_requested(void)
+{
+   return atomic_load(&s_shutdownRequested);
+}
+
+bool psignal_pid1_escalated(void)
+{
+   return atomic_load(&s_escalated);
+}
@@ -0,0 +1,280 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_preemption.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+// Older glibc versions don't expose the thread id field of sigevent under its documented name.
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+/*
+   The CPU timer ticks every slice / TICKS_PER_SLICE. A task seen running on TICKS_PER_SLICE + 1
+   consecutive ticks has consumed between 1 and 1 + 1/TICKS_PER_SLICE slice of CPU time.
+*/
+static constexpr unsigned TICKS_PER_SLICE = 2u;
+
+typedef struct SafeRange
+{
+   uintptr_t start;
+   uintptr_t end;
+} SafeRange;
+
+// Only accessed by its own thread, from normal and handler context.
+typedef struct WorkerState
+{
+   timer_t timer;
+   PSigPreemptHook hook;
+   void *userData;
+   uint64_t preemptions;
+
+   volatile uint64_t taskSeq;
+   volatile bool taskActive;
+   volatile sig_atomic_t yieldRequested;
+
+   uint64_t seenSeq;
+   unsigned seenTicks;
+   bool registered;
+} WorkerState;
+
+static thread_local WorkerState s_worker = {};
+
+static SafeRange s_safeRanges[PSIG_PREEMPTION_MAX_SAFE_RANGES] = {};
+static atomic_uint s_safeRangesCount = 0u;
+
+static PSignal s_signal;
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static bool is_safe_point(uintptr_t const pc)
+{
+   unsigned const count = atomic_load_explicit(&s_safeRangesCount, memory_order_acquire);
+   for (unsigned i = 0; i < count; ++i)
+   {
+      if (pc >= s_safeRanges[i].start && pc < s_safeRanges[i].end)
+         return true;
+   }
+   return false;
+}
+
+static void preemption_signal_handler(siginfo_t *const info, void *const context)
+{
+   WorkerState *const worker = &s_worker;
+   if (!worker->registered || !worker->taskActive)
+   {
+      worker->seenTicks = 0u;
+      return;
+   }
+
+   uint64_t const seq = worker->taskSeq;
+   if (seq != worker->seenSeq || worker->seenTicks == 0u)
+   {
+      worker->seenSeq = seq;
+      worker->seenTicks = 1u;
+      return;
+   }
+
+   worker->seenTicks += 1u;
+   if (worker->seenTicks <= TICKS_PER_SLICE)
+      return;
+
+   // Time slice exceeded.
+   worker->seenTicks = 0u;
+   worker->preemptions += 1u;
+
+   uintptr_t const pc = psignal_internal_context_pc(context);
+   if (worker->hook != nullptr && pc != 0u && is_safe_point(pc))
+   {
+      PSigPreemptInfo const preemptInfo = (PSigPreemptInfo) {
+         .ucontext = context,
+         .pc = pc,
+         .userData = worker->userData,
+         .taskId = seq
+      };
+      if (worker->hook(&preemptInfo))
+         return;
+   }
+
+   worker->yieldRequested = 1;
+}
+
+
+/*
+   The threads served by the module don't exist in a forked child, nor do the CPU timers of the
+   workers: the forking thread is no worker anymore.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_preemption_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+
+   s_worker = (WorkerState) {};
+   atomic_store(&s_safeRangesCount, 0u);
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_preemption_init(void)
+{
+   if (psignal_preemption_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   if (!psignal_callback_internal_reserve(&preemption_signal_handler, &s_signal))
+      return false;
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_preemption_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_preemption_shutdown(void)
+{
+   if (!psignal_preemption_is_running())
+      return;
+
+   // Workers timers are owned by their threads, which must have unregistered by now.
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+   atomic_store(&s_safeRangesCount, 0u);
+}
+
+PSignal psignal_preemption_signal(void)
+{
+   return s_signal;
+}
+
+bool psignal_preemption_add_safe_range(void const *const start, void const *const end)
+{
+   if ((uintptr_t)start >= (uintptr_t)end)
+      return false;
+
+   unsigned const idx = atomic_load(&s_safeRangesCount);
+   if (idx >= PSIG_PREEMPTION_MAX_SAFE_RANGES)
+      return false;
+
+   s_safeRanges[idx] = (SafeRange) { .start = (uintptr_t)start, .end = (uintptr_t)end };
+   atomic_store_explicit(&s_safeRangesCount, idx + 1u, memory_order_release);
+   return true;
+}
+
+bool psignal_preemption_redirect(PSigPreemptInfo const *const info, void (*const entry)(void *), void *const arg,
+   void *const stackTop)
+{
+   return psignal_internal_context_redirect(info->ucontext, entry, arg, stackTop);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Workers
+//------------------------------------------------------------------------------------------------
+
+bool psignal_preemption_register_worker(uint64_t const sliceNs, PSigPreemptHook const hook, void *const userData)
+{
+   if (!psignal_preemption_is_running() || s_worker.registered || sliceNs < TICKS_PER_SLICE)
+      return false;
+
+   struct sigevent sev = {};
+   sev.sigev_notify = SIGEV_THREAD_ID;
+   sev.sigev_signo = psignal_to_raw_signal(s_signal);
+   sev.sigev_notify_thread_id = gettid();
+
+   timer_t timer;
+   if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timer) != 0)
+      return false;
+
+   uint64_t const tickNs = sliceNs / TICKS_PER_SLICE;
+   struct timespec const period = {
+      .tv_sec = (time_t)(tickNs / 1000000000u),
+      .tv_nsec = (long)(tickNs % 1000000000u)
+   };
+
+   s_worker = (WorkerState) {
+      .timer = timer,
+      .hook = hook,
+      .userData = userData
+   };
+   atomic_signal_fence(memory_order_seq_cst);
+   s_worker.registered = true;
+
+   struct itimerspec const spec = { .it_value = period, .it_interval = period };
+   if (timer_settime(timer, 0, &spec, nullptr) != 0)
+   {
+      s_worker.registered = false;
+      timer_delete(timer);
+      return false;
+   }
+
+   return true;
+}
+
+void psignal_preemption_unregister_worker(void)
+{
+   if (!s_worker.registered)
+      return;
+
+   s_worker.registered = false;
+   atomic_signal_fence(memory_order_seq_cst);
+   timer_delete(s_worker.timer);
+   s_worker = (WorkerState) {};
+}
+
+uint64_t psignal_preemption_task_begin(void)
+{
+   s_worker.yieldRequested = 0;
+   s_worker.taskSeq += 1u;
+   s_worker.taskActive = true;
+   return s_worker.taskSeq;
+}
+
+void psignal_preemption_task_end(void)
+{
+   s_worker.taskActive = false;
+}
+
+bool psignal_preemption_yield_requested(void)
+{
+   return s_worker.yieldRequested != 0;
+}
+
+void psignal_preemption_clear_yield(void)
+{
+   s_worker.yieldRequested = 0;
+}
+
+uint64_t psignal_preemption_count(void)
+{
+   return s_worker.preemptions;
+}
@@ -0,0 +1,404 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_proc.h"
+#include "libposix_signals/posix_signals.h"
+#include "libmacros/macro_utils.h"
+
+#include "../src/internal.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// Large enough for the signal lines, which come before the long CPU and memory lists.
+static constexpr size_t STATUS_CAPACITY = 8192u;
+static constexpr size_t DIRENTS_BATCH = 4096u;
+static constexpr unsigned MAX_WORKERS = 64u;
+
+typedef struct MaskLine
+{
+   char key[8];
+   size_t offset;
+} MaskLine;
+
+static constexpr MaskLine S_MASK_LINES[] =
+{
+   { "SigPnd:", offsetof(PSigProcState, pending) },
+   { "ShdPnd:", offsetof(PSigProcState, sharedPending) },
+   { "SigBlk:", offsetof(PSigProcState, blocked) },
+   { "SigIgn:", offsetof(PSigProcState, ignored) },
+   { "SigCgt:", offsetof(PSigProcState, caught) },
+};
+static constexpr size_t MASK_KEY_LENGTH = 7u;
+static constexpr unsigned ALL_MASK_LINES = (1u << array_capacity(S_MASK_LINES)) - 1u;
+
+typedef struct ScanShared
+{
+   int rootFd;
+   bool threads;
+   PSigProcVisitor visitor;
+   void *arg;
+   pthread_mutex_t direntsMutex;
+} ScanShared;
+
+/*
+   Buffers of a worker, reused for every pid it reads.
+*/
+typedef struct ScanWorker
+{
+   ScanShared *shared;
+   alignas(struct dirent64) char pids[DIRENTS_BATCH];
+   alignas(struct dirent64) char tids[DIRENTS_BATCH];
+   char status[STATUS_CAPACITY];
+} ScanWorker;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Parsing
+//------------------------------------------------------------------------------------------------
+
+static char const *skip_blanks(char const *it, char const *const end)
+{
+   while (it < end && (*it == ' ' || *it == '\t'))
+   {
+      ++it;
+   }
+   return it;
+}
+
+[[nodiscard]]
+static bool parse_decimal(char const **const cursor, char const *const end, uint32_t *const out)
+{
+   char const *it = *cursor;
+   uint64_t value = 0u;
+   while (it < end && (unsigned)(*it - '0') < 10u && value <= UINT32_MAX)
+   {
+      value = value * 10u + (unsigned)(*it - '0');
+      ++it;
+   }
+   if (it == *cursor || value > UINT32_MAX)
+      return false;
+
+   *out = (uint32_t)value;
+   *cursor = it;
+   return true;
+}
+
+/*
+   The kernel prints a 64 signals set as 16 hex digits, signal n being bit (n - 1).
+*/
+[[nodiscard]]
+static bool parse_hex_mask(char const **const cursor, char const *const end, PSignalMask *const out)
+{
+   char const *it = *cursor;
+   uint64_t bits = 0u;
+   unsigned digits = 0u;
+   for (; it < end && digits < 16u; ++it, ++digits)
+   {
+      unsigned const c = (unsigned char)*it;
+      unsigned digit;
+      if (c - '0' < 10u)
+      {
+         digit = c - '0';
+      }
+      else if ((c | 0x20u) - 'a' < 6u)
+      {
+         digit = (c | 0x20u) - 'a' + 10u;
+      }
+      else
+      {
+         break;
+      }
+      bits = (bits << 4) | digit;
+   }
+   if (digits == 0u)
+      return false;
+
+   *out = psignal_mask_internal_from_raw_bits(bits);
+   *cursor = it;
+   return true;
+}
+
+static char const *next_line(char const *const it, char const *const end)
+{
+   char const *const eol = memchr(it, '\n', (size_t)(end - it));
+   return (eol != nullptr) ? eol + 1 : end;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Reading
+//------------------------------------------------------------------------------------------------
+
+/*
+   Writes "<value><suffix>" into out, which must hold 11 bytes more than the suffix.
+*/
+static void format_path(char *const out, pid_t const value, char const *const suffix)
+{
+   char digits[16];
+   unsigned count = 0u;
+   unsigned remaining = (unsigned)value;
+   do
+   {
+      digits[count++] = (char)('0' + remaining % 10u);
+      remaining /= 10u;
+   } while (remaining != 0u);
+
+   char *it = out;
+   while (count > 0u)
+   {
+      *it++ = digits[--count];
+   }
+   strcpy(it, suffix);
+}
+
+[[nodiscard]]
+static bool parse_pid(char const *name, pid_t *const out)
+{
+   uint32_t value;
+   if (!parse_decimal(&name, name + strnlen(name, 16u), &value) || *name != '\0' || value == 0u
+      || value > INT32_MAX)
+      return false;
+
+   *out = (pid_t)value;
+   return true;
+}
+
+[[nodiscard]]
+static bool read_status(int const dirFd, char const *const path, char *const buffer, PSigProcState *const state)
+{
+   int const fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+      return false;
+
+   size_t size = 0u;
+   while (size < STATUS_CAPACITY)
+   {
+      ssize_t const count = read(fd, buffer + size, STATUS_CAPACITY - size);
+      if (count <= 0)
+         break;
+
+      size += (size_t)count;
+   }
+   close(fd);
+
+   return psignal_proc_parse_status(buffer, size, state);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Scan
+//------------------------------------------------------------------------------------------------
+
+static void visit_threads(ScanWorker *const worker, int const taskFd, pid_t const pid)
+{
+   ScanShared const *const shared = worker->shared;
+
+   ssize_t size;
+   while ((size = getdents64(taskFd, worker->tids, sizeof(worker->tids))) > 0)
+   {
+      for (ssize_t offset = 0; offset < size;)
+      {
+         struct dirent64 const *const entry = (struct dirent64 const *)(worker->tids + offset);
+         offset += entry->d_reclen;
+
+         char path[32];
+         PSigProcState state;
+         if (!parse_pid(entry->d_name, &state.tid))
+            continue;
+
+         format_path(path, state.tid, "/status");
+         if (read_status(taskFd, path, worker->status, &state))
+         {
+            state.pid = pid;
+            shared->visitor(&state, shared->arg);
+         }
+      }
+   }
+}
+
+static void visit_process(ScanWorker *const worker, pid_t const pid)
+{
+   ScanShared const *const shared = worker->shared;
+   char path[32];
+
+   if (!shared->threads)
+   {
+      PSigProcState state;
+      format_path(path, pid, "/status");
+      if (read_status(shared->rootFd, path, worker->status, &state))
+      {
+         state.pid = pid;
+         state.tid = pid;
+         shared->visitor(&state, shared->arg);
+      }
+      return;
+   }
+
+   format_path(path, pid, "/task");
+   int const taskFd = openat(shared->rootFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (taskFd < 0)
+      return;
+
+   visit_threads(worker, taskFd, pid);
+   close(taskFd);
+}
+
+/*
+   Each batch of the root directory is taken by one worker only.
+*/
+static void scan_pids(ScanWorker *const worker)
+{
+   ScanShared *const shared = worker->shared;
+
+   while (true)
+   {
+      pthread_mutex_lock(&shared->direntsMutex);
+      ssize_t const size = getdents64(shared->rootFd, worker->pids, sizeof(worker->pids));
+      pthread_mutex_unlock(&shared->direntsMutex);
+      if (size <= 0)
+         break;
+
+      for (ssize_t offset = 0; offset < size;)
+      {
+         struct dirent64 const *const entry = (struct dirent64 const *)(worker->pids + offset);
+         offset += entry->d_reclen;
+
+         pid_t pid;
+         if (parse_pid(entry->d_name, &pid))
+         {
+            visit_process(worker, pid);
+         }
+      }
+   }
+}
+
+static void *worker_main(void *const arg)
+{
+   ScanWorker worker;
+   worker.shared = arg;
+   scan_pids(&worker);
+   return nullptr;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_proc_parse_status(char const *const content, size_t const size, PSigProcState *const state)
+{
+   char const *const end = content + size;
+
+   // The signal lines follow each other, starting with SigQ.
+   char const *it = content;
+   if (!(size >= 5u && memcmp(content, "SigQ:", 5u) == 0))
+   {
+      it = memmem(content, size, "\nSigQ:", 6u);
+      if (it == nullptr)
+         return false;
+
+      ++it;
+   }
+
+   it = skip_blanks(it + 5, end);
+   if (!parse_decimal(&it, end, &state->queued) || it == end || *it++ != '/'
+      || !parse_decimal(&it, end, &state->queueLimit))
+      return false;
+
+   unsigned found = 0u;
+   for (it = next_line(it, end); it < end && found != ALL_MASK_LINES; it = next_line(it, end))
+   {
+      if ((size_t)(end - it) < MASK_KEY_LENGTH)
+         break;
+
+      unsigned line = 0u;
+      while (line < array_capacity(S_MASK_LINES) && memcmp(it, S_MASK_LINES[line].key, MASK_KEY_LENGTH) != 0)
+      {
+         ++line;
+      }
+      if (line == array_capacity(S_MASK_LINES))
+         break;
+
+      it = skip_blanks(it + MASK_KEY_LENGTH, end);
+      PSignalMask *const mask = (PSignalMask *)((char *)state + S_MASK_LINES[line].offset);
+      if (!parse_hex_mask(&it, end, mask))
+         return false;
+
+      found |= 1u << line;
+   }
+
+   return found == ALL_MASK_LINES;
+}
+
+bool psignal_proc_read(pid_t const pid, pid_t const tid, PSigProcState *const state)
+{
+   char path[64];
+   if (tid != 0)
+   {
+      snprintf(path, sizeof(path), "/proc/%d/task/%d/status", (int)pid, (int)tid);
+   }
+   else
+   {
+      snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+   }
+
+   char buffer[STATUS_CAPACITY];
+   if (!read_status(AT_FDCWD, path, buffer, state))
+      return false;
+
+   state->pid = pid;
+   state->tid = (tid != 0) ? tid : pid;
+   return true;
+}
+
+bool psignal_proc_scan(PSigProcScanConfig const *const config, PSigProcVisitor const visitor, void *const arg)
+{
+   PSigProcScanConfig const cfg = (config != nullptr) ? *config : (PSigProcScanConfig) {};
+
+   int const rootFd = open((cfg.root != nullptr) ? cfg.root : "/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (rootFd < 0)
+      return false;
+
+   ScanShared shared = (ScanShared) {
+      .rootFd = rootFd,
+      .threads = cfg.threads,
+      .visitor = visitor,
+      .arg = arg,
+   };
+   pthread_mutex_init(&shared.direntsMutex, nullptr);
+
+   // The caller is a worker too, and goes on alone if the other ones can't be created.
+   pthread_t workers[MAX_WORKERS];
+   unsigned const wanted = (cfg.workers > MAX_WORKERS) ? MAX_WORKERS : cfg.workers;
+   unsigned started = 0u;
+   while (started + 1u < wanted && pthread_create(&workers[started], nullptr, &worker_main, &shared) == 0)
+   {
+      ++started;
+   }
+
+   (void)worker_main(&shared);
+
+   for (unsigned i = 0; i < started; ++i)
+   {
+      pthread_join(workers[i], nullptr);
+   }
+
+   pthread_mutex_destroy(&shared.direntsMutex);
+   close(rootFd);
+   return true;
+}
@@ -0,0 +1,484 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_reload.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+struct PSigReloadHandle
+{
+   void *config;
+   atomic_uint refs;
+   uint64_t retireEpoch;     // Set once replaced.
+   PSigReloadHandle *next;   // Retired list, only used by the reload thread.
+};
+
+typedef struct ReaderSlot
+{
+   atomic_bool used;
+   _Atomic(uint64_t) epoch; // Global epoch seen at the last quiescent state, 0 while offline.
+} ReaderSlot;
+
+// Retired configurations are checked this often while some are left.
+static constexpr uint64_t RECLAIM_PERIOD_NS = 1000000u;
+
+static PSigReloadConfig s_config = {};
+
+// Both point to the same configuration: readers load the first one, references use the second.
+static _Atomic(void *) s_currentConfig = nullptr;
+static _Atomic(PSigReloadHandle *) s_current = nullptr;
+
+static PSigReloadHandle *s_retired = nullptr;
+static unsigned s_retiredCount = 0u;
+
+static _Atomic(uint64_t) s_epoch = 1u;
+static atomic_uint s_acquiring = 0u;
+static ReaderSlot s_readers[PSIG_RELOAD_MAX_READERS] = {};
+static thread_local ReaderSlot *s_selfReader = nullptr;
+
+static pthread_t s_thread;
+static sem_t s_sem;
+static atomic_bool s_stop = false;
+static atomic_bool s_pending = false;
+static _Atomic(uint64_t) s_requestNs = 0u;
+
+static _Atomic(uint64_t) s_version = 0u;
+static _Atomic(uint64_t) s_reloads = 0u;
+static _Atomic(uint64_t) s_failures = 0u;
+static _Atomic(uint64_t) s_coalesced = 0u;
+static _Atomic(uint64_t) s_lastLatencyNs = 0u;
+static _Atomic(uint64_t) s_maxLatencyNs = 0u;
+static atomic_uint s_retiredStat = 0u;
+
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Async-signal-safe.
+static void request_reload(void)
+{
+   if (atomic_load(&s_pending))
+   {
+      atomic_fetch_add(&s_coalesced, 1u);
+      return;
+   }
+
+   atomic_store(&s_requestNs, now_ns());
+   if (atomic_exchange(&s_pending, true))
+   {
+      atomic_fetch_add(&s_coalesced, 1u);
+      return;
+   }
+   sem_post(&s_sem);
+}
+
+static void sighup_handler(siginfo_t *const info, void *const context)
+{
+   request_reload();
+}
+
+[[nodiscard]]
+static PSigReloadHandle *make_handle(void *const config)
+{
+   PSigReloadHandle *const handle = calloc(1u, sizeof(*handle));
+   if (handle != nullptr)
+   {
+      handle->config = config;
+      atomic_init(&handle->refs, 0u);
+   }
+   return handle;
+}
+
+static void free_handle(PSigReloadHandle *const handle)
+{
+   if (s_config.free != nullptr && handle->config != nullptr)
+   {
+      s_config.free(handle->config, s_config.arg);
+   }
+   free(handle);
+}
+
+static void publish(PSigReloadHandle *const handle)
+{
+   atomic_store(&s_current, handle);
+   atomic_store(&s_currentConfig, handle->config);
+   atomic_fetch_add(&s_version, 1u);
+}
+
+static void retire(PSigReloadHandle *const handle)
+{
+   // Readers having seen the configuration are all behind this epoch.
+   handle->retireEpoch = atomic_fetch_add(&s_epoch, 1u) + 1u;
+   handle->next = s_retired;
+   s_retired = handle;
+   s_retiredCount += 1u;
+   atomic_store(&s_retiredStat, s_retiredCount);
+}
+
+static void reload(void)
+{
+   uint64_t const requestNs = atomic_load(&s_requestNs);
+
+   void *const config = s_config.load(s_config.arg);
+   PSigReloadHandle *const handle = (config != nullptr) ? make_handle(config) : nullptr;
+   if (handle == nullptr)
+   {
+      if (config != nullptr && s_config.free != nullptr)
+      {
+         s_config.free(config, s_config.arg);
+      }
+      atomic_fetch_add(&s_failures, 1u);
+      return;
+   }
+
+   PSigReloadHandle *const previous = atomic_load(&s_current);
+   publish(handle);
+   retire(previous);
+
+   uint64_t const latency = now_ns() - requestNs;
+   atomic_store(&s_lastLatencyNs, latency);
+   if (latency > atomic_load(&s_maxLatencyNs))
+   {
+      atomic_store(&s_maxLatencyNs, latency);
+   }
+   atomic_fetch_add(&s_reloads, 1u);
+}
+
+[[nodiscard]]
+static uint64_t oldest_reader_epoch(void)
+{
+   uint64_t oldest = UINT64_MAX;
+   for (unsigned i = 0; i < PSIG_RELOAD_MAX_READERS; ++i)
+   {
+      uint64_t const epoch = atomic_load(&s_readers[i].epoch);
+      if (epoch != 0u && epoch < oldest)
+      {
+         oldest = epoch;
+      }
+   }
+   return oldest;
+}
+
+static void reclaim(void)
+{
+   if (s_retired == nullptr)
+      return;
+
+   // A reference taken on a retired configuration is always counted before this check.
+   if (atomic_load(&s_acquiring) != 0u)
+      return;
+
+   uint64_t const oldest = oldest_reader_epoch();
+
+   PSigReloadHandle **link = &s_retired;
+   while (*link != nullptr)
+   {
+      PSigReloadHandle *const handle = *link;
+      if (handle->retireEpoch <= oldest && atomic_load(&handle->refs) == 0u)
+      {
+         *link = handle->next;
+         free_handle(handle);
+         s_retiredCount -= 1u;
+      }
+      else
+      {
+         link = &handle->next;
+      }
+   }
+   atomic_store(&s_retiredStat, s_retiredCount);
+}
+
+static void *reload_main(void *const arg)
+{
+   while (true)
+   {
+      if (s_retired != nullptr)
+      {
+         struct timespec deadline;
+         clock_gettime(CLOCK_MONOTONIC, &deadline);
+         uint64_t const ns = (uint64_t)deadline.tv_nsec + RECLAIM_PERIOD_NS;
+         deadline.tv_sec += (time_t)(ns / 1000000000u);
+         deadline.tv_nsec = (long)(ns % 1000000000u);
+         (void)sem_clockwait(&s_sem, CLOCK_MONOTONIC, &deadline);
+      }
+      else
+      {
+         while (sem_wait(&s_sem) != 0 && errno == EINTR) {}
+      }
+
+      if (atomic_load(&s_stop))
+         break;
+
+      if (atomic_exchange(&s_pending, false))
+      {
+         reload();
+      }
+      reclaim();
+   }
+
+   return nullptr;
+}
+
+static void free_all(void)
+{
+   while (s_retired != nullptr)
+   {
+      PSigReloadHandle *const handle = s_retired;
+      s_retired = handle->next;
+      free_handle(handle);
+   }
+   s_retiredCount = 0u;
+   atomic_store(&s_retiredStat, 0u);
+
+   PSigReloadHandle *const current = atomic_exchange(&s_current, nullptr);
+   atomic_store(&s_currentConfig, nullptr);
+   if (current != nullptr)
+   {
+      free_handle(current);
+   }
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, and the readers lost with them must not
+   hold the reclamation back. The configurations are kept, the forking thread may still be reading
+   them: the next init retires them.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_reload_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGHUP);
+
+   for (unsigned i = 0; i < PSIG_RELOAD_MAX_READERS; ++i)
+   {
+      if (&s_readers[i] != s_selfReader)
+      {
+         atomic_store(&s_readers[i].epoch, 0u);
+         atomic_store(&s_readers[i].used, false);
+      }
+   }
+   atomic_store(&s_acquiring, 0u);
+   atomic_store(&s_pending, false);
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_reload_init(PSigReloadConfig const *const config)
+{
+   if (psignal_reload_is_running())
+      return true;
+
+   if (!psignal_library_is_running() || config == nullptr || config->load == nullptr)
+      return false;
+
+   s_config = *config;
+
+   void *const initial = s_config.load(s_config.arg);
+   PSigReloadHandle *const handle = (initial != nullptr) ? make_handle(initial) : nullptr;
+   if (handle == nullptr)
+   {
+      if (initial != nullptr && s_config.free != nullptr)
+      {
+         s_config.free(initial, s_config.arg);
+      }
+      return false;
+   }
+
+   atomic_store(&s_version, 0u);
+   atomic_store(&s_reloads, 0u);
+   atomic_store(&s_failures, 0u);
+   atomic_store(&s_coalesced, 0u);
+   atomic_store(&s_lastLatencyNs, 0u);
+   atomic_store(&s_maxLatencyNs, 0u);
+
+   // Only left by the parent of a forked child.
+   PSigReloadHandle *const inherited = atomic_load(&s_current);
+   publish(handle);
+   if (inherited != nullptr)
+   {
+      retire(inherited);
+   }
+
+   atomic_store(&s_stop, false);
+   atomic_store(&s_pending, false);
+
+   bool success = (sem_init(&s_sem, 0, 0u) == 0);
+   if (success && pthread_create(&s_thread, nullptr, &reload_main, nullptr) != 0)
+   {
+      sem_destroy(&s_sem);
+      success = false;
+   }
+
+   if (success && !psignal_callback_internal_claim(PSignal_SIGHUP, &sighup_handler))
+   {
+      atomic_store(&s_stop, true);
+      sem_post(&s_sem);
+      pthread_join(s_thread, nullptr);
+      sem_destroy(&s_sem);
+      success = false;
+   }
+
+   if (!success)
+   {
+      free_all();
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_reload_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_reload_shutdown(void)
+{
+   if (!psignal_reload_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGHUP);
+
+   atomic_store(&s_stop, true);
+   sem_post(&s_sem);
+   pthread_join(s_thread, nullptr);
+   sem_destroy(&s_sem);
+
+   free_all();
+}
+
+bool psignal_reload_request(void)
+{
+   if (!psignal_reload_is_running())
+      return false;
+
+   request_reload();
+   return true;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Online readers
+//------------------------------------------------------------------------------------------------
+
+bool psignal_reload_reader_online(void)
+{
+   if (s_selfReader != nullptr)
+      return true;
+
+   for (unsigned i = 0; i < PSIG_RELOAD_MAX_READERS; ++i)
+   {
+      bool expected = false;
+      if (atomic_compare_exchange_strong(&s_readers[i].used, &expected, true))
+      {
+         s_selfReader = &s_readers[i];
+         atomic_store(&s_selfReader->epoch, atomic_load(&s_epoch));
+         return true;
+      }
+   }
+   return false;
+}
+
+void psignal_reload_reader_offline(void)
+{
+   ReaderSlot *const slot = s_selfReader;
+   if (slot == nullptr)
+      return;
+
+   s_selfReader = nullptr;
+   atomic_store(&slot->epoch, 0u);
+   atomic_store(&slot->used, false);
+}
+
+void psignal_reload_quiescent(void)
+{
+   ReaderSlot *const slot = s_selfReader;
+   if (slot != nullptr)
+   {
+      atomic_store(&slot->epoch, atomic_load(&s_epoch));
+   }
+}
+
+void const *psignal_reload_current(void)
+{
+   return atomic_load_explicit(&s_currentConfig, memory_order_acquire);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// References
+//------------------------------------------------------------------------------------------------
+
+PSigReloadHandle *psignal_reload_acquire(void)
+{
+   // Holds the reclamation back between the load and the reference count.
+   atomic_fetch_add(&s_acquiring, 1u);
+   PSigReloadHandle *const handle = atomic_load(&s_current);
+   if (handle != nullptr)
+   {
+      atomic_fetch_add(&handle->refs, 1u);
+   }
+   atomic_fetch_sub(&s_acquiring, 1u);
+   return handle;
+}
+
+void const *psignal_reload_handle_config(PSigReloadHandle const *const handle)
+{
+   return (handle != nullptr) ? handle->config : nullptr;
+}
+
+void psignal_reload_release(PSigReloadHandle *const handle)
+{
+   if (handle != nullptr)
+   {
+      atomic_fetch_sub(&handle->refs, 1u);
+   }
+}
+
+void psignal_reload_stats(PSigReloadStats *const stats)
+{
+   *stats = (PSigReloadStats) {
+      .version = atomic_load(&s_version),
+      .reloads = atomic_load(&s_reloads),
+      .failures = atomic_load(&s_failures),
+      .coalesced = atomic_load(&s_coalesced),
+      .lastLatencyNs = atomic_load(&s_lastLatencyNs),
+      .maxLatencyNs = atomic_load(&s_maxLatencyNs),
+      .retired = atomic_load(&s_retiredStat)
+   };
+}
@@ -0,0 +1,326 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_seccomp.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Only defined by the kernel headers, which can't be included along with <signal.h>.
+#ifndef SYS_SECCOMP
+#define SYS_SECCOMP 1
+#endif
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+/*
+   Syscalls run for real go through this function. The filter allows any syscall issued from it,
+   recognized by the instruction pointer the kernel reports: the address following the syscall
+   instruction.
+*/
+#if defined(__x86_64__)
+#define PSIG_SECCOMP_AUDIT_ARCH AUDIT_ARCH_X86_64
+#define PSIG_SECCOMP_HAS_ESCAPE 1
+__asm__(
+   ".text\n"
+   ".p2align 4\n"
+   ".globl psignal_seccomp_escape\n"
+   ".hidden psignal_seccomp_escape\n"
+   ".type psignal_seccomp_escape, @function\n"
+   "psignal_seccomp_escape:\n"
+   "   movq %rdi, %rax\n"
+   "   movq %rsi, %rdi\n"
+   "   movq %rdx, %rsi\n"
+   "   movq %rcx, %rdx\n"
+   "   movq %r8, %r10\n"
+   "   movq %r9, %r8\n"
+   "   movq 8(%rsp), %r9\n"
+   "   syscall\n"
+   ".globl psignal_seccomp_escape_return\n"
+   ".hidden psignal_seccomp_escape_return\n"
+   "psignal_seccomp_escape_return:\n"
+   "   ret\n"
+   ".size psignal_seccomp_escape, .-psignal_seccomp_escape\n"
+);
+#elif defined(__aarch64__)
+#define PSIG_SECCOMP_AUDIT_ARCH AUDIT_ARCH_AARCH64
+#define PSIG_SECCOMP_HAS_ESCAPE 1
+__asm__(
+   ".text\n"
+   ".p2align 4\n"
+   ".globl psignal_seccomp_escape\n"
+   ".hidden psignal_seccomp_escape\n"
+   ".type psignal_seccomp_escape, %function\n"
+   "psignal_seccomp_escape:\n"
+   "   mov x8, x0\n"
+   "   mov x0, x1\n"
+   "   mov x1, x2\n"
+   "   mov x2, x3\n"
+   "   mov x3, x4\n"
+   "   mov x4, x5\n"
+   "   mov x5, x6\n"
+   "   svc #0\n"
+   ".globl psignal_seccomp_escape_return\n"
+   ".hidden psignal_seccomp_escape_return\n"
+   "psignal_seccomp_escape_return:\n"
+   "   ret\n"
+   ".size psignal_seccomp_escape, .-psignal_seccomp_escape\n"
+);
+#elif defined(__i386__)
+#define PSIG_SECCOMP_AUDIT_ARCH AUDIT_ARCH_I386
+#define PSIG_SECCOMP_HAS_ESCAPE 0
+#else
+#define PSIG_SECCOMP_HAS_ESCAPE 0
+#endif
+
+#if PSIG_SECCOMP_HAS_ESCAPE
+long psignal_seccomp_escape(long nr, long a0, long a1, long a2, long a3, long a4, long a5);
+extern char const psignal_seccomp_escape_return[];
+#endif
+
+typedef struct SyscallEntry
+{
+   _Atomic(PSigSyscallHandler) handler;
+   void *userData;
+   bool trapped;
+} SyscallEntry;
+
+// Indexed by syscall number.
+static SyscallEntry s_syscalls[PSIG_SECCOMP_MAX_SYSCALLS] = {};
+static pthread_mutex_t s_syscallsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool s_installed = false;
+static atomic_bool s_running = false;
+static atomic_uint_fast64_t s_trapCount = 0u;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static inline bool is_valid_nr(long const nr)
+{
+   return nr >= 0 && nr < (long)PSIG_SECCOMP_MAX_SYSCALLS;
+}
+
+static void sigsys_handler(siginfo_t *const info, void *const context)
+{
+   if (info == nullptr || info->si_code != SYS_SECCOMP)
+      return;
+
+   PSigSyscall call = (PSigSyscall) {
+      .nr = info->si_syscall,
+      .result = -ENOSYS,
+      .ucontext = context
+   };
+   if (!psignal_internal_context_syscall_args(context, call.args))
+      return;
+
+   bool emulated = false;
+   if (is_valid_nr(call.nr))
+   {
+      SyscallEntry *const entry = &s_syscalls[call.nr];
+      PSigSyscallHandler const handler = atomic_load_explicit(&entry->handler, memory_order_acquire);
+      if (handler != nullptr)
+      {
+         call.userData = entry->userData;
+         emulated = handler(&call);
+      }
+   }
+
+   if (!emulated)
+   {
+      call.result = psignal_seccomp_syscall(call.nr, call.args);
+   }
+
+   (void)psignal_internal_context_set_syscall_result(context, call.result);
+   atomic_fetch_add_explicit(&s_trapCount, 1u, memory_order_relaxed);
+}
+
+[[nodiscard]]
+static bool install_filter(long const *const nrs, unsigned const count)
+{
+#if defined(PSIG_SECCOMP_AUDIT_ARCH)
+   // Architecture checks, escape hatch, then one comparison per trapped syscall.
+   unsigned const capacity = 11u + 2u * count + 1u;
+   struct sock_filter *const filter = calloc(capacity, sizeof(*filter));
+   if (filter == nullptr)
+      return false;
+
+   unsigned len = 0u;
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch));
+   filter[len++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PSIG_SECCOMP_AUDIT_ARCH, 1, 0);
+   // Another syscall ABI (ia32 on x86_64, ...) would number the syscalls differently and bypass the
+   // comparisons below.
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS);
+
+#if PSIG_SECCOMP_HAS_ESCAPE
+   uint64_t const escape = (uint64_t)(uintptr_t)psignal_seccomp_escape_return;
+   size_t const ipOffset = offsetof(struct seccomp_data, instruction_pointer);
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_W | BPF_ABS, ipOffset);
+   filter[len++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)escape, 0, 3);
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_W | BPF_ABS, ipOffset + 4u);
+   filter[len++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(escape >> 32), 0, 1);
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+#endif
+
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr));
+#if defined(__X32_SYSCALL_BIT)
+   // x32 syscalls share the x86_64 architecture, with their own numbers.
+   filter[len++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, __X32_SYSCALL_BIT, 0, 1);
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS);
+#endif
+   for (unsigned i = 0; i < count; ++i)
+   {
+      filter[len++] = (struct sock_filter) BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)nrs[i], 0, 1);
+      filter[len++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRAP);
+   }
+   filter[len++] = (struct sock_filter) BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+
+   struct sock_fprog const program = { .len = (unsigned short)len, .filter = filter };
+   bool const success = prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0
+      && syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, SECCOMP_FILTER_FLAG_TSYNC, &program) == 0;
+
+   free(filter);
+   return success;
+#else
+   (void)nrs;
+   (void)count;
+   return false;
+#endif
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_seccomp_init(void)
+{
+   if (psignal_seccomp_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   if (!psignal_callback_internal_claim(PSignal_SIGSYS, &sigsys_handler))
+      return false;
+
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_seccomp_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_seccomp_shutdown(void)
+{
+   // Trapped syscalls would kill the process without the dispatcher.
+   if (!psignal_seccomp_is_running() || s_installed)
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(PSignal_SIGSYS);
+
+   for (unsigned i = 0; i < PSIG_SECCOMP_MAX_SYSCALLS; ++i)
+   {
+      atomic_store(&s_syscalls[i].handler, nullptr);
+   }
+}
+
+bool psignal_seccomp_set_handler(long const nr, PSigSyscallHandler const handler, void *const userData)
+{
+   if (!psignal_seccomp_is_running() || !is_valid_nr(nr))
+      return false;
+
+   pthread_mutex_lock(&s_syscallsMutex);
+   SyscallEntry *const entry = &s_syscalls[nr];
+
+   // Hidden while the user data changes, the syscall then runs for real.
+   atomic_store(&entry->handler, nullptr);
+   entry->userData = userData;
+   atomic_store_explicit(&entry->handler, handler, memory_order_release);
+
+   pthread_mutex_unlock(&s_syscallsMutex);
+   return true;
+}
+
+bool psignal_seccomp_install(void)
+{
+   if (!psignal_seccomp_is_running())
+      return false;
+
+   pthread_mutex_lock(&s_syscallsMutex);
+
+   long nrs[PSIG_SECCOMP_MAX_SYSCALLS];
+   unsigned count = 0u;
+   for (long nr = 0; nr < (long)PSIG_SECCOMP_MAX_SYSCALLS; ++nr)
+   {
+      if (!s_syscalls[nr].trapped && atomic_load(&s_syscalls[nr].handler) != nullptr)
+      {
+         nrs[count++] = nr;
+      }
+   }
+
+   bool const success = (count > 0u) && install_filter(nrs, count);
+   if (success)
+   {
+      // Trapped syscalls would kill the process without the dispatcher, even after the library.
+      psignal_callback_internal_pin(PSignal_SIGSYS);
+      s_installed = true;
+      for (unsigned i = 0; i < count; ++i)
+      {
+         s_syscalls[nrs[i]].trapped = true;
+      }
+   }
+
+   pthread_mutex_unlock(&s_syscallsMutex);
+   return success;
+}
+
+bool psignal_seccomp_is_trapped(long const nr)
+{
+   if (!is_valid_nr(nr))
+      return false;
+
+   pthread_mutex_lock(&s_syscallsMutex);
+   bool const trapped = s_syscalls[nr].trapped;
+   pthread_mutex_unlock(&s_syscallsMutex);
+   return trapped;
+}
+
+long psignal_seccomp_syscall(long const nr, long const args[6])
+{
+#if PSIG_SECCOMP_HAS_ESCAPE
+   return psignal_seccomp_escape(nr, args[0], args[1], args[2], args[3], args[4], args[5]);
+#else
+   (void)nr;
+   (void)args;
+   return -ENOSYS;
+#endif
+}
+
+uint64_t psignal_seccomp_trap_count(void)
+{
+   return atomic_load(&s_trapCount);
+}
@@ -0,0 +1,690 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_simulator.h"
+#include "libposix_signals/posix_signal_callbacks.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#if PSIG_CONFIG_SIMULATOR
+
+#include <ctype.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// A virtual time of 0 would turn the simulation off, see psignal_callback_internal_sim_set_time.
+static constexpr uint64_t START_NS = 1000000000u;
+
+typedef struct Frame
+{
+   PSignal sig;
+   int code;
+   bool immediate;
+   unsigned expected; // Simulated callbacks hooked on sig when the delivery started, one bit each.
+   unsigned unhooked; // Unhooked from sig during the delivery.
+   unsigned called;
+} Frame;
+
+// Model of the hooks, which the calls are checked against. Indexed by PSignal, one bit per callback.
+static unsigned s_hooked[PSignal_ENUM_COUNT];
+static unsigned s_disturbed[PSignal_ENUM_COUNT]; // Hooked or unhooked after a delivery.
+static uint64_t s_counts[PSignal_ENUM_COUNT][PSIG_SIM_CALLBACKS];
+static uint64_t s_deliveries[PSignal_ENUM_COUNT];
+static PSigDispatchMode s_modes[PSignal_ENUM_COUNT];
+static int s_rawSignals[PSignal_ENUM_COUNT];
+
+static Frame s_frames[PSIG_SIM_MAX_DEPTH];
+static unsigned s_depth;
+
+// Nested events of the top-level event running.
+static PSigSimEvent const *s_nested;
+static PSigSimEvent const *s_nestedEnd;
+
+static uint64_t s_nowNs;
+static size_t s_eventIndex;
+static PSigSimReport *s_report;
+
+typedef struct CodeName
+{
+   char const *name;
+   int code;
+} CodeName;
+
+static CodeName const CODE_NAMES[] = {
+   { "SI_USER", SI_USER },         { "SI_QUEUE", SI_QUEUE },       { "SI_TIMER", SI_TIMER },
+   { "SI_MESGQ", SI_MESGQ },       { "SI_ASYNCIO", SI_ASYNCIO },   { "SI_TKILL", SI_TKILL },
+   { "SI_KERNEL", SI_KERNEL },
+   { "SEGV_MAPERR", SEGV_MAPERR }, { "SEGV_ACCERR", SEGV_ACCERR },
+   { "BUS_ADRALN", BUS_ADRALN },   { "BUS_ADRERR", BUS_ADRERR },   { "BUS_OBJERR", BUS_OBJERR },
+   { "FPE_INTDIV", FPE_INTDIV },   { "FPE_INTOVF", FPE_INTOVF },   { "FPE_FLTDIV", FPE_FLTDIV },
+   { "FPE_FLTOVF", FPE_FLTOVF },   { "FPE_FLTUND", FPE_FLTUND },   { "FPE_FLTRES", FPE_FLTRES },
+   { "FPE_FLTINV", FPE_FLTINV },   { "FPE_FLTSUB", FPE_FLTSUB },
+   { "ILL_ILLOPC", ILL_ILLOPC },   { "ILL_ILLOPN", ILL_ILLOPN },   { "ILL_ILLADR", ILL_ILLADR },
+   { "ILL_ILLTRP", ILL_ILLTRP },   { "ILL_PRVOPC", ILL_PRVOPC },   { "ILL_PRVREG", ILL_PRVREG },
+   { "ILL_COPROC", ILL_COPROC },   { "ILL_BADSTK", ILL_BADSTK },
+   { "TRAP_BRKPT", TRAP_BRKPT },   { "TRAP_TRACE", TRAP_TRACE },
+   { "CLD_EXITED", CLD_EXITED },   { "CLD_KILLED", CLD_KILLED },   { "CLD_DUMPED", CLD_DUMPED },
+   { "CLD_TRAPPED", CLD_TRAPPED }, { "CLD_STOPPED", CLD_STOPPED }, { "CLD_CONTINUED", CLD_CONTINUED },
+};
+
+static char const *const VIOLATION_NAMES[] = {
+   [PSigSimViolation_NONE]          = "none",
+   [PSigSimViolation_INVALID_EVENT] = "invalid event",
+   [PSigSimViolation_SPURIOUS]      = "spurious call",
+   [PSigSimViolation_WRONG_SIGNAL]  = "wrong signal",
+   [PSigSimViolation_WRONG_CODE]    = "wrong code",
+   [PSigSimViolation_DUPLICATE]     = "duplicate call",
+   [PSigSimViolation_MISSED]        = "missed call",
+   [PSigSimViolation_LOST]          = "lost deliveries",
+};
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+static void run_nested(void);
+
+static void violation(PSigSimViolation const kind)
+{
+   if (s_report->violations == 0u)
+   {
+      s_report->firstViolation = kind;
+      s_report->firstViolationEvent = s_eventIndex;
+   }
+   s_report->violations += 1u;
+}
+
+[[nodiscard]]
+static bool is_simulated(PSignal const psig)
+{
+   return psignal_validate(psig) && psignal_callback_is_authorized(psig) && !psignal_callback_is_reserved(psig);
+}
+
+[[nodiscard]]
+static bool is_synchronous_fault(PSignal const psig)
+{
+   return psig == PSignal_SIGSEGV || psig == PSignal_SIGBUS || psig == PSignal_SIGILL
+      || psig == PSignal_SIGFPE || psig == PSignal_SIGTRAP;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Simulated callbacks
+//------------------------------------------------------------------------------------------------
+
+static void on_call(unsigned const idx, PSigCallbackInfo const *const info)
+{
+   s_report->calls += 1u;
+   s_report->checksum = (s_report->checksum ^ ((uint64_t)idx | ((uint64_t)info->sig << 8)
+      | ((uint64_t)(uint16_t)info->sigCode << 16) | ((uint64_t)info->count << 32))) * 0x100000001b3u;
+
+   if (!(s_hooked[info->sig] & (1u << idx)))
+   {
+      violation(PSigSimViolation_SPURIOUS);
+   }
+   s_counts[info->sig][idx] += info->count;
+
+   // Batches dispatched by a flush or a policy change run outside of any delivery.
+   if (s_depth > 0u)
+   {
+      Frame *const frame = &s_frames[s_depth - 1u];
+      if (info->sig != frame->sig)
+      {
+         violation(PSigSimViolation_WRONG_SIGNAL);
+      }
+      else if (frame->immediate)
+      {
+         if (info->sigCode != frame->code)
+         {
+            violation(PSigSimViolation_WRONG_CODE);
+         }
+         if (frame->called & (1u << idx))
+         {
+            violation(PSigSimViolation_DUPLICATE);
+         }
+         frame->called |= (1u << idx);
+      }
+   }
+
+   run_nested();
+}
+
+#define SIM_CALLBACK(idx) \
+   static void sim_callback_##idx(PSigCallbackInfo const *const info) { on_call(idx, info); }
+
+SIM_CALLBACK(0)
+SIM_CALLBACK(1)
+SIM_CALLBACK(2)
+SIM_CALLBACK(3)
+SIM_CALLBACK(4)
+SIM_CALLBACK(5)
+SIM_CALLBACK(6)
+SIM_CALLBACK(7)
+
+#undef SIM_CALLBACK
+
+static PSigCallback const CALLBACKS[] = {
+   &sim_callback_0, &sim_callback_1, &sim_callback_2, &sim_callback_3,
+   &sim_callback_4, &sim_callback_5, &sim_callback_6, &sim_callback_7,
+};
+
+static_assert(sizeof(CALLBACKS) / sizeof(CALLBACKS[0]) == PSIG_SIM_CALLBACKS);
+
+
+//------------------------------------------------------------------------------------------------
+// Events
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool is_valid(PSigSimEvent const *const event)
+{
+   switch (event->op)
+   {
+      case PSigSimOp_DELIVER:
+         return is_simulated(event->sig);
+
+      case PSigSimOp_HOOK:
+      case PSigSimOp_UNHOOK:
+         return event->callback < PSIG_SIM_CALLBACKS && is_simulated(event->sig);
+
+      case PSigSimOp_POLICY:
+         return !event->nested && is_simulated(event->sig)
+            && (event->mode == PSigDispatchMode_IMMEDIATE || !is_synchronous_fault(event->sig));
+
+      case PSigSimOp_ADVANCE:
+         return !event->nested;
+   }
+
+   return false;
+}
+
+static void deliver(PSigSimEvent const *const event)
+{
+   if (s_depth == PSIG_SIM_MAX_DEPTH)
+   {
+      s_report->skipped += 1u;
+      return;
+   }
+
+   Frame *const frame = &s_frames[s_depth];
+   *frame = (Frame) {
+      .sig = event->sig,
+      .code = event->code,
+      .immediate = (s_modes[event->sig] == PSigDispatchMode_IMMEDIATE),
+      .expected = s_hooked[event->sig],
+   };
+   s_depth += 1u;
+   if (s_depth > s_report->maxDepth)
+   {
+      s_report->maxDepth = s_depth;
+   }
+
+   s_report->deliveries += 1u;
+   s_deliveries[event->sig] += 1u;
+
+   siginfo_t info = {};
+   info.si_signo = s_rawSignals[event->sig];
+   info.si_code = event->code;
+   psignal_callback_internal_sim_deliver(&info);
+
+   s_depth -= 1u;
+   if (frame->immediate && (frame->expected & ~frame->unhooked & ~frame->called) != 0u)
+   {
+      violation(PSigSimViolation_MISSED);
+   }
+}
+
+static void hook(PSigSimEvent const *const event)
+{
+   unsigned const bit = 1u << event->callback;
+   if (s_deliveries[event->sig] != 0u)
+   {
+      s_disturbed[event->sig] |= bit;
+   }
+
+   if (event->op == PSigSimOp_HOOK)
+   {
+      if (psignal_callback_hook_on_sig(event->sig, CALLBACKS[event->callback]))
+      {
+         s_hooked[event->sig] |= bit;
+      }
+      return;
+   }
+
+   psignal_callback_remove_from_sig(event->sig, CALLBACKS[event->callback]);
+   s_hooked[event->sig] &= ~bit;
+   for (unsigned i = 0; i < s_depth; ++i)
+   {
+      if (s_frames[i].sig == event->sig)
+      {
+         s_frames[i].unhooked |= bit;
+      }
+   }
+}
+
+static void set_policy(PSigSimEvent const *const event)
+{
+   PSigDispatchPolicy const policy = {
+      .mode = event->mode,
+      .windowNs = event->value,
+      .maxPerSecond = (unsigned)event->value,
+   };
+
+   if (!psignal_callback_set_policy(event->sig, &policy))
+   {
+      violation(PSigSimViolation_INVALID_EVENT);
+      return;
+   }
+   s_modes[event->sig] = event->mode;
+}
+
+static void run_event(PSigSimEvent const *const event)
+{
+   switch (event->op)
+   {
+      case PSigSimOp_DELIVER:
+         deliver(event);
+         break;
+
+      case PSigSimOp_HOOK:
+      case PSigSimOp_UNHOOK:
+         hook(event);
+         break;
+
+      case PSigSimOp_POLICY:
+         set_policy(event);
+         break;
+
+      case PSigSimOp_ADVANCE:
+         s_nowNs += event->value;
+         psignal_callback_internal_sim_set_time(s_nowNs);
+         (void)psignal_callback_internal_sim_flush();
+         break;
+   }
+}
+
+static void run_nested(void)
+{
+   if (s_nested < s_nestedEnd)
+   {
+      PSigSimEvent const *const event = s_nested;
+      s_nested += 1;
+      run_event(event);
+   }
+}
+
+static void reset_model(void)
+{
+   memset(s_hooked, 0, sizeof(s_hooked));
+   memset(s_disturbed, 0, sizeof(s_disturbed));
+   memset(s_counts, 0, sizeof(s_counts));
+   memset(s_deliveries, 0, sizeof(s_deliveries));
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      s_modes[idx] = PSigDispatchMode_IMMEDIATE;
+      s_rawSignals[idx] = psignal_to_raw_signal(idx);
+   }
+   s_depth = 0u;
+   s_nested = nullptr;
+   s_nestedEnd = nullptr;
+}
+
+// Dispatches what the policies still hold, and checks nothing was lost on the way.
+static void drain_and_check(void)
+{
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      if (s_modes[idx] != PSigDispatchMode_IMMEDIATE)
+      {
+         (void)psignal_callback_set_policy(idx, nullptr);
+         s_modes[idx] = PSigDispatchMode_IMMEDIATE;
+      }
+   }
+
+   for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
+   {
+      unsigned const steady = s_hooked[idx] & ~s_disturbed[idx];
+      for (unsigned i = 0; i < PSIG_SIM_CALLBACKS; ++i)
+      {
+         if ((steady & (1u << i)) && s_counts[idx][i] != s_deliveries[idx])
+         {
+            violation(PSigSimViolation_LOST);
+         }
+      }
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Generation
+//------------------------------------------------------------------------------------------------
+
+// splitmix64: a seed always draws the same stream, whatever the platform.
+[[nodiscard]]
+static uint64_t next_random(uint64_t *const state)
+{
+   uint64_t z = (*state += 0x9e3779b97f4a7c15u);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+   return z ^ (z >> 31);
+}
+
+[[nodiscard]]
+static int random_code(PSignal const psig, uint64_t const r)
+{
+   static int const OTHER_CODES[] = { SI_USER, SI_QUEUE, SI_TKILL, SI_KERNEL, SI_TIMER };
+
+   switch (psig)
+   {
+      case PSignal_SIGSEGV: return SEGV_MAPERR + (int)(r % 2u);
+      case PSignal_SIGBUS:  return BUS_ADRALN + (int)(r % 3u);
+      case PSignal_SIGFPE:  return FPE_INTDIV + (int)(r % 8u);
+      case PSignal_SIGILL:  return ILL_ILLOPC + (int)(r % 8u);
+      case PSignal_SIGTRAP: return TRAP_BRKPT + (int)(r % 2u);
+      case PSignal_SIGCHLD: return CLD_EXITED + (int)(r % 6u);
+      default:              return OTHER_CODES[r % (sizeof(OTHER_CODES) / sizeof(OTHER_CODES[0]))];
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Parsing
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool parse_u64(char const *const token, uint64_t *const out)
+{
+   if (token == nullptr || !isdigit((unsigned char)token[0]))
+      return false;
+
+   char *end;
+   *out = strtoull(token, &end, 10);
+   return *end == '\0';
+}
+
+[[nodiscard]]
+static bool parse_code(char const *const token, int *const out)
+{
+   for (unsigned i = 0; i < sizeof(CODE_NAMES) / sizeof(CODE_NAMES[0]); ++i)
+   {
+      if (strcasecmp(token, CODE_NAMES[i].name) == 0)
+      {
+         *out = CODE_NAMES[i].code;
+         return true;
+      }
+   }
+
+   char *end;
+   long const code = strtol(token, &end, 10);
+   if (end == token || *end != '\0' || code < INT32_MIN || code > INT32_MAX)
+      return false;
+
+   *out = (int)code;
+   return true;
+}
+
+[[nodiscard]]
+static bool parse_policy(char *const *const tokens, unsigned const count, PSigSimEvent *const event)
+{
+   if (strcasecmp(tokens[0], "immediate") == 0 && count == 1u)
+   {
+      event->mode = PSigDispatchMode_IMMEDIATE;
+      return true;
+   }
+   if (strcasecmp(tokens[0], "latest") == 0 && count == 1u)
+   {
+      event->mode = PSigDispatchMode_LATEST_ONLY;
+      return true;
+   }
+   if (strcasecmp(tokens[0], "coalesce") == 0 && count == 2u)
+   {
+      event->mode = PSigDispatchMode_COALESCE;
+      return parse_u64(tokens[1], &event->value) && event->value != 0u;
+   }
+   if (strcasecmp(tokens[0], "rate") == 0 && count == 2u)
+   {
+      event->mode = PSigDispatchMode_RATE_LIMIT;
+      return parse_u64(tokens[1], &event->value) && event->value != 0u && event->value <= UINT32_MAX;
+   }
+
+   return false;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_sim_run(PSigSimEvent const *const events, size_t const count, PSigSimReport *const report)
+{
+   *report = (PSigSimReport) { .checksum = 0xcbf29ce484222325u };
+   if (psignal_library_is_running())
+      return false;
+
+   s_report = report;
+   for (size_t i = 0; i < count; ++i)
+   {
+      if (!is_valid(&events[i]))
+      {
+         s_eventIndex = i;
+         violation(PSigSimViolation_INVALID_EVENT);
+         return false;
+      }
+   }
+
+   reset_model();
+   s_nowNs = START_NS;
+   psignal_callback_internal_sim_set_time(s_nowNs);
+
+   size_t i = 0;
+   while (i < count)
+   {
+      size_t end = i + 1u;
+      while (end < count && events[end].nested)
+      {
+         end += 1u;
+      }
+
+      s_eventIndex = i;
+      if (events[i].nested)
+      {
+         // Nothing runs before the first top-level event.
+         report->skipped += end - i;
+      }
+      else
+      {
+         s_nested = &events[i + 1u];
+         s_nestedEnd = &events[end];
+         run_event(&events[i]);
+         report->skipped += (size_t)(s_nestedEnd - s_nested);
+      }
+      i = end;
+   }
+   s_nested = nullptr;
+   s_nestedEnd = nullptr;
+
+   drain_and_check();
+   report->events = count;
+
+   for (unsigned idx = 0; idx < PSIG_SIM_CALLBACKS; ++idx)
+   {
+      psignal_callback_remove_from_all(CALLBACKS[idx]);
+   }
+   psignal_callback_internal_sim_set_time(0u);
+   s_report = nullptr;
+
+   return report->violations == 0u;
+}
+
+void psignal_sim_generate(PSigSimGenConfig const *const config, PSigSimEvent *const events, size_t const count)
+{
+   PSignalMask requested = config->signals;
+   if (requested == 0u)
+   {
+      static PSignal const DEFAULT_SIGNALS[] = {
+         PSignal_SIGHUP, PSignal_SIGINT, PSignal_SIGSEGV, PSignal_SIGUSR1,
+         PSignal_SIGUSR2, PSignal_SIGCHLD, PSignal_SIGWINCH, PSignal_SIGRTMIN,
+      };
+      for (unsigned i = 0; i < sizeof(DEFAULT_SIGNALS) / sizeof(DEFAULT_SIGNALS[0]); ++i)
+      {
+         requested |= psignal_mask_of(DEFAULT_SIGNALS[i]);
+      }
+   }
+
+   PSignal signals[PSignal_ENUM_COUNT];
+   unsigned signalCount = 0u;
+   PSignal psig;
+   while (psignal_mask_next(&requested, &psig))
+   {
+      if (is_simulated(psig))
+      {
+         signals[signalCount++] = psig;
+      }
+   }
+
+   unsigned const callbacks = (config->callbacks == 0u || config->callbacks > PSIG_SIM_CALLBACKS)
+      ? PSIG_SIM_CALLBACKS
+      : config->callbacks;
+
+   uint64_t state = config->seed;
+   for (size_t i = 0; i < count; ++i)
+   {
+      PSigSimEvent *const event = &events[i];
+      uint64_t const r = next_random(&state);
+      uint64_t const choice = r % 100u;
+
+      if (signalCount == 0u)
+      {
+         *event = (PSigSimEvent) { .op = PSigSimOp_ADVANCE };
+         continue;
+      }
+
+      PSignal const sig = signals[(r >> 8) % signalCount];
+      bool const nested = ((r >> 24) % 100u) < config->nestPercent;
+      uint64_t const draw = r >> 32;
+
+      if (choice < config->policyPercent)
+      {
+         if (draw & 1u)
+         {
+            *event = (PSigSimEvent) { .op = PSigSimOp_ADVANCE, .value = (draw >> 1) % 20000000u };
+            continue;
+         }
+
+         PSigDispatchMode const mode = is_synchronous_fault(sig)
+            ? PSigDispatchMode_IMMEDIATE
+            : (PSigDispatchMode)((draw >> 1) % 4u);
+         uint64_t value = 0u;
+         if (mode == PSigDispatchMode_COALESCE)
+         {
+            value = 100000u + (draw >> 3) % 10000000u;
+         }
+         else if (mode == PSigDispatchMode_RATE_LIMIT)
+         {
+            value = 10u + (draw >> 3) % 10000u;
+         }
+         *event = (PSigSimEvent) { .op = PSigSimOp_POLICY, .sig = sig, .mode = mode, .value = value };
+      }
+      else if (choice < config->policyPercent + config->hookPercent)
+      {
+         *event = (PSigSimEvent) {
+            .op = (draw & 1u) ? PSigSimOp_HOOK : PSigSimOp_UNHOOK,
+            .nested = nested,
+            .callback = (unsigned char)((draw >> 1) % callbacks),
+            .sig = sig,
+         };
+      }
+      else
+      {
+         *event = (PSigSimEvent) {
+            .op = PSigSimOp_DELIVER,
+            .nested = nested,
+            .sig = sig,
+            .code = random_code(sig, draw),
+         };
+      }
+   }
+}
+
+PSigSimParse psignal_sim_parse(char const *const line, PSigSimEvent *const event)
+{
+   char buffer[256];
+   size_t const length = strcspn(line, "#\n");
+   if (length >= sizeof(buffer))
+      return PSigSimParse_ERROR;
+
+   memcpy(buffer, line, length);
+   buffer[length] = '\0';
+
+   char *tokens[6];
+   unsigned count = 0u;
+   char *save;
+   for (char *token = strtok_r(buffer, " \t\r", &save); token != nullptr; token = strtok_r(nullptr, " \t\r", &save))
+   {
+      if (count == sizeof(tokens) / sizeof(tokens[0]))
+         return PSigSimParse_ERROR;
+      tokens[count++] = token;
+   }
+
+   if (count == 0u)
+      return PSigSimParse_BLANK;
+
+   *event = (PSigSimEvent) {};
+   char *const *args = tokens;
+   if (strcmp(args[0], ">") == 0)
+   {
+      event->nested = true;
+      args += 1;
+      count -= 1u;
+      if (count == 0u)
+         return PSigSimParse_ERROR;
+   }
+
+   uint64_t callback;
+   bool parsed = false;
+   if (strcasecmp(args[0], "deliver") == 0 && (count == 2u || count == 3u))
+   {
+      event->op = PSigSimOp_DELIVER;
+      event->code = SI_USER;
+      parsed = psignal_from_name(args[1], &event->sig) && (count == 2u || parse_code(args[2], &event->code));
+   }
+   else if ((strcasecmp(args[0], "hook") == 0 || strcasecmp(args[0], "unhook") == 0) && count == 3u)
+   {
+      event->op = (tolower((unsigned char)args[0][0]) == 'h') ? PSigSimOp_HOOK : PSigSimOp_UNHOOK;
+      parsed = parse_u64(args[1], &callback) && callback < PSIG_SIM_CALLBACKS
+         && psignal_from_name(args[2], &event->sig);
+      event->callback = (unsigned char)callback;
+   }
+   else if (strcasecmp(args[0], "policy") == 0 && count >= 3u && !event->nested)
+   {
+      event->op = PSigSimOp_POLICY;
+      parsed = psignal_from_name(args[1], &event->sig) && parse_policy(&args[2], count - 2u, event);
+   }
+   else if (strcasecmp(args[0], "advance") == 0 && count == 2u && !event->nested)
+   {
+      event->op = PSigSimOp_ADVANCE;
+      parsed = parse_u64(args[1], &event->value);
+   }
+
+   return parsed ? PSigSimParse_EVENT : PSigSimParse_ERROR;
+}
+
+char const *psignal_sim_violation_name(PSigSimViolation const kind)
+{
+   return (kind < sizeof(VIOLATION_NAMES) / sizeof(VIOLATION_NAMES[0]))
+      ? VIOLATION_NAMES[kind]
+      : "unknown";
+}
+
+#endif
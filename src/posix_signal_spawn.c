@@ -0,0 +1,91 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_spawn.h"
+#include "libposix_signals/posix_signal_dispositions.h"
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+
+extern char **environ;
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_spawn(pid_t *const pid, char const *const path, char *const argv[], char *const envp[], PSigSpawnConfig const *const config)
+{
+   if (pid == nullptr || path == nullptr || argv == nullptr)
+   {
+      errno = EINVAL;
+      return false;
+   }
+
+   PSigSpawnConfig const cfg = (config != nullptr) ? *config : (PSigSpawnConfig) {};
+
+   // SIGKILL and SIGSTOP can be neither blocked nor caught.
+   PSignalMask const uncatchable = psignal_mask_union(psignal_mask_of(PSignal_SIGKILL), psignal_mask_of(PSignal_SIGSTOP));
+   PSignalMask const defaultMask = (cfg.defaultMask != 0u) ? cfg.defaultMask : psignal_disposition_mask_all();
+
+   sigset_t blocked, defaults;
+   psignal_mask_to_sigset(psignal_mask_diff(cfg.blockedMask, uncatchable), &blocked);
+   psignal_mask_to_sigset(psignal_mask_diff(defaultMask, uncatchable), &defaults);
+
+   posix_spawnattr_t attr;
+   int error = posix_spawnattr_init(&attr);
+   if (error != 0)
+   {
+      errno = error;
+      return false;
+   }
+
+   short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_USEVFORK
+   // Implied by recent glibc versions, older ones would fork() without it.
+   flags |= POSIX_SPAWN_USEVFORK;
+#endif
+   if (cfg.newProcessGroup)
+   {
+      flags |= POSIX_SPAWN_SETPGROUP;
+      error = posix_spawnattr_setpgroup(&attr, 0);
+   }
+#ifdef POSIX_SPAWN_SETSID
+   if (cfg.newSession)
+   {
+      flags |= POSIX_SPAWN_SETSID;
+   }
+#else
+   if (cfg.newSession)
+   {
+      error = ENOTSUP;
+   }
+#endif
+
+   if (error == 0)
+      error = posix_spawnattr_setsigmask(&attr, &blocked);
+   if (error == 0)
+      error = posix_spawnattr_setsigdefault(&attr, &defaults);
+   if (error == 0)
+      error = posix_spawnattr_setflags(&attr, flags);
+
+   if (error == 0)
+   {
+      char *const *const env = (envp != nullptr) ? envp : environ;
+      error = cfg.searchPath
+         ? posix_spawnp(pid, path, cfg.fileActions, &attr, argv, env)
+         : posix_spawn(pid, path, cfg.fileActions, &attr, argv, env);
+   }
+
+   posix_spawnattr_destroy(&attr);
+
+   if (error != 0)
+   {
+      errno = error;
+      return false;
+   }
+   return true;
+}
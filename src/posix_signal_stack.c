@@ -0,0 +1,355 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_stack.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signal_threads.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// Pages checked per mincore() call.
+static constexpr unsigned S_MINCORE_BATCH = 256u;
+
+// Faults this far below the stack pointer are still attributed to it (large frames, alloca, ...).
+static constexpr uintptr_t S_FRAME_SLACK = 64u * 1024u;
+
+static uintptr_t s_pageSize = 4096u;
+
+// Set while the SIGSEGV callbacks run for a stack overflow.
+static thread_local PSigStackOverflow s_current = {};
+static thread_local bool s_inOverflow = false;
+
+static atomic_uint_fast64_t s_overflowCount = 0u;
+
+static uint64_t s_samplePeriodNs = 0u;
+static bool s_samplerStarted = false;
+static pthread_t s_sampler;
+static sem_t s_samplerSem;
+static atomic_bool s_samplerStop = false;
+
+static pthread_mutex_t s_peakMutex = PTHREAD_MUTEX_INITIALIZER;
+static size_t s_peakHighWater = 0u;
+static size_t s_peakStackSize = 0u;
+static atomic_uint_fast64_t s_samplesCount = 0u;
+
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Overflow
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool is_overflow(PSigThreadInfo const *const self, uintptr_t const fault, uintptr_t const sp)
+{
+   if (self->stackAddr == nullptr)
+      return false;
+
+   uintptr_t const low = (uintptr_t)self->stackAddr;
+   uintptr_t const guard = (self->guardSize > s_pageSize) ? self->guardSize : s_pageSize;
+   uintptr_t const floor = (low > guard) ? low - guard : 0u;
+
+   // Touching the guard region, or the bottom page right above it.
+   if (fault >= floor && fault < low + s_pageSize)
+      return true;
+
+   // A frame larger than the guard region jumped over it.
+   return sp != 0u && sp < low + s_pageSize && sp + S_FRAME_SLACK > low
+      && fault < sp + s_pageSize && fault + S_FRAME_SLACK >= sp;
+}
+
+static void reset_to_default(void)
+{
+   struct sigaction sa = {};
+   sigemptyset(&sa.sa_mask);
+   sa.sa_handler = SIG_DFL;
+   sigaction(SIGSEGV, &sa, nullptr);
+}
+
+static void sigsegv_handler(siginfo_t *const info, void *const context)
+{
+   PSigThreadInfo self;
+
+   // Only faults raised by the kernel (si_code > 0) carry a meaningful address.
+   if (info == nullptr || info->si_code <= 0 || !psignal_threads_internal_self(&self))
+   {
+      psignal_callback_internal_forward(PSignal_SIGSEGV, info);
+      return;
+   }
+
+   uintptr_t const fault = (uintptr_t)info->si_addr;
+   uintptr_t const sp = psignal_internal_context_sp(context);
+   if (!is_overflow(&self, fault, sp))
+   {
+      psignal_callback_internal_forward(PSignal_SIGSEGV, info);
+      return;
+   }
+
+   uintptr_t const high = (uintptr_t)self.stackAddr + self.stackSize;
+   uintptr_t const deepest = (sp != 0u && sp < fault) ? sp : fault;
+   s_current = (PSigStackOverflow) {
+      .tid = self.tid,
+      .userData = self.userData,
+      .faultAddress = info->si_addr,
+      .depth = (deepest < high) ? (size_t)(high - deepest) : 0u,
+      .stackSize = self.stackSize,
+      .guardSize = self.guardSize
+   };
+   atomic_fetch_add(&s_overflowCount, 1u);
+
+   s_inOverflow = true;
+   psignal_callback_internal_forward(PSignal_SIGSEGV, info);
+   s_inOverflow = false;
+
+   // Resuming faults again, this time with the default action.
+   reset_to_default();
+}
+
+
+//------------------------------------------------------------------------------------------------
+// High-water mark
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool is_resident(uintptr_t const page)
+{
+   unsigned char vec = 0u;
+   return mincore((void *)page, s_pageSize, &vec) == 0 && (vec & 1u) != 0u;
+}
+
+/*
+   Stacks grow down: the lowest resident page gives the high-water mark. Unmapped ranges (the
+   main thread stack isn't mapped up to its limit) fail mincore() as a whole and are checked page
+   by page.
+*/
+[[nodiscard]]
+static size_t measure_high_water(void *const stackAddr, size_t const stackSize)
+{
+   uintptr_t const low = (uintptr_t)stackAddr & ~(s_pageSize - 1u);
+   uintptr_t const high = (uintptr_t)stackAddr + stackSize;
+   if (stackAddr == nullptr || high <= low)
+      return 0u;
+
+   unsigned char vec[S_MINCORE_BATCH];
+   for (uintptr_t page = low; page < high; page += (uintptr_t)S_MINCORE_BATCH * s_pageSize)
+   {
+      size_t const remaining = (size_t)((high - page + s_pageSize - 1u) / s_pageSize);
+      size_t const count = (remaining < S_MINCORE_BATCH) ? remaining : S_MINCORE_BATCH;
+
+      if (mincore((void *)page, count * s_pageSize, vec) != 0)
+      {
+         if (errno != ENOMEM)
+            return 0u;
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            uintptr_t const current = page + i * s_pageSize;
+            if (is_resident(current))
+               return (size_t)(high - current);
+         }
+         continue;
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         if ((vec[i] & 1u) != 0u)
+            return (size_t)(high - (page + i * s_pageSize));
+      }
+   }
+
+   return 0u;
+}
+
+typedef struct UsageVisit
+{
+   PSigStackVisitor visitor;
+   void *arg;
+} UsageVisit;
+
+static void visit_usage(PSigThreadInfo const *const thread, void *const arg)
+{
+   UsageVisit const *const visit = arg;
+
+   PSigStackUsage const usage = (PSigStackUsage) {
+      .tid = thread->tid,
+      .userData = thread->userData,
+      .stackSize = thread->stackSize,
+      .highWater = measure_high_water(thread->stackAddr, thread->stackSize)
+   };
+   visit->visitor(&usage, visit->arg);
+}
+
+static void keep_peak(PSigStackUsage const *const usage, void *const arg)
+{
+   pthread_mutex_lock(&s_peakMutex);
+   if (usage->highWater > s_peakHighWater)
+   {
+      s_peakHighWater = usage->highWater;
+      s_peakStackSize = usage->stackSize;
+   }
+   pthread_mutex_unlock(&s_peakMutex);
+}
+
+static void *sampler_main(void *const arg)
+{
+   struct timespec deadline;
+   clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+   while (!atomic_load(&s_samplerStop))
+   {
+      uint64_t const ns = (uint64_t)deadline.tv_nsec + s_samplePeriodNs;
+      deadline.tv_sec += (time_t)(ns / 1000000000u);
+      deadline.tv_nsec = (long)(ns % 1000000000u);
+
+      // Posted at shutdown only.
+      if (sem_clockwait(&s_samplerSem, CLOCK_MONOTONIC, &deadline) == 0 || errno != ETIMEDOUT)
+         continue;
+
+      psignal_stack_for_each(&keep_peak, nullptr);
+      atomic_fetch_add(&s_samplesCount, 1u);
+   }
+
+   return nullptr;
+}
+
+[[nodiscard]]
+static bool start_sampler(void)
+{
+   if (sem_init(&s_samplerSem, 0, 0u) != 0)
+      return false;
+
+   atomic_store(&s_samplerStop, false);
+   if (pthread_create(&s_sampler, nullptr, &sampler_main, nullptr) != 0)
+   {
+      sem_destroy(&s_samplerSem);
+      return false;
+   }
+
+   s_samplerStarted = true;
+   return true;
+}
+
+static void stop_sampler(void)
+{
+   if (!s_samplerStarted)
+      return;
+
+   atomic_store(&s_samplerStop, true);
+   sem_post(&s_samplerSem);
+   pthread_join(s_sampler, nullptr);
+   sem_destroy(&s_samplerSem);
+   s_samplerStarted = false;
+}
+
+
+// The sampler thread doesn't exist in a forked child, overflows are still detected there.
+static void forget_after_fork(void)
+{
+   s_samplerStarted = false;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_stack_init(PSigStackConfig const *const config)
+{
+   if (psignal_stack_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   long const pageSize = sysconf(_SC_PAGESIZE);
+   if (pageSize > 0)
+   {
+      s_pageSize = (uintptr_t)pageSize;
+   }
+
+   s_samplePeriodNs = (config != nullptr) ? config->samplePeriodNs : 0u;
+
+   if (!psignal_callback_internal_claim_forwarding(PSignal_SIGSEGV, &sigsegv_handler))
+      return false;
+
+   if (s_samplePeriodNs != 0u && !start_sampler())
+   {
+      psignal_callback_internal_release(PSignal_SIGSEGV);
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_stack_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_stack_shutdown(void)
+{
+   if (!psignal_stack_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   stop_sampler();
+   psignal_callback_internal_release(PSignal_SIGSEGV);
+}
+
+bool psignal_stack_overflow_current(PSigStackOverflow *const out)
+{
+   if (!s_inOverflow)
+      return false;
+
+   *out = s_current;
+   return true;
+}
+
+uint64_t psignal_stack_overflow_count(void)
+{
+   return atomic_load(&s_overflowCount);
+}
+
+void psignal_stack_for_each(PSigStackVisitor const visitor, void *const arg)
+{
+   UsageVisit visit = (UsageVisit) { .visitor = visitor, .arg = arg };
+   psignal_threads_for_each(&visit_usage, &visit);
+}
+
+size_t psignal_stack_peak_high_water(size_t *const stackSize)
+{
+   pthread_mutex_lock(&s_peakMutex);
+   size_t const peak = s_peakHighWater;
+   if (stackSize != nullptr)
+   {
+      *stackSize = s_peakStackSize;
+   }
+   pthread_mutex_unlock(&s_peakMutex);
+   return peak;
+}
+
+uint64_t psignal_stack_samples_count(void)
+{
+   return atomic_load(&s_samplesCount);
+}
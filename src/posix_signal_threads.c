@@ -0,0 +1,747 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_threads.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signal_masks.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+typedef struct ThreadSlot
+{
+   pthread_t thread;
+   pid_t tid;
+   void *userData;
+   _Atomic(void *) ucontext;
+   void *stackAddr;
+   size_t stackSize;
+   size_t guardSize;
+   void *altStack; // Installed at registration, owned by the slot.
+   bool used;
+} ThreadSlot;
+
+/*
+   What a registered thread is asked to do when it receives the reserved signal.
+   A pointer to a structure starting with the request kind is carried in si_value.
+*/
+typedef enum ThreadRequest : unsigned char
+{
+     ThreadRequest_STOP_THE_WORLD
+   , ThreadRequest_BROADCAST
+} ThreadRequest;
+
+typedef struct BroadcastSlot
+{
+   ThreadRequest kind; // Must stay first.
+   PSigBroadcastFn fn;
+   PSigBroadcastFn onComplete;
+   void *arg;
+   atomic_uint pending;
+   atomic_uint generation; // Bumped when the broadcast completes.
+   atomic_bool used;
+} BroadcastSlot;
+
+static constexpr ThreadRequest S_WORLD_REQUEST = ThreadRequest_STOP_THE_WORLD;
+
+// Large enough for the internal handlers walking the stack (backtrace, ...).
+static constexpr size_t S_ALT_STACK_SIZE = 64u * 1024u;
+
+// Slots never move, so that a thread can keep a pointer to its own slot.
+static ThreadSlot s_slots[PSIG_THREADS_MAX_CAPACITY] = {};
+static unsigned s_slotsHighWater = 0u;
+static unsigned s_registeredCount = 0u;
+static pthread_mutex_t s_registryMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t s_exitKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t s_exitKey;
+
+static thread_local ThreadSlot *s_selfSlot = nullptr;
+// Set while the calling thread holds the registry, so that visitors can be used within a stop
+// the world.
+static thread_local bool s_registryOwned = false;
+
+static PSignal s_signal;
+static atomic_bool s_running = false;
+
+static atomic_uint s_worldEpoch = 0u;
+static atomic_uint s_releasedEpoch = 0u;
+static atomic_uint s_parkedCount = 0u;
+static atomic_uint s_parkTarget = 0u;
+
+static BroadcastSlot s_broadcasts[PSIG_BROADCASTS_MAX_IN_FLIGHT] = {};
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Futex
+//------------------------------------------------------------------------------------------------
+
+static void futex_wait(atomic_uint *const addr, unsigned const expected)
+{
+   syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake_all(atomic_uint *const addr)
+{
+   syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Registry
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static bool registry_lock(void)
+{
+   if (s_registryOwned)
+      return false;
+
+   pthread_mutex_lock(&s_registryMutex);
+   s_registryOwned = true;
+   return true;
+}
+
+static void registry_unlock(bool const acquired)
+{
+   if (acquired)
+   {
+      s_registryOwned = false;
+      pthread_mutex_unlock(&s_registryMutex);
+   }
+}
+
+static void release_slot(ThreadSlot *const slot)
+{
+   assert(slot->used);
+
+   // Always released by the thread owning the slot, its alternate stack can be disabled.
+   if (slot->altStack != nullptr)
+   {
+      stack_t const disabled = (stack_t) { .ss_flags = SS_DISABLE };
+      sigaltstack(&disabled, nullptr);
+      free(slot->altStack);
+   }
+   psignal_arena_internal_thread_detach();
+
+   *slot = (ThreadSlot) {};
+   s_registeredCount -= 1u;
+
+   while (s_slotsHighWater > 0u && !s_slots[s_slotsHighWater - 1u].used)
+   {
+      s_slotsHighWater -= 1u;
+   }
+}
+
+static void drain_pending_requests(void);
+
+// Called at thread exit for threads that didn't unregister themselves.
+static void on_thread_exit(void *const value)
+{
+   bool const acquired = registry_lock();
+   ThreadSlot *const slot = value;
+   if (slot->used)
+   {
+      release_slot(slot);
+   }
+   registry_unlock(acquired);
+
+   s_selfSlot = nullptr;
+   drain_pending_requests();
+}
+
+// Only the forking thread exists in a child, it keeps its registration.
+static void forget_after_fork(void)
+{
+   pthread_mutex_init(&s_registryMutex, nullptr);
+   s_registryOwned = false;
+
+   for (unsigned i = 0; i < s_slotsHighWater; ++i)
+   {
+      if (s_slots[i].used && &s_slots[i] != s_selfSlot)
+      {
+         // Their alternate stacks and arenas belong to threads that don't exist anymore.
+         s_slots[i] = (ThreadSlot) {};
+         s_registeredCount -= 1u;
+      }
+   }
+   while (s_slotsHighWater > 0u && !s_slots[s_slotsHighWater - 1u].used)
+   {
+      s_slotsHighWater -= 1u;
+   }
+
+   if (s_selfSlot != nullptr)
+   {
+      s_selfSlot->thread = pthread_self();
+      s_selfSlot->tid = gettid();
+   }
+
+   if (psignal_threads_is_running())
+   {
+      atomic_store(&s_running, false);
+      psignal_callback_internal_release(s_signal);
+   }
+}
+
+static void create_exit_key(void)
+{
+   pthread_key_create(&s_exitKey, &on_thread_exit);
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+}
+
+static void record_stack(ThreadSlot *const slot)
+{
+   pthread_attr_t attr;
+   if (pthread_getattr_np(pthread_self(), &attr) != 0)
+      return;
+
+   void *addr = nullptr;
+   size_t size = 0u;
+   size_t guard = 0u;
+   if (pthread_attr_getstack(&attr, &addr, &size) == 0)
+   {
+      slot->stackAddr = addr;
+      slot->stackSize = size;
+   }
+   if (pthread_attr_getguardsize(&attr, &guard) == 0)
+   {
+      slot->guardSize = guard;
+   }
+   pthread_attr_destroy(&attr);
+}
+
+// Without an alternate stack, a stack overflow kills the thread before any handler can run.
+static void install_alt_stack(ThreadSlot *const slot)
+{
+   stack_t current;
+   if (sigaltstack(nullptr, &current) != 0 || (current.ss_flags & SS_DISABLE) == 0)
+      return;
+
+   void *const buffer = malloc(S_ALT_STACK_SIZE);
+   if (buffer == nullptr)
+      return;
+
+   stack_t const stack = (stack_t) {
+      .ss_sp = buffer,
+      .ss_size = S_ALT_STACK_SIZE,
+      .ss_flags = 0
+   };
+
+   if (sigaltstack(&stack, nullptr) == 0)
+      slot->altStack = buffer;
+   else
+      free(buffer);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Stop the world
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static inline bool epoch_reached(unsigned const current, unsigned const epoch)
+{
+   return (int)(current - epoch) >= 0;
+}
+
+static void park_thread(ThreadSlot *const self, void *const context)
+{
+   // Only one stop the world at a time, and it can't end before this thread is parked.
+   unsigned const epoch = atomic_load(&s_worldEpoch);
+
+   atomic_store(&self->ucontext, context);
+   if (atomic_fetch_add(&s_parkedCount, 1u) + 1u == atomic_load(&s_parkTarget))
+   {
+      futex_wake_all(&s_parkedCount);
+   }
+
+   unsigned released = atomic_load(&s_releasedEpoch);
+   while (!epoch_reached(released, epoch))
+   {
+      futex_wait(&s_releasedEpoch, released);
+      released = atomic_load(&s_releasedEpoch);
+   }
+
+   atomic_store(&self->ucontext, nullptr);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Broadcast
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static inline PSigBroadcastId broadcast_id(BroadcastSlot const *const slot, unsigned const generation)
+{
+   uint64_t const index = (uint64_t)(slot - s_broadcasts) + 1u;
+   return ((uint64_t)generation << 32) | index;
+}
+
+[[nodiscard]]
+static BroadcastSlot *alloc_broadcast(void)
+{
+   for (unsigned i = 0; i < PSIG_BROADCASTS_MAX_IN_FLIGHT; ++i)
+   {
+      bool expected = false;
+      if (atomic_compare_exchange_strong(&s_broadcasts[i].used, &expected, true))
+      {
+         return &s_broadcasts[i];
+      }
+   }
+   return nullptr;
+}
+
+// Async-signal-safe: the last thread to acknowledge completes the broadcast from its handler.
+static void release_broadcast_ref(BroadcastSlot *const slot)
+{
+   if (atomic_fetch_sub(&slot->pending, 1u) != 1u)
+      return;
+
+   if (slot->onComplete != nullptr)
+   {
+      slot->onComplete(slot->arg);
+   }
+
+   atomic_fetch_add(&slot->generation, 1u);
+   atomic_store(&slot->used, false);
+   futex_wake_all(&slot->generation);
+}
+
+static void run_broadcast(BroadcastSlot *const slot)
+{
+   slot->fn(slot->arg);
+   release_broadcast_ref(slot);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Signal
+//------------------------------------------------------------------------------------------------
+
+/*
+   The request is only read through the pointer if this process queued it (pthread_sigqueue) and
+   it is one of ours: anyone with our uid can sigqueue the reserved signal with any value.
+*/
+[[nodiscard]]
+static ThreadRequest const *trusted_request(siginfo_t const *const info)
+{
+   if (info == nullptr || info->si_code != SI_QUEUE || info->si_pid != getpid())
+      return nullptr;
+
+   void const *const ptr = info->si_value.sival_ptr;
+   if (ptr == &S_WORLD_REQUEST)
+      return &S_WORLD_REQUEST;
+
+   uintptr_t const address = (uintptr_t)ptr;
+   uintptr_t const first = (uintptr_t)&s_broadcasts[0];
+   if (address < first || address >= (uintptr_t)&s_broadcasts[PSIG_BROADCASTS_MAX_IN_FLIGHT]
+      || (address - first) % sizeof(BroadcastSlot) != 0u)
+      return nullptr;
+
+   BroadcastSlot const *const slot = &s_broadcasts[(address - first) / sizeof(BroadcastSlot)];
+   return atomic_load(&slot->used) ? &slot->kind : nullptr;
+}
+
+static void handle_request(siginfo_t const *const info, void *const context)
+{
+   ThreadRequest const *const request = trusted_request(info);
+   if (request == nullptr)
+      return;
+
+   switch (*request)
+   {
+      case ThreadRequest_STOP_THE_WORLD:
+         // Can't be pending on an unregistered thread: unregistering waits for the stop the world.
+         if (s_selfSlot != nullptr)
+         {
+            park_thread(s_selfSlot, context);
+         }
+         break;
+
+      case ThreadRequest_BROADCAST:
+         // Always served, the broadcast waits for this thread's acknowledgement.
+         run_broadcast((BroadcastSlot *)request);
+         break;
+   }
+}
+
+static void threads_signal_handler(siginfo_t *const info, void *const context)
+{
+   handle_request(info, context);
+}
+
+/*
+   A request may still be queued for a thread that just left the registry. Pending
+   thread-directed signals are discarded when a thread exits, which would leave a broadcast
+   waiting forever, so they are drained right away.
+*/
+static void drain_pending_requests(void)
+{
+   if (!psignal_threads_is_running())
+      return;
+
+   PSignalMask const mask = psignal_mask_of(s_signal);
+   PSigMaskScope scope;
+   if (!psignal_mask_block(mask, &scope))
+      return;
+
+   sigset_t set;
+   psignal_mask_to_sigset(mask, &set);
+   siginfo_t info;
+   struct timespec const noWait = {};
+   while (sigtimedwait(&set, &info, &noWait) > 0)
+   {
+      handle_request(&info, nullptr);
+   }
+
+   psignal_mask_restore(&scope);
+}
+
+[[nodiscard]]
+static bool send_request(ThreadSlot const *const slot, ThreadRequest const *const request)
+{
+   union sigval const value = { .sival_ptr = (void *)request };
+   return pthread_sigqueue(slot->thread, psignal_to_raw_signal(s_signal), value) == 0;
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_threads_init(void)
+{
+   if (psignal_threads_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   if (!psignal_callback_internal_reserve(&threads_signal_handler, &s_signal))
+      return false;
+
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_threads_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_threads_shutdown(void)
+{
+   if (!psignal_threads_is_running())
+      return;
+
+   // Waits for a stop the world in progress.
+   bool const acquired = registry_lock();
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+   registry_unlock(acquired);
+}
+
+PSignal psignal_threads_signal(void)
+{
+   return s_signal;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Registry
+//------------------------------------------------------------------------------------------------
+
+bool psignal_thread_register(void *const userData)
+{
+   pthread_once(&s_exitKeyOnce, &create_exit_key);
+
+   bool const acquired = registry_lock();
+
+   if (s_selfSlot != nullptr)
+   {
+      s_selfSlot->userData = userData;
+      registry_unlock(acquired);
+      return true;
+   }
+
+   ThreadSlot *slot = nullptr;
+   for (unsigned i = 0; i < PSIG_THREADS_MAX_CAPACITY; ++i)
+   {
+      if (!s_slots[i].used)
+      {
+         slot = &s_slots[i];
+         break;
+      }
+   }
+
+   if (slot == nullptr)
+   {
+      registry_unlock(acquired);
+      return false;
+   }
+
+   slot->thread = pthread_self();
+   slot->tid = gettid();
+   slot->userData = userData;
+   atomic_store(&slot->ucontext, nullptr);
+   record_stack(slot);
+   install_alt_stack(slot);
+   psignal_arena_internal_thread_attach();
+   slot->used = true;
+
+   unsigned const idx = (unsigned)(slot - s_slots);
+   if (idx >= s_slotsHighWater)
+   {
+      s_slotsHighWater = idx + 1u;
+   }
+   s_registeredCount += 1u;
+
+   s_selfSlot = slot;
+   pthread_setspecific(s_exitKey, slot);
+
+   registry_unlock(acquired);
+   return true;
+}
+
+void psignal_thread_unregister(void)
+{
+   if (s_selfSlot == nullptr)
+      return;
+
+   bool const acquired = registry_lock();
+   release_slot(s_selfSlot);
+   s_selfSlot = nullptr;
+   pthread_setspecific(s_exitKey, nullptr);
+   registry_unlock(acquired);
+
+   drain_pending_requests();
+}
+
+bool psignal_thread_is_registered(void)
+{
+   return s_selfSlot != nullptr;
+}
+
+unsigned psignal_threads_registered_count(void)
+{
+   bool const acquired = registry_lock();
+   unsigned const count = s_registeredCount;
+   registry_unlock(acquired);
+   return count;
+}
+
+void psignal_threads_for_each(PSigThreadVisitor const visitor, void *const arg)
+{
+   bool const acquired = registry_lock();
+
+   for (unsigned i = 0; i < s_slotsHighWater; ++i)
+   {
+      ThreadSlot const *const slot = &s_slots[i];
+      if (!slot->used)
+         continue;
+
+      PSigThreadInfo const info = (PSigThreadInfo) {
+         .thread = slot->thread,
+         .tid = slot->tid,
+         .userData = slot->userData,
+         .ucontext = atomic_load(&slot->ucontext),
+         .stackAddr = slot->stackAddr,
+         .stackSize = slot->stackSize,
+         .guardSize = slot->guardSize
+      };
+      visitor(&info, arg);
+   }
+
+   registry_unlock(acquired);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Internal
+//------------------------------------------------------------------------------------------------
+
+bool psignal_threads_internal_self(PSigThreadInfo *const out)
+{
+   ThreadSlot const *const slot = s_selfSlot;
+   if (slot == nullptr)
+      return false;
+
+   *out = (PSigThreadInfo) {
+      .thread = slot->thread,
+      .tid = slot->tid,
+      .userData = slot->userData,
+      .stackAddr = slot->stackAddr,
+      .stackSize = slot->stackSize,
+      .guardSize = slot->guardSize
+   };
+   return true;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Stop the world
+//------------------------------------------------------------------------------------------------
+
+bool psignal_threads_stop_the_world(PSigThreadsWorldFn const fn, void *const arg)
+{
+   if (fn == nullptr || !psignal_threads_is_running())
+      return false;
+
+   // Can't be nested.
+   bool const acquired = registry_lock();
+   if (!acquired)
+      return false;
+
+   unsigned const epoch = atomic_load(&s_worldEpoch) + 1u;
+   atomic_store(&s_worldEpoch, epoch);
+   atomic_store(&s_parkedCount, 0u);
+   // No parked thread can match the target before every thread has been signalled.
+   atomic_store(&s_parkTarget, UINT_MAX);
+
+   unsigned sent = 0u;
+   bool allSent = true;
+   for (unsigned i = 0; i < s_slotsHighWater; ++i)
+   {
+      ThreadSlot const *const slot = &s_slots[i];
+      if (!slot->used || slot == s_selfSlot)
+         continue;
+
+      if (send_request(slot, &S_WORLD_REQUEST))
+         sent += 1u;
+      else
+         allSent = false;
+   }
+   atomic_store(&s_parkTarget, sent);
+
+   unsigned parked = atomic_load(&s_parkedCount);
+   while (parked < sent)
+   {
+      futex_wait(&s_parkedCount, parked);
+      parked = atomic_load(&s_parkedCount);
+   }
+
+   if (allSent)
+   {
+      fn(arg);
+   }
+
+   atomic_store(&s_releasedEpoch, epoch);
+   futex_wake_all(&s_releasedEpoch);
+
+   registry_unlock(acquired);
+   return allSent;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Broadcast
+//------------------------------------------------------------------------------------------------
+
+bool psignal_broadcast_call(PSigBroadcastFn const fn, void *const arg)
+{
+   PSigBroadcastId id;
+   if (!psignal_broadcast_call_async(fn, arg, nullptr, &id))
+   {
+      if (id != PSIG_BROADCAST_INVALID_ID)
+      {
+         psignal_broadcast_wait(id);
+      }
+      return false;
+   }
+
+   psignal_broadcast_wait(id);
+   return true;
+}
+
+bool psignal_broadcast_call_async(PSigBroadcastFn const fn, void *const arg, PSigBroadcastFn const onComplete, PSigBroadcastId *const out)
+{
+   *out = PSIG_BROADCAST_INVALID_ID;
+
+   if (fn == nullptr || !psignal_threads_is_running())
+      return false;
+
+   BroadcastSlot *const slot = alloc_broadcast();
+   if (slot == nullptr)
+      return false;
+
+   slot->kind = ThreadRequest_BROADCAST;
+   slot->fn = fn;
+   slot->onComplete = onComplete;
+   slot->arg = arg;
+   // The caller holds a reference until every thread has been signalled.
+   atomic_store(&slot->pending, 1u);
+
+   unsigned const generation = atomic_load(&slot->generation);
+   *out = broadcast_id(slot, generation);
+
+   bool const acquired = registry_lock();
+
+   bool allSent = true;
+   for (unsigned i = 0; i < s_slotsHighWater; ++i)
+   {
+      ThreadSlot const *const thread = &s_slots[i];
+      if (!thread->used || thread == s_selfSlot)
+         continue;
+
+      atomic_fetch_add(&slot->pending, 1u);
+      if (!send_request(thread, &slot->kind))
+      {
+         atomic_fetch_sub(&slot->pending, 1u);
+         allSent = false;
+      }
+   }
+
+   registry_unlock(acquired);
+
+   // The caller is served directly, from its normal context.
+   if (s_selfSlot != nullptr)
+   {
+      fn(arg);
+   }
+
+   release_broadcast_ref(slot);
+   return allSent;
+}
+
+bool psignal_broadcast_is_done(PSigBroadcastId const id)
+{
+   uint64_t const index = (id & UINT32_MAX);
+   if (index == 0u || index > PSIG_BROADCASTS_MAX_IN_FLIGHT)
+      return true;
+
+   return atomic_load(&s_broadcasts[index - 1u].generation) != (unsigned)(id >> 32);
+}
+
+void psignal_broadcast_wait(PSigBroadcastId const id)
+{
+   uint64_t const index = (id & UINT32_MAX);
+   if (index == 0u || index > PSIG_BROADCASTS_MAX_IN_FLIGHT)
+      return;
+
+   BroadcastSlot *const slot = &s_broadcasts[index - 1u];
+   unsigned const generation = (unsigned)(id >> 32);
+   while (atomic_load(&slot->generation) == generation)
+   {
+      futex_wait(&slot->generation, generation);
+   }
+}
@@ -0,0 +1,890 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_timers.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+/*
+   Hierarchical timer wheel: 4 levels of 64 slots.
+   Level L holds the timers expiring in [64^L, 64^(L+1)) ticks from now. When the lower level
+   wraps around, the matching slot of the upper level is cascaded (re-inserted) one level down.
+   Deadlines further than 64^4 ticks are clamped and re-inserted when reached.
+*/
+static constexpr unsigned WHEEL_LEVELS    = 4u;
+static constexpr unsigned WHEEL_SLOT_BITS = 6u;
+static constexpr unsigned WHEEL_SLOTS     = 1u << WHEEL_SLOT_BITS;
+static constexpr uint64_t WHEEL_MAX_DELTA = (1ull << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) - 1u;
+static constexpr uint64_t NO_TICK         = UINT64_MAX;
+
+// Slot occupancy is tracked in a 64 bits word.
+static_assert(WHEEL_SLOTS == 64);
+
+// Pseudo level of the nodes detached from a level 0 slot and about to be fired.
+static constexpr unsigned char EXPIRING_LEVEL = WHEEL_LEVELS;
+
+typedef struct TimerNode TimerNode;
+struct TimerNode
+{
+   TimerNode *wheelPrev;
+   TimerNode *wheelNext;
+   TimerNode *queuePrev;
+   TimerNode *queueNext; // Also used to chain free nodes.
+
+   uint64_t expiryTick;
+   uint64_t intervalTicks;
+   uint64_t queuedDeadlineNs;
+   uint64_t queuedFiredNs;
+
+   PSigTimerCallback callback;
+   void *userData;
+
+   uint32_t generation;
+   PSigTimerDelivery delivery;
+   bool allocated;
+   bool inWheel;
+   bool queued;
+   unsigned char level;
+   unsigned char slot;
+};
+
+typedef struct WheelLevel
+{
+   TimerNode *slots[WHEEL_SLOTS];
+   uint64_t occupied;
+} WheelLevel;
+
+static WheelLevel s_wheel[WHEEL_LEVELS] = {};
+static TimerNode *s_expiring = nullptr;
+static uint64_t s_currentTick = 0u; // Next tick to be processed.
+static uint64_t s_armedTick   = NO_TICK;
+static uint64_t s_epochNs     = 0u;
+static uint64_t s_resolutionNs = PSIG_TIMERS_DEFAULT_RESOLUTION_NS;
+
+static TimerNode *s_nodes    = nullptr;
+static unsigned   s_capacity = 0u;
+static TimerNode *s_freeList = nullptr;
+
+static TimerNode *s_queueHead = nullptr;
+static TimerNode *s_queueTail = nullptr;
+
+static timer_t   s_posixTimer;
+static PSignal   s_signal;
+static pthread_t s_thread;
+static sem_t     s_threadSem;
+static atomic_bool s_threadStop = false;
+
+/*
+   The wheel is shared between user threads and the signal handler, so it is guarded by a
+   spinlock that the handler only ever try-locks. When the handler can't get it, it flags the
+   tick as pending and whoever owns the lock processes it on release.
+*/
+static atomic_flag s_lock = ATOMIC_FLAG_INIT;
+static atomic_bool s_tickPending = false;
+static atomic_bool s_running = false;
+static thread_local bool s_lockOwned = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+//------------------------------------------------------------------------------------------------
+// Time
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+[[nodiscard]]
+static inline uint64_t ns_to_tick_floor(uint64_t const ns)
+{
+   return (ns - s_epochNs) / s_resolutionNs;
+}
+
+[[nodiscard]]
+static inline uint64_t ns_to_tick_ceil(uint64_t const ns)
+{
+   return (ns - s_epochNs + s_resolutionNs - 1u) / s_resolutionNs;
+}
+
+[[nodiscard]]
+static inline uint64_t tick_to_ns(uint64_t const tick)
+{
+   return s_epochNs + tick * s_resolutionNs;
+}
+
+[[nodiscard]]
+static inline uint64_t delay_to_ticks(uint64_t const delayNs)
+{
+   return (delayNs + s_resolutionNs - 1u) / s_resolutionNs;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Lock
+//------------------------------------------------------------------------------------------------
+
+static void drain_pending_tick(void);
+
+// Returns false when the current thread already owns the lock (timer callback in handler mode).
+[[nodiscard]]
+static bool wheel_lock(void)
+{
+   if (s_lockOwned)
+      return false;
+
+   while (atomic_flag_test_and_set_explicit(&s_lock, memory_order_acquire))
+   {
+      sched_yield();
+   }
+   s_lockOwned = true;
+   return true;
+}
+
+[[nodiscard]]
+static bool wheel_try_lock(void)
+{
+   if (s_lockOwned || atomic_flag_test_and_set_explicit(&s_lock, memory_order_acquire))
+      return false;
+
+   s_lockOwned = true;
+   return true;
+}
+
+static void wheel_unlock_raw(void)
+{
+   s_lockOwned = false;
+   atomic_flag_clear_explicit(&s_lock, memory_order_release);
+}
+
+static void wheel_unlock(bool const acquired)
+{
+   if (acquired)
+   {
+      wheel_unlock_raw();
+      drain_pending_tick();
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Handles
+//------------------------------------------------------------------------------------------------
+
+[[nodiscard]]
+static inline PSigTimerId node_id(TimerNode const *const node)
+{
+   uint64_t const index = (uint64_t)(node - s_nodes) + 1u;
+   return ((uint64_t)node->generation << 32) | index;
+}
+
+[[nodiscard]]
+static TimerNode *node_from_id(PSigTimerId const id)
+{
+   uint64_t const index = (id & UINT32_MAX);
+   if (index == 0u || index > s_capacity)
+      return nullptr;
+
+   TimerNode *const node = &s_nodes[index - 1u];
+   return (node->allocated && node->generation == (uint32_t)(id >> 32)) ? node : nullptr;
+}
+
+[[nodiscard]]
+static TimerNode *alloc_node(void)
+{
+   TimerNode *const node = s_freeList;
+   if (node != nullptr)
+   {
+      s_freeList = node->queueNext;
+      node->queueNext = nullptr;
+      node->allocated = true;
+   }
+   return node;
+}
+
+static void free_node(TimerNode *const node)
+{
+   assert(!node->inWheel && !node->queued);
+
+   node->allocated = false;
+   node->generation += 1u;
+   node->callback = nullptr;
+   node->userData = nullptr;
+   node->queueNext = s_freeList;
+   s_freeList = node;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Timer wheel
+//------------------------------------------------------------------------------------------------
+
+static void wheel_insert(TimerNode *const node)
+{
+   assert(!node->inWheel);
+
+   uint64_t tick = (node->expiryTick < s_currentTick) ? s_currentTick : node->expiryTick;
+   if (tick - s_currentTick > WHEEL_MAX_DELTA)
+   {
+      tick = s_currentTick + WHEEL_MAX_DELTA;
+   }
+
+   uint64_t const delta = tick - s_currentTick;
+   unsigned level = 0u;
+   while (level + 1u < WHEEL_LEVELS && delta >= (1ull << ((level + 1u) * WHEEL_SLOT_BITS)))
+   {
+      level += 1u;
+   }
+
+   unsigned const slot = (tick >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1u);
+   WheelLevel *const wl = &s_wheel[level];
+
+   node->level = level;
+   node->slot = slot;
+   node->wheelPrev = nullptr;
+   node->wheelNext = wl->slots[slot];
+   if (node->wheelNext != nullptr)
+   {
+      node->wheelNext->wheelPrev = node;
+   }
+   wl->slots[slot] = node;
+   wl->occupied |= (1ull << slot);
+   node->inWheel = true;
+}
+
+static void wheel_remove(TimerNode *const node)
+{
+   assert(node->inWheel);
+
+   bool const expiring = (node->level == EXPIRING_LEVEL);
+   TimerNode **const head = expiring ? &s_expiring : &s_wheel[node->level].slots[node->slot];
+
+   if (node->wheelPrev != nullptr)
+   {
+      node->wheelPrev->wheelNext = node->wheelNext;
+   }
+   else
+   {
+      *head = node->wheelNext;
+   }
+
+   if (node->wheelNext != nullptr)
+   {
+      node->wheelNext->wheelPrev = node->wheelPrev;
+   }
+
+   if (!expiring && *head == nullptr)
+   {
+      s_wheel[node->level].occupied &= ~(1ull << node->slot);
+   }
+
+   node->wheelPrev = nullptr;
+   node->wheelNext = nullptr;
+   node->inWheel = false;
+}
+
+[[nodiscard]]
+static TimerNode *wheel_detach_slot(unsigned const level, unsigned const slot)
+{
+   WheelLevel *const wl = &s_wheel[level];
+   TimerNode *const head = wl->slots[slot];
+
+   wl->slots[slot] = nullptr;
+   wl->occupied &= ~(1ull << slot);
+
+   for (TimerNode *node = head; node != nullptr; node = node->wheelNext)
+   {
+      node->inWheel = false;
+   }
+   return head;
+}
+
+/*
+   Moves a level 0 slot into the expiring list. Its nodes stay "in the wheel" so that a callback
+   cancelling or rearming a timer that is about to fire within the same tick unlinks it safely.
+*/
+static void wheel_move_slot_to_expiring(unsigned const slot)
+{
+   assert(s_expiring == nullptr);
+
+   WheelLevel *const wl = &s_wheel[0];
+   s_expiring = wl->slots[slot];
+   wl->slots[slot] = nullptr;
+   wl->occupied &= ~(1ull << slot);
+
+   for (TimerNode *node = s_expiring; node != nullptr; node = node->wheelNext)
+   {
+      node->level = EXPIRING_LEVEL;
+   }
+}
+
+/*
+   Returns the next tick at which something has to be done: either a level 0 slot to fire or an
+   upper slot to cascade. Only the occupancy words are looked at.
+*/
+[[nodiscard]]
+static uint64_t wheel_next_event_tick(void)
+{
+   uint64_t next = NO_TICK;
+
+   for (unsigned level = 0u; level < WHEEL_LEVELS; ++level)
+   {
+      uint64_t const occupied = s_wheel[level].occupied;
+      if (occupied == 0u)
+         continue;
+
+      unsigned const shift = level * WHEEL_SLOT_BITS;
+      unsigned const curIdx = (s_currentTick >> shift) & (WHEEL_SLOTS - 1u);
+      uint64_t const rotated = (occupied >> curIdx) | (occupied << ((WHEEL_SLOTS - curIdx) & (WHEEL_SLOTS - 1u)));
+      unsigned const slot = (curIdx + (unsigned)__builtin_ctzll(rotated)) & (WHEEL_SLOTS - 1u);
+
+      uint64_t tick;
+      if (level == 0u)
+      {
+         tick = s_currentTick + ((slot - curIdx) & (WHEEL_SLOTS - 1u));
+      }
+      else
+      {
+         uint64_t const period = 1ull << (shift + WHEEL_SLOT_BITS);
+         tick = (s_currentTick & ~(period - 1u)) | ((uint64_t)slot << shift);
+         if (tick < s_currentTick)
+         {
+            tick += period;
+         }
+      }
+
+      if (tick < next)
+      {
+         next = tick;
+      }
+   }
+
+   return next;
+}
+
+static void program_posix_timer(void)
+{
+   uint64_t const next = wheel_next_event_tick();
+   if (next == s_armedTick)
+      return;
+
+   struct itimerspec spec = {};
+   if (next != NO_TICK)
+   {
+      uint64_t const ns = tick_to_ns(next);
+      spec.it_value.tv_sec = (time_t)(ns / 1000000000u);
+      spec.it_value.tv_nsec = (long)(ns % 1000000000u);
+   }
+
+   s_armedTick = next;
+   timer_settime(s_posixTimer, TIMER_ABSTIME, &spec, nullptr);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Deferred delivery queue
+//------------------------------------------------------------------------------------------------
+
+static void queue_push(TimerNode *const node)
+{
+   assert(!node->queued);
+
+   node->queueNext = nullptr;
+   node->queuePrev = s_queueTail;
+   if (s_queueTail != nullptr)
+   {
+      s_queueTail->queueNext = node;
+   }
+   else
+   {
+      s_queueHead = node;
+   }
+   s_queueTail = node;
+   node->queued = true;
+}
+
+static void queue_remove(TimerNode *const node)
+{
+   assert(node->queued);
+
+   if (node->queuePrev != nullptr)
+      node->queuePrev->queueNext = node->queueNext;
+   else
+      s_queueHead = node->queueNext;
+
+   if (node->queueNext != nullptr)
+      node->queueNext->queuePrev = node->queuePrev;
+   else
+      s_queueTail = node->queuePrev;
+
+   node->queuePrev = nullptr;
+   node->queueNext = nullptr;
+   node->queued = false;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Expiration
+//------------------------------------------------------------------------------------------------
+
+static void fire_node(TimerNode *const node, uint64_t const tick, uint64_t const firedNs)
+{
+   uint64_t const deadlineNs = tick_to_ns(node->expiryTick);
+
+   if (node->intervalTicks != 0u)
+   {
+      // Missed periods are dropped rather than delivered in a burst.
+      node->expiryTick += node->intervalTicks;
+      if (node->expiryTick <= tick)
+      {
+         node->expiryTick = tick + node->intervalTicks;
+      }
+      wheel_insert(node);
+   }
+
+   if (node->delivery == PSigTimerDelivery_DEFERRED)
+   {
+      if (!node->queued)
+      {
+         node->queuedDeadlineNs = deadlineNs;
+         node->queuedFiredNs = firedNs;
+         queue_push(node);
+         sem_post(&s_threadSem);
+      }
+      return;
+   }
+
+   uint32_t const generation = node->generation;
+   PSigTimerInfo const info = (PSigTimerInfo) {
+      .id = node_id(node),
+      .userData = node->userData,
+      .deadlineNs = deadlineNs,
+      .firedNs = firedNs
+   };
+   node->callback(&info);
+
+   // The callback may have cancelled or rearmed its own timer.
+   if (node->allocated && node->generation == generation && !node->inWheel && !node->queued)
+   {
+      free_node(node);
+   }
+}
+
+static void process_tick(uint64_t const tick, uint64_t const firedNs)
+{
+   s_currentTick = tick;
+
+   // Upper levels first, so that a cascade can feed the level right below it.
+   for (unsigned level = WHEEL_LEVELS - 1u; level > 0u; --level)
+   {
+      unsigned const shift = level * WHEEL_SLOT_BITS;
+      if ((tick & ((1ull << shift) - 1u)) != 0u)
+         continue;
+
+      unsigned const slot = (tick >> shift) & (WHEEL_SLOTS - 1u);
+      TimerNode *node = wheel_detach_slot(level, slot);
+      while (node != nullptr)
+      {
+         TimerNode *const next = node->wheelNext;
+         wheel_insert(node);
+         node = next;
+      }
+   }
+
+   wheel_move_slot_to_expiring(tick & (WHEEL_SLOTS - 1u));
+
+   // Anything added from now on (including by the callbacks) belongs to the next ticks.
+   s_currentTick = tick + 1u;
+
+   while (s_expiring != nullptr)
+   {
+      TimerNode *const node = s_expiring;
+      wheel_remove(node);
+
+      if (node->expiryTick > tick)
+      {
+         // Clamped deadline, not reached yet.
+         wheel_insert(node);
+      }
+      else
+      {
+         fire_node(node, tick, firedNs);
+      }
+   }
+}
+
+static void advance_wheel(void)
+{
+   uint64_t const firedNs = now_ns();
+   uint64_t const nowTick = ns_to_tick_floor(firedNs);
+
+   // Once its deadline is reached, the POSIX timer is spent and doesn't need to be disarmed.
+   if (s_armedTick <= nowTick)
+   {
+      s_armedTick = NO_TICK;
+   }
+
+   for (uint64_t tick = wheel_next_event_tick(); tick <= nowTick; tick = wheel_next_event_tick())
+   {
+      process_tick(tick, firedNs);
+   }
+
+   if (s_currentTick <= nowTick)
+   {
+      s_currentTick = nowTick + 1u;
+   }
+
+   program_posix_timer();
+}
+
+static void drain_pending_tick(void)
+{
+   while (atomic_load(&s_tickPending) && wheel_try_lock())
+   {
+      atomic_store(&s_tickPending, false);
+      if (atomic_load(&s_running))
+      {
+         advance_wheel();
+      }
+      wheel_unlock_raw();
+   }
+}
+
+static void timers_signal_handler(siginfo_t *const info, void *const context)
+{
+   atomic_store(&s_tickPending, true);
+   drain_pending_tick();
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Deferred delivery thread
+//------------------------------------------------------------------------------------------------
+
+static void *timers_thread_main(void *const arg)
+{
+   while (true)
+   {
+      while (sem_wait(&s_threadSem) != 0 && errno == EINTR) {}
+
+      if (atomic_load(&s_threadStop))
+         break;
+
+      bool const acquired = wheel_lock();
+      TimerNode *const node = s_queueHead;
+      if (node == nullptr)
+      {
+         wheel_unlock(acquired);
+         continue;
+      }
+
+      queue_remove(node);
+      uint32_t const generation = node->generation;
+      PSigTimerCallback const callback = node->callback;
+      PSigTimerInfo const info = (PSigTimerInfo) {
+         .id = node_id(node),
+         .userData = node->userData,
+         .deadlineNs = node->queuedDeadlineNs,
+         .firedNs = node->queuedFiredNs
+      };
+      wheel_unlock(acquired);
+
+      callback(&info);
+
+      bool const reacquired = wheel_lock();
+      if (node->allocated && node->generation == generation && !node->inWheel && !node->queued)
+      {
+         free_node(node);
+      }
+      wheel_unlock(reacquired);
+   }
+
+   return nullptr;
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Setup
+//------------------------------------------------------------------------------------------------
+
+static void reset_state(void)
+{
+   for (unsigned level = 0u; level < WHEEL_LEVELS; ++level)
+   {
+      s_wheel[level] = (WheelLevel) {};
+   }
+
+   free(s_nodes);
+   s_nodes = nullptr;
+   s_capacity = 0u;
+   s_freeList = nullptr;
+   s_queueHead = nullptr;
+   s_queueTail = nullptr;
+   s_expiring = nullptr;
+   s_currentTick = 0u;
+   s_armedTick = NO_TICK;
+   atomic_store(&s_tickPending, false);
+}
+
+[[nodiscard]]
+static bool setup_nodes(unsigned const capacity)
+{
+   s_nodes = calloc(capacity, sizeof(*s_nodes));
+   if (s_nodes == nullptr)
+      return false;
+
+   s_capacity = capacity;
+   for (unsigned i = capacity; i-- > 0;)
+   {
+      s_nodes[i].generation = 1u;
+      s_nodes[i].queueNext = s_freeList;
+      s_freeList = &s_nodes[i];
+   }
+   return true;
+}
+
+[[nodiscard]]
+static bool setup_posix_timer(void)
+{
+   struct sigevent sev = {};
+   sev.sigev_notify = SIGEV_SIGNAL;
+   sev.sigev_signo = psignal_to_raw_signal(s_signal);
+
+   return timer_create(CLOCK_MONOTONIC, &sev, &s_posixTimer) == 0;
+}
+
+[[nodiscard]]
+static uint64_t arm_node(TimerNode *const node, uint64_t const delayNs)
+{
+   node->expiryTick = ns_to_tick_ceil(now_ns() + delayNs);
+   if (node->expiryTick < s_currentTick)
+   {
+      node->expiryTick = s_currentTick;
+   }
+   wheel_insert(node);
+   return node->expiryTick;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, nor does the POSIX timer. The timers
+   armed by the parent are dropped, and the wheel lock may have been held by a lost thread.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_timers_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+
+   wheel_unlock_raw();
+   reset_state();
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_timers_init(PSigTimersConfig const *const config)
+{
+   if (psignal_timers_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   unsigned const capacity = (config != nullptr) ? config->capacity : PSIG_TIMERS_DEFAULT_CAPACITY;
+   uint64_t const resolution = (config != nullptr) ? config->resolutionNs : PSIG_TIMERS_DEFAULT_RESOLUTION_NS;
+   if (capacity == 0u || capacity >= UINT32_MAX || resolution == 0u)
+      return false;
+
+   if (!psignal_callback_internal_reserve(&timers_signal_handler, &s_signal))
+      return false;
+
+   s_resolutionNs = resolution;
+   s_epochNs = now_ns();
+
+   if (!setup_nodes(capacity))
+   {
+      psignal_callback_internal_release(s_signal);
+      return false;
+   }
+
+   if (sem_init(&s_threadSem, 0, 0) != 0)
+   {
+      reset_state();
+      psignal_callback_internal_release(s_signal);
+      return false;
+   }
+
+   if (!setup_posix_timer())
+   {
+      sem_destroy(&s_threadSem);
+      reset_state();
+      psignal_callback_internal_release(s_signal);
+      return false;
+   }
+
+   atomic_store(&s_threadStop, false);
+   if (pthread_create(&s_thread, nullptr, &timers_thread_main, nullptr) != 0)
+   {
+      timer_delete(s_posixTimer);
+      sem_destroy(&s_threadSem);
+      reset_state();
+      psignal_callback_internal_release(s_signal);
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_timers_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_timers_shutdown(void)
+{
+   if (!psignal_timers_is_running())
+      return;
+
+   // From now on, a late signal won't touch the wheel anymore.
+   bool const acquired = wheel_lock();
+   atomic_store(&s_running, false);
+   wheel_unlock(acquired);
+
+   timer_delete(s_posixTimer);
+
+   atomic_store(&s_threadStop, true);
+   sem_post(&s_threadSem);
+   pthread_join(s_thread, nullptr);
+   sem_destroy(&s_threadSem);
+
+   psignal_callback_internal_release(s_signal);
+   reset_state();
+}
+
+PSignal psignal_timers_signal(void)
+{
+   return s_signal;
+}
+
+bool psignal_timer_add(PSigTimerSpec const *const spec, PSigTimerId *const out)
+{
+   if (spec == nullptr || spec->callback == nullptr || !psignal_timers_is_running())
+      return false;
+
+   if (spec->delivery != PSigTimerDelivery_HANDLER && spec->delivery != PSigTimerDelivery_DEFERRED)
+      return false;
+
+   bool const acquired = wheel_lock();
+
+   TimerNode *const node = alloc_node();
+   if (node == nullptr)
+   {
+      wheel_unlock(acquired);
+      return false;
+   }
+
+   node->callback = spec->callback;
+   node->userData = spec->userData;
+   node->delivery = spec->delivery;
+   node->intervalTicks = (spec->intervalNs != 0u) ? delay_to_ticks(spec->intervalNs) : 0u;
+   if (spec->intervalNs != 0u && node->intervalTicks == 0u)
+   {
+      node->intervalTicks = 1u;
+   }
+
+   if (arm_node(node, spec->delayNs) < s_armedTick)
+   {
+      program_posix_timer();
+   }
+
+   if (out != nullptr)
+   {
+      *out = node_id(node);
+   }
+
+   wheel_unlock(acquired);
+   return true;
+}
+
+bool psignal_timer_cancel(PSigTimerId const id)
+{
+   if (!psignal_timers_is_running())
+      return false;
+
+   bool const acquired = wheel_lock();
+
+   TimerNode *const node = node_from_id(id);
+   if (node == nullptr)
+   {
+      wheel_unlock(acquired);
+      return false;
+   }
+
+   if (node->inWheel)
+      wheel_remove(node);
+   if (node->queued)
+      queue_remove(node);
+
+   // The POSIX timer is left as is: an early wake-up is cheaper than a syscall per cancel.
+   free_node(node);
+
+   wheel_unlock(acquired);
+   return true;
+}
+
+bool psignal_timer_rearm(PSigTimerId const id, uint64_t const delayNs)
+{
+   if (!psignal_timers_is_running())
+      return false;
+
+   bool const acquired = wheel_lock();
+
+   TimerNode *const node = node_from_id(id);
+   if (node == nullptr)
+   {
+      wheel_unlock(acquired);
+      return false;
+   }
+
+   if (node->inWheel)
+      wheel_remove(node);
+   if (node->queued)
+      queue_remove(node);
+
+   if (arm_node(node, delayNs) < s_armedTick)
+   {
+      program_posix_timer();
+   }
+
+   wheel_unlock(acquired);
+   return true;
+}
@@ -0,0 +1,248 @@
+#define _GNU_SOURCE
+
+#include "../src/internal.h"
+
+#include <fenv.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+#if defined(__aarch64__)
+// Mirrors the kernel's fpsimd_context record, found in the reserved area of the mcontext.
+typedef struct FpsimdRecord
+{
+   uint32_t magic;
+   uint32_t size;
+   uint32_t fpsr;
+   uint32_t fpcr;
+} FpsimdRecord;
+
+static constexpr uint32_t FPSIMD_RECORD_MAGIC = 0x46508001u;
+
+[[nodiscard]]
+static FpsimdRecord *find_fpsimd_record(ucontext_t *const uc)
+{
+   unsigned char *const reserved = (unsigned char *)uc->uc_mcontext.__reserved;
+   for (size_t offset = 0u; offset + sizeof(FpsimdRecord) <= sizeof(uc->uc_mcontext.__reserved);)
+   {
+      FpsimdRecord *const record = (FpsimdRecord *)(reserved + offset);
+      if (record->magic == FPSIMD_RECORD_MAGIC)
+         return record;
+      if (record->magic == 0u || record->size == 0u)
+         break;
+      offset += record->size;
+   }
+   return nullptr;
+}
+#endif
+
+
+//================================================================================================
+// Internal API Functions
+//================================================================================================
+
+uintptr_t psignal_internal_context_pc(void const *const ucontext)
+{
+   if (ucontext == nullptr)
+      return 0u;
+
+   ucontext_t const *const uc = ucontext;
+#if defined(__x86_64__)
+   return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+   return (uintptr_t)uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+   return (uintptr_t)uc->uc_mcontext.pc;
+#else
+   (void)uc;
+   return 0u;
+#endif
+}
+
+uintptr_t psignal_internal_context_sp(void const *const ucontext)
+{
+   if (ucontext == nullptr)
+      return 0u;
+
+   ucontext_t const *const uc = ucontext;
+#if defined(__x86_64__)
+   return (uintptr_t)uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__i386__)
+   return (uintptr_t)uc->uc_mcontext.gregs[REG_ESP];
+#elif defined(__aarch64__)
+   return (uintptr_t)uc->uc_mcontext.sp;
+#else
+   (void)uc;
+   return 0u;
+#endif
+}
+
+bool psignal_internal_context_syscall_args(void const *const ucontext, long args[6])
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t const *const uc = ucontext;
+#if defined(__x86_64__)
+   greg_t const *const regs = uc->uc_mcontext.gregs;
+   args[0] = (long)regs[REG_RDI];
+   args[1] = (long)regs[REG_RSI];
+   args[2] = (long)regs[REG_RDX];
+   args[3] = (long)regs[REG_R10];
+   args[4] = (long)regs[REG_R8];
+   args[5] = (long)regs[REG_R9];
+   return true;
+#elif defined(__i386__)
+   greg_t const *const regs = uc->uc_mcontext.gregs;
+   args[0] = (long)regs[REG_EBX];
+   args[1] = (long)regs[REG_ECX];
+   args[2] = (long)regs[REG_EDX];
+   args[3] = (long)regs[REG_ESI];
+   args[4] = (long)regs[REG_EDI];
+   args[5] = (long)regs[REG_EBP];
+   return true;
+#elif defined(__aarch64__)
+   for (unsigned i = 0; i < 6u; ++i)
+   {
+      args[i] = (long)uc->uc_mcontext.regs[i];
+   }
+   return true;
+#else
+   (void)uc;
+   (void)args;
+   return false;
+#endif
+}
+
+bool psignal_internal_context_set_syscall_result(void *const ucontext, long const result)
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t *const uc = ucontext;
+#if defined(__x86_64__)
+   uc->uc_mcontext.gregs[REG_RAX] = (greg_t)result;
+   return true;
+#elif defined(__i386__)
+   uc->uc_mcontext.gregs[REG_EAX] = (greg_t)result;
+   return true;
+#elif defined(__aarch64__)
+   uc->uc_mcontext.regs[0] = (unsigned long long)result;
+   return true;
+#else
+   (void)uc;
+   (void)result;
+   return false;
+#endif
+}
+
+/*
+   The floating point environment restored with the context. On x86_64 the exception flags and
+   trap masks are the ones of SSE (MXCSR, mask bits 7 to 12) and of the x87 unit. On aarch64, the
+   trap enable bits of FPCR start at bit 8 and the flags are in FPSR.
+*/
+bool psignal_internal_context_fpe_mask(void *const ucontext, int const excepts)
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t *const uc = ucontext;
+   unsigned const bits = (unsigned)excepts & FE_ALL_EXCEPT;
+#if defined(__x86_64__)
+   if (uc->uc_mcontext.fpregs == nullptr)
+      return false;
+   uc->uc_mcontext.fpregs->mxcsr = (uc->uc_mcontext.fpregs->mxcsr | (bits << 7)) & ~bits;
+   uc->uc_mcontext.fpregs->cwd |= (unsigned short)bits;
+   uc->uc_mcontext.fpregs->swd &= (unsigned short)~bits;
+   return true;
+#elif defined(__aarch64__)
+   FpsimdRecord *const record = find_fpsimd_record(uc);
+   if (record == nullptr)
+      return false;
+   record->fpcr &= ~(bits << 8);
+   record->fpsr &= ~bits;
+   return true;
+#else
+   (void)uc;
+   (void)bits;
+   return false;
+#endif
+}
+
+bool psignal_internal_context_fpe_unmask(void *const ucontext, int const excepts)
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t *const uc = ucontext;
+   unsigned const bits = (unsigned)excepts & FE_ALL_EXCEPT;
+#if defined(__x86_64__)
+   if (uc->uc_mcontext.fpregs == nullptr)
+      return false;
+   uc->uc_mcontext.fpregs->mxcsr &= ~((bits << 7) | bits);
+   uc->uc_mcontext.fpregs->cwd &= (unsigned short)~bits;
+   uc->uc_mcontext.fpregs->swd &= (unsigned short)~bits;
+   return true;
+#elif defined(__aarch64__)
+   FpsimdRecord *const record = find_fpsimd_record(uc);
+   if (record == nullptr)
+      return false;
+   record->fpcr |= (bits << 8);
+   record->fpsr &= ~bits;
+   return true;
+#else
+   (void)uc;
+   (void)bits;
+   return false;
+#endif
+}
+
+bool psignal_internal_context_single_step(void *const ucontext, bool const enable)
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t *const uc = ucontext;
+#if defined(__x86_64__)
+   // EFLAGS.TF: a SIGTRAP is raised after the next instruction.
+   greg_t const trapFlag = 0x100;
+   uc->uc_mcontext.gregs[REG_EFL] = enable
+      ? (uc->uc_mcontext.gregs[REG_EFL] | trapFlag)
+      : (uc->uc_mcontext.gregs[REG_EFL] & ~trapFlag);
+   return true;
+#else
+   (void)uc;
+   (void)enable;
+   return false;
+#endif
+}
+
+bool psignal_internal_context_redirect(void *const ucontext, void (*const entry)(void *), void *const arg,
+   void *const stackTop)
+{
+   if (ucontext == nullptr)
+      return false;
+
+   ucontext_t *const uc = ucontext;
+   uintptr_t const top = (uintptr_t)stackTop & ~(uintptr_t)15u;
+#if defined(__x86_64__)
+   // Entered with a null return address pushed, the stack being 16 bytes aligned before the call.
+   uintptr_t *const sp = (uintptr_t *)top - 1;
+   *sp = 0u;
+   uc->uc_mcontext.gregs[REG_RSP] = (greg_t)sp;
+   uc->uc_mcontext.gregs[REG_RIP] = (greg_t)entry;
+   uc->uc_mcontext.gregs[REG_RDI] = (greg_t)arg;
+   return true;
+#elif defined(__aarch64__)
+   uc->uc_mcontext.sp = top;
+   uc->uc_mcontext.pc = (uintptr_t)entry;
+   uc->uc_mcontext.regs[0] = (uintptr_t)arg;
+   uc->uc_mcontext.regs[30] = 0u;
+   return true;
+#else
+   (void)uc;
+   (void)entry;
+   (void)arg;
+   (void)top;
+   return false;
+#endif
+}
@@ -0,0 +1,493 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_watchdog.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+// How long the monitor waits for a stalled thread to capture its own stack.
+static constexpr uint64_t CAPTURE_TIMEOUT_NS = 50000000u; // 50ms
+static constexpr uint64_t CAPTURE_POLL_NS    = 100000u;   // 100us
+
+// Heartbeats are even numbers, the low bit flags an idle thread.
+static constexpr uint64_t BEAT_IDLE_BIT = 1u;
+
+typedef struct WatchedSlot
+{
+   // Written by the monitored thread.
+   _Atomic(uint64_t) beat;
+
+   // Set at registration.
+   pthread_t thread;
+   pid_t tid;
+   uint64_t deadlineNs;
+
+   // Monitor thread only.
+   uint64_t lastBeat;
+   uint64_t lastChangeNs;
+   bool reported;
+
+   // Stack capture handshake, frames are written by the handler of the monitored thread.
+   atomic_uint captureRequest;
+   atomic_uint captureDone;
+   unsigned frameCount;
+   void *frames[PSIG_WATCHDOG_MAX_FRAMES];
+
+   bool used;
+} WatchedSlot;
+
+// A stall found by the monitor, reported once the registry is unlocked.
+typedef struct Stall
+{
+   WatchedSlot *slot;
+   pthread_t thread;
+   pid_t tid;
+   uint64_t deadlineNs;
+   uint64_t stalledNs;
+} Stall;
+
+static WatchedSlot s_slots[PSIG_WATCHDOG_MAX_THREADS] = {};
+static unsigned s_slotsHighWater = 0u;
+static pthread_mutex_t s_slotsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t s_exitKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t s_exitKey;
+
+static thread_local WatchedSlot *s_self = nullptr;
+static thread_local uint64_t s_localBeat = 0u;
+
+static PSigWatchdogConfig s_config = {};
+static PSignal s_signal;
+static pthread_t s_monitor;
+static atomic_bool s_monitorStop = false;
+static atomic_bool s_running = false;
+static atomic_uint_fast64_t s_stallCount = 0u;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t const ns)
+{
+   struct timespec const ts = {
+      .tv_sec = (time_t)(ns / 1000000000u),
+      .tv_nsec = (long)(ns % 1000000000u)
+   };
+   nanosleep(&ts, nullptr);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Registry
+//------------------------------------------------------------------------------------------------
+
+static void release_slot(WatchedSlot *const slot)
+{
+   slot->used = false;
+   while (s_slotsHighWater > 0u && !s_slots[s_slotsHighWater - 1u].used)
+   {
+      s_slotsHighWater -= 1u;
+   }
+}
+
+// Called at thread exit for threads that didn't unregister themselves.
+static void on_thread_exit(void *const value)
+{
+   pthread_mutex_lock(&s_slotsMutex);
+   WatchedSlot *const slot = value;
+   if (slot->used)
+   {
+      release_slot(slot);
+   }
+   pthread_mutex_unlock(&s_slotsMutex);
+
+   s_self = nullptr;
+}
+
+static void create_exit_key(void)
+{
+   pthread_key_create(&s_exitKey, &on_thread_exit);
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Stack capture
+//------------------------------------------------------------------------------------------------
+
+static void watchdog_signal_handler(siginfo_t *const info, void *const context)
+{
+   // Only the monitor of this process asks for a capture, anyone with our uid can queue signals.
+   WatchedSlot *const self = s_self;
+   if (self == nullptr || info == nullptr || info->si_code != SI_QUEUE || info->si_pid != getpid())
+      return;
+
+   // backtrace() has been warmed up at init, it doesn't allocate anymore.
+   int count = backtrace(self->frames, (int)PSIG_WATCHDOG_MAX_FRAMES);
+
+   // Drop the handler frames: the interrupted frame starts at the interrupted PC.
+   uintptr_t const pc = psignal_internal_context_pc(context);
+   for (int i = 0; i < count && pc != 0u; ++i)
+   {
+      uintptr_t const frame = (uintptr_t)self->frames[i];
+      if (frame == pc || frame == pc + 1u)
+      {
+         memmove(&self->frames[0], &self->frames[i], (size_t)(count - i) * sizeof(self->frames[0]));
+         count -= i;
+         break;
+      }
+   }
+
+   self->frameCount = (count > 0) ? (unsigned)count : 0u;
+   atomic_store(&self->captureDone, (unsigned)info->si_value.sival_int);
+}
+
+/*
+   Runs without the registry lock: the thread may have unregistered, even exited, meanwhile. It is
+   reached by its tid rather than its pthread_t, and then simply never answers.
+*/
+[[nodiscard]]
+static bool capture_stack(Stall const *const stall)
+{
+   WatchedSlot *const slot = stall->slot;
+   unsigned const request = atomic_load(&slot->captureRequest) + 1u;
+   atomic_store(&slot->captureRequest, request);
+
+   int const sig = psignal_to_raw_signal(s_signal);
+   siginfo_t info = {};
+   info.si_signo = sig;
+   info.si_code = SI_QUEUE;
+   info.si_pid = getpid();
+   info.si_uid = getuid();
+   info.si_value.sival_int = (int)request;
+   if (syscall(SYS_rt_tgsigqueueinfo, getpid(), stall->tid, sig, &info) != 0)
+      return false;
+
+   for (uint64_t waited = 0u; waited < CAPTURE_TIMEOUT_NS; waited += CAPTURE_POLL_NS)
+   {
+      if (atomic_load(&slot->captureDone) == request)
+         return true;
+      sleep_ns(CAPTURE_POLL_NS);
+   }
+   return atomic_load(&slot->captureDone) == request;
+}
+
+static void print_report(PSigWatchdogReport const *const report, void *const arg)
+{
+   fprintf(stderr, "WATCHDOG - Thread %i stalled for %.1fms (deadline %.1fms).\n",
+      (int)report->tid, report->stalledNs / 1000000.0, report->deadlineNs / 1000000.0
+   );
+   if (report->frameCount > 0u)
+   {
+      backtrace_symbols_fd(report->frames, (int)report->frameCount, STDERR_FILENO);
+   }
+   else
+   {
+      fprintf(stderr, "WATCHDOG - Stack couldn't be captured.\n");
+   }
+}
+
+static void report_stall(Stall const *const stall)
+{
+   void *frames[PSIG_WATCHDOG_MAX_FRAMES];
+   unsigned frameCount = 0u;
+   if (capture_stack(stall))
+   {
+      frameCount = stall->slot->frameCount;
+      memcpy(frames, stall->slot->frames, frameCount * sizeof(frames[0]));
+   }
+
+   PSigWatchdogReport const report = (PSigWatchdogReport) {
+      .thread = stall->thread,
+      .tid = stall->tid,
+      .deadlineNs = stall->deadlineNs,
+      .stalledNs = stall->stalledNs,
+      .frames = frames,
+      .frameCount = frameCount
+   };
+
+   atomic_fetch_add(&s_stallCount, 1u);
+
+   if (s_config.reporter != nullptr)
+   {
+      s_config.reporter(&report, s_config.reporterArg);
+   }
+   else
+   {
+      print_report(&report, nullptr);
+   }
+}
+
+
+//------------------------------------------------------------------------------------------------
+// Monitor
+//------------------------------------------------------------------------------------------------
+
+// s_slotsMutex must be held.
+[[nodiscard]]
+static bool check_slot(WatchedSlot *const slot, uint64_t const now, Stall *const stall)
+{
+   uint64_t const beat = atomic_load_explicit(&slot->beat, memory_order_relaxed);
+   if (beat != slot->lastBeat)
+   {
+      slot->lastBeat = beat;
+      slot->lastChangeNs = now;
+      slot->reported = false;
+      return false;
+   }
+
+   if ((beat & BEAT_IDLE_BIT) != 0u || slot->reported)
+      return false;
+
+   uint64_t const stalledNs = now - slot->lastChangeNs;
+   if (stalledNs <= slot->deadlineNs)
+      return false;
+
+   // Reported once per stall.
+   slot->reported = true;
+   *stall = (Stall) {
+      .slot = slot,
+      .thread = slot->thread,
+      .tid = slot->tid,
+      .deadlineNs = slot->deadlineNs,
+      .stalledNs = stalledNs
+   };
+   return true;
+}
+
+// Checks the slots from *next on, up to the first stall found.
+[[nodiscard]]
+static bool find_stall(unsigned *const next, uint64_t const now, Stall *const stall)
+{
+   pthread_mutex_lock(&s_slotsMutex);
+   bool found = false;
+   while (*next < s_slotsHighWater && !found)
+   {
+      WatchedSlot *const slot = &s_slots[(*next)++];
+      found = slot->used && check_slot(slot, now, stall);
+   }
+   pthread_mutex_unlock(&s_slotsMutex);
+   return found;
+}
+
+static void *monitor_main(void *const arg)
+{
+   while (!atomic_load(&s_monitorStop))
+   {
+      sleep_ns(s_config.checkIntervalNs);
+
+      uint64_t const now = now_ns();
+
+      // Reported unlocked: the capture takes up to CAPTURE_TIMEOUT_NS, and reporters may unregister.
+      unsigned next = 0u;
+      Stall stall;
+      while (find_stall(&next, now, &stall))
+      {
+         report_stall(&stall);
+      }
+   }
+
+   return nullptr;
+}
+
+
+/*
+   The threads of the module don't exist in a forked child, where the registry lock may have been
+   held by the monitor. Only the forking thread stays registered.
+*/
+static void forget_after_fork(void)
+{
+   if (!psignal_watchdog_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_internal_release(s_signal);
+
+   pthread_mutex_init(&s_slotsMutex, nullptr);
+   for (unsigned i = 0; i < s_slotsHighWater; ++i)
+   {
+      if (&s_slots[i] != s_self)
+      {
+         s_slots[i].used = false;
+      }
+   }
+   while (s_slotsHighWater > 0u && !s_slots[s_slotsHighWater - 1u].used)
+   {
+      s_slotsHighWater -= 1u;
+   }
+   if (s_self != nullptr)
+   {
+      s_self->tid = gettid();
+   }
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_watchdog_init(PSigWatchdogConfig const *const config)
+{
+   if (psignal_watchdog_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   s_config = (config != nullptr) ? *config : (PSigWatchdogConfig) {};
+   if (s_config.checkIntervalNs == 0u)
+   {
+      s_config.checkIntervalNs = PSIG_WATCHDOG_DEFAULT_CHECK_INTERVAL_NS;
+   }
+
+   // The first call to backtrace() loads the unwinder, which isn't async-signal-safe.
+   void *warmup[1];
+   backtrace(warmup, 1);
+
+   if (!psignal_callback_internal_reserve(&watchdog_signal_handler, &s_signal))
+      return false;
+
+   atomic_store(&s_monitorStop, false);
+   atomic_store(&s_stallCount, 0u);
+   if (pthread_create(&s_monitor, nullptr, &monitor_main, nullptr) != 0)
+   {
+      psignal_callback_internal_release(s_signal);
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_watchdog_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_watchdog_shutdown(void)
+{
+   if (!psignal_watchdog_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   atomic_store(&s_monitorStop, true);
+   pthread_join(s_monitor, nullptr);
+
+   psignal_callback_internal_release(s_signal);
+}
+
+PSignal psignal_watchdog_signal(void)
+{
+   return s_signal;
+}
+
+bool psignal_watchdog_register(uint64_t const deadlineNs)
+{
+   if (s_self != nullptr || deadlineNs == 0u)
+      return false;
+
+   pthread_once(&s_exitKeyOnce, &create_exit_key);
+
+   pthread_mutex_lock(&s_slotsMutex);
+
+   WatchedSlot *slot = nullptr;
+   for (unsigned i = 0; i < PSIG_WATCHDOG_MAX_THREADS; ++i)
+   {
+      if (!s_slots[i].used)
+      {
+         slot = &s_slots[i];
+         break;
+      }
+   }
+
+   if (slot == nullptr)
+   {
+      pthread_mutex_unlock(&s_slotsMutex);
+      return false;
+   }
+
+   s_localBeat += 2u;
+   atomic_store(&slot->beat, s_localBeat);
+   slot->thread = pthread_self();
+   slot->tid = gettid();
+   slot->deadlineNs = deadlineNs;
+   slot->lastBeat = s_localBeat;
+   slot->lastChangeNs = now_ns();
+   slot->reported = false;
+   slot->frameCount = 0u;
+   slot->used = true;
+
+   unsigned const idx = (unsigned)(slot - s_slots);
+   if (idx >= s_slotsHighWater)
+   {
+      s_slotsHighWater = idx + 1u;
+   }
+
+   s_self = slot;
+   pthread_setspecific(s_exitKey, slot);
+
+   pthread_mutex_unlock(&s_slotsMutex);
+   return true;
+}
+
+void psignal_watchdog_unregister(void)
+{
+   if (s_self == nullptr)
+      return;
+
+   pthread_mutex_lock(&s_slotsMutex);
+   release_slot(s_self);
+   s_self = nullptr;
+   pthread_setspecific(s_exitKey, nullptr);
+   pthread_mutex_unlock(&s_slotsMutex);
+}
+
+void psignal_watchdog_heartbeat(void)
+{
+   WatchedSlot *const self = s_self;
+   if (self != nullptr)
+   {
+      s_localBeat += 2u;
+      atomic_store_explicit(&self->beat, s_localBeat, memory_order_relaxed);
+   }
+}
+
+void psignal_watchdog_idle(void)
+{
+   WatchedSlot *const self = s_self;
+   if (self != nullptr)
+   {
+      atomic_store_explicit(&self->beat, s_localBeat | BEAT_IDLE_BIT, memory_order_relaxed);
+   }
+}
+
+uint64_t psignal_watchdog_stall_count(void)
+{
+   return atomic_load(&s_stallCount);
+}
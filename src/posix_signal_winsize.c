@@ -0,0 +1,185 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/posix_signal_winsize.h"
+#include "libposix_signals/posix_signal_callbacks.h"
+#include "libposix_signals/posix_signal_library.h"
+#include "libposix_signals/posix_signals.h"
+
+#include "../src/internal.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+
+//================================================================================================
+// Internal Data
+//================================================================================================
+
+/*
+   Rows, columns and generation packed in one word: (generation << 32) | (cols << 16) | rows.
+*/
+static _Atomic(uint64_t) s_size = 0u;
+
+static int s_fd = -1;
+static bool s_policySet = false;
+
+static atomic_bool s_running = false;
+
+
+//================================================================================================
+// Internal Functions
+//================================================================================================
+
+[[nodiscard]]
+static uint64_t pack(PSigWinsize const size)
+{
+   return ((uint64_t)size.generation << 32) | ((uint64_t)size.cols << 16) | size.rows;
+}
+
+[[nodiscard]]
+static PSigWinsize unpack(uint64_t const word)
+{
+   return (PSigWinsize) {
+      .rows = (uint16_t)word,
+      .cols = (uint16_t)(word >> 16),
+      .generation = (uint32_t)(word >> 32),
+   };
+}
+
+// Async-signal-safe.
+[[nodiscard]]
+static bool refresh(void)
+{
+   struct winsize ws;
+   if (ioctl(s_fd, TIOCGWINSZ, &ws) != 0)
+      return false;
+
+   // A refresh racing with another one only publishes a size that is actually new.
+   uint64_t current = atomic_load(&s_size);
+   PSigWinsize next;
+   do
+   {
+      next = unpack(current);
+      if (next.rows == ws.ws_row && next.cols == ws.ws_col)
+         return true;
+
+      next.rows = ws.ws_row;
+      next.cols = ws.ws_col;
+      next.generation += 1u;
+   } while (!atomic_compare_exchange_weak(&s_size, &current, pack(next)));
+
+   return true;
+}
+
+static void sigwinch_callback(PSigCallbackInfo const *const info)
+{
+   (void)refresh();
+}
+
+// Keeps the generation going, a renderer can't mistake a size published later for the one it has.
+static void clear_size(void)
+{
+   PSigWinsize const cleared = { .generation = unpack(atomic_load(&s_size)).generation + 1u };
+   atomic_store(&s_size, pack(cleared));
+}
+
+// The user callbacks are reset in a forked child.
+static void forget_after_fork(void)
+{
+   if (!psignal_winsize_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   clear_size();
+}
+
+
+//================================================================================================
+// Public API Functions
+//================================================================================================
+
+bool psignal_winsize_init(PSigWinsizeConfig const *const config)
+{
+   if (psignal_winsize_is_running())
+      return true;
+
+   if (!psignal_library_is_running())
+      return false;
+
+   PSigWinsizeConfig const cfg = (config != nullptr) ? *config : (PSigWinsizeConfig) { .fd = STDOUT_FILENO };
+
+   s_fd = cfg.fd;
+   if (!refresh())
+      return false;
+
+   s_policySet = false;
+   if (cfg.coalesceNs != 0u)
+   {
+      PSigDispatchPolicy const policy = { .mode = PSigDispatchMode_COALESCE, .windowNs = cfg.coalesceNs };
+      if (!psignal_callback_set_policy(PSignal_SIGWINCH, &policy))
+      {
+         clear_size();
+         return false;
+      }
+
+      s_policySet = true;
+   }
+
+   if (!psignal_callback_hook_on_sig(PSignal_SIGWINCH, &sigwinch_callback))
+   {
+      if (s_policySet)
+      {
+         (void)psignal_callback_set_policy(PSignal_SIGWINCH, nullptr);
+      }
+      clear_size();
+      return false;
+   }
+
+   psignal_callback_internal_on_fork_child(&forget_after_fork);
+   atomic_store(&s_running, true);
+   return true;
+}
+
+bool psignal_winsize_is_running(void)
+{
+   return atomic_load(&s_running);
+}
+
+void psignal_winsize_shutdown(void)
+{
+   if (!psignal_winsize_is_running())
+      return;
+
+   atomic_store(&s_running, false);
+   psignal_callback_remove_from_sig(PSignal_SIGWINCH, &sigwinch_callback);
+   if (s_policySet)
+   {
+      (void)psignal_callback_set_policy(PSignal_SIGWINCH, nullptr);
+   }
+   clear_size();
+}
+
+PSigWinsize psignal_winsize_get(void)
+{
+   return unpack(atomic_load_explicit(&s_size, memory_order_relaxed));
+}
+
+bool psignal_winsize_changed(uint32_t *const generation, PSigWinsize *const size)
+{
+   PSigWinsize const current = psignal_winsize_get();
+   if (size != nullptr)
+   {
+      *size = current;
+   }
+
+   bool const changed = (current.generation != *generation);
+   *generation = current.generation;
+   return changed;
+}
+
+bool psignal_winsize_refresh(void)
+{
+   return psignal_winsize_is_running() && refresh();
+}
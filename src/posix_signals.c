@@ -5,7 +5,11 @@
 #include "libmacros/macro_utils.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 
@@ -13,125 +17,310 @@
 // Private Data
 //================================================================================================
 
-struct StdSigProperties
+// Standard signals: X(PSignal, raw signal, description).
+#define CG_STD_SIGNALS(X) \
+   X(PSignal_SIGHUP,    SIGHUP,    "Terminal Hang-Up / Process Death Detected")     \
+   X(PSignal_SIGINT,    SIGINT,    "User Interrupt (Ctrl+C)")                       \
+   X(PSignal_SIGQUIT,   SIGQUIT,   "Quit from keyboard")                            \
+   X(PSignal_SIGILL,    SIGILL,    "Illegal Instruction")                           \
+   X(PSignal_SIGTRAP,   SIGTRAP,   "Trace / Breakpoint trap")                       \
+   X(PSignal_SIGABRT,   SIGABRT,   "Abort signal")                                  \
+   X(PSignal_SIGBUS,    SIGBUS,    "Bus error (bad memory access)")                 \
+   X(PSignal_SIGFPE,    SIGFPE,    "Erroneous arithmetic operation")                \
+   X(PSignal_SIGKILL,   SIGKILL,   "Kill signal")                                   \
+   X(PSignal_SIGUSR1,   SIGUSR1,   "User-defined signal 1")                         \
+   X(PSignal_SIGSEGV,   SIGSEGV,   "Invalid memory reference (Segmentation Fault)") \
+   X(PSignal_SIGUSR2,   SIGUSR2,   "User-defined signal 2")                         \
+   X(PSignal_SIGPIPE,   SIGPIPE,   "Broken pipe: write to pipe with no readers")    \
+   X(PSignal_SIGALRM,   SIGALRM,   "Timer signal")                                  \
+   X(PSignal_SIGTERM,   SIGTERM,   "Termination signal")                            \
+   X(PSignal_SIGSTKFLT, SIGSTKFLT, "Stack fault on coprocessor")                    \
+   X(PSignal_SIGCHLD,   SIGCHLD,   "Child stopped, terminated, or continued")       \
+   X(PSignal_SIGCONT,   SIGCONT,   "Continue if stopped")                           \
+   X(PSignal_SIGSTOP,   SIGSTOP,   "Stop process")                                  \
+   X(PSignal_SIGTSTP,   SIGTSTP,   "Stop typed at terminal")                        \
+   X(PSignal_SIGTTIN,   SIGTTIN,   "Terminal input for background process")         \
+   X(PSignal_SIGTTOU,   SIGTTOU,   "Terminal output for background process")        \
+   X(PSignal_SIGURG,    SIGURG,    "Urgent condition on socket")                    \
+   X(PSignal_SIGXCPU,   SIGXCPU,   "CPU time limit exceeded")                       \
+   X(PSignal_SIGXFSZ,   SIGXFSZ,   "File size limit exceeded")                      \
+   X(PSignal_SIGVTALRM, SIGVTALRM, "Virtual alarm clock")                           \
+   X(PSignal_SIGPROF,   SIGPROF,   "Profiling timer expired")                       \
+   X(PSignal_SIGWINCH,  SIGWINCH,  "Window resize signal")                          \
+   X(PSignal_SIGIO,     SIGIO,     "I/O now possible")                              \
+   X(PSignal_SIGPWR,    SIGPWR,    "Power failure (System V)")                      \
+   X(PSignal_SIGSYS,    SIGSYS,    "Bad system call (SVr4)")
+
+// Real-Time signals: X(PSignal, name, description).
+#define CG_RT_SIGNALS(X) \
+   X(PSignal_SIGRTMIN,     "SIGRTMIN",      "Real-time signal 0")  \
+   X(PSignal_SIGRTMIN_1,   "SIGRTMIN + 1",  "Real-time signal 1")  \
+   X(PSignal_SIGRTMIN_2,   "SIGRTMIN + 2",  "Real-time signal 2")  \
+   X(PSignal_SIGRTMIN_3,   "SIGRTMIN + 3",  "Real-time signal 3")  \
+   X(PSignal_SIGRTMIN_4,   "SIGRTMIN + 4",  "Real-time signal 4")  \
+   X(PSignal_SIGRTMIN_5,   "SIGRTMIN + 5",  "Real-time signal 5")  \
+   X(PSignal_SIGRTMIN_6,   "SIGRTMIN + 6",  "Real-time signal 6")  \
+   X(PSignal_SIGRTMIN_7,   "SIGRTMIN + 7",  "Real-time signal 7")  \
+   X(PSignal_SIGRTMIN_8,   "SIGRTMIN + 8",  "Real-time signal 8")  \
+   X(PSignal_SIGRTMIN_9,   "SIGRTMIN + 9",  "Real-time signal 9")  \
+   X(PSignal_SIGRTMIN_10,  "SIGRTMIN + 10", "Real-time signal 10") \
+   X(PSignal_SIGRTMIN_11,  "SIGRTMIN + 11", "Real-time signal 11") \
+   X(PSignal_SIGRTMIN_12,  "SIGRTMIN + 12", "Real-time signal 12") \
+   X(PSignal_SIGRTMIN_13,  "SIGRTMIN + 13", "Real-time signal 13") \
+   X(PSignal_SIGRTMIN_14,  "SIGRTMIN + 14", "Real-time signal 14") \
+   X(PSignal_SIGRTMIN_15,  "SIGRTMIN + 15", "Real-time signal 15") \
+   X(PSignal_SIGRTMAX_14,  "SIGRTMAX - 14", "Real-time signal 16") \
+   X(PSignal_SIGRTMAX_13,  "SIGRTMAX - 13", "Real-time signal 17") \
+   X(PSignal_SIGRTMAX_12,  "SIGRTMAX - 12", "Real-time signal 18") \
+   X(PSignal_SIGRTMAX_11,  "SIGRTMAX - 11", "Real-time signal 19") \
+   X(PSignal_SIGRTMAX_10,  "SIGRTMAX - 10", "Real-time signal 20") \
+   X(PSignal_SIGRTMAX_9,   "SIGRTMAX - 9",  "Real-time signal 21") \
+   X(PSignal_SIGRTMAX_8,   "SIGRTMAX - 8",  "Real-time signal 22") \
+   X(PSignal_SIGRTMAX_7,   "SIGRTMAX - 7",  "Real-time signal 23") \
+   X(PSignal_SIGRTMAX_6,   "SIGRTMAX - 6",  "Real-time signal 24") \
+   X(PSignal_SIGRTMAX_5,   "SIGRTMAX - 5",  "Real-time signal 25") \
+   X(PSignal_SIGRTMAX_4,   "SIGRTMAX - 4",  "Real-time signal 26") \
+   X(PSignal_SIGRTMAX_3,   "SIGRTMAX - 3",  "Real-time signal 27") \
+   X(PSignal_SIGRTMAX_2,   "SIGRTMAX - 2",  "Real-time signal 28") \
+   X(PSignal_SIGRTMAX_1,   "SIGRTMAX - 1",  "Real-time signal 29") \
+   X(PSignal_SIGRTMAX,     "SIGRTMAX",      "Real-time signal 30")
+
+// Aliases accepted by psignal_from_name: X(name, PSignal).
+#define CG_ALIASES(X)            \
+   X(SIGIOT,    PSignal_SIGABRT) \
+   X(SIGCLD,    PSignal_SIGCHLD) \
+   X(SIGPOLL,   PSignal_SIGIO)   \
+   X(SIGUNUSED, PSignal_SIGSYS)
+
+
+//------------------------------------------------------------------------------------------------
+// Strings
+//------------------------------------------------------------------------------------------------
+
+/*
+   Every name and description is packed in a single blob, referenced by 16 bits offsets. Tables of
+   pointers would each need a relocation at load time in PIE and shared builds, and be spread
+   across more cache lines.
+*/
+#define CG_STD_STRINGS_MEMBERS(pSig, pRaw, pDesc) char name_##pSig[sizeof(#pRaw)]; char desc_##pSig[sizeof(pDesc)];
+#define CG_RT_STRINGS_MEMBERS(pSig, pName, pDesc) char name_##pSig[sizeof(pName)]; char desc_##pSig[sizeof(pDesc)];
+#define CG_ALIAS_STRINGS_MEMBERS(pName, pSig)     char alias_##pName[sizeof(#pName)];
+typedef struct SignalsStrings
+{
+   CG_STD_SIGNALS(CG_STD_STRINGS_MEMBERS)
+   CG_RT_SIGNALS(CG_RT_STRINGS_MEMBERS)
+   CG_ALIASES(CG_ALIAS_STRINGS_MEMBERS)
+} SignalsStrings;
+#undef CG_STD_STRINGS_MEMBERS
+#undef CG_RT_STRINGS_MEMBERS
+#undef CG_ALIAS_STRINGS_MEMBERS
+
+#define CG_STD_STRINGS(pSig, pRaw, pDesc) #pRaw, pDesc,
+#define CG_RT_STRINGS(pSig, pName, pDesc) pName, pDesc,
+#define CG_ALIAS_STRINGS(pName, pSig)     #pName,
+static constexpr SignalsStrings S_STRINGS =
 {
-   int rawSignal;
-   char const *name;
-   char const *desc;
+   CG_STD_SIGNALS(CG_STD_STRINGS)
+   CG_RT_SIGNALS(CG_RT_STRINGS)
+   CG_ALIASES(CG_ALIAS_STRINGS)
 };
-typedef struct StdSigProperties StdSigProperties;
+#undef CG_STD_STRINGS
+#undef CG_RT_STRINGS
+#undef CG_ALIAS_STRINGS
 
-struct RTSigProperties
+static_assert(sizeof(SignalsStrings) <= UINT16_MAX);
+
+typedef struct SigStrings
+{
+   uint16_t name;
+   uint16_t desc;
+} SigStrings;
+
+#define CG_SIG_STRINGS(pSig, pName, pDesc) \
+   [pSig] = (SigStrings) {                  \
+      .name = offsetof(SignalsStrings, name_##pSig), \
+      .desc = offsetof(SignalsStrings, desc_##pSig)  \
+   },
+static constexpr SigStrings S_SIGNALS_STRINGS[] =
 {
-   char const *name;
-   char const *desc;
+   CG_STD_SIGNALS(CG_SIG_STRINGS)
+   CG_RT_SIGNALS(CG_SIG_STRINGS)
 };
-typedef struct RTSigProperties RTSigProperties;
+#undef CG_SIG_STRINGS
 
+static_assert(array_capacity(S_SIGNALS_STRINGS) == PSignal_ENUM_COUNT);
 
-#define CG_STDSIG_PROPS(pSig, pRaw, pDesc)  \
-   [pSig] = (StdSigProperties) { \
-      .rawSignal = pRaw,         \
-      .name = #pRaw,             \
-      .desc = pDesc              \
-   }
-static constexpr StdSigProperties S_STD_SIGNALS_PROPS[] =
-{
-     CG_STDSIG_PROPS(PSignal_SIGHUP,    SIGHUP,    "Terminal Hang-Up / Process Death Detected")
-   , CG_STDSIG_PROPS(PSignal_SIGINT,    SIGINT,    "User Interrupt (Ctrl+C)")
-   , CG_STDSIG_PROPS(PSignal_SIGQUIT,   SIGQUIT,   "Quit from keyboard")
-   , CG_STDSIG_PROPS(PSignal_SIGILL,    SIGILL,    "Illegal Instruction")
-   , CG_STDSIG_PROPS(PSignal_SIGTRAP,   SIGTRAP,   "Trace / Breakpoint trap")
-   , CG_STDSIG_PROPS(PSignal_SIGABRT,   SIGABRT,   "Abort signal")
-   , CG_STDSIG_PROPS(PSignal_SIGBUS,    SIGBUS,    "Bus error (bad memory access)")
-   , CG_STDSIG_PROPS(PSignal_SIGFPE,    SIGFPE,    "Erroneous arithmetic operation")
-   , CG_STDSIG_PROPS(PSignal_SIGKILL,   SIGKILL,   "Kill signal")
-   , CG_STDSIG_PROPS(PSignal_SIGUSR1,   SIGUSR1,   "User-defined signal 1")
-   , CG_STDSIG_PROPS(PSignal_SIGSEGV,   SIGSEGV,   "Invalid memory reference (Segmentation Fault)")
-   , CG_STDSIG_PROPS(PSignal_SIGUSR2,   SIGUSR2,   "User-defined signal 2")
-   , CG_STDSIG_PROPS(PSignal_SIGPIPE,   SIGPIPE,   "Broken pipe: write to pipe with no readers")
-   , CG_STDSIG_PROPS(PSignal_SIGALRM,   SIGALRM,   "Timer signal")
-   , CG_STDSIG_PROPS(PSignal_SIGTERM,   SIGTERM,   "Termination signal")
-   , CG_STDSIG_PROPS(PSignal_SIGSTKFLT, SIGSTKFLT, "Stack fault on coprocessor")
-   , CG_STDSIG_PROPS(PSignal_SIGCHLD,   SIGCHLD,   "Child stopped, terminated, or continued")
-   , CG_STDSIG_PROPS(PSignal_SIGCONT,   SIGCONT,   "Continue if stopped")
-   , CG_STDSIG_PROPS(PSignal_SIGSTOP,   SIGSTOP,   "Stop process")
-   , CG_STDSIG_PROPS(PSignal_SIGTSTP,   SIGTSTP,   "Stop typed at terminal")
-   , CG_STDSIG_PROPS(PSignal_SIGTTIN,   SIGTTIN,   "Terminal input for background process")
-   , CG_STDSIG_PROPS(PSignal_SIGTTOU,   SIGTTOU,   "Terminal output for background process")
-   , CG_STDSIG_PROPS(PSignal_SIGURG,    SIGURG,    "Urgent condition on socket")
-   , CG_STDSIG_PROPS(PSignal_SIGXCPU,   SIGXCPU,   "CPU time limit exceeded")
-   , CG_STDSIG_PROPS(PSignal_SIGXFSZ,   SIGXFSZ,   "File size limit exceeded")
-   , CG_STDSIG_PROPS(PSignal_SIGVTALRM, SIGVTALRM, "Virtual alarm clock")
-   , CG_STDSIG_PROPS(PSignal_SIGPROF,   SIGPROF,   "Profiling timer expired")
-   , CG_STDSIG_PROPS(PSignal_SIGWINCH,  SIGWINCH,  "Window resize signal")
-   , CG_STDSIG_PROPS(PSignal_SIGIO,     SIGIO,     "I/O now possible")
-   , CG_STDSIG_PROPS(PSignal_SIGPWR,    SIGPWR,    "Power failure (System V)")
-   , CG_STDSIG_PROPS(PSignal_SIGSYS,    SIGSYS,    "Bad system call (SVr4)")
+
+//------------------------------------------------------------------------------------------------
+// Raw signals
+//------------------------------------------------------------------------------------------------
+
+#define CG_STDSIG_RAW(pSig, pRaw, pDesc) [pSig] = pRaw,
+static constexpr unsigned char S_STD_SIGNALS_RAW[] =
+{
+   CG_STD_SIGNALS(CG_STDSIG_RAW)
 };
-#undef CG_STDSIG_PROPS
-
-static constexpr RTSigProperties S_RT_SIGNALS_PROPS[] =
-{
-     (RTSigProperties) { .name = "SIGRTMIN",      .desc = "Real-time signal 0" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 1",  .desc = "Real-time signal 1" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 2",  .desc = "Real-time signal 2" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 3",  .desc = "Real-time signal 3" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 4",  .desc = "Real-time signal 4" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 5",  .desc = "Real-time signal 5" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 6",  .desc = "Real-time signal 6" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 7",  .desc = "Real-time signal 7" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 8",  .desc = "Real-time signal 8" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 9",  .desc = "Real-time signal 9" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 10", .desc = "Real-time signal 10" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 11", .desc = "Real-time signal 11" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 12", .desc = "Real-time signal 12" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 13", .desc = "Real-time signal 13" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 14", .desc = "Real-time signal 14" }
-   , (RTSigProperties) { .name = "SIGRTMIN + 15", .desc = "Real-time signal 15" }
-
-   , (RTSigProperties) { .name = "SIGRTMAX - 14", .desc = "Real-time signal 16" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 13", .desc = "Real-time signal 17" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 12", .desc = "Real-time signal 18" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 11", .desc = "Real-time signal 19" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 10", .desc = "Real-time signal 20" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 9",  .desc = "Real-time signal 21" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 8",  .desc = "Real-time signal 22" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 7",  .desc = "Real-time signal 23" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 6",  .desc = "Real-time signal 24" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 5",  .desc = "Real-time signal 25" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 4",  .desc = "Real-time signal 26" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 3",  .desc = "Real-time signal 27" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 2",  .desc = "Real-time signal 28" }
-   , (RTSigProperties) { .name = "SIGRTMAX - 1",  .desc = "Real-time signal 29" }
-   , (RTSigProperties) { .name = "SIGRTMAX",      .desc = "Real-time signal 30" }
+#undef CG_STDSIG_RAW
+
+static_assert(array_capacity(S_STD_SIGNALS_RAW) == PSignal_ENUM_STD_COUNT);
+
+/*
+   Indexed by raw signal, resolves the standard signals in the handlers without a search.
+   Stores PSignal + 1, 0 for values not mapped to a standard signal.
+*/
+#define CG_STDSIG_FROM_RAW(pSig, pRaw, pDesc) [pRaw] = (pSig) + 1u,
+static constexpr unsigned char S_STD_SIGNALS_FROM_RAW[] =
+{
+   CG_STD_SIGNALS(CG_STDSIG_FROM_RAW)
 };
+#undef CG_STDSIG_FROM_RAW
+
+
+//------------------------------------------------------------------------------------------------
+// Names lookup
+//------------------------------------------------------------------------------------------------
 
+/*
+   Perfect hash of the standard names and aliases, without their "SIG" prefix: see name_hash.
+   The slots were computed offline for these names, every one of them is checked by the tests.
+   A slot stores the offset of the name past its prefix, 0 for an empty slot.
+*/
+static constexpr unsigned S_NAME_HASH_SIZE = 64u;
 
-static_assert(array_capacity(S_STD_SIGNALS_PROPS) == PSignal_ENUM_STD_COUNT);
-static_assert(array_capacity(S_RT_SIGNALS_PROPS)  == PSignal_ENUM_RT_COUNT);
+typedef struct NameSlot
+{
+   uint16_t name;
+   PSignal psig;
+} NameSlot;
+
+#define CG_NAME_SLOT(pHash, pMember, pSig) \
+   [pHash] = (NameSlot) { .name = offsetof(SignalsStrings, pMember) + 3u, .psig = pSig }
+static constexpr NameSlot S_NAME_SLOTS[S_NAME_HASH_SIZE] =
+{
+     CG_NAME_SLOT( 1, name_PSignal_SIGSTOP,    PSignal_SIGSTOP)
+   , CG_NAME_SLOT( 2, name_PSignal_SIGWINCH,   PSignal_SIGWINCH)
+   , CG_NAME_SLOT( 4, name_PSignal_SIGTSTP,    PSignal_SIGTSTP)
+   , CG_NAME_SLOT( 6, name_PSignal_SIGPROF,    PSignal_SIGPROF)
+   , CG_NAME_SLOT( 7, name_PSignal_SIGSEGV,    PSignal_SIGSEGV)
+   , CG_NAME_SLOT( 9, name_PSignal_SIGKILL,    PSignal_SIGKILL)
+   , CG_NAME_SLOT(10, name_PSignal_SIGBUS,     PSignal_SIGBUS)
+   , CG_NAME_SLOT(11, name_PSignal_SIGTTOU,    PSignal_SIGTTOU)
+   , CG_NAME_SLOT(13, name_PSignal_SIGCHLD,    PSignal_SIGCHLD)
+   , CG_NAME_SLOT(14, name_PSignal_SIGILL,     PSignal_SIGILL)
+   , CG_NAME_SLOT(15, name_PSignal_SIGURG,     PSignal_SIGURG)
+   , CG_NAME_SLOT(17, name_PSignal_SIGCONT,    PSignal_SIGCONT)
+   , CG_NAME_SLOT(18, name_PSignal_SIGTTIN,    PSignal_SIGTTIN)
+   , CG_NAME_SLOT(22, name_PSignal_SIGALRM,    PSignal_SIGALRM)
+   , CG_NAME_SLOT(23, name_PSignal_SIGABRT,    PSignal_SIGABRT)
+   , CG_NAME_SLOT(24, name_PSignal_SIGFPE,     PSignal_SIGFPE)
+   , CG_NAME_SLOT(26, name_PSignal_SIGXFSZ,    PSignal_SIGXFSZ)
+   , CG_NAME_SLOT(27, name_PSignal_SIGPIPE,    PSignal_SIGPIPE)
+   , CG_NAME_SLOT(28, alias_SIGPOLL,           PSignal_SIGIO)
+   , CG_NAME_SLOT(30, name_PSignal_SIGINT,     PSignal_SIGINT)
+   , CG_NAME_SLOT(31, name_PSignal_SIGTERM,    PSignal_SIGTERM)
+   , CG_NAME_SLOT(37, alias_SIGUNUSED,         PSignal_SIGSYS)
+   , CG_NAME_SLOT(39, name_PSignal_SIGHUP,     PSignal_SIGHUP)
+   , CG_NAME_SLOT(42, alias_SIGIOT,            PSignal_SIGABRT)
+   , CG_NAME_SLOT(43, name_PSignal_SIGQUIT,    PSignal_SIGQUIT)
+   , CG_NAME_SLOT(46, name_PSignal_SIGIO,      PSignal_SIGIO)
+   , CG_NAME_SLOT(49, name_PSignal_SIGUSR2,    PSignal_SIGUSR2)
+   , CG_NAME_SLOT(50, name_PSignal_SIGUSR1,    PSignal_SIGUSR1)
+   , CG_NAME_SLOT(51, name_PSignal_SIGVTALRM,  PSignal_SIGVTALRM)
+   , CG_NAME_SLOT(53, name_PSignal_SIGPWR,     PSignal_SIGPWR)
+   , CG_NAME_SLOT(56, name_PSignal_SIGTRAP,    PSignal_SIGTRAP)
+   , CG_NAME_SLOT(57, name_PSignal_SIGSYS,     PSignal_SIGSYS)
+   , CG_NAME_SLOT(59, name_PSignal_SIGXCPU,    PSignal_SIGXCPU)
+   , CG_NAME_SLOT(60, alias_SIGCLD,            PSignal_SIGCHLD)
+   , CG_NAME_SLOT(63, name_PSignal_SIGSTKFLT,  PSignal_SIGSTKFLT)
+};
+#undef CG_NAME_SLOT
+
+// Longest standard name or alias without its prefix (STKFLT, VTALRM, UNUSED).
+static constexpr unsigned S_NAME_MAX_LENGTH = 6u;
 
 
 //================================================================================================
 // Private Functions
 //================================================================================================
 
-// We can't assume that STD/RT signals are 0-indexed so these functions are defined for that.
+[[nodiscard]] static inline
+char const *string_at(uint16_t const offset)
+{
+   return (char const *)&S_STRINGS + offset;
+}
 
 [[nodiscard]] static inline
-unsigned std_sig_idx(PSignal const psig)
+char ascii_upper(char const c)
 {
-   assert(psignal_is_standard(psig));
-   return (psig - PSignal_ENUM_STD_FIRST);
+   return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+// Case insensitive, expected is upper case.
+[[nodiscard]] static
+bool has_prefix(char const *const str, char const *const expected)
+{
+   for (size_t i = 0; expected[i] != '\0'; ++i)
+   {
+      if (ascii_upper(str[i]) != expected[i])
+         return false;
+   }
+   return true;
 }
 
 [[nodiscard]] static inline
-unsigned rt_sig_idx(PSignal const psig)
+unsigned name_hash(char const *const name, size_t const length)
+{
+   unsigned const first  = (unsigned char)ascii_upper(name[0]);
+   unsigned const second = (unsigned char)ascii_upper(name[1]);
+   unsigned const last   = (unsigned char)ascii_upper(name[length - 1u]);
+   return (first * 15u + second * 12u + last * 63u + (unsigned)length) & (S_NAME_HASH_SIZE - 1u);
+}
+
+[[nodiscard]] static
+char const *skip_spaces(char const *str)
 {
-   assert(psignal_is_real_time(psig));
-   return (psig - PSignal_ENUM_RT_FIRST);
+   while (*str == ' ')
+   {
+      ++str;
+   }
+   return str;
 }
 
+/*
+   "RTMIN", "RTMIN+n", "RTMAX" or "RTMAX-n", spaces allowed around the sign.
+*/
+[[nodiscard]] static
+bool parse_real_time_name(char const *name, PSignal *const out)
+{
+   bool const fromMin = has_prefix(name, "RTMIN");
+   if (!fromMin && !has_prefix(name, "RTMAX"))
+      return false;
+
+   name = skip_spaces(name + 5);
+
+   unsigned offset = 0u;
+   if (*name != '\0')
+   {
+      if (*name != (fromMin ? '+' : '-'))
+         return false;
+
+      name = skip_spaces(name + 1);
+      if (*name < '0' || *name > '9')
+         return false;
+
+      while (*name >= '0' && *name <= '9' && offset < PSignal_ENUM_RT_COUNT)
+      {
+         offset = offset * 10u + (unsigned)(*name - '0');
+         ++name;
+      }
+
+      if (*name != '\0' || offset >= PSignal_ENUM_RT_COUNT)
+         return false;
+   }
+
+   *out = fromMin ? (PSignal)(PSignal_ENUM_RT_FIRST + offset) : (PSignal)(PSignal_ENUM_RT_LAST - offset);
+   return true;
+}
 
 //================================================================================================
 // Public API Functions
@@ -141,13 +330,12 @@ unsigned rt_sig_idx(PSignal const psig)
 // Identification
 //------------------------------------------------------------------------------------------------
 
-bool psignal_validate(unsigned const v)
-{
-   // The code below assumes that we start from 0 and enum is unsigned.
-   static_assert(PSignal_ENUM_STD_FIRST == 0 && type_is_unsigned(PSignal));
+// The inline definitions assume that we start from 0 and enum is unsigned.
+static_assert(PSignal_ENUM_STD_FIRST == 0 && type_is_unsigned(PSignal));
+static_assert(PSignal_ENUM_STD_LAST == PSignal_SIGSYS && PSignal_ENUM_RT_FIRST == PSignal_SIGRTMIN);
+static_assert(PSignal_ENUM_LAST == PSignal_SIGRTMAX);
 
-   return v <= PSignal_ENUM_LAST;
-}
+extern inline bool psignal_validate(unsigned);
 
 
 //------------------------------------------------------------------------------------------------
@@ -172,43 +360,47 @@ bool psignal_raise_on_pid(PSignal const psig, pid_t const pid)
    }
 }
 
+bool psignal_raise_on_thread(PSignal const psig, pthread_t const thread)
+{
+   int const sig = psignal_to_raw_signal(psig);
+   if (psignal_is_standard(psig))
+   {
+      return pthread_kill(thread, sig) == 0;
+   }
+   else
+   {
+      return pthread_sigqueue(thread, sig, (union sigval){}) == 0;
+   }
+}
+
 
 //------------------------------------------------------------------------------------------------
 // Properties
 //------------------------------------------------------------------------------------------------
 
-bool psignal_is_standard(PSignal const psig)
-{
-   // The code below assumes that we start from 0 and enum is unsigned.
-   static_assert(PSignal_ENUM_STD_FIRST == 0 && type_is_unsigned(PSignal));
-
-   return psig <= PSignal_ENUM_STD_LAST;
-}
+extern inline bool psignal_is_standard(PSignal);
+extern inline bool psignal_is_real_time(PSignal);
 
-bool psignal_is_real_time(PSignal const psig)
+bool psignal_is_compiled(PSignal const psig)
 {
-   return !(psig < PSignal_ENUM_RT_FIRST || psig > PSignal_ENUM_RT_LAST);
+   return (PSignal_BUILD_MASK >> psig) & 1u;
 }
 
 int psignal_to_raw_signal(PSignal const psig)
 {
    return psignal_is_standard(psig)
-      ? S_STD_SIGNALS_PROPS[std_sig_idx(psig)].rawSignal
-      : SIGRTMIN + (int)rt_sig_idx(psig);
+      ? S_STD_SIGNALS_RAW[psig]
+      : SIGRTMIN + (int)(psig - PSignal_ENUM_RT_FIRST);
 }
 
 char const *psignal_name(PSignal const psig)
 {
-   return psignal_is_standard(psig)
-      ? S_STD_SIGNALS_PROPS[std_sig_idx(psig)].name
-      : S_RT_SIGNALS_PROPS[rt_sig_idx(psig)].name;
+   return string_at(S_SIGNALS_STRINGS[psig].name);
 }
 
 char const *psignal_desc(PSignal const psig)
 {
-   return psignal_is_standard(psig)
-      ? S_STD_SIGNALS_PROPS[std_sig_idx(psig)].desc
-      : S_RT_SIGNALS_PROPS[rt_sig_idx(psig)].desc;
+   return string_at(S_SIGNALS_STRINGS[psig].desc);
 }
 
 
@@ -219,13 +411,11 @@ char const *psignal_desc(PSignal const psig)
 bool psignal_from_raw_signal(int const signal, PSignal *const out)
 {
    // STD Signals
-   for (PSignal idx = PSignal_ENUM_STD_FIRST; idx <= PSignal_ENUM_STD_LAST; ++idx)
+   if (signal > 0 && (unsigned)signal < array_capacity(S_STD_SIGNALS_FROM_RAW)
+      && S_STD_SIGNALS_FROM_RAW[signal] != 0u)
    {
-      if (S_STD_SIGNALS_PROPS[idx].rawSignal == signal)
-      {
-         *out = idx;
-         return true;
-      }
+      *out = (PSignal)(S_STD_SIGNALS_FROM_RAW[signal] - 1u);
+      return true;
    }
 
    // RT Signals
@@ -237,3 +427,34 @@ bool psignal_from_raw_signal(int const signal, PSignal *const out)
 
    return false;
 }
+
+bool psignal_from_name(char const *name, PSignal *const out)
+{
+   if (has_prefix(name, "SIG"))
+   {
+      name += 3;
+   }
+
+   if (has_prefix(name, "RT"))
+      return parse_real_time_name(name, out);
+
+   size_t const length = strnlen(name, S_NAME_MAX_LENGTH + 1u);
+   if (length < 2u || length > S_NAME_MAX_LENGTH)
+      return false;
+
+   NameSlot const slot = S_NAME_SLOTS[name_hash(name, length)];
+   if (slot.name == 0u)
+      return false;
+
+   char const *const expected = string_at(slot.name);
+   for (size_t i = 0; i < length; ++i)
+   {
+      if (ascii_upper(name[i]) != expected[i])
+         return false;
+   }
+   if (expected[length] != '\0')
+      return false;
+
+   *out = slot.psig;
+   return true;
+}
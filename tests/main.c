@@ -1,26 +1,1813 @@
+#define _GNU_SOURCE
+
 #include "libposix_signals/libposix_signals.h"
 
-#include <assert.h>
-#include <stdio.h>
-#include <signal.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fenv.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+static sig_atomic_t sigintReceived = 0;
+static sig_atomic_t sigsegvReceived = 0;
+static sig_atomic_t sigcontReceived = 0;
+
+void crash_callback(PSigCallbackInfo const *info)
+{
+   printf("Crash callback called with signal %s (%i)\n",
+      psignal_name(info->sig), psignal_to_raw_signal(info->sig)
+   );
+
+   switch (info->sig)
+   {
+      case PSignal_SIGINT: sigintReceived += 1; break;
+      case PSignal_SIGSEGV: sigsegvReceived += 1; break;
+      case PSignal_SIGCONT: sigcontReceived += 1; break;
+      default: break;
+   }
+}
+
+static void sleep_ms(unsigned const ms)
+{
+   struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000l };
+   while (nanosleep(&ts, &ts) != 0) {}
+}
+
+// Signals delivery is asynchronous, poll the counter for a while before giving up.
+static bool wait_for_count(atomic_int const *counter, int const expected, unsigned const timeoutMs)
+{
+   for (unsigned elapsed = 0u; elapsed < timeoutMs; ++elapsed)
+   {
+      if (atomic_load(counter) >= expected)
+         return true;
+      sleep_ms(1u);
+   }
+   return atomic_load(counter) >= expected;
+}
+
+
+static atomic_int timerFired = 0;
+
+void timer_callback(PSigTimerInfo const *info)
+{
+   assert(info->firedNs >= info->deadlineNs);
+   atomic_fetch_add((atomic_int *)info->userData, 1);
+}
+
+static atomic_int policyCalls = 0;
+static atomic_int policyDeliveries = 0;
+static atomic_int policyLastCount = 0;
+
+static void policy_callback(PSigCallbackInfo const *info)
+{
+   assert(info->count >= 1u && info->firstNs != 0u && info->firstNs <= info->lastNs);
+   atomic_fetch_add(&policyCalls, 1);
+   atomic_fetch_add(&policyDeliveries, (int)info->count);
+   atomic_store(&policyLastCount, (int)info->count);
+
+   // Nested deliveries (SA_NODEFER), collapsed into the next call with LATEST_ONLY.
+   if (atomic_load(&policyCalls) == 1 && info->sig == PSignal_SIGWINCH)
+   {
+      for (int i = 0; i < 5; ++i)
+      {
+         assert(psignal_raise(PSignal_SIGWINCH));
+      }
+   }
+}
+
+static void reset_policy_counters(void)
+{
+   atomic_store(&policyCalls, 0);
+   atomic_store(&policyDeliveries, 0);
+   atomic_store(&policyLastCount, 0);
+}
+
+static void test_policies(void)
+{
+   printf("Testing dispatch policies...\n");
+
+   assert(!psignal_callback_set_policy(PSignal_SIGSEGV,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_LATEST_ONLY }));
+   assert(!psignal_callback_set_policy(PSignal_SIGUSR2,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_COALESCE }));
+   assert(!psignal_callback_set_policy(PSignal_SIGUSR2,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_RATE_LIMIT }));
+
+   assert(psignal_callback_hook_on_sig(PSignal_SIGUSR2, policy_callback));
+   assert(psignal_callback_hook_on_sig(PSignal_SIGWINCH, policy_callback));
+
+   // A burst within the window is dispatched once, when it closes.
+   assert(psignal_callback_set_policy(PSignal_SIGUSR2,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_COALESCE, .windowNs = 200000000u }));
+   for (int i = 0; i < 100; ++i)
+   {
+      assert(psignal_raise(PSignal_SIGUSR2));
+   }
+   assert(wait_for_count(&policyDeliveries, 100, 2000u));
+   assert(atomic_load(&policyCalls) == 1 && atomic_load(&policyLastCount) == 100);
+
+   PSigDispatchStats stats;
+   psignal_callback_policy_stats(PSignal_SIGUSR2, &stats);
+   assert(stats.received == 100u && stats.dispatched == 1u);
+
+   // The first delivery is dispatched right away, the rest once the next call is allowed.
+   reset_policy_counters();
+   assert(psignal_callback_set_policy(PSignal_SIGUSR2,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_RATE_LIMIT, .maxPerSecond = 5u }));
+   assert(psignal_raise(PSignal_SIGUSR2));
+   assert(atomic_load(&policyCalls) == 1);
+   for (int i = 0; i < 49; ++i)
+   {
+      assert(psignal_raise(PSignal_SIGUSR2));
+   }
+   assert(wait_for_count(&policyDeliveries, 50, 2000u));
+   assert(atomic_load(&policyCalls) >= 2 && atomic_load(&policyCalls) <= 4);
+
+   reset_policy_counters();
+   assert(psignal_callback_set_policy(PSignal_SIGWINCH,
+      &(PSigDispatchPolicy) { .mode = PSigDispatchMode_LATEST_ONLY }));
+   assert(psignal_raise(PSignal_SIGWINCH));
+   assert(atomic_load(&policyCalls) == 2 && atomic_load(&policyLastCount) == 5);
+
+   assert(psignal_callback_set_policy(PSignal_SIGUSR2, nullptr));
+   assert(psignal_callback_set_policy(PSignal_SIGWINCH, nullptr));
+   psignal_callback_remove_from_sig(PSignal_SIGUSR2, policy_callback);
+   psignal_callback_remove_from_sig(PSignal_SIGWINCH, policy_callback);
+}
+
+static void *arenaOuter = nullptr;
+static bool arenaNestedOk = false;
+
+// Runs nested in a scope of the interrupted code (SA_NODEFER).
+static void arena_callback(PSigCallbackInfo const *)
+{
+   PSigArenaMark const mark = psignal_arena_mark();
+   char *const scratch = psignal_arena_alloc(64u, 0u);
+   arenaNestedOk = scratch != nullptr && scratch != arenaOuter;
+   if (scratch != nullptr)
+   {
+      memset(scratch, 0xAB, 64u);
+   }
+   psignal_arena_reset(mark);
+}
+
+static void *arena_thread_main(void *)
+{
+   PSigArenaStats before;
+   psignal_arena_stats(&before);
+   assert(before.capacity == PSIG_ARENA_DEFAULT_SIZE);
+
+   assert(psignal_thread_register(nullptr));
+
+   // Scopes of a thread arena are freed as soon as they close.
+   PSigArenaStats stats;
+   psignal_arena_stats(&stats);
+   assert(stats.capacity == 8192u && stats.used == 0u);
+
+   PSigArenaMark const outer = psignal_arena_mark();
+   assert(psignal_arena_alloc(100u, 8u) != nullptr);
+   PSigArenaMark const inner = psignal_arena_mark();
+   assert(psignal_arena_alloc(1000u, 8u) != nullptr);
+   psignal_arena_reset(inner);
+   psignal_arena_stats(&stats);
+   assert(stats.used == 100u && stats.peak >= 1100u);
+   psignal_arena_reset(outer);
+
+   psignal_thread_unregister();
+   return nullptr;
+}
+
+static void test_arena(void)
+{
+   printf("Testing emergency arenas...\n");
+
+   // Allocations need an open scope.
+   assert(psignal_arena_alloc(16u, 0u) == nullptr);
+
+   PSigArenaMark const mark = psignal_arena_mark();
+   arenaOuter = psignal_arena_alloc(128u, 64u);
+   assert(arenaOuter != nullptr && ((uintptr_t)arenaOuter % 64u) == 0u);
+   memset(arenaOuter, 0x11, 128u);
+
+   assert(psignal_callback_hook_on_sig(PSignal_SIGUSR1, arena_callback));
+   assert(psignal_raise(PSignal_SIGUSR1));
+   psignal_callback_remove_from_sig(PSignal_SIGUSR1, arena_callback);
+   assert(arenaNestedOk);
+   assert(((unsigned char *)arenaOuter)[127] == 0x11);
+
+   PSigArenaStats stats;
+   uint64_t const exhaustions = (psignal_arena_stats(&stats), stats.exhaustions);
+   assert(psignal_arena_alloc(PSIG_ARENA_DEFAULT_SIZE, 0u) == nullptr);
+   assert(psignal_arena_alloc(3u, 3u) == nullptr);
+   psignal_arena_stats(&stats);
+   assert(stats.exhaustions == exhaustions + 1u);
+
+   psignal_arena_reset(mark);
+   psignal_arena_stats(&stats);
+   assert(stats.used == 0u && stats.peak >= 128u + 64u);
+
+   // Thread arenas are configured with the library.
+   psignal_library_shutdown();
+   assert(psignal_library_init_with_config(&(PSigLibraryConfig) { .threadArenaSize = 8192u }));
+
+   pthread_t thread;
+   assert(pthread_create(&thread, nullptr, &arena_thread_main, nullptr) == 0);
+   pthread_join(thread, nullptr);
+}
+
+static void test_timers(void)
+{
+   printf("Testing timers...\n");
+
+   assert(psignal_timers_init(&(PSigTimersConfig) { .capacity = 4u, .resolutionNs = 1000000u }));
+   assert(psignal_callback_is_reserved(psignal_timers_signal()));
+   assert(!psignal_callback_hook_on_sig(psignal_timers_signal(), crash_callback));
+   assert(psignal_callback_hook_on_disposition(PSigDisposition_TERMINATE, crash_callback));
+   assert(psignal_callback_hook_on_all(crash_callback));
+   assert(!psignal_callback_is_hooked_on(psignal_timers_signal(), crash_callback));
+   psignal_callback_remove_from_all(crash_callback);
+
+   PSigTimerSpec spec = {
+      .delayNs = 2000000u,
+      .delivery = PSigTimerDelivery_HANDLER,
+      .callback = timer_callback,
+      .userData = &timerFired
+   };
+
+   PSigTimerId oneShot;
+   assert(psignal_timer_add(&spec, &oneShot));
+   assert(wait_for_count(&timerFired, 1, 1000u));
+   // One-shot timers are released once fired.
+   assert(!psignal_timer_cancel(oneShot));
+
+   PSigTimerId cancelled;
+   spec.delayNs = 20000000u;
+   assert(psignal_timer_add(&spec, &cancelled));
+   assert(psignal_timer_cancel(cancelled));
+   assert(!psignal_timer_cancel(cancelled));
+
+   PSigTimerId periodic;
+   spec.delayNs = 1000000u;
+   spec.intervalNs = 1000000u;
+   spec.delivery = PSigTimerDelivery_DEFERRED;
+   assert(psignal_timer_add(&spec, &periodic));
+   assert(wait_for_count(&timerFired, 4, 1000u));
+   assert(psignal_timer_cancel(periodic));
+
+   // Capacity is enforced.
+   PSigTimerId ids[4];
+   spec.delayNs = 1000000000u;
+   spec.intervalNs = 0u;
+   for (unsigned i = 0; i < 4; ++i)
+   {
+      assert(psignal_timer_add(&spec, &ids[i]));
+   }
+   assert(!psignal_timer_add(&spec, nullptr));
+   assert(psignal_timer_rearm(ids[0], 2000000000u));
+   for (unsigned i = 0; i < 4; ++i)
+   {
+      assert(psignal_timer_cancel(ids[i]));
+   }
+
+   psignal_timers_shutdown();
+   assert(!psignal_timers_is_running());
+}
+
+
+static constexpr unsigned WORKERS_COUNT = 4u;
+
+static atomic_bool workersStop = false;
+static atomic_int workersReady = 0;
+static atomic_int workersProgress = 0;
+static atomic_int rtReceived = 0;
+
+void rt_callback(PSigCallbackInfo const *)
+{
+   atomic_fetch_add(&rtReceived, 1);
+}
+
+static void *worker_main(void *arg)
+{
+   assert(psignal_thread_register(arg));
+   assert(psignal_thread_is_registered());
+   atomic_fetch_add(&workersReady, 1);
+
+   while (!atomic_load(&workersStop))
+   {
+      atomic_fetch_add(&workersProgress, 1);
+   }
+   // Unregistering is left to the thread exit on purpose.
+   return nullptr;
+}
+
+static void count_parked(PSigThreadInfo const *info, void *arg)
+{
+   if (info->ucontext != nullptr)
+   {
+      *(unsigned *)arg += 1u;
+   }
+}
+
+static void world_fn(void *arg)
+{
+   unsigned parked = 0u;
+   psignal_threads_for_each(count_parked, &parked);
+   assert(parked == WORKERS_COUNT);
+
+   // Nobody is running anymore.
+   int const progress = atomic_load(&workersProgress);
+   sleep_ms(5u);
+   assert(atomic_load(&workersProgress) == progress);
+
+   *(bool *)arg = true;
+}
+
+static atomic_int broadcastCalls = 0;
+static atomic_int broadcastCompleted = 0;
+
+static void broadcast_fn(void *arg)
+{
+   atomic_fetch_add((atomic_int *)arg, 1);
+}
+
+static void broadcast_done(void *)
+{
+   atomic_fetch_add(&broadcastCompleted, 1);
+}
+
+// Laid out as a broadcast request, queued by another process.
+static atomic_int forgedCalls = 0;
+static struct
+{
+   unsigned char kind;
+   PSigBroadcastFn fn;
+   PSigBroadcastFn onComplete;
+   void *arg;
+   unsigned padding[8];
+} forgedRequest = { .kind = 1u, .fn = broadcast_fn, .arg = &forgedCalls };
+
+static void test_threads(void)
+{
+   printf("Testing threads...\n");
+
+   assert(psignal_threads_init());
+
+   pthread_t workers[WORKERS_COUNT];
+   for (unsigned i = 0; i < WORKERS_COUNT; ++i)
+   {
+      assert(pthread_create(&workers[i], nullptr, worker_main, nullptr) == 0);
+   }
+   assert(wait_for_count(&workersReady, WORKERS_COUNT, 1000u));
+   assert(psignal_threads_registered_count() == WORKERS_COUNT);
+
+   assert(psignal_callback_hook_on_sig(PSignal_SIGRTMIN_1, rt_callback));
+   assert(psignal_raise_on_thread(PSignal_SIGRTMIN_1, workers[0]));
+   assert(wait_for_count(&rtReceived, 1, 1000u));
+   psignal_callback_remove_from_sig(PSignal_SIGRTMIN_1, rt_callback);
+
+   for (unsigned round = 0; round < 3; ++round)
+   {
+      bool ran = false;
+      assert(psignal_threads_stop_the_world(world_fn, &ran));
+      assert(ran);
+   }
+
+   assert(psignal_broadcast_call(broadcast_fn, &broadcastCalls));
+   assert(atomic_load(&broadcastCalls) == WORKERS_COUNT);
+
+   PSigBroadcastId broadcast;
+   assert(psignal_broadcast_call_async(broadcast_fn, &broadcastCalls, broadcast_done, &broadcast));
+   psignal_broadcast_wait(broadcast);
+   assert(psignal_broadcast_is_done(broadcast));
+   assert(atomic_load(&broadcastCalls) == 2 * WORKERS_COUNT);
+   assert(atomic_load(&broadcastCompleted) == 1);
+
+   // Requests not queued by this process are ignored, whatever they point to.
+   fflush(stdout);
+   pid_t const forger = fork();
+   assert(forger >= 0);
+   if (forger == 0)
+   {
+      union sigval const value = { .sival_ptr = &forgedRequest };
+      sigqueue(getppid(), psignal_to_raw_signal(psignal_threads_signal()), value);
+      _exit(0);
+   }
+   // The forged signal may land on this thread, without SA_RESTART.
+   pid_t waited;
+   while ((waited = waitpid(forger, nullptr, 0)) < 0 && errno == EINTR)
+   {
+   }
+   assert(waited == forger);
+   sleep_ms(50u);
+   assert(atomic_load(&forgedCalls) == 0);
+
+   atomic_store(&workersStop, true);
+   for (unsigned i = 0; i < WORKERS_COUNT; ++i)
+   {
+      pthread_join(workers[i], nullptr);
+   }
+   assert(psignal_threads_registered_count() == 0u);
+
+   psignal_threads_shutdown();
+   assert(!psignal_threads_is_running());
+}
+
+
+static atomic_int preemptHookCalls = 0;
+
+static bool preempt_hook(PSigPreemptInfo const *info)
+{
+   assert(info->ucontext != nullptr);
+   atomic_fetch_add(&preemptHookCalls, 1);
+   return true;
+}
+
+// Burns CPU until the condition is met, or gives up after ~2s of wall time.
+static bool spin_until(bool (*condition)(void))
+{
+   struct timespec start, now;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   do
+   {
+      if (condition())
+         return true;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+   } while (now.tv_sec - start.tv_sec < 2);
+   return condition();
+}
+
+static bool preempt_hook_called(void)
+{
+   return atomic_load(&preemptHookCalls) > 0;
+}
+
+// The task switched to by redirecting the preempted one, which it never resumes.
+static ucontext_t preemptScheduler;
+static atomic_bool preemptSwitched = false;
+static alignas(16) unsigned char preemptTaskStack[64 * 1024];
+
+static void preempt_next_task(void *arg)
+{
+   // The handler has returned: nothing runs on the alternate signal stack anymore.
+   stack_t altStack;
+   assert(sigaltstack(nullptr, &altStack) == 0);
+   assert(!(altStack.ss_flags & SS_ONSTACK));
+   atomic_store(&preemptSwitched, true);
+   setcontext(arg);
+   abort();
+}
+
+static bool preempt_switch_hook(PSigPreemptInfo const *info)
+{
+   return psignal_preemption_redirect(info, preempt_next_task, &preemptScheduler,
+      preemptTaskStack + sizeof(preemptTaskStack)
+   );
+}
+
+static bool never(void)
+{
+   return false;
+}
+
+static void test_preemption(void)
+{
+   printf("Testing preemption...\n");
+
+   assert(psignal_preemption_init());
+   assert(psignal_preemption_register_worker(4000000u, nullptr, nullptr));
+
+   psignal_preemption_task_begin();
+   assert(!psignal_preemption_yield_requested());
+   assert(spin_until(psignal_preemption_yield_requested));
+   assert(psignal_preemption_count() >= 1u);
+   psignal_preemption_task_end();
+   psignal_preemption_unregister_worker();
+
+   // Everything is a safe point: the hook takes over the yield flag.
+   assert(psignal_preemption_add_safe_range((void const *)1, (void const *)UINTPTR_MAX));
+   assert(psignal_preemption_register_worker(4000000u, preempt_hook, nullptr));
+   psignal_preemption_task_begin();
+   assert(spin_until(preempt_hook_called));
+   assert(!psignal_preemption_yield_requested());
+   psignal_preemption_task_end();
+   psignal_preemption_unregister_worker();
+
+   // The hook redirects the preempted task to another one, which resumes the scheduler.
+   assert(psignal_preemption_register_worker(4000000u, preempt_switch_hook, nullptr));
+   volatile bool started = false;
+   assert(getcontext(&preemptScheduler) == 0);
+   if (!started)
+   {
+      started = true;
+      psignal_preemption_task_begin();
+      (void)spin_until(never);
+      assert(false);
+   }
+   assert(atomic_load(&preemptSwitched));
+   psignal_preemption_task_end();
+   psignal_preemption_unregister_worker();
+
+   psignal_preemption_shutdown();
+   assert(!psignal_preemption_is_running());
+}
+
+
+static atomic_int watchdogReports = 0;
+static atomic_bool stalledWorkerStop = false;
+static pid_t stalledWorkerTid = 0;
+
+static void watchdog_reporter(PSigWatchdogReport const *report, void *)
+{
+   assert(report->tid == stalledWorkerTid);
+   assert(report->stalledNs > report->deadlineNs);
+   assert(report->frameCount > 0u && report->frames[0] != nullptr);
+
+   // Reports run without the registry lock.
+   assert(psignal_watchdog_register(1000000000u));
+   psignal_watchdog_unregister();
+   atomic_fetch_add(&watchdogReports, 1);
+}
+
+static void *stalled_worker_main(void *)
+{
+   stalledWorkerTid = gettid();
+   assert(psignal_watchdog_register(20000000u));
+
+   // Healthy for a while...
+   for (unsigned i = 0; i < 10u; ++i)
+   {
+      psignal_watchdog_heartbeat();
+      sleep_ms(5u);
+   }
+
+   // ... then stuck.
+   while (!atomic_load(&stalledWorkerStop)) {}
+
+   psignal_watchdog_unregister();
+   return nullptr;
+}
+
+static void test_watchdog(void)
+{
+   printf("Testing watchdog...\n");
+
+   assert(psignal_watchdog_init(&(PSigWatchdogConfig) {
+      .checkIntervalNs = 5000000u,
+      .reporter = watchdog_reporter
+   }));
+
+   pthread_t worker;
+   assert(pthread_create(&worker, nullptr, stalled_worker_main, nullptr) == 0);
+   assert(wait_for_count(&watchdogReports, 1, 2000u));
+   atomic_store(&stalledWorkerStop, true);
+   pthread_join(worker, nullptr);
+
+   // Reported once per stall.
+   assert(atomic_load(&watchdogReports) == 1);
+   assert(psignal_watchdog_stall_count() == 1u);
+
+   psignal_watchdog_shutdown();
+   assert(!psignal_watchdog_is_running());
+}
+
+static atomic_int childrenExits = 0;
+static atomic_int childrenStatusSum = 0;
+
+static void child_exit_callback(PSigChildExit const *exit)
+{
+   assert(exit->code == CLD_EXITED);
+   assert(exit->usage != nullptr);
+   assert(exit->userData == (void *)(intptr_t)exit->status);
+   atomic_fetch_add(&childrenStatusSum, exit->status);
+   atomic_fetch_add(&childrenExits, 1);
+}
+
+static pid_t fork_exiting(int const status, pid_t const wantedPid)
+{
+   if (wantedPid != 0)
+   {
+      // Needs CAP_SYS_ADMIN (or CAP_CHECKPOINT_RESTORE), the next pid isn't guaranteed anyway.
+      FILE *const file = fopen("/proc/sys/kernel/ns_last_pid", "w");
+      if (file == nullptr)
+         return -1;
+      fprintf(file, "%d", (int)wantedPid - 1);
+      if (fclose(file) != 0)
+         return -1;
+   }
+
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      _exit(status);
+   }
+   return pid;
+}
+
+static void wait_reaped(unsigned long long const reaped)
+{
+   for (unsigned i = 0; i < 2000u && psignal_children_stats().reaped < reaped; ++i)
+   {
+      sleep_ms(1u);
+   }
+   assert(psignal_children_stats().reaped == reaped);
+}
+
+// A reused pid exiting again unwatched while the kept exits ring is full.
+static void test_children_reused_pid(void)
+{
+   assert(psignal_children_init(&(PSigChildrenConfig) { .capacity = 16u, .keptUnwatched = 2u }));
+
+   // The statistics aren't reset by init.
+   PSigChildrenStats const base = psignal_children_stats();
+
+   fflush(stdout);
+   pid_t const first = fork_exiting(1, 0);
+   wait_reaped(base.reaped + 1u);
+   pid_t const second = fork_exiting(2, 0);
+   wait_reaped(base.reaped + 2u);
+
+   pid_t const reused = fork_exiting(3, first);
+   if (reused != first)
+   {
+      printf("   pid reuse unavailable, skipped\n");
+      if (reused > 0)
+      {
+         wait_reaped(base.reaped + 3u);
+      }
+      psignal_children_shutdown();
+      return;
+   }
+   wait_reaped(base.reaped + 3u);
+   assert(psignal_children_stats().tracked == 2u);
+
+   pid_t const third = fork_exiting(4, 0);
+   wait_reaped(base.reaped + 4u);
+
+   // The ring never holds more than its capacity: the first exit and then the second one went.
+   PSigChildrenStats stats = psignal_children_stats();
+   assert(stats.tracked == 2u && stats.dropped == base.dropped + 2u);
+
+   atomic_store(&childrenExits, 0);
+   atomic_store(&childrenStatusSum, 0);
+   assert(psignal_children_watch(first, child_exit_callback, (void *)(intptr_t)3));
+   assert(psignal_children_watch(third, child_exit_callback, (void *)(intptr_t)4));
+   assert(atomic_load(&childrenExits) == 2 && atomic_load(&childrenStatusSum) == 7);
+   assert(psignal_children_watch(second, child_exit_callback, (void *)(intptr_t)2));
+   psignal_children_unwatch(second);
+
+   stats = psignal_children_stats();
+   assert(stats.dispatched == base.dispatched + 2u && stats.tracked == 0u);
+
+   psignal_children_shutdown();
+}
+
+static void test_children(void)
+{
+   printf("Testing children reaping...\n");
+
+   assert(psignal_children_init(nullptr));
+   assert(psignal_callback_is_reserved(PSignal_SIGCHLD));
+   assert(!psignal_callback_hook_on_sig(PSignal_SIGCHLD, policy_callback));
+
+   // Children exiting all at once: SIGCHLD coalesces but every exit must be dispatched.
+   int pipeFds[2];
+   assert(pipe(pipeFds) == 0);
+
+   pid_t pids[33] = {};
+   int expectedSum = 0;
+   for (int i = 1; i <= 32; ++i)
+   {
+      pid_t const pid = fork();
+      assert(pid >= 0);
+      if (pid == 0)
+      {
+         char byte;
+         close(pipeFds[1]);
+         (void)read(pipeFds[0], &byte, 1);
+         _exit(i);
+      }
+
+      pids[i] = pid;
+
+      // Odd children are watched after they exit.
+      if ((i % 2) == 0)
+      {
+         assert(psignal_children_watch(pid, child_exit_callback, (void *)(intptr_t)i));
+      }
+      expectedSum += i;
+   }
+   close(pipeFds[0]);
+   close(pipeFds[1]);
+
+   assert(wait_for_count(&childrenExits, 16, 2000u));
+   while (psignal_children_stats().reaped < 32u)
+   {
+      sleep_ms(1u);
+   }
+   assert(psignal_children_stats().tracked == 16u);
+
+   for (int i = 1; i <= 32; i += 2)
+   {
+      assert(psignal_children_watch(pids[i], child_exit_callback, (void *)(intptr_t)i));
+   }
+   assert(atomic_load(&childrenExits) == 32);
+   assert(atomic_load(&childrenStatusSum) == expectedSum);
+
+   PSigChildrenStats const stats = psignal_children_stats();
+   assert(stats.reaped == 32u && stats.dispatched == 32u && stats.dropped == 0u && stats.tracked == 0u);
+
+   psignal_children_shutdown();
+   assert(!psignal_children_is_running());
+   assert(!psignal_callback_is_reserved(PSignal_SIGCHLD));
+
+   test_children_reused_pid();
+}
+
+static atomic_int pid1Exits = 0;
+static atomic_int pid1LastSignal = 0;
+
+static void pid1_child_exit_callback(PSigChildExit const *exit)
+{
+   assert(exit->code == CLD_KILLED);
+   atomic_store(&pid1LastSignal, exit->status);
+   atomic_fetch_add(&pid1Exits, 1);
+}
+
+static pid_t fork_group_member(pid_t const group, bool const stubborn)
+{
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      // Handlers are inherited from the library, as long as the child doesn't exec.
+      setpgid(0, group);
+      signal(SIGTERM, stubborn ? SIG_IGN : SIG_DFL);
+      signal(SIGUSR1, stubborn ? SIG_IGN : SIG_DFL);
+      while (true)
+      {
+         pause();
+      }
+   }
+
+   // Set from both sides, whichever runs first.
+   setpgid(pid, (group != 0) ? group : pid);
+   return pid;
+}
+
+static void test_pid1(void)
+{
+   printf("Testing PID 1 mode...\n");
+
+   assert(psignal_pid1_init(&(PSigPid1Config) { .gracePeriodNs = 50000000u }));
+   assert(psignal_children_is_running());
+   assert(psignal_callback_is_reserved(PSignal_SIGTERM));
+   assert(!psignal_callback_is_reserved(PSignal_SIGPIPE));
+
+   pid_t const stubborn = fork_group_member(0, true);
+   pid_t const member = fork_group_member(stubborn, false);
+   assert(psignal_children_watch(stubborn, pid1_child_exit_callback, nullptr));
+   assert(psignal_children_watch(member, pid1_child_exit_callback, nullptr));
+
+   assert(!psignal_pid1_set_process_group(getpgrp()));
+   assert(psignal_pid1_set_process_group(stubborn));
+
+   // SIGUSR1 received from another process is forwarded to the group.
+   pid_t const sender = fork();
+   assert(sender >= 0);
+   if (sender == 0)
+   {
+      kill(getppid(), SIGUSR1);
+      _exit(0);
+   }
+   assert(wait_for_count(&pid1Exits, 1, 2000u));
+   assert(atomic_load(&pid1LastSignal) == SIGUSR1);
+   assert(!psignal_pid1_shutdown_requested());
+
+   // SIGTERM is ignored by the remaining child, escalated after the grace period.
+   assert(psignal_pid1_terminate());
+   assert(psignal_pid1_shutdown_requested());
+   assert(wait_for_count(&pid1Exits, 2, 2000u));
+   assert(atomic_load(&pid1LastSignal) == SIGKILL);
+   assert(psignal_pid1_escalated());
+
+   psignal_pid1_shutdown();
+   assert(!psignal_pid1_is_running());
+   assert(!psignal_children_is_running());
+   assert(!psignal_callback_is_reserved(PSignal_SIGTERM));
+}
+
+static void test_io(void)
+{
+   printf("Testing I/O readiness...\n");
+
+   assert(psignal_io_init(nullptr));
+
+   int fds[2];
+   assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+
+   char const byte = 'x';
+   char buffer[16];
+   PSigIoEvent events[8];
+
+   // Data already there when arming is reported.
+   assert(write(fds[1], &byte, 1) == 1);
+   assert(psignal_io_arm(fds[0], POLLIN, &fds[0]));
+   assert(psignal_io_poll(events, 8u, 1000) == 1u);
+   assert(events[0].fd == fds[0] && (events[0].revents & POLLIN) && events[0].userData == &fds[0]);
+   assert(read(fds[0], buffer, sizeof(buffer)) == 1);
+
+   // New data raises the RT signal.
+   assert(write(fds[1], &byte, 1) == 1);
+   assert(psignal_io_poll(events, 8u, 1000) == 1u);
+   assert(events[0].fd == fds[0] && events[0].code == POLL_IN);
+
+   // SIGIO means the RT queue overflowed: every armed descriptor is rescanned.
+   assert(kill(getpid(), SIGIO) == 0);
+   assert(psignal_io_poll(events, 8u, 1000) == 1u);
+   assert(events[0].fd == fds[0] && events[0].code == 0);
+   assert(psignal_io_stats().rescans >= 1u);
+   assert(read(fds[0], buffer, sizeof(buffer)) == 1);
+
+   // Checks queued by another process are ignored, out of range descriptors included. The
+   // signal is blocked here so that the dispatcher thread collects it.
+   assert(psignal_io_arm(fds[1], POLLOUT, nullptr));
+   assert(psignal_io_poll(events, 8u, 1000) == 1u);
+   assert(events[0].fd == fds[1] && (events[0].revents & POLLOUT));
+
+   PSigMaskScope ioScope;
+   assert(psignal_mask_block(psignal_mask_of(psignal_io_signal()), &ioScope));
+   fflush(stdout);
+   pid_t const forger = fork();
+   assert(forger >= 0);
+   if (forger == 0)
+   {
+      int const raw = psignal_to_raw_signal(psignal_io_signal());
+      sigqueue(getppid(), raw, (union sigval) { .sival_int = INT32_MAX / 2 });
+      sigqueue(getppid(), raw, (union sigval) { .sival_int = fds[1] });
+      _exit(0);
+   }
+   assert(waitpid(forger, nullptr, 0) == forger);
+   assert(psignal_io_poll(events, 8u, 50) == 0u);
+   psignal_mask_restore(&ioScope);
+   psignal_io_disarm(fds[1]);
+
+   psignal_io_disarm(fds[0]);
+   assert(write(fds[1], &byte, 1) == 1);
+   assert(psignal_io_poll(events, 8u, 50) == 0u);
+
+   close(fds[0]);
+   close(fds[1]);
+
+   psignal_io_shutdown();
+   assert(!psignal_io_is_running());
+}
+
+static atomic_int channelMessages = 0;
+static atomic_int channelSum = 0;
+
+static void channel_callback(void const *message, unsigned const length, void *)
+{
+   assert(length == sizeof(int));
+   int value;
+   memcpy(&value, message, sizeof(value));
+   atomic_fetch_add(&channelSum, value);
+   atomic_fetch_add(&channelMessages, 1);
+}
+
+static void test_channels(void)
+{
+   printf("Testing channels...\n");
+
+   assert(psignal_channels_init());
+
+   PSigChannel *channel;
+   assert(psignal_channel_create(&(PSigChannelConfig) { .capacity = 64u, .messageSize = 16u }, &channel));
+   assert(psignal_channel_consume(channel, channel_callback, nullptr));
+   assert(!psignal_channel_consume(channel, channel_callback, nullptr));
+
+   char const tooLarge[32] = {};
+   assert(!psignal_channel_send(channel, tooLarge, sizeof(tooLarge)));
+
+   // Producers in another process, through the inherited mapping.
+   pid_t const producer = fork();
+   assert(producer >= 0);
+   if (producer == 0)
+   {
+      for (int i = 1; i <= 1000; ++i)
+      {
+         while (!psignal_channel_send(channel, &i, sizeof(i))) {}
+      }
+      _exit(0);
+   }
+
+   for (int i = 1; i <= 1000; ++i)
+   {
+      while (!psignal_channel_send(channel, &i, sizeof(i))) {}
+   }
+
+   assert(wait_for_count(&channelMessages, 2000, 5000u));
+   assert(atomic_load(&channelSum) == 2 * (1000 * 1001 / 2));
+
+   PSigChannelStats const stats = psignal_channel_stats(channel);
+   assert(stats.sent == 2000u && stats.received == 2000u);
+   assert(stats.doorbells <= stats.batches + 1u);
+
+   // A second handle mapped from the descriptor shares the ring.
+   PSigChannel *opened;
+   assert(psignal_channel_open(psignal_channel_fd(channel), &opened));
+   int const value = 7;
+   assert(psignal_channel_send(opened, &value, sizeof(value)));
+   assert(wait_for_count(&channelMessages, 2001, 1000u));
+
+   // The header is trusted once validated: a peer rewriting it afterwards changes nothing.
+   uint32_t *const header = mmap(nullptr, 16u, PROT_READ | PROT_WRITE, MAP_SHARED, psignal_channel_fd(channel), 0);
+   assert(header != MAP_FAILED);
+   uint32_t saved[4];
+   memcpy(saved, header, sizeof(saved));
+   header[1] = 1u << 24;
+   header[2] = 1u << 24;
+   header[3] = 1u << 30;
+   assert(!psignal_channel_send(opened, tooLarge, sizeof(tooLarge)));
+   for (int i = 0; i < 64; ++i)
+   {
+      while (!psignal_channel_send(opened, &value, sizeof(value))) {}
+   }
+   assert(wait_for_count(&channelMessages, 2065, 1000u));
+   memcpy(header, saved, sizeof(saved));
+   munmap(header, 16u);
+   psignal_channel_close(opened);
+
+   // Descriptors not holding a channel, or a header not fitting the file, are refused.
+   int const forged = memfd_create("forged_channel", MFD_CLOEXEC);
+   assert(forged >= 0);
+   assert(!psignal_channel_open(forged, &opened));
+   assert(ftruncate(forged, 4096) == 0);
+   assert(!psignal_channel_open(forged, &opened));
+   uint32_t const badCapacity[] = { 0x50534348u, 3u, 8u, 64u };
+   assert(pwrite(forged, badCapacity, sizeof(badCapacity), 0) == (ssize_t)sizeof(badCapacity));
+   assert(!psignal_channel_open(forged, &opened));
+   uint32_t const badSize[] = { 0x50534348u, 1u << 20, 8u, 64u };
+   assert(pwrite(forged, badSize, sizeof(badSize), 0) == (ssize_t)sizeof(badSize));
+   assert(!psignal_channel_open(forged, &opened));
+   close(forged);
+
+   psignal_channel_close(channel);
+   psignal_channels_shutdown();
+   assert(!psignal_channels_is_running());
+}
+
+static void count_fpe_site(PSigFpeSite const *site, void *arg)
+{
+   uint64_t *const traps = arg;
+   assert(site->pc != 0u && site->excepts == FE_DIVBYZERO && site->frameCount > 0u);
+   *traps += site->count;
+}
+
+static void test_fpe(void)
+{
+   printf("Testing floating point exception traps...\n");
+
+   assert(psignal_fpe_init());
+   assert(psignal_callback_is_reserved(PSignal_SIGFPE));
+
+   volatile double zero = 0.0;
+   volatile double one = 1.0;
+
+   // Masked after the first trap: the operations still produce their IEEE results.
+   PSigFpeScope scope;
+   if (!psignal_fpe_scope_begin(FE_DIVBYZERO | FE_INVALID, PSigFpeAction_MASK, &scope))
+   {
+      printf("Floating point traps unsupported, skipped.\n");
+      psignal_fpe_shutdown();
+      return;
+   }
+   volatile double const inf = one / zero;
+   volatile double const nan = zero / zero;
+   volatile double const again = one / zero;
+   psignal_fpe_scope_end(&scope);
+   assert(isinf(inf) && isnan(nan) && isinf(again));
+   assert(fegetexcept() == 0);
+   assert(psignal_fpe_sites_count() == 2u);
+
+   // Single-stepped: every faulting instruction is trapped.
+   psignal_fpe_reset_sites();
+   assert(psignal_fpe_scope_begin(FE_DIVBYZERO, PSigFpeAction_STEP, &scope));
+   for (int i = 0; i < 3; ++i)
+   {
+      volatile double const value = one / zero;
+      assert(isinf(value));
+   }
+   psignal_fpe_scope_end(&scope);
+   assert(psignal_fpe_sites_count() == 1u);
 
-static sig_atomic_t sigintReceived = 0;
-static sig_atomic_t sigsegvReceived = 0;
-static sig_atomic_t sigcontReceived = 0;
+   uint64_t traps = 0u;
+   psignal_fpe_for_each_site(count_fpe_site, &traps);
+#if defined(__x86_64__)
+   assert(traps == 3u);
+#else
+   assert(traps >= 1u);
+#endif
+   assert(psignal_fpe_dropped_count() == 0u);
 
-void crash_callback(PSigCallbackInfo const *info)
+   // Outside of a scope, nothing is trapped.
+   volatile double const untrapped = one / zero;
+   assert(isinf(untrapped));
+   assert(psignal_fpe_sites_count() == 1u);
+
+   psignal_fpe_shutdown();
+   assert(!psignal_callback_is_reserved(PSignal_SIGFPE));
+}
+
+static atomic_bool flushStarted = false;
+
+static bool phase_stop_accepting(void *arg)
 {
-   printf("Crash callback called with signal %s (%i)\n",
-      psignal_name(info->sig), psignal_to_raw_signal(info->sig)
-   );
+   atomic_fetch_add((atomic_uint *)arg, 1u);
+   return true;
+}
 
-   switch (info->sig)
+static bool phase_drain_forever(void *)
+{
+   while (!psignal_graceful_phase_abandoned())
    {
-      case PSignal_SIGINT: sigintReceived += 1; break;
-      case PSignal_SIGSEGV: sigsegvReceived += 1; break;
-      case PSignal_SIGCONT: sigcontReceived += 1; break;
-      default: break;
+      usleep(1000);
+   }
+   return true;
+}
+
+static bool phase_flush(void *)
+{
+   atomic_store(&flushStarted, true);
+   while (!psignal_graceful_phase_abandoned())
+   {
+      usleep(1000);
+   }
+   return true;
+}
+
+static bool phase_failing(void *)
+{
+   return false;
+}
+
+static void test_graceful(void)
+{
+   printf("Testing graceful shutdown...\n");
+
+   assert(!psignal_graceful_init(&(PSigGracefulConfig) { .triggerMask = (PSignalMask)1u << PSignal_SIGSEGV }));
+   assert(psignal_graceful_init(&(PSigGracefulConfig) { .keepRunning = true }));
+   assert(psignal_callback_is_reserved(PSignal_SIGTERM) && psignal_callback_is_reserved(PSignal_SIGINT));
+
+   atomic_uint accepted = 0u;
+   assert(psignal_graceful_add_phase("stop accepting", phase_stop_accepting, &accepted, 1000000000u));
+   assert(psignal_graceful_add_phase("drain", phase_drain_forever, nullptr, 20000000u));
+   assert(psignal_graceful_add_phase("flush", phase_flush, nullptr, 0u));
+   assert(psignal_graceful_add_phase("exit", phase_failing, nullptr, 0u));
+
+   assert(!psignal_graceful_requested());
+   assert(psignal_raise(PSignal_SIGTERM));
+   assert(psignal_graceful_requested());
+
+   // A second signal ends the phase that would never end by itself.
+   while (!atomic_load(&flushStarted))
+   {
+      usleep(1000);
+   }
+   assert(psignal_raise(PSignal_SIGINT));
+
+   PSigGracefulReport reports[PSIG_GRACEFUL_MAX_PHASES];
+   assert(psignal_graceful_wait(reports, PSIG_GRACEFUL_MAX_PHASES) == 4u);
+   assert(atomic_load(&accepted) == 1u);
+   assert(reports[0].outcome == PSigGracefulOutcome_COMPLETED);
+   assert(reports[1].outcome == PSigGracefulOutcome_TIMED_OUT && reports[1].durationNs >= 20000000u);
+   assert(reports[2].outcome == PSigGracefulOutcome_ESCALATED);
+   assert(reports[3].outcome == PSigGracefulOutcome_FAILED);
+   assert(strcmp(reports[1].name, "drain") == 0);
+
+   // Too late for new phases.
+   assert(!psignal_graceful_add_phase("late", phase_failing, nullptr, 0u));
+
+   psignal_graceful_shutdown();
+   assert(!psignal_callback_is_reserved(PSignal_SIGTERM));
+
+   // Shutting down abandons a phase without deadline, the next ones never start.
+   atomic_store(&flushStarted, false);
+   assert(psignal_graceful_init(&(PSigGracefulConfig) { .keepRunning = true }));
+   assert(psignal_graceful_add_phase("flush", phase_flush, nullptr, 0u));
+   assert(psignal_graceful_add_phase("exit", phase_failing, nullptr, 0u));
+   assert(psignal_graceful_request());
+   while (!atomic_load(&flushStarted))
+   {
+      usleep(1000);
+   }
+   psignal_graceful_shutdown();
+
+   assert(psignal_graceful_wait(reports, PSIG_GRACEFUL_MAX_PHASES) == 2u);
+   assert(reports[0].outcome == PSigGracefulOutcome_CANCELLED);
+   assert(reports[1].outcome == PSigGracefulOutcome_PENDING && reports[1].durationNs == 0u);
+}
+
+typedef struct ReloadedConfig
+{
+   unsigned generation;
+} ReloadedConfig;
+
+static atomic_uint reloadGeneration = 0u;
+static atomic_uint reloadFrees = 0u;
+static atomic_bool reloadGate = false;
+static atomic_bool reloadBlocked = false;
+static atomic_bool reloadFails = false;
+
+static void *load_config(void *)
+{
+   atomic_store(&reloadBlocked, true);
+   while (atomic_load(&reloadGate))
+   {
+      usleep(1000);
+   }
+   atomic_store(&reloadBlocked, false);
+
+   if (atomic_load(&reloadFails))
+      return nullptr;
+
+   ReloadedConfig *const config = malloc(sizeof(*config));
+   config->generation = atomic_fetch_add(&reloadGeneration, 1u) + 1u;
+   return config;
+}
+
+static void free_config(void *config, void *)
+{
+   atomic_fetch_add(&reloadFrees, 1u);
+   free(config);
+}
+
+static void wait_reloads(uint64_t const reloads, uint64_t const failures)
+{
+   PSigReloadStats stats;
+   do
+   {
+      usleep(1000);
+      psignal_reload_stats(&stats);
+   } while (stats.reloads < reloads || stats.failures < failures);
+}
+
+static void test_reload(void)
+{
+   printf("Testing configuration reloads...\n");
+
+   assert(psignal_reload_init(&(PSigReloadConfig) { .load = load_config, .free = free_config }));
+   assert(psignal_callback_is_reserved(PSignal_SIGHUP));
+   assert(psignal_reload_reader_online());
+   assert(((ReloadedConfig const *)psignal_reload_current())->generation == 1u);
+
+   PSigReloadHandle *const first = psignal_reload_acquire();
+   assert(((ReloadedConfig const *)psignal_reload_handle_config(first))->generation == 1u);
+
+   // Signals received while a reload is pending are merged into it.
+   atomic_store(&reloadGate, true);
+   assert(psignal_raise(PSignal_SIGHUP));
+   while (!atomic_load(&reloadBlocked))
+   {
+      usleep(1000);
+   }
+   for (int i = 0; i < 3; ++i)
+   {
+      assert(psignal_raise(PSignal_SIGHUP));
+   }
+   atomic_store(&reloadGate, false);
+   wait_reloads(2u, 0u);
+
+   PSigReloadStats stats;
+   psignal_reload_stats(&stats);
+   assert(stats.version == 3u && stats.coalesced == 2u && stats.maxLatencyNs > 0u);
+   assert(((ReloadedConfig const *)psignal_reload_current())->generation == 3u);
+
+   // Still read by this thread and referenced.
+   usleep(5000);
+   psignal_reload_stats(&stats);
+   assert(stats.retired == 2u && atomic_load(&reloadFrees) == 0u);
+
+   psignal_reload_quiescent();
+   psignal_reload_release(first);
+   while (atomic_load(&reloadFrees) < 2u)
+   {
+      usleep(1000);
+   }
+
+   // A failed reload keeps the current configuration.
+   atomic_store(&reloadFails, true);
+   assert(psignal_reload_request());
+   wait_reloads(2u, 1u);
+   assert(((ReloadedConfig const *)psignal_reload_current())->generation == 3u);
+
+   psignal_reload_reader_offline();
+   psignal_reload_shutdown();
+   assert(atomic_load(&reloadFrees) == 3u);
+   assert(!psignal_callback_is_reserved(PSignal_SIGHUP));
+}
+
+static int spawn_and_wait(char const *script, PSigSpawnConfig const *config)
+{
+   char *const argv[] = { "sh", "-c", (char *)script, nullptr };
+
+   pid_t pid;
+   assert(psignal_spawn(&pid, "/bin/sh", argv, nullptr, config));
+
+   int status = 0;
+   assert(waitpid(pid, &status, 0) == pid);
+   return status;
+}
+
+static void fork_callback(PSigCallbackInfo const *)
+{
+}
+
+static atomic_int forkParentTimer = 0;
+static atomic_int forkChildTimers = 0;
+
+// Subsystems running when forking are initialized again in the child, and work there.
+static void test_fork_reinit(void)
+{
+   assert(psignal_timers_init(&(PSigTimersConfig) { .capacity = 2u, .resolutionNs = 1000000u }));
+   assert(psignal_children_init(nullptr));
+   assert(psignal_io_init(nullptr));
+
+   PSigTimerSpec spec = {
+      .delayNs = 30000000u,
+      .delivery = PSigTimerDelivery_HANDLER,
+      .callback = timer_callback,
+      .userData = &forkParentTimer
+   };
+   assert(psignal_timer_add(&spec, nullptr));
+
+   fflush(stdout);
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      // The whole capacity is free again, and only the timers of the child fire.
+      assert(psignal_timers_init(&(PSigTimersConfig) { .capacity = 2u, .resolutionNs = 1000000u }));
+      spec.delayNs = 5000000u;
+      spec.userData = &forkChildTimers;
+      assert(psignal_timer_add(&spec, nullptr) && psignal_timer_add(&spec, nullptr));
+      sleep_ms(60u);
+      assert(atomic_load(&forkChildTimers) == 2 && atomic_load(&forkParentTimer) == 0);
+
+      assert(psignal_children_init(nullptr));
+      atomic_store(&childrenExits, 0);
+      pid_t const grandchild = fork_exiting(5, 0);
+      assert(psignal_children_watch(grandchild, child_exit_callback, (void *)(intptr_t)5));
+      assert(wait_for_count(&childrenExits, 1, 2000u));
+
+      assert(psignal_io_init(nullptr));
+      int fds[2];
+      assert(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+      assert(psignal_io_arm(fds[1], POLLOUT, nullptr));
+      PSigIoEvent event;
+      assert(psignal_io_poll(&event, 1u, 1000) == 1u && event.fd == fds[1]);
+      _exit(0);
+   }
+
+   int status = 0;
+   while (waitpid(pid, &status, 0) < 0)
+   {
+      assert(errno == EINTR);
+   }
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+   assert(wait_for_count(&forkParentTimer, 1, 1000u));
+
+   psignal_io_shutdown();
+   psignal_children_shutdown();
+   psignal_timers_shutdown();
+}
+
+static void test_spawn(void)
+{
+   printf("Testing spawn and fork...\n");
+
+   pid_t pid;
+   char *const missing[] = { "missing", nullptr };
+   assert(!psignal_spawn(&pid, "/nonexistent/program", missing, nullptr, nullptr));
+
+   // Blocked in the new program: the signal stays pending.
+   int status = spawn_and_wait("kill -USR1 $$; exit 3",
+      &(PSigSpawnConfig) { .blockedMask = (PSignalMask)1u << PSignal_SIGUSR1 });
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+
+   status = spawn_and_wait("kill -USR1 $$; exit 3", nullptr);
+   assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGUSR1);
+
+   // Ignored signals would be inherited through exec, they are reset by default.
+   struct sigaction ignore = { .sa_handler = SIG_IGN }, previous;
+   sigemptyset(&ignore.sa_mask);
+   assert(sigaction(SIGUSR2, &ignore, &previous) == 0);
+
+   status = spawn_and_wait("kill -USR2 $$; exit 3", nullptr);
+   assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGUSR2);
+   status = spawn_and_wait("kill -USR2 $$; exit 3",
+      &(PSigSpawnConfig) { .defaultMask = (PSignalMask)1u << PSignal_SIGUSR1 });
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+
+   assert(sigaction(SIGUSR2, &previous, nullptr) == 0);
+
+   // A forked child starts with an empty callback table and no subsystem thread.
+   assert(psignal_threads_init());
+   assert(psignal_callback_hook_on_sig(PSignal_SIGUSR1, fork_callback));
+
+   pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      bool const reset = !psignal_callback_is_hooked_on(PSignal_SIGUSR1, fork_callback)
+         && !psignal_threads_is_running() && psignal_library_is_running();
+      _exit(reset ? 0 : 1);
+   }
+   assert(waitpid(pid, &status, 0) == pid);
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+   assert(psignal_callback_is_hooked_on(PSignal_SIGUSR1, fork_callback));
+   psignal_callback_remove_from_sig(PSignal_SIGUSR1, fork_callback);
+   psignal_threads_shutdown();
+
+   test_fork_reinit();
+}
+
+static volatile unsigned stackFrames = UINT32_MAX;
+
+// Each frame uses about 1KiB of stack.
+static unsigned touch_stack(unsigned const remaining)
+{
+   volatile char frame[1024];
+   frame[0] = (char)remaining;
+   frame[sizeof(frame) - 1u] = frame[0];
+   return (remaining == 0u) ? 0u : touch_stack(remaining - 1u) + (unsigned)frame[sizeof(frame) - 1u];
+}
+
+typedef struct StackThread
+{
+   atomic_bool touched;
+   atomic_bool release;
+   pid_t tid;
+} StackThread;
+
+static void *stack_thread_main(void *arg)
+{
+   StackThread *const thread = arg;
+   assert(psignal_thread_register(nullptr));
+   thread->tid = gettid();
+
+   (void)touch_stack(256u);
+   atomic_store(&thread->touched, true);
+   while (!atomic_load(&thread->release))
+   {
+      sched_yield();
+   }
+
+   psignal_thread_unregister();
+   return nullptr;
+}
+
+static void find_stack_usage(PSigStackUsage const *usage, void *arg)
+{
+   PSigStackUsage *const found = arg;
+   if (usage->tid == found->tid)
+   {
+      *found = *usage;
+   }
+}
+
+static void overflow_callback(PSigCallbackInfo const *)
+{
+   PSigStackOverflow overflow;
+   bool const detected = psignal_stack_overflow_current(&overflow)
+      && overflow.tid == gettid() && overflow.depth + 64u * 1024u >= overflow.stackSize;
+   _exit(detected ? 42 : 43);
+}
+
+static void *overflow_thread_main(void *)
+{
+   if (!psignal_thread_register(nullptr))
+      _exit(44);
+
+   (void)touch_stack(stackFrames);
+   return nullptr;
+}
+
+static void test_stack(void)
+{
+   printf("Testing stack overflows and high-water marks...\n");
+
+   assert(psignal_stack_init(&(PSigStackConfig) { .samplePeriodNs = 1000000u }));
+   assert(psignal_callback_is_reserved(PSignal_SIGSEGV));
+
+   pthread_attr_t attr;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, 1024u * 1024u);
+
+   StackThread thread = {};
+   pthread_t handle;
+   assert(pthread_create(&handle, &attr, &stack_thread_main, &thread) == 0);
+   while (!atomic_load(&thread.touched))
+   {
+      sched_yield();
+   }
+
+   PSigStackUsage usage = { .tid = thread.tid };
+   psignal_stack_for_each(&find_stack_usage, &usage);
+   assert(usage.stackSize >= 1024u * 1024u);
+   assert(usage.highWater >= 256u * 1024u && usage.highWater < usage.stackSize);
+
+   uint64_t const samples = psignal_stack_samples_count();
+   while (psignal_stack_samples_count() < samples + 2u)
+   {
+      sched_yield();
+   }
+   size_t peakStackSize = 0u;
+   assert(psignal_stack_peak_high_water(&peakStackSize) >= 256u * 1024u);
+   assert(peakStackSize >= 1024u * 1024u);
+
+   atomic_store(&thread.release, true);
+   pthread_join(handle, nullptr);
+
+   // Overflowing a registered thread: the callback sees it, then the process is terminated.
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      // Reserved, but the faults not overflowing a stack are forwarded.
+      if (!psignal_callback_hook_on_sig(PSignal_SIGSEGV, overflow_callback))
+         _exit(45);
+
+      pthread_attr_setstacksize(&attr, 256u * 1024u);
+      pthread_t overflowing;
+      if (pthread_create(&overflowing, &attr, &overflow_thread_main, nullptr) != 0)
+         _exit(46);
+      pthread_join(overflowing, nullptr);
+      _exit(47);
+   }
+   pthread_attr_destroy(&attr);
+
+   int status = 0;
+   assert(waitpid(pid, &status, 0) == pid);
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 42);
+
+   psignal_stack_shutdown();
+   assert(!psignal_callback_is_reserved(PSignal_SIGSEGV));
+}
+
+static void test_masks(void)
+{
+   printf("Testing signal masks...\n");
+
+   PSignalMask const a = psignal_mask_of(PSignal_SIGINT) | psignal_mask_of(PSignal_SIGTERM);
+   PSignalMask const b = psignal_mask_of(PSignal_SIGTERM) | psignal_mask_of(PSignal_SIGRTMAX);
+   assert(psignal_mask_count(psignal_mask_union(a, b)) == 3u);
+   assert(psignal_mask_intersect(a, b) == psignal_mask_of(PSignal_SIGTERM));
+   assert(psignal_mask_diff(a, b) == psignal_mask_of(PSignal_SIGINT));
+   assert(psignal_mask_has(b, PSignal_SIGRTMAX) && !psignal_mask_has(b, PSignal_SIGINT));
+   assert(psignal_mask_count(psignal_disposition_mask_all()) == PSignal_ENUM_COUNT);
+
+   // Visits the set bits only, lowest first.
+   PSignal psig;
+   PSignal previous = PSignal_ENUM_FIRST;
+   unsigned visited = 0u;
+   for (PSignalMask it = psignal_mask_union(a, b); psignal_mask_next(&it, &psig); ++visited)
+   {
+      assert(visited == 0u || psig > previous);
+      assert(psignal_mask_has(psignal_mask_union(a, b), psig));
+      previous = psig;
+   }
+   assert(visited == 3u);
+
+   sigset_t set;
+   PSignalMask const all = psignal_disposition_mask_all();
+   psignal_mask_to_sigset(all, &set);
+   assert(psignal_mask_from_sigset(&set) == all);
+   psignal_mask_to_sigset(b, &set);
+   assert(sigismember(&set, SIGTERM) == 1 && sigismember(&set, SIGRTMAX) == 1);
+   assert(sigismember(&set, SIGINT) == 0);
+   assert(psignal_mask_from_sigset(&set) == b);
+
+   // SIGTERM is blocked by the outer scope only, restoring the inner one keeps it blocked.
+   PSignalMask const initial = psignal_mask_blocked();
+   assert(psignal_mask_intersect(initial, psignal_mask_union(a, b)) == 0u);
+
+   PSigMaskScope outer, inner;
+   assert(psignal_mask_block(psignal_mask_of(PSignal_SIGTERM), &outer));
+   assert(psignal_mask_block(b, &inner));
+   assert(inner.changed == psignal_mask_of(PSignal_SIGRTMAX));
+   pthread_sigmask(SIG_BLOCK, nullptr, &set);
+   assert(sigismember(&set, SIGTERM) == 1 && sigismember(&set, SIGRTMAX) == 1);
+   psignal_mask_restore(&inner);
+   assert(psignal_mask_blocked() == psignal_mask_union(initial, psignal_mask_of(PSignal_SIGTERM)));
+
+   PSigMaskScope unblocked;
+   assert(psignal_mask_unblock(a, &unblocked));
+   assert(psignal_mask_blocked() == initial);
+   psignal_mask_restore(&unblocked);
+   psignal_mask_restore(&unblocked);
+   assert(psignal_mask_has(psignal_mask_blocked(), PSignal_SIGTERM));
+
+   psignal_mask_restore(&outer);
+   assert(psignal_mask_blocked() == initial);
+}
+
+typedef struct ProcScan
+{
+   pid_t tid;
+   PSignalMask blocked;
+   atomic_uint visited;
+   atomic_uint found;
+} ProcScan;
+
+static void find_proc_state(PSigProcState const *state, void *arg)
+{
+   ProcScan *const scan = arg;
+   atomic_fetch_add(&scan->visited, 1u);
+   // The scanning thread blocks every signal for a moment when it creates the other workers.
+   if (state->tid == scan->tid && state->pid == getpid())
+   {
+      assert(psignal_mask_intersect(state->blocked, scan->blocked) == scan->blocked);
+      atomic_fetch_add(&scan->found, 1u);
+   }
+}
+
+static void test_proc(void)
+{
+   printf("Testing /proc signal states...\n");
+
+   static char const STATUS[] =
+      "Name:\ttests.out\nThreads:\t1\nSigQ:\t3/63704\nSigPnd:\t0000000000000000\n"
+      "ShdPnd:\t0000000000004000\nSigBlk:\t8000000000000002\nSigIgn:\t0000000000001000\n"
+      "SigCgt:\t00000001000004Ec\nCapInh:\t0000000000000000\n";
+   PSigProcState state = {};
+   assert(psignal_proc_parse_status(STATUS, sizeof(STATUS) - 1u, &state));
+   assert(state.queued == 3u && state.queueLimit == 63704u);
+   assert(state.pending == 0u);
+   assert(state.sharedPending == psignal_mask_of(PSignal_SIGTERM));
+   assert(state.blocked == (psignal_mask_of(PSignal_SIGINT) | psignal_mask_of(PSignal_SIGRTMAX)));
+   assert(state.ignored == psignal_mask_of(PSignal_SIGPIPE));
+   assert(psignal_mask_has(state.caught, PSignal_SIGSEGV) && psignal_mask_count(state.caught) == 6u);
+
+   // Cut before SigCgt, then with a malformed mask.
+   assert(!psignal_proc_parse_status(STATUS, sizeof(STATUS) - 45u, &state));
+   assert(!psignal_proc_parse_status("SigQ:\t0/1\nSigPnd:\tz\n", 19u, &state));
+
+   PSignalMask const scoped = psignal_mask_of(PSignal_SIGUSR2) | psignal_mask_of(PSignal_SIGRTMIN_3);
+   PSigMaskScope scope;
+   assert(psignal_mask_block(scoped, &scope));
+   PSignalMask const blocked = psignal_mask_blocked();
+
+   assert(psignal_proc_read(getpid(), gettid(), &state));
+   assert(state.pid == getpid() && state.tid == gettid());
+   assert(state.blocked == blocked);
+   assert(psignal_mask_has(state.caught, PSignal_SIGINT));
+
+   ProcScan scan = { .tid = gettid(), .blocked = scoped };
+   assert(psignal_proc_scan(&(PSigProcScanConfig) { .threads = true, .workers = 4u }, &find_proc_state, &scan));
+   assert(atomic_load(&scan.found) == 1u && atomic_load(&scan.visited) > 1u);
+
+   psignal_mask_restore(&scope);
+   assert(!psignal_proc_scan(&(PSigProcScanConfig) { .root = "/nonexistent" }, &find_proc_state, &scan));
+}
+
+typedef struct GovernorEvents
+{
+   PSigGovernorEvent last;
+   _Atomic(uint64_t) reactionNs;
+   atomic_uint count;
+} GovernorEvents;
+
+static void record_throttle(PSigGovernorEvent const *event, void *arg)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   GovernorEvents *const events = arg;
+   events->last = *event;
+   atomic_store(&events->reactionNs, (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec - event->signalNs);
+   atomic_fetch_add(&events->count, 1u);
+}
+
+static void wait_throttles(GovernorEvents *const events, unsigned const count)
+{
+   while (atomic_load(&events->count) < count)
+   {
+      sleep_ms(1u);
+   }
+}
+
+// Hard limits can't be raised back: the limits are lowered in a child.
+static void test_governor(void)
+{
+   printf("Testing resource limits governor...\n");
+   fflush(stdout);
+
+   pid_t const pid = fork();
+   assert(pid >= 0);
+   if (pid == 0)
+   {
+      static constexpr unsigned BLOCK = 4096u;
+      assert(setrlimit(RLIMIT_FSIZE, &(struct rlimit) { .rlim_cur = 3u * BLOCK, .rlim_max = 3u * BLOCK }) == 0);
+      assert(setrlimit(RLIMIT_CPU, &(struct rlimit) { .rlim_cur = 3u, .rlim_max = 3u }) == 0);
+
+      GovernorEvents events = {};
+      assert(psignal_governor_add_throttle(&record_throttle, &events));
+      assert(!psignal_governor_init(&(PSigGovernorConfig) {
+         .limits[PSigGovernorResource_FILE_SIZE] = { .soft = 3u * BLOCK }
+      }));
+      assert(psignal_governor_init(&(PSigGovernorConfig) {
+         .limits[PSigGovernorResource_CPU] = { .soft = 1u, .steps = 2u },
+         .limits[PSigGovernorResource_FILE_SIZE] = { .soft = BLOCK, .steps = 2u }
+      }));
+      assert(psignal_callback_is_reserved(PSignal_SIGXCPU) && psignal_callback_is_reserved(PSignal_SIGXFSZ));
+
+      // A forked child has no governor: its soft limits are the ones from before init.
+      pid_t const forked = fork();
+      assert(forked >= 0);
+      if (forked == 0)
+      {
+         struct rlimit fsize, cpu;
+         bool const restored = getrlimit(RLIMIT_FSIZE, &fsize) == 0 && fsize.rlim_cur == 3u * BLOCK
+            && getrlimit(RLIMIT_CPU, &cpu) == 0 && cpu.rlim_cur == 3u;
+         _exit(restored ? 0 : 1);
+      }
+      int forkedStatus = 0;
+      while (waitpid(forked, &forkedStatus, 0) < 0)
+      {
+         assert(errno == EINTR);
+      }
+      assert(WIFEXITED(forkedStatus) && WEXITSTATUS(forkedStatus) == 0);
+
+      // Each write past the soft limit fails once, the handler having raised it for the retry.
+      int const fd = memfd_create("governor", 0);
+      assert(fd >= 0);
+      static char const block[BLOCK] = {};
+      unsigned failures = 0u;
+      for (unsigned i = 0; i < 3u; ++i)
+      {
+         while (write(fd, block, BLOCK) != (ssize_t)BLOCK)
+         {
+            assert(errno == EFBIG && ++failures <= 2u);
+         }
+      }
+      assert(failures == 2u);
+      wait_throttles(&events, 2u);
+      assert(events.last.resource == PSigGovernorResource_FILE_SIZE);
+      assert(events.last.step == 2u && events.last.steps == 2u);
+      assert(events.last.softLimit == 3u * BLOCK && events.last.hardLimit == 3u * BLOCK);
+
+      // At the hard limit, writes fail for good.
+      assert(write(fd, block, BLOCK) < 0 && errno == EFBIG);
+      close(fd);
+
+      PSigGovernorStats stats;
+      psignal_governor_stats(&stats);
+      assert(stats.signals[PSigGovernorResource_FILE_SIZE] == 3u && stats.raises == 2u && stats.exhausted == 1u);
+      printf("File size limit reaction: %.3f ms to the throttle (max %.3f ms to the dispatch)\n",
+         atomic_load(&events.reactionNs) / 1000000.0, stats.maxReactionNs / 1000000.0
+      );
+      assert(stats.maxReactionNs < 100000000u);
+
+      // One second of CPU time, past which the process would have dumped a core.
+      struct timespec start, now;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      do
+      {
+         clock_gettime(CLOCK_MONOTONIC, &now);
+      } while (atomic_load(&events.count) < 3u && now.tv_sec - start.tv_sec < 10);
+      assert(atomic_load(&events.count) == 3u);
+      assert(events.last.resource == PSigGovernorResource_CPU);
+      assert(events.last.step == 1u && events.last.softLimit == 2u && events.last.hardLimit == 3u);
+      printf("CPU time limit reaction: %.3f ms to the throttle\n", atomic_load(&events.reactionNs) / 1000000.0);
+
+      psignal_governor_shutdown();
+      assert(!psignal_callback_is_reserved(PSignal_SIGXCPU));
+      struct rlimit cpu;
+      assert(getrlimit(RLIMIT_CPU, &cpu) == 0 && cpu.rlim_cur == 3u);
+      fflush(stdout);
+      _exit(0);
+   }
+
+   int status = 0;
+   assert(waitpid(pid, &status, 0) == pid);
+   assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void resize_terminal(int const fd, unsigned short const rows, unsigned short const cols)
+{
+   assert(ioctl(fd, TIOCSWINSZ, &(struct winsize) { .ws_row = rows, .ws_col = cols }) == 0);
+   assert(psignal_raise(PSignal_SIGWINCH));
+}
+
+static void test_winsize(void)
+{
+   printf("Testing terminal size cache...\n");
+
+   int const master = posix_openpt(O_RDWR | O_NOCTTY);
+   assert(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0);
+   int const terminal = open(ptsname(master), O_RDWR | O_NOCTTY);
+   assert(terminal >= 0);
+   assert(ioctl(terminal, TIOCSWINSZ, &(struct winsize) { .ws_row = 24u, .ws_col = 80u }) == 0);
+
+   int const notTerminal = memfd_create("winsize", 0);
+   assert(!psignal_winsize_init(&(PSigWinsizeConfig) { .fd = notTerminal }));
+   close(notTerminal);
+
+   assert(psignal_winsize_init(&(PSigWinsizeConfig) { .fd = terminal }));
+   PSigWinsize size = psignal_winsize_get();
+   assert(size.rows == 24u && size.cols == 80u);
+
+   uint32_t generation = size.generation;
+   assert(!psignal_winsize_changed(&generation, &size));
+
+   resize_terminal(terminal, 30u, 100u);
+   assert(psignal_winsize_changed(&generation, &size));
+   assert(size.rows == 30u && size.cols == 100u && generation == size.generation);
+
+   // Signals without a size change don't bump the generation.
+   assert(psignal_raise(PSignal_SIGWINCH));
+   assert(psignal_winsize_refresh());
+   assert(!psignal_winsize_changed(&generation, nullptr));
+   psignal_winsize_shutdown();
+   assert(psignal_winsize_get().rows == 0u);
+
+   // A burst within the window is a single refresh, to its last size.
+   assert(psignal_winsize_init(&(PSigWinsizeConfig) { .fd = terminal, .coalesceNs = 50000000u }));
+   assert(psignal_winsize_changed(&generation, &size));
+   for (unsigned short i = 1u; i <= 10u; ++i)
+   {
+      resize_terminal(terminal, 30u + i, 100u + i);
+   }
+   while (!psignal_winsize_changed(&generation, &size))
+   {
+      sleep_ms(1u);
    }
+   assert(size.rows == 40u && size.cols == 110u);
+   PSigDispatchStats stats;
+   psignal_callback_policy_stats(PSignal_SIGWINCH, &stats);
+   assert(stats.received == 10u && stats.dispatched == 1u);
+
+   psignal_winsize_shutdown();
+   assert(!psignal_winsize_refresh());
+   close(terminal);
+   close(master);
+}
+
+static constexpr long SECCOMP_FAKE_PARENT = 4242;
+
+static bool emulate_getppid(PSigSyscall *call)
+{
+   call->result = *(long const *)call->userData;
+   return true;
+}
+
+static bool passthrough_getsid(PSigSyscall *)
+{
+   return false;
+}
+
+// Installs a filter that can't be removed: runs last, trapping syscalls nothing else uses.
+static void test_seccomp(void)
+{
+   printf("Testing seccomp traps...\n");
+
+   static long const fakeParent = SECCOMP_FAKE_PARENT;
+   long const realSession = syscall(SYS_getsid, 0);
+
+   assert(psignal_seccomp_init());
+   assert(psignal_callback_is_reserved(PSignal_SIGSYS));
+   assert(psignal_seccomp_set_handler(SYS_getppid, emulate_getppid, (void *)&fakeParent));
+   assert(psignal_seccomp_set_handler(SYS_getsid, passthrough_getsid, nullptr));
+   assert(!psignal_seccomp_set_handler(-1, emulate_getppid, nullptr));
+   assert(psignal_seccomp_install());
+   assert(psignal_seccomp_is_trapped(SYS_getppid) && !psignal_seccomp_is_trapped(SYS_getpid));
+
+   assert(syscall(SYS_getppid) == fakeParent);
+   assert(syscall(SYS_getsid, 0) == realSession);
+   assert(psignal_seccomp_trap_count() == 2u);
+
+   // The filter outlives the module.
+   psignal_seccomp_shutdown();
+   assert(psignal_seccomp_is_running());
 }
 
 
@@ -40,18 +1827,56 @@ int main(void)
       char const *type     = psignal_is_standard(idx) ? "STANDARD" : "REAL-TIME";
 
       printf("POSIX Signal %2i -> %-15s (%-45s) - %s\n", rawSignal, name, desc, type);
+
+      PSignal fromRaw;
+      assert(psignal_from_raw_signal(rawSignal, &fromRaw) && fromRaw == idx);
+      PSignal fromName;
+      assert(psignal_from_name(name, &fromName) && fromName == idx);
    }
 
+   PSignal named;
+   assert(psignal_from_name("TERM", &named) && named == PSignal_SIGTERM);
+   assert(psignal_from_name("sigchld", &named) && named == PSignal_SIGCHLD);
+   assert(psignal_from_name("io", &named) && named == PSignal_SIGIO);
+   assert(psignal_from_name("SIGIOT", &named) && named == PSignal_SIGABRT);
+   assert(psignal_from_name("CLD", &named) && named == PSignal_SIGCHLD);
+   assert(psignal_from_name("RTMIN", &named) && named == PSignal_SIGRTMIN);
+   assert(psignal_from_name("RTMIN+3", &named) && named == PSignal_SIGRTMIN_3);
+   assert(psignal_from_name("SIGRTMIN+16", &named) && named == PSignal_SIGRTMAX_14);
+   assert(psignal_from_name("sigrtmax-2", &named) && named == PSignal_SIGRTMAX_2);
+   assert(psignal_from_name("RTMAX - 30", &named) && named == PSignal_SIGRTMIN);
+   assert(!psignal_from_name("", &named));
+   assert(!psignal_from_name("SIG", &named));
+   assert(!psignal_from_name("SIGTERMS", &named));
+   assert(!psignal_from_name("SIGFOO", &named));
+   assert(!psignal_from_name("TERM ", &named));
+   assert(!psignal_from_name("RTMIN-1", &named));
+   assert(!psignal_from_name("RTMIN+31", &named));
+   assert(!psignal_from_name("RTMAX-", &named));
+   assert(!psignal_from_name("RTMIN+0003x", &named));
+
+   assert(strcmp(psignal_emission_reason(PSignal_SIGSEGV, SEGV_MAPERR), "Address not mapped to object.") == 0);
+   assert(strcmp(psignal_emission_reason(PSignal_SIGCHLD, CLD_CONTINUED), "Stopped child has continued") == 0);
+   assert(strcmp(psignal_emission_reason(PSignal_SIGUSR1, SI_QUEUE), "Sent by sigqueue.") == 0);
+   assert(strcmp(psignal_emission_reason(PSignal_SIGTERM, SI_KERNEL), "Sent by kernel.") == 0);
+   assert(strcmp(psignal_emission_reason(PSignal_SIGILL, 1000), "Unspecified reason") == 0);
+   assert(strcmp(psignal_emission_reason(PSignal_SIGFPE, -1), "Unspecified reason") == 0);
+
+   PSignal unknown;
+   assert(!psignal_from_raw_signal(0, &unknown));
+   assert(!psignal_from_raw_signal(-1, &unknown));
+   assert(!psignal_from_raw_signal(SIGRTMAX + 1, &unknown));
+
    assert(psignal_callback_hook_on_disposition(PSigDisposition_TERMINATE, crash_callback));
    assert(psignal_callback_hook_on_disposition(PSigDisposition_CORE_DUMP, crash_callback));
    assert(psignal_callback_hook_on_disposition(PSigDisposition_STOP, crash_callback));
    for (PSignal idx = PSignal_ENUM_FIRST; idx <= PSignal_ENUM_LAST; ++idx)
    {
       PSigDisposition const disp = psignal_disposition_default(idx);
-      bool const shouldBeHooked =
-          ( disp == PSigDisposition_TERMINATE
-         || disp == PSigDisposition_CORE_DUMP
-         || disp == PSigDisposition_STOP);
+      bool const shouldBeHooked = psignal_is_compiled(idx)
+         && ( disp == PSigDisposition_TERMINATE
+           || disp == PSigDisposition_CORE_DUMP
+           || disp == PSigDisposition_STOP);
       assert(psignal_callback_is_hooked_on(idx, crash_callback) == shouldBeHooked);
    }
 
@@ -77,12 +1902,38 @@ int main(void)
       assert(!psignal_callback_is_hooked_on(idx, crash_callback));
    }
 
+   test_masks();
+   test_proc();
+   test_policies();
+   test_arena();
+   test_timers();
+   test_threads();
+   test_preemption();
+   test_watchdog();
+   test_children();
+   test_pid1();
+   test_io();
+   test_channels();
+   test_fpe();
+   test_stack();
+   test_graceful();
+   test_reload();
+   test_governor();
+   test_winsize();
+   test_spawn();
+   test_seccomp();
+
 
    psignal_library_shutdown();
    assert(psignal_library_is_running() == false);
    psignal_library_shutdown();
    assert(psignal_library_is_running() == false);
 
+   // The seccomp filter outlives the library, its traps are still dispatched.
+   assert(psignal_seccomp_is_running());
+   assert(syscall(SYS_getppid) == SECCOMP_FAKE_PARENT);
+   assert(psignal_seccomp_trap_count() == 3u);
+
    printf("\nAll tests passed !\n");
 
    return 0;
@@ -1,6 +1,6 @@
 #!/bin/bash
 
-gcc -std=c23 -Wall -Wextra -Werror main.c  -L./../ -l:libposix-signals.a -I../include/ -o tests.out
+gcc -std=c23 -Wall -Wextra -Werror main.c  -L./../ -l:libposix-signals.a -pthread -lm -I../include/ -o tests.out
 
 if [[ $? == 0 ]]; then
    ./tests.out
@@ -0,0 +1,165 @@
+#define _GNU_SOURCE
+
+#include "libposix_signals/libposix_signals.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+   Runs corpus files through the signal simulator (make simulate). The events of a file make one
+   run. A file can also hold fuzzing directives, each one a run of its own, twice to check it is
+   reproducible:
+
+      fuzz <seed> <events> [<nest %> <hook %> <policy %>]
+*/
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool run(char const *const name, PSigSimEvent const *const events, size_t const count,
+   unsigned const *const lines, PSigSimReport *const report)
+{
+   uint64_t const start = now_ns();
+   bool const passed = psignal_sim_run(events, count, report);
+   uint64_t const elapsedNs = now_ns() - start;
+
+   printf("%-32s: %10zu events | %10" PRIu64 " calls | depth %2u | %7.2f M events/s | %016" PRIx64 "\n",
+      name, count, report->calls, report->maxDepth, count * 1000.0 / (double)(elapsedNs + 1u), report->checksum
+   );
+
+   if (!passed)
+   {
+      printf("   FAILED: %" PRIu64 " violation(s), first: %s at event %zu",
+         report->violations, psignal_sim_violation_name(report->firstViolation), report->firstViolationEvent
+      );
+      if (lines != nullptr && report->firstViolationEvent < count)
+      {
+         printf(" (line %u)", lines[report->firstViolationEvent]);
+      }
+      printf("\n");
+   }
+   return passed;
+}
+
+static bool fuzz(char const *const path, unsigned const line, char const *const args)
+{
+   unsigned long long seed, count;
+   PSigSimGenConfig config = { .nestPercent = 20u, .hookPercent = 10u, .policyPercent = 5u };
+   int const fields = sscanf(args, "%llu %llu %u %u %u", &seed, &count,
+      &config.nestPercent, &config.hookPercent, &config.policyPercent
+   );
+   if (fields != 2 && fields != 5)
+   {
+      printf("%s:%u: invalid fuzz directive\n", path, line);
+      return false;
+   }
+   config.seed = seed;
+
+   PSigSimEvent *const events = malloc(count * sizeof(PSigSimEvent));
+   if (events == nullptr)
+      return false;
+
+   psignal_sim_generate(&config, events, count);
+
+   char name[64];
+   snprintf(name, sizeof(name), "fuzz %llu", seed);
+   PSigSimReport first, second;
+   bool passed = run(name, events, count, nullptr, &first);
+   if (passed && (!psignal_sim_run(events, count, &second) || second.checksum != first.checksum))
+   {
+      printf("   FAILED: seed %llu isn't reproducible\n", seed);
+      passed = false;
+   }
+
+   free(events);
+   return passed;
+}
+
+static bool run_corpus(char const *const path)
+{
+   FILE *const file = fopen(path, "r");
+   if (file == nullptr)
+   {
+      printf("%s: can't be opened\n", path);
+      return false;
+   }
+
+   PSigSimEvent *events = nullptr;
+   unsigned *lines = nullptr;
+   size_t count = 0u, capacity = 0u;
+   bool passed = true;
+
+   char *text = nullptr;
+   size_t textCapacity = 0u;
+   unsigned line = 0u;
+   while (getline(&text, &textCapacity, file) > 0)
+   {
+      line += 1u;
+      if (strncmp(text, "fuzz ", 5) == 0)
+      {
+         passed = fuzz(path, line, text + 5) && passed;
+         continue;
+      }
+
+      if (count == capacity)
+      {
+         capacity = (capacity == 0u) ? 64u : capacity * 2u;
+         events = realloc(events, capacity * sizeof(PSigSimEvent));
+         lines = realloc(lines, capacity * sizeof(unsigned));
+      }
+
+      switch (psignal_sim_parse(text, &events[count]))
+      {
+         case PSigSimParse_EVENT:
+            lines[count++] = line;
+            break;
+
+         case PSigSimParse_BLANK:
+            break;
+
+         case PSigSimParse_ERROR:
+            printf("%s:%u: invalid event: %s", path, line, text);
+            passed = false;
+            break;
+      }
+   }
+   free(text);
+   fclose(file);
+
+   if (count != 0u)
+   {
+      PSigSimReport report;
+      passed = run(path, events, count, lines, &report) && passed;
+   }
+
+   free(events);
+   free(lines);
+   return passed;
+}
+
+
+int main(int const argc, char const *const *const argv)
+{
+   if (argc < 2)
+   {
+      printf("Usage: %s <corpus.psim>...\n", argv[0]);
+      return 2;
+   }
+
+   unsigned failures = 0u;
+   for (int i = 1; i < argc; ++i)
+   {
+      failures += !run_corpus(argv[i]);
+   }
+
+   printf("%u corpus file(s), %u failed\n", (unsigned)(argc - 1), failures);
+   return (failures == 0u) ? 0 : 1;
+}